@@ -0,0 +1,369 @@
+
+// ================================================================================================
+// File: Apps/AssetCooker/VkAppAssetCooker.cpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Offline asset cooker - converts source models and textures to optimized binaries.
+// ================================================================================================
+
+#include "Apps/VulkanDemoApp.hpp"
+#include "VkToolbox/Hashing.hpp"
+#include "VkToolbox/Image.hpp"
+#include "VkToolbox/Mesh.hpp"
+#include "VkToolbox/Texture.hpp"
+
+#include <vector>
+
+#if defined(WIN32) || defined(WIN64)
+    #define NOMINMAX 1
+    #define WIN32_LEAN_AND_MEAN 1
+    #include <Windows.h>
+#endif // WIN32 || WIN64
+
+using namespace VkToolbox;
+
+// ========================================================
+// class VkAppAssetCooker:
+// ========================================================
+
+// Walks Assets/Models and Assets/Textures and converts every source asset
+// into its optimized binary form - .bmesh for models, mipmapped .dxtc for
+// textures - so the demo apps start up as pure binary streaming, paying no
+// assimp/STB import cost. Cooking is incremental: sources are keyed by a
+// content hash kept in a manifest file, and only changed files are re-cooked.
+//
+// Run it like any other demo:
+//   VulkanDemo.exe -VkAppAssetCooker
+//
+// It cooks and exits without entering the render loop.
+class VkAppAssetCooker final
+    : public VulkanDemoApp
+{
+public:
+
+    VkAppAssetCooker(const StartupOptions & options)
+        : VulkanDemoApp{ options }
+    { }
+
+    void onRunMainLoop() override;
+
+private:
+
+    // One entry per cooked source file. The path hash stands in for the
+    // file name so the manifest entries are fixed-size PODs.
+    struct ManifestEntry
+    {
+        Hash64 sourcePathHash;
+        Hash64 sourceContentHash;
+    };
+
+    struct CookStats
+    {
+        int cooked  = 0;
+        int skipped = 0;
+        int failed  = 0;
+    };
+
+    void loadManifest();
+    void saveManifest() const;
+    bool isUpToDate(const char * sourceFile, const char * outputFile, Hash64 * outContentHash);
+    void updateManifest(const char * sourceFile, Hash64 contentHash);
+
+    void cookModels(const char * directory);
+    void cookTextures(const char * directory);
+    void cookModelFile(const char * sourceFile);
+    void cookTextureFile(const char * sourceFile);
+
+    template<typename Func>
+    static void forEachFileInDirectory(const char * directory, Func && fn);
+
+    static Hash64 hashFileContents(const char * filePath);
+    static float importerScaleForModel(const char * sourceFile);
+
+    std::vector<ManifestEntry> m_manifest;
+    CookStats m_stats;
+};
+
+VULKAN_DEMO_REGISTER_APP(VkAppAssetCooker);
+
+// ========================================================
+
+constexpr const char *  CookerManifestFile  = "Assets/CookerManifest.bin";
+constexpr std::uint32_t CookerManifestMagic = 'TFMC'; // CMFT 4cc
+
+struct CookerManifestHeader
+{
+    std::uint32_t magic;
+    std::int32_t  entryCount;
+};
+
+// ========================================================
+
+void VkAppAssetCooker::onRunMainLoop()
+{
+    const auto startMs = timeMilliseconds();
+
+    loadManifest();
+    cookModels(VKTB_MESH_MODELS_PATH);
+    cookTextures(VKTB_TEXTURES_PATH);
+    saveManifest();
+
+    Log::debugF("Asset cook finished in %i ms: %i cooked, %i up-to-date, %i failed.",
+                static_cast<int>(timeMilliseconds() - startMs),
+                m_stats.cooked, m_stats.skipped, m_stats.failed);
+
+    // No render loop - cook and exit.
+}
+
+// ========================================================
+
+void VkAppAssetCooker::loadManifest()
+{
+    m_manifest.clear();
+
+    ScopedFileHandle fileIn = openFile(CookerManifestFile, "rb");
+    if (fileIn == nullptr)
+    {
+        return; // First run - everything gets cooked.
+    }
+
+    CookerManifestHeader header = {};
+    if (!readStructFromFile(fileIn, &header) ||
+        header.magic != CookerManifestMagic || header.entryCount <= 0)
+    {
+        Log::warningF("Cooker manifest '%s' is damaged - recooking everything.", CookerManifestFile);
+        return;
+    }
+
+    m_manifest.resize(header.entryCount);
+    readArrayFromFile(fileIn, m_manifest.data(), m_manifest.size());
+}
+
+void VkAppAssetCooker::saveManifest() const
+{
+    ScopedFileHandle fileOut = openFile(CookerManifestFile, "wb");
+    if (fileOut == nullptr)
+    {
+        Log::warningF("Can't write cooker manifest '%s'!", CookerManifestFile);
+        return;
+    }
+
+    CookerManifestHeader header;
+    header.magic      = CookerManifestMagic;
+    header.entryCount = narrowCast<std::int32_t>(m_manifest.size());
+
+    writeStructToFile(fileOut, header);
+    writeArrayToFile(fileOut, m_manifest.data(), m_manifest.size());
+}
+
+bool VkAppAssetCooker::isUpToDate(const char * const sourceFile, const char * const outputFile,
+                                  Hash64 * const outContentHash)
+{
+    (*outContentHash) = hashFileContents(sourceFile);
+
+    if (!probeFile(outputFile))
+    {
+        return false; // Output missing - always cook.
+    }
+
+    const Hash64 pathHash{ sourceFile };
+    for (const ManifestEntry & entry : m_manifest)
+    {
+        if (entry.sourcePathHash == pathHash)
+        {
+            return (entry.sourceContentHash == (*outContentHash));
+        }
+    }
+    return false; // Not in the manifest yet.
+}
+
+void VkAppAssetCooker::updateManifest(const char * const sourceFile, const Hash64 contentHash)
+{
+    const Hash64 pathHash{ sourceFile };
+    for (ManifestEntry & entry : m_manifest)
+    {
+        if (entry.sourcePathHash == pathHash)
+        {
+            entry.sourceContentHash = contentHash;
+            return;
+        }
+    }
+    m_manifest.push_back({ pathHash, contentHash });
+}
+
+Hash64 VkAppAssetCooker::hashFileContents(const char * const filePath)
+{
+    std::size_t fileSize = 0;
+    auto fileContents = loadTextFile(filePath, &fileSize);
+    if (fileContents == nullptr)
+    {
+        return Hash64{};
+    }
+    return Hash64{ fileContents.get(), fileSize };
+}
+
+// ========================================================
+
+template<typename Func>
+void VkAppAssetCooker::forEachFileInDirectory(const char * const directory, Func && fn)
+{
+    str512 searchPattern;
+    searchPattern.setf("%s*", directory);
+
+    WIN32_FIND_DATAA findData = {};
+    HANDLE findHandle = FindFirstFileA(searchPattern.c_str(), &findData);
+    if (findHandle == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+
+    do
+    {
+        if (findData.cFileName[0] == '.')
+        {
+            continue; // Skip '.', '..' and hidden files.
+        }
+
+        str512 entryPath;
+        if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        {
+            entryPath.setf("%s%s/", directory, findData.cFileName);
+            forEachFileInDirectory(entryPath.c_str(), fn);
+        }
+        else
+        {
+            entryPath.setf("%s%s", directory, findData.cFileName);
+            fn(entryPath.c_str());
+        }
+    } while (FindNextFileA(findHandle, &findData));
+
+    FindClose(findHandle);
+}
+
+// ========================================================
+
+float VkAppAssetCooker::importerScaleForModel(const char * const sourceFile)
+{
+    // Per-asset import scales, mirroring what the demo apps use
+    // (see the Sponza bootstrap in VkAppScene::initVertexBuffer).
+    struct ScaleOverride
+    {
+        const char * fileName;
+        float scale;
+    };
+    static const ScaleOverride overrides[] = {
+        { "sponza.dae", 0.1f },
+    };
+
+    const str_ref source{ sourceFile };
+    for (const ScaleOverride & entry : overrides)
+    {
+        if (source.ends_with(entry.fileName))
+        {
+            return entry.scale;
+        }
+    }
+    return 1.0f;
+}
+
+void VkAppAssetCooker::cookModels(const char * const directory)
+{
+    forEachFileInDirectory(directory, [this](const char * const file)
+    {
+        const str_ref fileName{ file };
+        if (fileName.ends_with(".obj") || fileName.ends_with(".dae"))
+        {
+            cookModelFile(file);
+        }
+    });
+}
+
+void VkAppAssetCooker::cookModelFile(const char * const sourceFile)
+{
+    // sourceFile extension swapped for .bmesh - e.g. sponza.dae -> sponza.bmesh:
+    const str_ref source{ sourceFile };
+    str512 outputFile;
+    outputFile.setf("%.*s%s", source.last_index_of('.'), sourceFile, Mesh::BinaryFormatFileExt);
+
+    Hash64 contentHash;
+    if (isUpToDate(sourceFile, outputFile.c_str(), &contentHash))
+    {
+        m_stats.skipped++;
+        return;
+    }
+
+    Log::debugF("Cooking model '%s' -> '%s'...", sourceFile, outputFile.c_str());
+
+    Mesh mesh;
+    if (!mesh.initFromFile(sourceFile, importerScaleForModel(sourceFile)) ||
+        !mesh.saveBinary(outputFile.c_str()))
+    {
+        Log::warningF("Failed to cook model '%s'!", sourceFile);
+        m_stats.failed++;
+        return;
+    }
+
+    updateManifest(sourceFile, contentHash);
+    m_stats.cooked++;
+}
+
+// ========================================================
+
+void VkAppAssetCooker::cookTextures(const char * const directory)
+{
+    forEachFileInDirectory(directory, [this](const char * const file)
+    {
+        // Anything the STB loaders handle. DDS files are already
+        // GPU-ready and are streamed as-is, so they are not cooked.
+        const str_ref fileName{ file };
+        if (fileName.ends_with(".png") || fileName.ends_with(".jpg") ||
+            fileName.ends_with(".tga") || fileName.ends_with(".bmp"))
+        {
+            cookTextureFile(file);
+        }
+    });
+}
+
+void VkAppAssetCooker::cookTextureFile(const char * const sourceFile)
+{
+    // Same naming convention as the runtime cache in Texture.cpp,
+    // so the cooked file is picked up transparently at load time:
+    str512 outputFile;
+    outputFile.setf("%s.dxtc", sourceFile);
+
+    Hash64 contentHash;
+    if (isUpToDate(sourceFile, outputFile.c_str(), &contentHash))
+    {
+        m_stats.skipped++;
+        return;
+    }
+
+    Log::debugF("Cooking texture '%s' -> '%s'...", sourceFile, outputFile.c_str());
+
+    Image uncompressedImage;
+    if (!uncompressedImage.initFromFile(sourceFile))
+    {
+        Log::warningF("Failed to load texture '%s'!", sourceFile);
+        m_stats.failed++;
+        return;
+    }
+
+    if (!uncompressedImage.isMipmapped())
+    {
+        uncompressedImage.generateMipmapSurfaces();
+    }
+
+    DXTCompressedImage compressedImage;
+    if (!compressedImage.initFromUncompressed(uncompressedImage) ||
+        !compressedImage.saveCacheFile(outputFile.c_str()))
+    {
+        Log::warningF("Failed to cook texture '%s'!", sourceFile);
+        m_stats.failed++;
+        return;
+    }
+
+    updateManifest(sourceFile, contentHash);
+    m_stats.cooked++;
+}
+
+// ========================================================
@@ -0,0 +1,539 @@
+
+// ================================================================================================
+// File: Apps/Benchmark/VkAppBenchmark.cpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Automated benchmark - scripted camera over the Sponza scene with CSV/JSON reports.
+// ================================================================================================
+
+#include "Apps/VulkanDemoApp.hpp"
+#include "VkToolbox/Model3D.hpp"
+#include "VkToolbox/Camera.hpp"
+#include "VkToolbox/GpuProfiler.hpp"
+#include "VkToolbox/FrameStats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace VkToolbox;
+
+// ========================================================
+// class VkAppBenchmark:
+// ========================================================
+
+// Reproducible performance run for regression tracking. Orbits a scripted
+// camera over the Sponza scene for a fixed number of frames with vsync off
+// (IMMEDIATE present mode), then writes per-frame CPU/GPU timings to a CSV
+// and a summary (percentiles plus startup/load-phase breakdown) to a JSON
+// file, and quits. Every frame is a pure function of its index, never of
+// wall time, so two runs on the same machine render the exact same frames.
+//
+// Run it from CI like any other demo:
+//   VulkanDemo.exe -VkAppBenchmark -benchFrames=2000
+//
+// The swap chain still needs a window surface, so this is not fully
+// headless - but the run takes no input and never requires focus, which
+// is enough for an unattended desktop session on the build machine.
+class VkAppBenchmark final
+    : public VulkanDemoApp
+{
+private:
+
+    using BufferPtr = std::unique_ptr<CommandBuffer>;
+    using FencePtr  = std::unique_ptr<Fence>;
+
+    // One buffer for each frame in flight
+    // (assuming the context was created with triple buffering).
+    CommandPool              m_cmdPool;
+    std::array<BufferPtr, 3> m_cmdBuffers;
+    std::array<FencePtr,  3> m_cmdBufferFences;
+    CommandBuffer *          m_currentCmdBuffer      = nullptr;
+    Fence *                  m_currentCmdBufferFence = nullptr;
+    int                      m_nextCmdBufferIndex    = 0;
+
+    // Shading pipeline state:
+    const char *             m_shaderFilename = VKTB_SHADER_SOURCE_PATH "Teapot.glsl";
+    GlslShader               m_shaderProgram;
+    DescriptorSetPool        m_descriptorSetPool;
+    DescriptorSetLayout      m_descriptorSetLayout;
+    DescriptorSets<1>        m_descriptorSet;
+    PipelineStateLayout      m_pipelineStateLayout;
+    PipelineStateObject      m_pipelineState;
+
+    struct Matrices
+    {
+        Matrix4 model      = Matrix4::identity();
+        Matrix4 view       = Matrix4::identity();
+        Matrix4 projection = Matrix4::identity();
+        Matrix4 mvp        = Matrix4::identity();
+    };
+
+    // The MVP is handed to the vertex shader as a push constant - the other
+    // matrices are only kept around for building it each frame.
+    Matrices m_matrices;
+
+    // Texture/sampler/mesh:
+    const char * m_textureName = VKTB_TEXTURES_PATH "Common/default.png";
+    Texture      m_texture;
+    VkSampler    m_sampler = VK_NULL_HANDLE; // Shared handle from the context sampler cache.
+    Model3D      m_worldModel;
+
+    // Measurements:
+    struct FrameSample
+    {
+        float cpuMs;
+        float gpuMs; // Resolved timestamps lag by the swap-chain depth; the first few samples read 0.
+    };
+    struct LoadPhase
+    {
+        const char * name;
+        double       milliseconds;
+    };
+
+    std::vector<FrameSample> m_frameSamples;
+    std::vector<LoadPhase>   m_loadPhases;
+    double                   m_startupTimeMs = 0.0;
+    int                      m_benchFrameCount;
+    int                      m_framesDone = 0;
+
+private:
+
+    // Must run before the base class constructs the VulkanContext.
+    static const StartupOptions & applyBenchmarkContextSettings(const StartupOptions & options);
+
+    void initDescriptorSets();
+    void initPipeline();
+    void initTexture();
+    void initWorldModel();
+
+    void updateScriptedCamera();
+    void updateBuffers(CommandBuffer & cmdBuff);
+    void prepareCommandBuffer(CommandBuffer & cmdBuff);
+
+    float resolvedGpuFrameMs() const;
+    void writeCsvReport() const;
+    void writeJsonReport() const;
+
+    struct Summary
+    {
+        double p50Ms, p95Ms, p99Ms, averageMs, worstMs;
+    };
+    static Summary summarize(std::vector<float> samples);
+
+public:
+
+    VkAppBenchmark(const StartupOptions & options);
+    ~VkAppBenchmark();
+
+    void onRunMainLoop() override;
+    void onFrameUpdate() override;
+};
+
+// ========================================================
+
+VULKAN_DEMO_REGISTER_APP(VkAppBenchmark);
+
+// ========================================================
+
+constexpr const char * BenchmarkCsvFile  = "benchmark_frames.csv";
+constexpr const char * BenchmarkJsonFile = "benchmark_summary.json";
+
+// ========================================================
+
+const VulkanDemoApp::StartupOptions & VkAppBenchmark::applyBenchmarkContextSettings(const StartupOptions & options)
+{
+    // Uncapped frame rate - a vsynced benchmark only measures the monitor.
+    VulkanContext::sm_preferredPresentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+    return options;
+}
+
+VkAppBenchmark::VkAppBenchmark(const StartupOptions & options)
+    : VulkanDemoApp{ applyBenchmarkContextSettings(options) }
+    , m_cmdPool{ context() }
+    , m_shaderProgram{ context(), m_shaderFilename }
+    , m_descriptorSetPool{ context() }
+    , m_descriptorSetLayout{ context() }
+    , m_pipelineStateLayout{ context() }
+    , m_pipelineState{ m_pipelineStateLayout }
+    , m_texture{ context(), m_textureName }
+    , m_worldModel{ context(), VKTB_MESH_MODELS_PATH "Sponza/sponza.bmesh" }
+    , m_benchFrameCount{ static_cast<int>(g_benchFrameCount->getIntValue()) }
+{
+    GlslShaderManager::initialize(context());
+    TextureManager::initialize(context());
+
+    // Bracket every startup phase we want in the report:
+    const auto timedPhase = [this](const char * const name, const auto & phaseFn)
+    {
+        const auto t0 = FrameStats::timestampNow();
+        phaseFn();
+        m_loadPhases.push_back({ name, (FrameStats::timestampNow() - t0) * (1.0 / 1000000.0) });
+    };
+
+    timedPhase("ShaderLoad", [this]() { m_shaderProgram.load(); });
+
+    m_cmdPool.initialize(VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, context().graphisQueue().familyIndex);
+
+    for (std::size_t i = 0; i < m_cmdBuffers.size(); ++i)
+    {
+        m_cmdBuffers[i].reset(new CommandBuffer{ context(), VK_COMMAND_BUFFER_LEVEL_PRIMARY, m_cmdPool });
+    }
+    m_currentCmdBuffer = m_cmdBuffers[0].get();
+
+    for (std::size_t i = 0; i < m_cmdBufferFences.size(); ++i)
+    {
+        m_cmdBufferFences[i].reset(new Fence{ context(), VK_FENCE_CREATE_SIGNALED_BIT });
+    }
+    m_currentCmdBufferFence = m_cmdBufferFences[0].get();
+
+    timedPhase("TextureLoad", [this]() { initTexture(); });
+    timedPhase("ModelLoad",   [this]() { initWorldModel(); });
+
+    initDescriptorSets();
+    timedPhase("PipelineCreate", [this]() { initPipeline(); });
+
+    m_frameSamples.reserve(m_benchFrameCount);
+    GpuProfiler::sm_enabled = true;
+
+    context().setDefaultClearColor({ 0.4f, 0.4f, 0.4f, 1.0f });
+
+    // Everything up to here counts as startup.
+    m_startupTimeMs = static_cast<double>(timeMilliseconds());
+    Log::debugF("Benchmark startup done in %.1f ms - running %i frames...",
+                m_startupTimeMs, m_benchFrameCount);
+}
+
+VkAppBenchmark::~VkAppBenchmark()
+{
+    TextureManager::shutdown();
+    GlslShaderManager::shutdown();
+}
+
+void VkAppBenchmark::initDescriptorSets()
+{
+    // Pool (the MVP goes through push constants, so no uniform buffers here):
+    const VkDescriptorPoolSize descriptorPoolSizes[] = {
+        { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 }, // uniform textureSampler
+    };
+    m_descriptorSetPool.initialize(1, make_array_view(descriptorPoolSizes));
+
+    // Set layout:
+    VkDescriptorSetLayoutBinding samplerLayoutBindings[1] = {};
+    samplerLayoutBindings[0].binding         = 1; // layout(binding = 1)
+    samplerLayoutBindings[0].descriptorCount = 1; // Matching 'textureSampler' declaration in the FS
+    samplerLayoutBindings[0].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    samplerLayoutBindings[0].stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT;
+    m_descriptorSetLayout.initialize(make_array_view(samplerLayoutBindings));
+
+    // The Descriptor Set:
+    const VkDescriptorSetLayout layouts[] = { m_descriptorSetLayout.descriptorSetLayoutHandle() };
+    m_descriptorSet.initialize(&m_descriptorSetPool);
+    m_descriptorSet.allocate(make_array_view(layouts));
+
+    VkDescriptorImageInfo imageInfo;
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imageInfo.imageView   = m_texture.imageViewHandle();
+    imageInfo.sampler     = m_sampler;
+
+    VkWriteDescriptorSet descriptorWrites[1] = {};
+    descriptorWrites[0].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[0].dstSet          = m_descriptorSet.descriptorSetHandles[0];
+    descriptorWrites[0].dstBinding      = 1;
+    descriptorWrites[0].dstArrayElement = 0;
+    descriptorWrites[0].descriptorCount = 1;
+    descriptorWrites[0].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptorWrites[0].pImageInfo      = &imageInfo;
+    m_descriptorSet.update(make_array_view(descriptorWrites));
+}
+
+void VkAppBenchmark::initPipeline()
+{
+    const VkDescriptorSetLayout setLayouts[] = { m_descriptorSetLayout.descriptorSetLayoutHandle() };
+
+    // The MVP is fed to the vertex shader via push constants:
+    VkPushConstantRange pushConstantRanges[1] = {};
+    pushConstantRanges[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRanges[0].offset     = 0;
+    pushConstantRanges[0].size       = sizeof(Matrix4);
+
+    m_pipelineStateLayout.initialize(make_array_view(setLayouts), make_array_view(pushConstantRanges));
+
+    PipelineStateBuilder psoBuilder;
+    const Size2D fbSize = context().framebufferSize();
+
+    psoBuilder.viewport.width           = static_cast<float>(fbSize.width);
+    psoBuilder.viewport.height          = static_cast<float>(fbSize.height);
+    psoBuilder.scissor.extent.width     = fbSize.width;
+    psoBuilder.scissor.extent.height    = fbSize.height;
+    psoBuilder.pipelineState.layout     = m_pipelineStateLayout;
+    psoBuilder.pipelineState.renderPass = context().mainRenderPass();
+    psoBuilder.pipelineState.stageCount = m_shaderProgram.pipelineStages(&psoBuilder.shaderPipelineStages);
+
+    const auto & bindingDescription     = MeshVertex::bindingDescription();
+    const auto & attributeDescriptions  = MeshVertex::attributeDescriptions();
+
+    psoBuilder.vertexInputState.vertexBindingDescriptionCount   = 1;
+    psoBuilder.vertexInputState.pVertexBindingDescriptions      = &bindingDescription;
+
+    psoBuilder.vertexInputState.vertexAttributeDescriptionCount = static_cast<std::uint32_t>(attributeDescriptions.size());
+    psoBuilder.vertexInputState.pVertexAttributeDescriptions    = attributeDescriptions.data();
+
+    m_pipelineState.initialize(psoBuilder);
+}
+
+void VkAppBenchmark::initTexture()
+{
+    m_sampler = context().defaultSampler();
+
+    const auto & cmdBuff = context().mainTextureStagingCmdBuffer();
+    cmdBuff.beginRecording();
+
+    m_texture.load();
+
+    cmdBuff.endRecording();
+    context().enqueueSubmit(cmdBuff);
+    context().flushPendingSubmits(); // The staging data is released right below.
+    cmdBuff.reset();
+
+    // Done with the staging data.
+    m_texture.releaseStagingResources();
+}
+
+void VkAppBenchmark::initWorldModel()
+{
+    // The benchmark wants the steady-state binary loading path - cook the
+    // mesh first with VkAppAssetCooker (or run VkAppScene once) if missing.
+    if (!probeFile(VKTB_MESH_MODELS_PATH "Sponza/sponza.bmesh"))
+    {
+        Log::fatalF("Benchmark requires the cooked '%sSponza/sponza.bmesh' - run the asset cooker first!",
+                    VKTB_MESH_MODELS_PATH);
+    }
+
+    TextureManager::preallocate(128);
+    TextureManager::beginResourceLoad();
+
+    m_worldModel.load();
+
+    TextureManager::waitPendingAsyncLoadRequests();
+    TextureManager::endResourceLoad();
+}
+
+void VkAppBenchmark::updateScriptedCamera()
+{
+    // Two full orbits along the length of the Sponza atrium over the run,
+    // parametrized purely by the frame index for reproducibility.
+    const float t     = static_cast<float>(m_framesDone) / static_cast<float>(m_benchFrameCount);
+    const float angle = t * 2.0f * TwoPI;
+    const float sweep = std::sin(t * PI); // Drift from one end of the hall to the other and back.
+
+    const Point3 eye{ std::cos(angle) * 6.0f, 3.0f + sweep * 4.0f, std::sin(angle) * 2.0f };
+    const Point3 lookAt{ -std::cos(angle) * 10.0f, 2.0f, 0.0f };
+
+    m_matrices.view       = Matrix4::lookAt(eye, lookAt, Vector3{ 0.0f, 1.0f, 0.0f });
+    m_matrices.projection = Matrix4::perspective(60.0f * DegToRad, context().framebufferAspect(), 0.1f, 1000.0f);
+    m_matrices.mvp        = m_matrices.projection * m_matrices.view * m_matrices.model;
+
+    // Model space == world space here (identity model matrix), so the eye
+    // feeds the per-submesh LOD selection directly.
+    m_worldModel.selectSubmeshLods(eye);
+}
+
+void VkAppBenchmark::updateBuffers(CommandBuffer & cmdBuff)
+{
+    m_worldModel.uploadBuffersToGpu(cmdBuff);
+}
+
+void VkAppBenchmark::prepareCommandBuffer(CommandBuffer & cmdBuff)
+{
+    GpuProfiler & profiler = context().gpuProfiler();
+
+    cmdBuff.beginRecording();
+    profiler.beginFrame(cmdBuff);
+
+    profiler.beginZone(cmdBuff, "UpdateBuffers");
+    updateBuffers(cmdBuff);
+    profiler.endZone(cmdBuff);
+
+    m_worldModel.cullSubmeshes(Frustum{ m_matrices.projection * m_matrices.view });
+
+    profiler.beginZone(cmdBuff, "MainRenderPass");
+    context().beginRenderPass(cmdBuff);
+
+    context().bindGraphicsPipelineState(cmdBuff, m_pipelineState);
+
+    const auto descriptorSet = make_array_view(m_descriptorSet.descriptorSetHandles);
+    context().bindGraphicsDescriptorSets(cmdBuff, m_pipelineStateLayout, descriptorSet);
+
+    cmdBuff.pushConstants(m_pipelineStateLayout, VK_SHADER_STAGE_VERTEX_BIT, m_matrices.mvp);
+
+    m_worldModel.drawInstanceRange(cmdBuff, 0, m_worldModel.drawData().submeshIndexCount);
+
+    context().endRenderPass(cmdBuff);
+    profiler.endZone(cmdBuff);
+
+    cmdBuff.endRecording();
+}
+
+float VkAppBenchmark::resolvedGpuFrameMs() const
+{
+    // Total of the top-level zones the last beginFrame() resolved. These lag
+    // the CPU frame by the swap-chain depth, which shifts the CSV columns
+    // against each other by a couple of rows but doesn't affect summaries.
+    float totalMs = 0.0f;
+    for (const auto & zone : context().gpuProfiler().frameResults())
+    {
+        if (zone.depth == 0)
+        {
+            totalMs += zone.milliseconds;
+        }
+    }
+    return totalMs;
+}
+
+void VkAppBenchmark::onFrameUpdate()
+{
+    const auto frameStartNs = FrameStats::timestampNow();
+
+    updateScriptedCamera();
+
+    context().beginFrame();
+
+    m_currentCmdBufferFence->wait(InfiniteFenceWaitTimeout);
+    m_currentCmdBufferFence->reset();
+    m_currentCmdBuffer->reset();
+
+    prepareCommandBuffer(*m_currentCmdBuffer);
+
+    VkCommandBuffer cbHandle = m_currentCmdBuffer->commandBufferHandle();
+    const auto submitBuffers = make_array_view(&cbHandle, 1);
+
+    context().endFrame(submitBuffers, m_currentCmdBufferFence->fenceHandle());
+
+    // Grab the next buffer in the chain:
+    m_nextCmdBufferIndex    = (m_nextCmdBufferIndex + 1) % m_cmdBuffers.size();
+    m_currentCmdBuffer      = m_cmdBuffers[m_nextCmdBufferIndex].get();
+    m_currentCmdBufferFence = m_cmdBufferFences[m_nextCmdBufferIndex].get();
+
+    FrameSample sample;
+    sample.cpuMs = static_cast<float>((FrameStats::timestampNow() - frameStartNs) * (1.0 / 1000000.0));
+    sample.gpuMs = resolvedGpuFrameMs();
+    m_frameSamples.push_back(sample);
+
+    if (++m_framesDone >= m_benchFrameCount)
+    {
+        window().setStopEventLoop(true);
+    }
+}
+
+void VkAppBenchmark::onRunMainLoop()
+{
+    VulkanDemoApp::onRunMainLoop();
+
+    // The run is over - dump the reports.
+    writeCsvReport();
+    writeJsonReport();
+}
+
+VkAppBenchmark::Summary VkAppBenchmark::summarize(std::vector<float> samples)
+{
+    Summary summary = {};
+    if (samples.empty())
+    {
+        return summary;
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    const auto percentile = [&samples](const double p)
+    {
+        const auto index = static_cast<std::size_t>((samples.size() - 1) * (p / 100.0));
+        return static_cast<double>(samples[index]);
+    };
+
+    double total = 0.0;
+    for (const float s : samples)
+    {
+        total += s;
+    }
+
+    summary.p50Ms     = percentile(50.0);
+    summary.p95Ms     = percentile(95.0);
+    summary.p99Ms     = percentile(99.0);
+    summary.averageMs = total / samples.size();
+    summary.worstMs   = samples.back();
+    return summary;
+}
+
+void VkAppBenchmark::writeCsvReport() const
+{
+    ScopedFileHandle file{ openFile(BenchmarkCsvFile, "wt") };
+    if (file == nullptr)
+    {
+        Log::errorF("Can't open '%s' for writing!", BenchmarkCsvFile);
+        return;
+    }
+
+    std::fprintf(file, "frame,cpuMs,gpuMs\n");
+    for (std::size_t f = 0; f < m_frameSamples.size(); ++f)
+    {
+        std::fprintf(file, "%zu,%.4f,%.4f\n", f, m_frameSamples[f].cpuMs, m_frameSamples[f].gpuMs);
+    }
+
+    Log::debugF("Benchmark frame timings written to '%s' (%zu frames).",
+                BenchmarkCsvFile, m_frameSamples.size());
+}
+
+void VkAppBenchmark::writeJsonReport() const
+{
+    ScopedFileHandle file{ openFile(BenchmarkJsonFile, "wt") };
+    if (file == nullptr)
+    {
+        Log::errorF("Can't open '%s' for writing!", BenchmarkJsonFile);
+        return;
+    }
+
+    std::vector<float> cpuSamples, gpuSamples;
+    cpuSamples.reserve(m_frameSamples.size());
+    gpuSamples.reserve(m_frameSamples.size());
+    for (const auto & sample : m_frameSamples)
+    {
+        cpuSamples.push_back(sample.cpuMs);
+        gpuSamples.push_back(sample.gpuMs);
+    }
+
+    const Summary cpu = summarize(std::move(cpuSamples));
+    const Summary gpu = summarize(std::move(gpuSamples));
+
+    const auto writeSummary = [&file](const char * const name, const Summary & s, const char * const trailer)
+    {
+        std::fprintf(file, "  \"%s\": { \"p50Ms\": %.4f, \"p95Ms\": %.4f, \"p99Ms\": %.4f, \"averageMs\": %.4f, \"worstMs\": %.4f }%s\n",
+                     name, s.p50Ms, s.p95Ms, s.p99Ms, s.averageMs, s.worstMs, trailer);
+    };
+
+    std::fprintf(file, "{\n");
+    std::fprintf(file, "  \"app\": \"VkAppBenchmark\",\n");
+    std::fprintf(file, "  \"frameCount\": %i,\n", m_framesDone);
+    std::fprintf(file, "  \"startupTimeMs\": %.1f,\n", m_startupTimeMs);
+
+    std::fprintf(file, "  \"loadPhases\": [\n");
+    for (std::size_t p = 0; p < m_loadPhases.size(); ++p)
+    {
+        std::fprintf(file, "    { \"name\": \"%s\", \"ms\": %.2f }%s\n",
+                     m_loadPhases[p].name, m_loadPhases[p].milliseconds,
+                     (p + 1 < m_loadPhases.size()) ? "," : "");
+    }
+    std::fprintf(file, "  ],\n");
+
+    writeSummary("cpuFrame", cpu, ",");
+    writeSummary("gpuFrame", gpu, "");
+    std::fprintf(file, "}\n");
+
+    Log::debugF("Benchmark summary written to '%s'.", BenchmarkJsonFile);
+    Log::debugF("CPU frame: p50=%.3fms p95=%.3fms p99=%.3fms avg=%.3fms worst=%.3fms",
+                cpu.p50Ms, cpu.p95Ms, cpu.p99Ms, cpu.averageMs, cpu.worstMs);
+    Log::debugF("GPU frame: p50=%.3fms p95=%.3fms p99=%.3fms avg=%.3fms worst=%.3fms",
+                gpu.p50Ms, gpu.p95Ms, gpu.p99Ms, gpu.averageMs, gpu.worstMs);
+}
+
+// ========================================================
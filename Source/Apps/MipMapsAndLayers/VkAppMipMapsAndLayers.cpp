@@ -65,8 +65,8 @@ private:
     static constexpr int NumLayers  = 3;
     Texture m_arrayTexture;
     Texture m_mipmapsTexture;
-    Sampler m_arraySampler;
-    Sampler m_mipmapsSampler;
+    VkSampler m_arraySampler   = VK_NULL_HANDLE; // Shared handles from the context sampler cache.
+    VkSampler m_mipmapsSampler = VK_NULL_HANDLE;
 
 private:
 
@@ -103,8 +103,6 @@ VkAppMipMapsAndLayers::VkAppMipMapsAndLayers(const StartupOptions & options)
     , m_vbLayers{ context() }
     , m_arrayTexture{ context(), VKTB_TEXTURES_PATH "Common/a_dummy.dds" }
     , m_mipmapsTexture{ context(), "Generated/mipmap_texture.png" }
-    , m_arraySampler{ context() }
-    , m_mipmapsSampler{ context() }
 {
     m_shaderProgram.load();
     m_uniformBuffer.initialize(1);
@@ -273,7 +271,8 @@ void VkAppMipMapsAndLayers::initTexture()
     assert(m_arrayTexture.isArrayTexture() && m_arrayTexture.layerCount() == NumLayers);
 
     cmdBuff.endRecording();
-    cmdBuff.submitAndWaitComplete(context().graphisQueue());
+    context().enqueueSubmit(cmdBuff);
+    context().flushPendingSubmits(); // The staging texture data is released after this.
     cmdBuff.reset();
 
     // Set up the samplers:
@@ -282,14 +281,14 @@ void VkAppMipMapsAndLayers::initTexture()
     samplerDesc.minFilter  = VK_FILTER_NEAREST;
     samplerDesc.magFilter  = VK_FILTER_NEAREST;
     samplerDesc.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
-    m_mipmapsSampler.initialize(samplerDesc);
+    m_mipmapsSampler = context().sharedSampler(samplerDesc);
 
     samplerDesc = Sampler::defaults();
     samplerDesc.maxLod     = static_cast<float>(m_arrayTexture.mipmapCount());
     samplerDesc.minFilter  = VK_FILTER_NEAREST;
     samplerDesc.magFilter  = VK_FILTER_NEAREST;
     samplerDesc.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
-    m_arraySampler.initialize(samplerDesc);
+    m_arraySampler = context().sharedSampler(samplerDesc);
 
     // Done with the staging data.
     m_mipmapsTexture.releaseStagingResources();
@@ -10,6 +10,8 @@
 #include "VkToolbox/Model3D.hpp"
 #include "VkToolbox/Input.hpp"
 #include "VkToolbox/Camera.hpp"
+#include "VkToolbox/JobQueue.hpp"
+#include "VkToolbox/CpuProfiler.hpp"
 
 using namespace VkToolbox;
 
@@ -25,14 +27,34 @@ private:
     using BufferPtr = std::unique_ptr<CommandBuffer>;
     using FencePtr  = std::unique_ptr<Fence>;
 
-    // One buffer for each frame in flight 
-    // (assuming the context was created with triple buffering).
+    // One buffer for each swap chain image (assuming the context was created
+    // with triple buffering). The buffers are retained: the draw stream is
+    // static, so once an image's primary is recorded it gets resubmitted
+    // as-is every time that image is acquired, until something baked into
+    // it changes and marks it dirty (see markCommandBuffersDirty()).
     CommandPool              m_cmdPool;
     std::array<BufferPtr, 3> m_cmdBuffers;
     std::array<FencePtr,  3> m_cmdBufferFences;
-    CommandBuffer *          m_currentCmdBuffer      = nullptr;
-    Fence *                  m_currentCmdBufferFence = nullptr;
-    int                      m_nextCmdBufferIndex    = 0;
+    std::array<bool,      3> m_cmdBufferDirty;
+    CommandBuffer *          m_currentCmdBuffer       = nullptr;
+    Fence *                  m_currentCmdBufferFence  = nullptr;
+    int                      m_currentSwapImageIndex  = 0;
+
+    // View-projection the retained buffers were last recorded with. A camera
+    // move changes culling, LOD selection and the pushed MVP, so it dirties
+    // all of them.
+    Matrix4                  m_lastRecordedViewProj   = Matrix4::identity();
+
+    // Submesh draws are recorded in parallel by the job threads into secondary
+    // buffers, then stitched into the frame's primary with vkCmdExecuteCommands.
+    // Command pools cannot be shared across threads, so each recording thread
+    // gets its own pool, with one secondary buffer per frame in flight.
+    static constexpr int RecordingThreadCount = JobQueuePool::MaxPriorities;
+
+    using PoolPtr = std::unique_ptr<CommandPool>;
+    JobQueuePool                                           m_recordingJobs;
+    std::array<PoolPtr, RecordingThreadCount>              m_secondaryCmdPools;
+    std::array<std::array<BufferPtr, RecordingThreadCount>, 3> m_secondaryCmdBuffers;
 
     // Shading pipeline state:
     const char *             m_shaderFilename = VKTB_SHADER_SOURCE_PATH "Teapot.glsl"; // TODO temp shader for testing...
@@ -43,6 +65,12 @@ private:
     PipelineStateLayout      m_pipelineStateLayout;
     PipelineStateObject      m_pipelineState;
 
+    // Optional depth-only pre-pass PSO ('depthPrePass' cvar): vertex stage
+    // only, targeting the leading depth subpass of the main render pass.
+    // The shading PSO then tests depth-equal and writes no depth, so only
+    // visible fragments pay for shading. Uninitialized when disabled.
+    PipelineStateObject      m_depthPrePassPipelineState;
+
     struct Matrices
     {
         Matrix4 model      = Matrix4::identity();
@@ -51,16 +79,17 @@ private:
         Matrix4 mvp        = Matrix4::identity();
     };
 
-    Camera                                  m_camera;
-    Matrices                                m_matrices;
-    StructuredShaderUniformBuffer<Matrices> m_uniformBuffer;
-    StructuredVertexBuffer<MeshVertex>      m_vertexBuffer;
-    StructuredIndexBuffer<MeshIndex>        m_indexBuffer;
+    // The MVP is handed to the vertex shader as a push constant - the other
+    // matrices are only kept around for building it each frame.
+    Camera                             m_camera;
+    Matrices                           m_matrices;
+    StructuredVertexBuffer<MeshVertex> m_vertexBuffer;
+    StructuredIndexBuffer<MeshIndex>   m_indexBuffer;
 
     // Texture/sampler/mesh:
     const char * m_textureName = VKTB_TEXTURES_PATH "Common/default.png";
     Texture      m_texture;
-    Sampler      m_sampler;
+    VkSampler    m_sampler = VK_NULL_HANDLE; // Shared handle from the context sampler cache.
     Model3D      m_worldModel;
 
 private:
@@ -74,6 +103,10 @@ private:
     void updateInput();
     void updateBuffers(CommandBuffer & cmdBuff);
     void prepareCommandBuffer(CommandBuffer & cmdBuff);
+    void recordDepthPrePass(CommandBuffer & cmdBuff);
+    void recordSecondaryCommandBuffers(CommandBuffer & primaryCmdBuff);
+    void recordSubmeshRange(int threadIndex);
+    void markCommandBuffersDirty();
 
 public:
 
@@ -81,6 +114,7 @@ public:
     ~VkAppScene();
 
     void onFrameUpdate() override;
+    void onResizeWindow(const Size2D newSize) override;
 };
 
 // ========================================================
@@ -97,18 +131,16 @@ VkAppScene::VkAppScene(const StartupOptions & options)
     , m_descriptorSetLayout{ context() }
     , m_pipelineStateLayout{ context() }
     , m_pipelineState{ m_pipelineStateLayout }
-    , m_uniformBuffer{ context() }
+    , m_depthPrePassPipelineState{ m_pipelineStateLayout }
     , m_vertexBuffer{ context() }
     , m_indexBuffer{ context() }
     , m_texture{ context(), m_textureName }
-    , m_sampler{ context() }
     , m_worldModel{ context(), VKTB_MESH_MODELS_PATH "Sponza/sponza.bmesh" }
 {
     GlslShaderManager::initialize(context());
     TextureManager::initialize(context());
 
     m_shaderProgram.load();
-    m_uniformBuffer.initialize(1);
     m_cmdPool.initialize(VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, context().graphisQueue().familyIndex);
 
     for (std::size_t i = 0; i < m_cmdBuffers.size(); ++i)
@@ -122,6 +154,20 @@ VkAppScene::VkAppScene(const StartupOptions & options)
         m_cmdBufferFences[i].reset(new Fence{ context(), VK_FENCE_CREATE_SIGNALED_BIT });
     }
     m_currentCmdBufferFence = m_cmdBufferFences[0].get();
+    m_cmdBufferDirty.fill(true);
+
+    m_recordingJobs.initialize();
+    for (int t = 0; t < RecordingThreadCount; ++t)
+    {
+        m_secondaryCmdPools[t].reset(new CommandPool{ context(), VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+                                                      context().graphisQueue().familyIndex });
+
+        for (std::size_t i = 0; i < m_secondaryCmdBuffers.size(); ++i)
+        {
+            m_secondaryCmdBuffers[i][t].reset(new CommandBuffer{ context(), VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+                                                                 *m_secondaryCmdPools[t] });
+        }
+    }
 
     initTexture();
     initDescriptorSets();
@@ -134,6 +180,9 @@ VkAppScene::VkAppScene(const StartupOptions & options)
 
 VkAppScene::~VkAppScene()
 {
+    m_recordingJobs.waitAll();
+    m_recordingJobs.shutdown();
+
     MouseState::hideCursor(false);
     TextureManager::shutdown();
     GlslShaderManager::shutdown();
@@ -141,62 +190,52 @@ VkAppScene::~VkAppScene()
 
 void VkAppScene::initDescriptorSets()
 {
-    // Pool:
+    // Pool (the MVP goes through push constants, so no uniform buffers here):
     const VkDescriptorPoolSize descriptorPoolSizes[] = {
-        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         1 }, // uniform matrices
         { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 }, // uniform textureSampler
     };
     m_descriptorSetPool.initialize(1, make_array_view(descriptorPoolSizes));
 
     // Set layout:
-    VkDescriptorSetLayoutBinding uboLayoutBindings[2] = {};
-    uboLayoutBindings[0].binding         = 0; // layout(binding = 0)
-    uboLayoutBindings[0].descriptorCount = 1; // Matching 'matrices' declaration in the VS
-    uboLayoutBindings[0].descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    uboLayoutBindings[0].stageFlags      = VK_SHADER_STAGE_VERTEX_BIT;
-    uboLayoutBindings[1].binding         = 1; // layout(binding = 1)
-    uboLayoutBindings[1].descriptorCount = 1; // Matching 'textureSampler' declaration in the FS
-    uboLayoutBindings[1].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    uboLayoutBindings[1].stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT;
-    m_descriptorSetLayout.initialize(make_array_view(uboLayoutBindings));
+    VkDescriptorSetLayoutBinding samplerLayoutBindings[1] = {};
+    samplerLayoutBindings[0].binding         = 1; // layout(binding = 1)
+    samplerLayoutBindings[0].descriptorCount = 1; // Matching 'textureSampler' declaration in the FS
+    samplerLayoutBindings[0].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    samplerLayoutBindings[0].stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT;
+    m_descriptorSetLayout.initialize(make_array_view(samplerLayoutBindings));
 
     // The Descriptor Set:
     const VkDescriptorSetLayout layouts[] = { m_descriptorSetLayout.descriptorSetLayoutHandle() };
     m_descriptorSet.initialize(&m_descriptorSetPool);
     m_descriptorSet.allocate(make_array_view(layouts));
 
-    VkDescriptorBufferInfo bufferInfo;
-    bufferInfo.buffer = m_uniformBuffer.bufferHandle();
-    bufferInfo.range  = m_uniformBuffer.elementSizeBytes();
-    bufferInfo.offset = 0;
-
     VkDescriptorImageInfo imageInfo;
     imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
     imageInfo.imageView   = m_texture.imageViewHandle();
     imageInfo.sampler     = m_sampler;
 
-    VkWriteDescriptorSet descriptorWrites[2] = {};
+    VkWriteDescriptorSet descriptorWrites[1] = {};
     descriptorWrites[0].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     descriptorWrites[0].dstSet          = m_descriptorSet.descriptorSetHandles[0];
-    descriptorWrites[0].dstBinding      = 0;
+    descriptorWrites[0].dstBinding      = 1;
     descriptorWrites[0].dstArrayElement = 0;
     descriptorWrites[0].descriptorCount = 1;
-    descriptorWrites[0].descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    descriptorWrites[0].pBufferInfo     = &bufferInfo;
-    descriptorWrites[1].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descriptorWrites[1].dstSet          = m_descriptorSet.descriptorSetHandles[0];
-    descriptorWrites[1].dstBinding      = 1;
-    descriptorWrites[1].dstArrayElement = 0;
-    descriptorWrites[1].descriptorCount = 1;
-    descriptorWrites[1].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    descriptorWrites[1].pImageInfo      = &imageInfo;
+    descriptorWrites[0].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptorWrites[0].pImageInfo      = &imageInfo;
     m_descriptorSet.update(make_array_view(descriptorWrites));
 }
 
 void VkAppScene::initPipeline()
 {
     const VkDescriptorSetLayout setLayouts[] = { m_descriptorSetLayout.descriptorSetLayoutHandle() };
-    m_pipelineStateLayout.initialize(make_array_view(setLayouts));
+
+    // The MVP is fed to the vertex shader via push constants:
+    VkPushConstantRange pushConstantRanges[1] = {};
+    pushConstantRanges[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRanges[0].offset     = 0;
+    pushConstantRanges[0].size       = sizeof(Matrix4);
+
+    m_pipelineStateLayout.initialize(make_array_view(setLayouts), make_array_view(pushConstantRanges));
 
     PipelineStateBuilder psoBuilder;
     const Size2D fbSize = context().framebufferSize();
@@ -207,6 +246,7 @@ void VkAppScene::initPipeline()
     psoBuilder.scissor.extent.height    = fbSize.height;
     psoBuilder.pipelineState.layout     = m_pipelineStateLayout;
     psoBuilder.pipelineState.renderPass = context().mainRenderPass();
+    psoBuilder.pipelineState.subpass    = context().colorSubpassIndex();
     psoBuilder.pipelineState.stageCount = m_shaderProgram.pipelineStages(&psoBuilder.shaderPipelineStages);
 
     const auto & bindingDescription     = MeshVertex::bindingDescription();
@@ -218,12 +258,44 @@ void VkAppScene::initPipeline()
     psoBuilder.vertexInputState.vertexAttributeDescriptionCount = static_cast<std::uint32_t>(attributeDescriptions.size());
     psoBuilder.vertexInputState.pVertexAttributeDescriptions    = attributeDescriptions.data();
 
+    if (context().isDepthPrePassEnabled())
+    {
+        // The pre-pass already laid down depth - shade only what's visible:
+        psoBuilder.depthStencilState.depthWriteEnable = VK_FALSE;
+        psoBuilder.depthStencilState.depthCompareOp   = VK_COMPARE_OP_EQUAL;
+    }
+
     m_pipelineState.initialize(psoBuilder);
+
+    if (context().isDepthPrePassEnabled())
+    {
+        // Depth-only PSO for the pre-pass subpass: same vertex setup with a
+        // null fragment stage and no color writes.
+        std::uint32_t vertexStage = UINT32_MAX;
+        for (std::uint32_t s = 0; s < psoBuilder.pipelineState.stageCount; ++s)
+        {
+            if (psoBuilder.shaderPipelineStages[s].stage == VK_SHADER_STAGE_VERTEX_BIT)
+            {
+                vertexStage = s;
+                break;
+            }
+        }
+        assert(vertexStage != UINT32_MAX);
+
+        psoBuilder.shaderPipelineStages[0]            = psoBuilder.shaderPipelineStages[vertexStage];
+        psoBuilder.pipelineState.stageCount           = 1;
+        psoBuilder.colorBlendState.attachmentCount    = 0;
+        psoBuilder.pipelineState.subpass              = context().depthPrePassSubpassIndex();
+        psoBuilder.depthStencilState.depthWriteEnable = VK_TRUE;
+        psoBuilder.depthStencilState.depthCompareOp   = VK_COMPARE_OP_LESS_OR_EQUAL;
+
+        m_depthPrePassPipelineState.initialize(psoBuilder);
+    }
 }
 
 void VkAppScene::initTexture()
 {
-    m_sampler.initialize(Sampler::defaults());
+    m_sampler = context().defaultSampler();
 
     const auto & cmdBuff = context().mainTextureStagingCmdBuffer();
     cmdBuff.beginRecording();
@@ -231,7 +303,8 @@ void VkAppScene::initTexture()
     m_texture.load();
 
     cmdBuff.endRecording();
-    cmdBuff.submitAndWaitComplete(context().graphisQueue());
+    context().enqueueSubmit(cmdBuff);
+    context().flushPendingSubmits(); // The staging data is released right below.
     cmdBuff.reset();
 
     // Done with the staging data.
@@ -314,57 +387,156 @@ void VkAppScene::updateBuffers(CommandBuffer & cmdBuff)
     m_worldModel.uploadBuffersToGpu(cmdBuff);
 
     //
-    // Uniform buffer per-frame update:
+    // Per-frame matrix update - the MVP is pushed into each secondary
+    // command buffer in recordSubmeshRange():
     //
     m_matrices.view       = m_camera.viewMatrix;
     m_matrices.projection = m_camera.projMatrix;
     m_matrices.mvp        = m_camera.vpMatrix * m_matrices.model;
-
-    m_uniformBuffer.write(m_matrices);
-    m_uniformBuffer.uploadStagingToGpu(cmdBuff);
 }
 
 void VkAppScene::prepareCommandBuffer(CommandBuffer & cmdBuff)
 {
+    VKTB_PROFILE_SCOPE("VkAppScene::prepareCommandBuffer");
+
     cmdBuff.beginRecording();
 
     updateBuffers(cmdBuff);
 
-    context().beginRenderPass(cmdBuff);
+    // Frustum-cull the submeshes and pick their LOD levels before the
+    // recording threads walk them. The model matrix is identity for the
+    // scene, so vpMatrix and the camera eye can be used unchanged.
+    m_worldModel.cullSubmeshes(Frustum{ m_camera.vpMatrix * m_matrices.model });
+    m_worldModel.selectSubmeshLods(Point3{ m_camera.eye });
+
+    if (context().isDepthPrePassEnabled())
+    {
+        // Depth-only draws go inline into the primary - they are cheap enough
+        // that parallel recording wouldn't buy anything. The shading subpass
+        // keeps the secondary-buffer fan-out.
+        context().beginRenderPass(cmdBuff, VK_SUBPASS_CONTENTS_INLINE);
+        recordDepthPrePass(cmdBuff);
+        context().nextSubpass(cmdBuff, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    }
+    else
+    {
+        context().beginRenderPass(cmdBuff, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    }
+
+    recordSecondaryCommandBuffers(cmdBuff);
+    context().endRenderPass(cmdBuff);
+
+    cmdBuff.endRecording();
+}
+
+void VkAppScene::recordDepthPrePass(CommandBuffer & cmdBuff)
+{
+    context().bindGraphicsPipelineState(cmdBuff, m_depthPrePassPipelineState);
+
+    // The vertex stage only needs the MVP - no descriptor sets to bind.
+    cmdBuff.pushConstants(m_pipelineStateLayout, VK_SHADER_STAGE_VERTEX_BIT, m_matrices.mvp);
+
+    m_worldModel.drawInstanceRange(cmdBuff, 0, m_worldModel.drawData().submeshIndexCount);
+}
+
+void VkAppScene::recordSecondaryCommandBuffers(CommandBuffer & primaryCmdBuff)
+{
+    auto & frameSecondaries = m_secondaryCmdBuffers[m_currentSwapImageIndex];
+
+    // Fan the submesh ranges out to the job threads, one secondary buffer each:
+    for (int t = 0; t < RecordingThreadCount; ++t)
+    {
+        frameSecondaries[t]->reset();
+        m_recordingJobs.queues[t]->pushJob([this, t]() { recordSubmeshRange(t); });
+    }
+    m_recordingJobs.waitAll();
+
+    // Stitch them into the primary, preserving submesh order:
+    VkCommandBuffer secondaryHandles[RecordingThreadCount];
+    for (int t = 0; t < RecordingThreadCount; ++t)
+    {
+        secondaryHandles[t] = frameSecondaries[t]->commandBufferHandle();
+    }
+    context().executeCommands(primaryCmdBuff, make_array_view(secondaryHandles));
+}
+
+void VkAppScene::recordSubmeshRange(const int threadIndex)
+{
+    CommandBuffer & cmdBuff = *m_secondaryCmdBuffers[m_currentSwapImageIndex][threadIndex];
+
+    const auto inheritanceInfo = context().mainRenderPassInheritanceInfo();
+    cmdBuff.beginRecording(inheritanceInfo, VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT |
+                                            VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT);
 
     context().bindGraphicsPipelineState(cmdBuff, m_pipelineState);
 
     const auto descriptorSet = make_array_view(m_descriptorSet.descriptorSetHandles);
     context().bindGraphicsDescriptorSets(cmdBuff, m_pipelineStateLayout, descriptorSet);
 
-    m_worldModel.drawInstance(cmdBuff);
+    // Push constant state doesn't carry across command buffers, so each
+    // secondary records its own copy of the MVP:
+    cmdBuff.pushConstants(m_pipelineStateLayout, VK_SHADER_STAGE_VERTEX_BIT, m_matrices.mvp);
 
-    context().endRenderPass(cmdBuff);
+    // Split the material-sorted submesh list evenly across the recording threads:
+    const int submeshCount   = m_worldModel.drawData().submeshIndexCount;
+    const int drawsPerThread = (submeshCount + RecordingThreadCount - 1) / RecordingThreadCount;
+    const int firstDraw      = threadIndex * drawsPerThread;
+    const int drawCount      = std::min(drawsPerThread, submeshCount - firstDraw);
+
+    m_worldModel.drawInstanceRange(cmdBuff, firstDraw, drawCount);
 
     cmdBuff.endRecording();
 }
 
+void VkAppScene::markCommandBuffersDirty()
+{
+    m_cmdBufferDirty.fill(true);
+}
+
 void VkAppScene::onFrameUpdate()
 {
     updateInput();
 
+    // A camera move invalidates everything baked into the retained buffers
+    // (culling, LOD picks, the pushed MVP), so it dirties all of them:
+    if (std::memcmp(&m_lastRecordedViewProj, &m_camera.vpMatrix, sizeof(Matrix4)) != 0)
+    {
+        m_lastRecordedViewProj = m_camera.vpMatrix;
+        markCommandBuffersDirty();
+    }
+
     context().beginFrame();
 
+    // The render pass is tied to the acquired swap chain image, so the
+    // retained primaries are keyed by image index rather than round-robin.
+    m_currentSwapImageIndex = context().swapChainBufferIndex();
+    m_currentCmdBuffer      = m_cmdBuffers[m_currentSwapImageIndex].get();
+    m_currentCmdBufferFence = m_cmdBufferFences[m_currentSwapImageIndex].get();
+
     m_currentCmdBufferFence->wait(InfiniteFenceWaitTimeout);
     m_currentCmdBufferFence->reset();
-    m_currentCmdBuffer->reset();
 
-    prepareCommandBuffer(*m_currentCmdBuffer);
+    // Only re-record when dirty - a static view resubmits the buffer as-is
+    // and the CPU cost of the frame is just the fence wait and the submit:
+    if (m_cmdBufferDirty[m_currentSwapImageIndex])
+    {
+        m_currentCmdBuffer->reset();
+        prepareCommandBuffer(*m_currentCmdBuffer);
+        m_cmdBufferDirty[m_currentSwapImageIndex] = false;
+    }
 
     VkCommandBuffer cbHandle = m_currentCmdBuffer->commandBufferHandle();
     const auto submitBuffers = make_array_view(&cbHandle, 1);
 
     context().endFrame(submitBuffers, m_currentCmdBufferFence->fenceHandle());
+}
+
+void VkAppScene::onResizeWindow(const Size2D newSize)
+{
+    VulkanDemoApp::onResizeWindow(newSize);
 
-    // Grab the next buffer in the chain:
-    m_nextCmdBufferIndex    = (m_nextCmdBufferIndex + 1) % m_cmdBuffers.size();
-    m_currentCmdBuffer      = m_cmdBuffers[m_nextCmdBufferIndex].get();
-    m_currentCmdBufferFence = m_cmdBufferFences[m_nextCmdBufferIndex].get();
+    // New swap chain framebuffers - every retained buffer references the old ones.
+    markCommandBuffersDirty();
 }
 
 // ========================================================
@@ -55,15 +55,16 @@ private:
         Matrix4 mvp          = Matrix4::identity();
     };
 
-    Matrices                                m_matrices;
-    StructuredShaderUniformBuffer<Matrices> m_uniformBuffer;
-    StructuredVertexBuffer<MeshVertex>      m_vertexBuffer;
-    StructuredIndexBuffer<MeshIndex>        m_indexBuffer;
+    // The MVP is handed to the vertex shader as a push constant - the other
+    // matrices are only kept around for building it each frame.
+    Matrices                           m_matrices;
+    StructuredVertexBuffer<MeshVertex> m_vertexBuffer;
+    StructuredIndexBuffer<MeshIndex>   m_indexBuffer;
 
     // Texture/sampler/mesh:
     const char * m_textureName = VKTB_TEXTURES_PATH "Common/default.png";
     Texture      m_texture;
-    Sampler      m_sampler;
+    VkSampler    m_sampler = VK_NULL_HANDLE; // Shared handle from the context sampler cache.
     Mesh         m_mesh;
 
 private:
@@ -96,14 +97,11 @@ VkAppTeapotModel::VkAppTeapotModel(const StartupOptions & options)
     , m_descriptorSetLayout{ context() }
     , m_pipelineStateLayout{ context() }
     , m_pipelineState{ m_pipelineStateLayout }
-    , m_uniformBuffer{ context() }
     , m_vertexBuffer{ context() }
     , m_indexBuffer{ context() }
     , m_texture{ context(), m_textureName }
-    , m_sampler{ context() }
 {
     m_shaderProgram.load();
-    m_uniformBuffer.initialize(1);
     m_cmdPool.initialize(VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, context().graphisQueue().familyIndex);
 
     for (std::size_t i = 0; i < m_cmdBuffers.size(); ++i)
@@ -137,62 +135,52 @@ VkAppTeapotModel::VkAppTeapotModel(const StartupOptions & options)
 
 void VkAppTeapotModel::initDescriptorSets()
 {
-    // Pool:
+    // Pool (the MVP goes through push constants, so no uniform buffers here):
     const VkDescriptorPoolSize descriptorPoolSizes[] = {
-        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         1 }, // uniform matrices
         { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 }, // uniform textureSampler
     };
     m_descriptorSetPool.initialize(1, make_array_view(descriptorPoolSizes));
 
     // Set layout:
-    VkDescriptorSetLayoutBinding uboLayoutBindings[2] = {};
-    uboLayoutBindings[0].binding         = 0; // layout(binding = 0)
-    uboLayoutBindings[0].descriptorCount = 1; // Matching 'matrices' declaration in the VS
-    uboLayoutBindings[0].descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    uboLayoutBindings[0].stageFlags      = VK_SHADER_STAGE_VERTEX_BIT;
-    uboLayoutBindings[1].binding         = 1; // layout(binding = 1)
-    uboLayoutBindings[1].descriptorCount = 1; // Matching 'textureSampler' declaration in the FS
-    uboLayoutBindings[1].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    uboLayoutBindings[1].stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT;
-    m_descriptorSetLayout.initialize(make_array_view(uboLayoutBindings));
+    VkDescriptorSetLayoutBinding samplerLayoutBindings[1] = {};
+    samplerLayoutBindings[0].binding         = 1; // layout(binding = 1)
+    samplerLayoutBindings[0].descriptorCount = 1; // Matching 'textureSampler' declaration in the FS
+    samplerLayoutBindings[0].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    samplerLayoutBindings[0].stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT;
+    m_descriptorSetLayout.initialize(make_array_view(samplerLayoutBindings));
 
     // The Descriptor Set:
     const VkDescriptorSetLayout layouts[] = { m_descriptorSetLayout.descriptorSetLayoutHandle() };
     m_descriptorSet.initialize(&m_descriptorSetPool);
     m_descriptorSet.allocate(make_array_view(layouts));
 
-    VkDescriptorBufferInfo bufferInfo;
-    bufferInfo.buffer = m_uniformBuffer.bufferHandle();
-    bufferInfo.range  = m_uniformBuffer.elementSizeBytes();
-    bufferInfo.offset = 0;
-
     VkDescriptorImageInfo imageInfo;
     imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
     imageInfo.imageView   = m_texture.imageViewHandle();
     imageInfo.sampler     = m_sampler;
 
-    VkWriteDescriptorSet descriptorWrites[2] = {};
+    VkWriteDescriptorSet descriptorWrites[1] = {};
     descriptorWrites[0].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     descriptorWrites[0].dstSet          = m_descriptorSet.descriptorSetHandles[0];
-    descriptorWrites[0].dstBinding      = 0;
+    descriptorWrites[0].dstBinding      = 1;
     descriptorWrites[0].dstArrayElement = 0;
     descriptorWrites[0].descriptorCount = 1;
-    descriptorWrites[0].descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    descriptorWrites[0].pBufferInfo     = &bufferInfo;
-    descriptorWrites[1].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descriptorWrites[1].dstSet          = m_descriptorSet.descriptorSetHandles[0];
-    descriptorWrites[1].dstBinding      = 1;
-    descriptorWrites[1].dstArrayElement = 0;
-    descriptorWrites[1].descriptorCount = 1;
-    descriptorWrites[1].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    descriptorWrites[1].pImageInfo      = &imageInfo;
+    descriptorWrites[0].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptorWrites[0].pImageInfo      = &imageInfo;
     m_descriptorSet.update(make_array_view(descriptorWrites));
 }
 
 void VkAppTeapotModel::initPipeline()
 {
     const VkDescriptorSetLayout setLayouts[] = { m_descriptorSetLayout.descriptorSetLayoutHandle() };
-    m_pipelineStateLayout.initialize(make_array_view(setLayouts));
+
+    // The MVP is fed to the vertex shader via push constants:
+    VkPushConstantRange pushConstantRanges[1] = {};
+    pushConstantRanges[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRanges[0].offset     = 0;
+    pushConstantRanges[0].size       = sizeof(Matrix4);
+
+    m_pipelineStateLayout.initialize(make_array_view(setLayouts), make_array_view(pushConstantRanges));
 
     PipelineStateBuilder psoBuilder;
     const Size2D fbSize = context().framebufferSize();
@@ -219,7 +207,7 @@ void VkAppTeapotModel::initPipeline()
 
 void VkAppTeapotModel::initTexture()
 {
-    m_sampler.initialize(Sampler::defaults());
+    m_sampler = context().defaultSampler();
 
     const auto & cmdBuff = context().mainTextureStagingCmdBuffer();
     cmdBuff.beginRecording();
@@ -227,7 +215,8 @@ void VkAppTeapotModel::initTexture()
     m_texture.load();
 
     cmdBuff.endRecording();
-    cmdBuff.submitAndWaitComplete(context().graphisQueue());
+    context().enqueueSubmit(cmdBuff);
+    context().flushPendingSubmits(); // The staging data is released right below.
     cmdBuff.reset();
 
     // Done with the staging data.
@@ -241,14 +230,14 @@ void VkAppTeapotModel::initVertexBuffer()
     m_vertexBuffer.initialize(m_mesh.vertexCount());
     m_indexBuffer.initialize(m_mesh.indexCount());
 
-    m_vertexBuffer.writeN(make_array_view(m_mesh.vertexes));
-    m_indexBuffer.writeN(make_array_view(m_mesh.indexes));
+    m_vertexBuffer.writeN(m_mesh.vertexArray());
+    m_indexBuffer.writeN(m_mesh.indexArray());
 
     // Validate the index buffer:
     #if DEBUG
     assert(m_vertexBuffer.elementCount() == m_mesh.vertexCount());
     assert(m_indexBuffer.elementCount()  == m_mesh.indexCount());
-    for (MeshIndex idx : m_mesh.indexes)
+    for (MeshIndex idx : m_mesh.indexArray())
     {
         assert(idx < MeshIndex(m_mesh.vertexCount()));
     }
@@ -269,7 +258,7 @@ void VkAppTeapotModel::updateBuffers(CommandBuffer & cmdBuff)
     }
 
     //
-    // Uniform buffer per-frame update:
+    // Per-frame matrix update - the MVP is pushed in prepareCommandBuffer():
     //
     const float time      = timeSeconds();
     const float rotationY = normalizeAngle180(time * 10.0f);
@@ -278,9 +267,6 @@ void VkAppTeapotModel::updateBuffers(CommandBuffer & cmdBuff)
     m_matrices.view       = Matrix4::lookAt(Point3{ 0.0f, 0.0f, 2.0f }, Point3{ 0.0f, 0.0f, -1.0f }, Vector3{ 0.0f, -1.0f, 0.0f });
     m_matrices.projection = Matrix4::perspective(45.0f * DegToRad, context().framebufferAspect(), 0.1f, 100.0f);
     m_matrices.mvp        = m_matrices.projection * m_matrices.view * m_matrices.model;
-
-    m_uniformBuffer.write(m_matrices);
-    m_uniformBuffer.uploadStagingToGpu(cmdBuff);
 }
 
 void VkAppTeapotModel::prepareCommandBuffer(CommandBuffer & cmdBuff)
@@ -296,10 +282,14 @@ void VkAppTeapotModel::prepareCommandBuffer(CommandBuffer & cmdBuff)
     const auto descriptorSet = make_array_view(m_descriptorSet.descriptorSetHandles);
     context().bindGraphicsDescriptorSets(cmdBuff, m_pipelineStateLayout, descriptorSet);
 
+    cmdBuff.pushConstants(m_pipelineStateLayout, VK_SHADER_STAGE_VERTEX_BIT, m_matrices.mvp);
+
     context().bindVertexBuffer(cmdBuff, m_vertexBuffer);
     context().bindIndexBuffer(cmdBuff, m_indexBuffer, vkIndexTypeForBuffer(m_indexBuffer));
 
-    context().drawIndexed(cmdBuff, m_indexBuffer.elementCount(), 1, 0, 0, 0);
+    // Only the full-detail indexes - the buffer also carries the reduced
+    // LOD sets at its tail, which this simple demo doesn't select from.
+    context().drawIndexed(cmdBuff, m_mesh.fullDetailIndexCount(), 1, 0, 0, 0);
 
     context().endRenderPass(cmdBuff);
 
@@ -3,17 +3,22 @@
 // File: Apps/TexturedCubes/VkAppTexturedCubes.cpp
 // Author: Guilherme R. Lampert
 // Created on: 08/04/17
-// Brief: Draws two textured cubes. One texture is loaded from file, the other is generated.
+// Brief: Draws a grid of textured cubes with GPU instancing. One texture is loaded from file, the other is generated.
 // ================================================================================================
 
 #include "Apps/VulkanDemoApp.hpp"
 #include "VkToolbox/DescriptorSets.hpp"
 #include "VkToolbox/PipelineState.hpp"
+#include "VkToolbox/GpuProfiler.hpp"
 #include "VkToolbox/GlslShader.hpp"
 #include "VkToolbox/Texture.hpp"
 #include "VkToolbox/Buffers.hpp"
 #include "VkToolbox/Mesh.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 using namespace VkToolbox;
 
 // ========================================================
@@ -46,25 +51,25 @@ private:
     PipelineStateLayout      m_pipelineStateLayout;
     PipelineStateObject      m_pipelineState;
 
-    struct Matrices
-    {
-        Matrix4 model        = Matrix4::identity();
-        Matrix4 view         = Matrix4::identity();
-        Matrix4 projection   = Matrix4::identity();
-        Matrix4 mvp          = Matrix4::identity();
-    };
-
-    std::array<Matrices, 2>                 m_matrices;
-    StructuredShaderUniformBuffer<Matrices> m_uniformBuffer;
-    StructuredVertexBuffer<MeshVertex>      m_vertexBuffer;
-    StructuredIndexBuffer<MeshIndex>        m_indexBuffer;
+    // One MVP per cube instance, living in a device-local SSBO that the
+    // vertex shader indexes with gl_InstanceIndex. The matrices are rebuilt
+    // on the CPU and re-uploaded through the persistently-mapped staging
+    // buffer once per frame, and the whole grid renders as a single
+    // instanced drawIndexed - the instance count comes from the
+    // 'cubeInstances' cvar, so this app doubles as the GPU instancing
+    // stress-test vehicle for very large object counts.
+    int                                m_cubeCount = 2;
+    std::vector<Matrix4>               m_cubeMvps;
+    StructuredStorageBuffer<Matrix4>   m_instanceBuffer;
+    StructuredVertexBuffer<MeshVertex> m_vertexBuffer;
+    StructuredIndexBuffer<MeshIndex>   m_indexBuffer;
 
     // Textures:
     const char * m_texture0Name = VKTB_TEXTURES_PATH "Common/lenna.png";
     const char * m_texture1Name = VKTB_TEXTURES_PATH "Generated/checkers.png";
     Texture      m_texture0;
     Texture      m_texture1;
-    Sampler      m_sharedSampler;
+    VkSampler    m_sharedSampler = VK_NULL_HANDLE; // Shared handle from the context sampler cache.
 
 private:
 
@@ -96,16 +101,18 @@ VkAppTexturedCubes::VkAppTexturedCubes(const StartupOptions & options)
     , m_descriptorSetLayout{ context() }
     , m_pipelineStateLayout{ context() }
     , m_pipelineState{ m_pipelineStateLayout }
-    , m_uniformBuffer{ context() }
+    , m_instanceBuffer{ context() }
     , m_vertexBuffer{ context() }
     , m_indexBuffer{ context() }
     , m_texture0{ context(), m_texture0Name }
     , m_texture1{ context(), m_texture1Name }
-    , m_sharedSampler{ context() }
 {
     m_shaderProgram.load();
 
-    m_uniformBuffer.initialize(2);          // One matrix uniform buffer for each cube we are going to draw
+    m_cubeCount = std::max(1, static_cast<int>(g_cubeInstanceCount->getIntValue()));
+    m_cubeMvps.resize(m_cubeCount);
+    m_instanceBuffer.initialize(m_cubeCount);
+
     m_vertexBuffer.initialize(BoxVertexes); // Number of unique vertexes in the object
     m_indexBuffer.initialize(BoxIndexes);   // Number of indexes mapping the shared verts
 
@@ -135,35 +142,32 @@ void VkAppTexturedCubes::initDescriptorSets()
 {
     // Pool:
     const VkDescriptorPoolSize descriptorPoolSizes[] = {
-        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         2 }, // matrices[2]
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         1 }, // instance transforms
         { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2 }, // textureSampler[2]
     };
     m_descriptorSetPool.initialize(1, make_array_view(descriptorPoolSizes));
 
     // Set layout:
-    VkDescriptorSetLayoutBinding uboLayoutBindings[2] = {};
-    uboLayoutBindings[0].binding         = 0; // layout(binding = 0)
-    uboLayoutBindings[0].descriptorCount = 2; // Matching 'matrices[2]' declaration in the VS
-    uboLayoutBindings[0].descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    uboLayoutBindings[0].stageFlags      = VK_SHADER_STAGE_VERTEX_BIT;
-    uboLayoutBindings[1].binding         = 1; // layout(binding = 1)
-    uboLayoutBindings[1].descriptorCount = 2; // Matching 'textureSampler[2]' declaration in the FS
-    uboLayoutBindings[1].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    uboLayoutBindings[1].stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT;
-    m_descriptorSetLayout.initialize(make_array_view(uboLayoutBindings));
+    VkDescriptorSetLayoutBinding layoutBindings[2] = {};
+    layoutBindings[0].binding         = 0; // layout(binding = 0)
+    layoutBindings[0].descriptorCount = 1; // Matching 'instances' declaration in the VS
+    layoutBindings[0].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    layoutBindings[0].stageFlags      = VK_SHADER_STAGE_VERTEX_BIT;
+    layoutBindings[1].binding         = 1; // layout(binding = 1)
+    layoutBindings[1].descriptorCount = 2; // Matching 'textureSampler[2]' declaration in the FS
+    layoutBindings[1].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    layoutBindings[1].stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT;
+    m_descriptorSetLayout.initialize(make_array_view(layoutBindings));
 
     // The Descriptor Set:
     const VkDescriptorSetLayout layouts[] = { m_descriptorSetLayout.descriptorSetLayoutHandle() };
     m_descriptorSet.initialize(&m_descriptorSetPool);
     m_descriptorSet.allocate(make_array_view(layouts));
 
-    VkDescriptorBufferInfo bufferInfos[2] = {};
-    bufferInfos[0].buffer = m_uniformBuffer.bufferHandle();
-    bufferInfos[0].range  = m_uniformBuffer.elementSizeBytes();
-    bufferInfos[0].offset = 0;
-    bufferInfos[1].buffer = m_uniformBuffer.bufferHandle();
-    bufferInfos[1].range  = m_uniformBuffer.elementSizeBytes();
-    bufferInfos[1].offset = m_uniformBuffer.elementSizeBytes();
+    VkDescriptorBufferInfo bufferInfo;
+    bufferInfo.buffer = m_instanceBuffer.bufferHandle();
+    bufferInfo.range  = VK_WHOLE_SIZE;
+    bufferInfo.offset = 0;
 
     VkDescriptorImageInfo imageInfos[2] = {};
     imageInfos[0].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
@@ -178,9 +182,9 @@ void VkAppTexturedCubes::initDescriptorSets()
     descriptorWrites[0].dstSet          = m_descriptorSet.descriptorSetHandles[0];
     descriptorWrites[0].dstBinding      = 0;
     descriptorWrites[0].dstArrayElement = 0;
-    descriptorWrites[0].descriptorCount = 2;
-    descriptorWrites[0].descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    descriptorWrites[0].pBufferInfo     = bufferInfos;
+    descriptorWrites[0].descriptorCount = 1;
+    descriptorWrites[0].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrites[0].pBufferInfo     = &bufferInfo;
     descriptorWrites[1].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     descriptorWrites[1].dstSet          = m_descriptorSet.descriptorSetHandles[0];
     descriptorWrites[1].dstBinding      = 1;
@@ -205,7 +209,12 @@ void VkAppTexturedCubes::initPipeline()
     psoBuilder.scissor.extent.height    = fbSize.height;
     psoBuilder.pipelineState.layout     = m_pipelineStateLayout;
     psoBuilder.pipelineState.renderPass = context().mainRenderPass();
-    psoBuilder.pipelineState.stageCount = m_shaderProgram.pipelineStages(&psoBuilder.shaderPipelineStages);
+
+    // NUM_TEXTURES in TexturedCubes.glsl - sizes the sampler array and the
+    // instance->texture cycling without a dedicated shader permutation.
+    psoBuilder.setSpecConstant(0, 2);
+    psoBuilder.pipelineState.stageCount = m_shaderProgram.pipelineStages(&psoBuilder.shaderPipelineStages,
+                                                                         psoBuilder.specInfo());
 
     const auto & bindingDescription     = MeshVertex::bindingDescription();
     const auto & attributeDescriptions  = MeshVertex::attributeDescriptions();
@@ -240,7 +249,7 @@ void VkAppTexturedCubes::initVertexBuffer()
 
 void VkAppTexturedCubes::initTextures()
 {
-    m_sharedSampler.initialize(Sampler::defaults());
+    m_sharedSampler = context().defaultSampler();
 
     const auto & cmdBuff = context().mainTextureStagingCmdBuffer();
     cmdBuff.beginRecording();
@@ -258,7 +267,8 @@ void VkAppTexturedCubes::initTextures()
         m_texture1.loadFromImageInMemory(image);
     }
     cmdBuff.endRecording();
-    cmdBuff.submitAndWaitComplete(context().graphisQueue());
+    context().enqueueSubmit(cmdBuff);
+    context().flushPendingSubmits(); // The staging data is released right below.
     cmdBuff.reset();
 
     // Done with the staging data.
@@ -280,33 +290,59 @@ void VkAppTexturedCubes::updateBuffers(CommandBuffer & cmdBuff)
     }
 
     //
-    // Uniform buffer per-frame update:
+    // Per-frame MVP update - all the instance matrices are rebuilt, then
+    // re-uploaded to the device-local SSBO in a single staging copy:
     //
     const float time      = timeSeconds();
     const float rotationX = normalizeAngle180(time * 60.0f);
     const float rotationY = normalizeAngle180(time * 30.0f);
 
-    m_matrices[0].model      = Matrix4::translation(Vector3{ -1.0f, 0.0f, -3.0f }) * Matrix4::rotationZYX(Vector3{ 0.0f, rotationY * DegToRad, rotationX * DegToRad });
-    m_matrices[0].view       = Matrix4::lookAt(Point3{ 0.0f, 0.0f, 2.0f }, Point3{ 0.0f, 0.0f, 0.0f }, Vector3{ 0.0f, 1.0f, 0.0f });
-    m_matrices[0].projection = Matrix4::perspective(45.0f * DegToRad, context().framebufferAspect(), 0.1f, 100.0f);
-    m_matrices[0].mvp        = m_matrices[0].projection * m_matrices[0].view * m_matrices[0].model;
-    m_uniformBuffer.write(m_matrices[0], 0);
+    // Every cube shares the same spin - only the grid position differs.
+    const Matrix4 rotation = Matrix4::rotationZYX(Vector3{ 0.0f, rotationY * DegToRad, rotationX * DegToRad });
+
+    // Lay the instances out in a roughly cubical grid, centered at the
+    // origin, and pull the camera back far enough to frame the whole thing.
+    constexpr float spacing = 2.0f;
+    const int   gridSize    = static_cast<int>(std::ceil(std::cbrt(static_cast<float>(m_cubeCount))));
+    const float gridOffset  = (gridSize - 1) * spacing * 0.5f;
+    const float cameraDist  = 3.0f + gridOffset * 3.0f;
 
-    m_matrices[1].model      = Matrix4::translation(Vector3{ 1.0f, 0.0f, -3.0f }) * Matrix4::rotationZYX(Vector3{ 0.0f, rotationY * DegToRad, rotationX * DegToRad });
-    m_matrices[1].view       = Matrix4::lookAt(Point3{ 0.0f, 0.0f, 2.0f }, Point3{ 0.0f, 0.0f, 0.0f }, Vector3{ 0.0f, 1.0f, 0.0f });
-    m_matrices[1].projection = Matrix4::perspective(45.0f * DegToRad, context().framebufferAspect(), 0.1f, 100.0f);
-    m_matrices[1].mvp        = m_matrices[1].projection * m_matrices[1].view * m_matrices[1].model;
-    m_uniformBuffer.write(m_matrices[1], 1);
+    const Matrix4 view       = Matrix4::lookAt(Point3{ 0.0f, 0.0f, cameraDist }, Point3{ 0.0f, 0.0f, 0.0f }, Vector3{ 0.0f, 1.0f, 0.0f });
+    const Matrix4 projection = Matrix4::perspective(45.0f * DegToRad, context().framebufferAspect(), 0.1f, cameraDist * 4.0f);
+    const Matrix4 viewProj   = projection * view;
 
-    m_uniformBuffer.uploadStagingToGpu(cmdBuff);
+    int cube = 0;
+    for (int z = 0; z < gridSize && cube < m_cubeCount; ++z)
+    {
+        for (int y = 0; y < gridSize && cube < m_cubeCount; ++y)
+        {
+            for (int x = 0; x < gridSize && cube < m_cubeCount; ++x, ++cube)
+            {
+                const Vector3 position{ x * spacing - gridOffset,
+                                        y * spacing - gridOffset,
+                                        z * spacing - gridOffset };
+
+                m_cubeMvps[cube] = viewProj * Matrix4::translation(position) * rotation;
+            }
+        }
+    }
+
+    m_instanceBuffer.writeN(make_array_view(m_cubeMvps.data(), m_cubeMvps.size()));
+    m_instanceBuffer.uploadStagingToGpu(cmdBuff);
 }
 
 void VkAppTexturedCubes::prepareCommandBuffer(CommandBuffer & cmdBuff)
 {
+    GpuProfiler & profiler = context().gpuProfiler();
+
     cmdBuff.beginRecording();
+    profiler.beginFrame(cmdBuff);
 
+    profiler.beginZone(cmdBuff, "UpdateBuffers");
     updateBuffers(cmdBuff);
+    profiler.endZone(cmdBuff);
 
+    profiler.beginZone(cmdBuff, "MainRenderPass");
     context().beginRenderPass(cmdBuff);
 
     context().bindGraphicsPipelineState(cmdBuff, m_pipelineState);
@@ -317,9 +353,11 @@ void VkAppTexturedCubes::prepareCommandBuffer(CommandBuffer & cmdBuff)
     context().bindVertexBuffer(cmdBuff, m_vertexBuffer);
     context().bindIndexBuffer(cmdBuff, m_indexBuffer, vkIndexTypeForBuffer(m_indexBuffer));
 
-    context().drawIndexed(cmdBuff, m_indexBuffer.elementCount(), 2, 0, 0, 0);
+    // The whole grid of cubes is a single instanced draw call.
+    context().drawIndexed(cmdBuff, m_indexBuffer.elementCount(), m_cubeCount, 0, 0, 0);
 
     context().endRenderPass(cmdBuff);
+    profiler.endZone(cmdBuff);
 
     cmdBuff.endRecording();
 }
@@ -339,6 +377,12 @@ void VkAppTexturedCubes::onFrameUpdate()
 
     context().endFrame(submitBuffers, m_currentCmdBufferFence->fenceHandle());
 
+    // Periodic GPU zone timings when profiling is turned on.
+    if (GpuProfiler::sm_enabled && (context().frameNumber() % 120) == 0)
+    {
+        context().gpuProfiler().logFrameReport();
+    }
+
     // Grab the next buffer in the chain:
     m_nextCmdBufferIndex    = (m_nextCmdBufferIndex + 1) % m_cmdBuffers.size();
     m_currentCmdBuffer      = m_cmdBuffers[m_nextCmdBufferIndex].get();
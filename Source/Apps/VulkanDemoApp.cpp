@@ -7,6 +7,9 @@
 // ================================================================================================
 
 #include "VulkanDemoApp.hpp"
+#include "VkToolbox/CpuProfiler.hpp"
+#include "VkToolbox/FileWatcher.hpp"
+#include "VkToolbox/TextureResidency.hpp"
 
 // ========================================================
 // Global CVars:
@@ -14,7 +17,13 @@
 cfg::CVar * g_startupWindowWidth    = nullptr;
 cfg::CVar * g_startupWindowHeight   = nullptr;
 cfg::CVar * g_startupMaximizeWindow = nullptr;
+cfg::CVar * g_startupGpuIndex       = nullptr;
 cfg::CVar * g_smoketestRunOnly      = nullptr;
+cfg::CVar * g_benchFrameCount       = nullptr;
+cfg::CVar * g_cubeInstanceCount     = nullptr;
+cfg::CVar * g_depthPrePass          = nullptr;
+cfg::CVar * g_textureBudgetMB       = nullptr;
+cfg::CVar * g_asyncLogging          = nullptr;
 
 // ========================================================
 // Static vars/methods:
@@ -53,6 +62,17 @@ std::unique_ptr<VulkanDemoApp> VulkanDemoApp::create(const int argc, const char
     options.initialWindowSize.height = static_cast<int>(g_startupWindowHeight->getIntValue());
     options.openMaximizedWindow      = g_startupMaximizeWindow->getBoolValue();
 
+    // GPU selection override and render pass layout - must be set before the
+    // VulkanContext is constructed.
+    VkToolbox::VulkanContext::sm_preferredGpuIndex   = static_cast<int>(g_startupGpuIndex->getIntValue());
+    VkToolbox::VulkanContext::sm_depthPrePassEnabled = g_depthPrePass->getBoolValue();
+
+    // VRAM budget for the texture residency system (0 = no budget, demotion disabled).
+    VkToolbox::TextureResidencyManager::sm_deviceMemoryBudgetBytes = g_textureBudgetMB->getIntValue() * 1024 * 1024;
+
+    // From here on log output goes through the background thread (unless opted out).
+    VkToolbox::Log::setAsyncMode(g_asyncLogging->getBoolValue());
+
     return create(appClassName, options);
 }
 
@@ -111,7 +131,13 @@ void VulkanDemoApp::initClass()
     g_startupWindowWidth     = sm_cvarManager->registerCVarInt("windowWidth", "Startup window width", cvarFlags, 1024, 0, 0);
     g_startupWindowHeight    = sm_cvarManager->registerCVarInt("windowHeight", "Startup window height", cvarFlags, 768, 0, 0);
     g_startupMaximizeWindow  = sm_cvarManager->registerCVarBool("maximizeWindow", "Open window maximized", cvarFlags, false);
+    g_startupGpuIndex        = sm_cvarManager->registerCVarInt("gpuIndex", "Physical GPU index to render with (-1 = auto-select best)", cvarFlags, -1, -1, 64);
     g_smoketestRunOnly       = sm_cvarManager->registerCVarBool("smoketest", "Run a smoke test frame and quit", cvarFlags, false);
+    g_benchFrameCount        = sm_cvarManager->registerCVarInt("benchFrames", "Frames rendered by VkAppBenchmark before it quits", cvarFlags, 1000, 0, 0);
+    g_cubeInstanceCount      = sm_cvarManager->registerCVarInt("cubeInstances", "Cube instances drawn by VkAppTexturedCubes (GPU instancing stress test)", cvarFlags, 2, 0, 0);
+    g_depthPrePass           = sm_cvarManager->registerCVarBool("depthPrePass", "Depth-only pre-pass in apps that support it (VkAppScene)", cvarFlags, false);
+    g_textureBudgetMB        = sm_cvarManager->registerCVarInt("textureBudgetMB", "VRAM budget in MB for textures under residency management (0 = unlimited)", cvarFlags, 0, 0, 0);
+    g_asyncLogging           = sm_cvarManager->registerCVarBool("asyncLog", "Write log messages from a background thread", cvarFlags, true);
 
     VkToolbox::VulkanContext::initClass();
 }
@@ -123,7 +149,16 @@ void VulkanDemoApp::shutdownClass()
     g_startupWindowWidth    = nullptr;
     g_startupWindowHeight   = nullptr;
     g_startupMaximizeWindow = nullptr;
+    g_startupGpuIndex       = nullptr;
     g_smoketestRunOnly      = nullptr;
+    g_benchFrameCount       = nullptr;
+    g_cubeInstanceCount     = nullptr;
+    g_depthPrePass          = nullptr;
+    g_textureBudgetMB       = nullptr;
+    g_asyncLogging          = nullptr;
+
+    // Make sure any queued async messages are written before we exit.
+    VkToolbox::Log::setAsyncMode(false);
 
     if (sm_cmdManager != nullptr)
     {
@@ -157,7 +192,18 @@ VulkanDemoApp::VulkanDemoApp(const StartupOptions & options)
     {
         const auto t0 = timeMilliseconds();
 
-        onFrameUpdate();
+        // Targeted hot-reloads for watched files changed on disk.
+        // Early-outs between scans, so per-frame cost is negligible.
+        VkToolbox::FileWatcher::shared().poll();
+
+        {
+            VKTB_PROFILE_SCOPE("FrameUpdate");
+            onFrameUpdate();
+        }
+
+        // Drain the profiler event rings now that the frame's zones are closed.
+        VkToolbox::CpuProfiler::shared().endFrame();
+
         if (s_smoketestRun)
         {
             m_window.setStopEventLoop(true);
@@ -190,7 +236,7 @@ void VulkanDemoApp::onFrameUpdate()
 void VulkanDemoApp::onResizeWindow(const VkToolbox::Size2D newSize)
 {
     VkToolbox::Log::debugF("Resizing window to {w=%i, h=%i}", newSize.width, newSize.height);
-    // Not handled here.
+    m_vkContext.recreateSwapChain(newSize);
 }
 
 // ========================================================
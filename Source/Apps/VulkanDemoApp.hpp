@@ -109,6 +109,12 @@ private:
 extern cfg::CVar * g_startupWindowWidth;
 extern cfg::CVar * g_startupWindowHeight;
 extern cfg::CVar * g_startupMaximizeWindow;
+extern cfg::CVar * g_startupGpuIndex;
 extern cfg::CVar * g_smoketestRunOnly;
+extern cfg::CVar * g_benchFrameCount;
+extern cfg::CVar * g_cubeInstanceCount;
+extern cfg::CVar * g_depthPrePass;
+extern cfg::CVar * g_textureBudgetMB;
+extern cfg::CVar * g_asyncLogging;
 
 // ========================================================
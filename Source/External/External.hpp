@@ -11,8 +11,6 @@
 #define ARRAY_VIEW_USE_ASSERTS 1
 #include "array_view/array_view.hpp"
 // ========================================================
-#include "hash_index/hash_index.hpp"
-// ========================================================
 #include "enum_helpers/enum_helpers.hpp"
 // ========================================================
 #include "vectormath/vectormath.hpp"
@@ -21,18 +21,16 @@ layout(location = 2) out vec3 outVertexNormal;
 layout(location = 3) out vec3 outVertexTangent;
 layout(location = 4) out vec3 outVertexBitangent;
 
-layout(binding = 0)
-uniform Matrices
+// The MVP is per-draw data, so it rides in a push constant range instead
+// of a uniform buffer - no buffer update or descriptor binding needed.
+layout(push_constant) uniform PushConstants
 {
-    mat4 model;
-    mat4 view;
-    mat4 projection;
     mat4 mvp;
-} matrices;
+} pushConstants;
 
 void main()
 {
-    gl_Position = matrices.mvp * vec4(inVertexPosition, 1.0);
+    gl_Position = pushConstants.mvp * vec4(inVertexPosition, 1.0);
 
     outVertexColor     = inVertexColor;
     outVertexTexCoords = inVertexTexCoords;
@@ -1,6 +1,6 @@
 //
 // Vertex position, color and texture. This shader is used by the textured cubes sample.
-// Assumes two instances of the geometry, indexing with the VK extension 'gl_InstanceIndex'.
+// Any number of instances of the geometry, indexing with the VK extension 'gl_InstanceIndex'.
 //
 
 // ----------------------------------------------------------------------------
@@ -17,21 +17,24 @@ layout(location = 0) out vec4 outVertexColor;
 layout(location = 1) out vec2 outVertexTexCoords;
 layout(location = 2) out flat int outTextureIndex;
 
-layout(binding = 0)
-uniform Matrices
+// Specialized at pipeline creation time (PipelineStateBuilder::setSpecConstant),
+// so the one compiled SPIR-V module serves any texture count without a recompile.
+layout(constant_id = 0) const int NUM_TEXTURES = 2;
+
+// One MVP per cube instance, indexed with gl_InstanceIndex. An unsized
+// SSBO array instead of a uniform block so the whole grid of cubes goes
+// down as a single instanced draw, whatever the instance count.
+layout(std430, binding = 0) readonly buffer InstanceTransforms
 {
-    mat4 model;
-    mat4 view;
-    mat4 projection;
-    mat4 mvp;
-} matrices[2];
+    mat4 mvp[];
+} instances;
 
 void main()
 {
-    gl_Position        = matrices[gl_InstanceIndex].mvp * vec4(inVertexPosition, 1.0);
+    gl_Position        = instances.mvp[gl_InstanceIndex] * vec4(inVertexPosition, 1.0);
     outVertexColor     = inVertexColor;
     outVertexTexCoords = inVertexTexCoords;
-    outTextureIndex    = gl_InstanceIndex;
+    outTextureIndex    = gl_InstanceIndex % NUM_TEXTURES; // Cycle through the available textures.
 }
 
 // ----------------------------------------------------------------------------
@@ -42,8 +45,11 @@ layout(location = 0) in vec4 inVertexColor;
 layout(location = 1) in vec2 inVertexTexCoords;
 layout(location = 2) in flat int inTextureIndex;
 
+// Each stage declares the constant_ids it uses - same id, same value.
+layout(constant_id = 0) const int NUM_TEXTURES = 2;
+
 layout(binding = 1)
-uniform sampler2D textureSampler[2];
+uniform sampler2D textureSampler[NUM_TEXTURES];
 
 layout(location = 0) out vec4 outFragColor;
 
@@ -0,0 +1,200 @@
+
+// ================================================================================================
+// File: VkToolbox/BindlessTextures.cpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Bindless-style texture array descriptor set (VK_EXT_descriptor_indexing).
+// ================================================================================================
+
+#include "BindlessTextures.hpp"
+
+#if VKTB_DESCRIPTOR_INDEXING_AVAILABLE
+
+namespace VkToolbox
+{
+
+// ========================================================
+// class BindlessTextureArray:
+// ========================================================
+
+BindlessTextureArray::BindlessTextureArray(const VulkanContext & vkContext)
+    : m_setPool{ vkContext }
+    , m_materialBuffer{ vkContext }
+    , m_vkContext{ &vkContext }
+{
+}
+
+BindlessTextureArray::~BindlessTextureArray()
+{
+    shutdown();
+}
+
+bool BindlessTextureArray::isInitialized() const
+{
+    return (m_setLayoutHandle != VK_NULL_HANDLE);
+}
+
+void BindlessTextureArray::initialize(const int maxTextures, const int maxMaterials)
+{
+    assert(!isInitialized());
+    assert(maxTextures  > 0);
+    assert(maxMaterials > 0);
+    assert(m_vkContext->isDescriptorIndexingSupported());
+
+    m_maxTextures = maxTextures;
+
+    // Pool - one set holding the whole array plus the material SSBO:
+    const VkDescriptorPoolSize descriptorPoolSizes[] = {
+        { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, static_cast<std::uint32_t>(maxTextures) },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         1                                       },
+    };
+    m_setPool.initialize(1, make_array_view(descriptorPoolSizes));
+
+    // Set layout. The texture array is partially bound so slots of textures
+    // that never loaded can stay unwritten - the material SSBO only ever
+    // indexes slots that were published.
+    VkDescriptorSetLayoutBinding layoutBindings[2] = {};
+    layoutBindings[0].binding         = TextureArrayBinding;
+    layoutBindings[0].descriptorCount = maxTextures;
+    layoutBindings[0].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    layoutBindings[0].stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT;
+    layoutBindings[1].binding         = MaterialBufferBinding;
+    layoutBindings[1].descriptorCount = 1;
+    layoutBindings[1].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    layoutBindings[1].stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    const VkDescriptorBindingFlagsEXT bindingFlags[2] = {
+        VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT,
+        0,
+    };
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo = {};
+    bindingFlagsInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+    bindingFlagsInfo.bindingCount  = static_cast<std::uint32_t>(arrayLength(bindingFlags));
+    bindingFlagsInfo.pBindingFlags = bindingFlags;
+
+    // The DescriptorSetLayout helper has no pNext hook,
+    // so this one layout is created by hand.
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext        = &bindingFlagsInfo;
+    layoutInfo.bindingCount = static_cast<std::uint32_t>(arrayLength(layoutBindings));
+    layoutInfo.pBindings    = layoutBindings;
+
+    VKTB_CHECK(vkCreateDescriptorSetLayout(m_vkContext->deviceHandle(), &layoutInfo,
+                                           m_vkContext->allocationCallbacks(), &m_setLayoutHandle));
+
+    // The descriptor set itself:
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool     = m_setPool.descriptorPoolHandle();
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts        = &m_setLayoutHandle;
+
+    VKTB_CHECK(vkAllocateDescriptorSets(m_vkContext->deviceHandle(), &allocInfo, &m_setHandle));
+
+    // Material constants SSBO, written into the set right away:
+    m_materialBuffer.initialize(maxMaterials);
+
+    VkDescriptorBufferInfo bufferInfo;
+    bufferInfo.buffer = m_materialBuffer.bufferHandle();
+    bufferInfo.range  = VK_WHOLE_SIZE;
+    bufferInfo.offset = 0;
+
+    VkWriteDescriptorSet descriptorWrite = {};
+    descriptorWrite.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet          = m_setHandle;
+    descriptorWrite.dstBinding      = MaterialBufferBinding;
+    descriptorWrite.dstArrayElement = 0;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrite.pBufferInfo     = &bufferInfo;
+
+    vkUpdateDescriptorSets(m_vkContext->deviceHandle(), 1, &descriptorWrite, 0, nullptr);
+}
+
+void BindlessTextureArray::shutdown()
+{
+    if (m_setLayoutHandle != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorSetLayout(m_vkContext->deviceHandle(), m_setLayoutHandle,
+                                     m_vkContext->allocationCallbacks());
+        m_setLayoutHandle = VK_NULL_HANDLE;
+    }
+
+    m_setHandle = VK_NULL_HANDLE; // Owned by the pool.
+    m_setPool.shutdown();
+    m_materialBuffer.shutdown();
+    m_maxTextures = 0;
+}
+
+void BindlessTextureArray::publishTexture(const int slotIndex, const Texture & texture, const VkSampler sampler)
+{
+    assert(isInitialized());
+    assert(slotIndex >= 0 && slotIndex < m_maxTextures);
+
+    VkDescriptorImageInfo imageInfo;
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imageInfo.imageView   = texture.imageViewHandle();
+    imageInfo.sampler     = sampler;
+
+    VkWriteDescriptorSet descriptorWrite = {};
+    descriptorWrite.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet          = m_setHandle;
+    descriptorWrite.dstBinding      = TextureArrayBinding;
+    descriptorWrite.dstArrayElement = slotIndex;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptorWrite.pImageInfo      = &imageInfo;
+
+    vkUpdateDescriptorSets(m_vkContext->deviceHandle(), 1, &descriptorWrite, 0, nullptr);
+}
+
+int BindlessTextureArray::publishLoadedTextures(const VkSampler sampler)
+{
+    assert(isInitialized());
+
+    int slotsWritten = 0;
+
+    const int textureCount = TextureManager::resourceCount();
+    assert(textureCount <= m_maxTextures);
+
+    for (int t = 0; t < textureCount; ++t)
+    {
+        if (!TextureManager::isLoaded(t))
+        {
+            continue; // Slot stays unwritten - the array is partially bound.
+        }
+
+        publishTexture(t, TextureManager::resourceRef(t), sampler);
+        ++slotsWritten;
+    }
+
+    return slotsWritten;
+}
+
+void BindlessTextureArray::writeMaterialConstants(array_view<const BindlessMaterialConstants> materials)
+{
+    assert(isInitialized());
+    assert(narrowCast<int>(materials.size()) <= m_materialBuffer.elementCount());
+
+    m_materialBuffer.writeN(materials);
+}
+
+void BindlessTextureArray::uploadToGpu(const CommandBuffer & cmdBuff) const
+{
+    assert(isInitialized());
+    m_materialBuffer.uploadStagingToGpu(cmdBuff);
+}
+
+void BindlessTextureArray::bind(const CommandBuffer & cmdBuff, const VkPipelineLayout pipelineLayout) const
+{
+    assert(isInitialized());
+
+    const VkDescriptorSet sets[] = { m_setHandle };
+    m_vkContext->bindGraphicsDescriptorSets(cmdBuff, pipelineLayout, make_array_view(sets));
+}
+
+} // namespace VkToolbox
+
+#endif // VKTB_DESCRIPTOR_INDEXING_AVAILABLE
@@ -0,0 +1,113 @@
+#pragma once
+
+// ================================================================================================
+// File: VkToolbox/BindlessTextures.hpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Bindless-style texture array descriptor set (VK_EXT_descriptor_indexing).
+// ================================================================================================
+
+#include "Buffers.hpp"
+#include "DescriptorSets.hpp"
+#include "ResourceManager.hpp"
+
+// The installed SDK headers may predate the extension - the whole bindless
+// path is compiled out in that case and the runtime falls back to the
+// per-material descriptor sets. VulkanContext::isDescriptorIndexingSupported()
+// then always reports false.
+#if defined(VK_EXT_descriptor_indexing)
+    #define VKTB_DESCRIPTOR_INDEXING_AVAILABLE 1
+#else // !VK_EXT_descriptor_indexing
+    #define VKTB_DESCRIPTOR_INDEXING_AVAILABLE 0
+#endif // VK_EXT_descriptor_indexing
+
+namespace VkToolbox
+{
+
+// ========================================================
+// struct BindlessMaterialConstants:
+// ========================================================
+
+// One entry per mesh material in the material constants SSBO (binding 1 of the
+// bindless set). The indices select slots of the global texture array at
+// binding 0 and are just the TextureManager ResourceIndex of each map. Layout
+// must match the MaterialConstants block declaration in the shaders (std430).
+struct BindlessMaterialConstants
+{
+    std::int32_t diffuseTexIndex;
+    std::int32_t normalTexIndex;
+    std::int32_t specularTexIndex;
+    float        shininess;
+};
+
+#if VKTB_DESCRIPTOR_INDEXING_AVAILABLE
+
+// ========================================================
+// class BindlessTextureArray:
+// ========================================================
+
+// Publishes loaded TextureManager textures into one big combined-image-sampler
+// array descriptor, with the per-material texture selections reduced to
+// integer indices in an SSBO - so a whole model renders with a single
+// descriptor set bound once, however many materials it crosses. Only usable
+// when VulkanContext::isDescriptorIndexingSupported(); callers keep the
+// per-material RenderStates path as the fallback.
+class BindlessTextureArray final
+{
+public:
+
+    // Texture array slot (binding 0) and material SSBO (binding 1)
+    // of the single descriptor set this class owns.
+    static constexpr std::uint32_t TextureArrayBinding    = 0;
+    static constexpr std::uint32_t MaterialBufferBinding  = 1;
+
+    explicit BindlessTextureArray(const VulkanContext & vkContext);
+    ~BindlessTextureArray();
+
+    BindlessTextureArray(const BindlessTextureArray &) = delete;
+    BindlessTextureArray & operator = (const BindlessTextureArray &) = delete;
+
+    // maxTextures bounds the texture array slots (TextureManager indexes must
+    // stay below it); maxMaterials sizes the material constants buffer. The
+    // array is created partially-bound, so slots for textures that never load
+    // can simply stay unwritten.
+    void initialize(int maxTextures, int maxMaterials);
+    void shutdown();
+    bool isInitialized() const;
+
+    // Write one texture array slot. slotIndex is normally the texture's
+    // TextureManager ResourceIndex, which is what the material SSBO stores.
+    void publishTexture(int slotIndex, const Texture & texture, VkSampler sampler);
+
+    // Walks the TextureManager and publishes every currently loaded texture
+    // at its ResourceIndex slot. Returns the number of slots written.
+    int publishLoadedTextures(VkSampler sampler);
+
+    // Copy the material constants into the staging SSBO. uploadToGpu() pushes
+    // them to device memory - record it alongside the model buffer uploads.
+    void writeMaterialConstants(array_view<const BindlessMaterialConstants> materials);
+    void uploadToGpu(const CommandBuffer & cmdBuff) const;
+
+    // Bind the set - set zero of a pipeline layout built from descriptorSetLayoutHandle().
+    void bind(const CommandBuffer & cmdBuff, VkPipelineLayout pipelineLayout) const;
+
+    const VulkanContext & context() const { return *m_vkContext; }
+    VkDescriptorSetLayout descriptorSetLayoutHandle() const { return m_setLayoutHandle; }
+
+private:
+
+    VkDescriptorSetLayout m_setLayoutHandle = VK_NULL_HANDLE;
+    VkDescriptorSet       m_setHandle       = VK_NULL_HANDLE;
+    DescriptorSetPool     m_setPool;
+
+    StructuredStorageBuffer<BindlessMaterialConstants> m_materialBuffer;
+
+    int m_maxTextures = 0;
+    const VulkanContext * m_vkContext;
+};
+
+#endif // VKTB_DESCRIPTOR_INDEXING_AVAILABLE
+
+// ========================================================
+
+} // namespace VkToolbox
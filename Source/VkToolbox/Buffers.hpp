@@ -33,6 +33,11 @@ public:
     bool isInitialized() const;
     void uploadStagingToGpu(const CommandBuffer & cmdBuff) const;
 
+    // Records the copy on the context's dedicated transfer queue instead, so the
+    // upload overlaps in-flight frames. Must be called between beginAsyncTransfer()
+    // and endAsyncTransfer(), and requires hasDedicatedTransferQueue().
+    void uploadStagingToGpuAsync() const;
+
     int bufferSizeBytes() const;
     VkBuffer bufferHandle() const;
     VkBuffer stagingBufferHandle() const;
@@ -53,9 +58,10 @@ private:
 
 // ========================================================
 
-using StagingBufferUB = StagingBuffer<VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT>;
-using StagingBufferVB = StagingBuffer<VK_BUFFER_USAGE_VERTEX_BUFFER_BIT>;
-using StagingBufferIB = StagingBuffer<VK_BUFFER_USAGE_INDEX_BUFFER_BIT>;
+using StagingBufferUB  = StagingBuffer<VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT>;
+using StagingBufferVB  = StagingBuffer<VK_BUFFER_USAGE_VERTEX_BUFFER_BIT>;
+using StagingBufferIB  = StagingBuffer<VK_BUFFER_USAGE_INDEX_BUFFER_BIT>;
+using StagingBufferSSB = StagingBuffer<VK_BUFFER_USAGE_STORAGE_BUFFER_BIT>;
 
 // ========================================================
 // class PersistentlyMappedBuffer:
@@ -130,6 +136,9 @@ using ShaderUniformBuffer = PersistentlyMappedBuffer<StagingBufferUB>;
 using VertexBuffer = PersistentlyMappedBuffer<StagingBufferVB>;
 using IndexBuffer  = PersistentlyMappedBuffer<StagingBufferIB>;
 
+// Persistently mapped storage buffer (SSBO) - e.g. the bindless material constants.
+using StorageBuffer = PersistentlyMappedBuffer<StagingBufferSSB>;
+
 // ========================================================
 // template class StructuredShaderUniformBuffer:
 // ========================================================
@@ -312,14 +321,86 @@ public:
 
 // ========================================================
 
-template<typename T> using StructuredVertexBuffer = GenericStructuredBuffer<T, VertexBuffer>;
-template<typename T> using StructuredIndexBuffer  = GenericStructuredBuffer<T, IndexBuffer>;
+template<typename T> using StructuredVertexBuffer  = GenericStructuredBuffer<T, VertexBuffer>;
+template<typename T> using StructuredIndexBuffer   = GenericStructuredBuffer<T, IndexBuffer>;
+template<typename T> using StructuredStorageBuffer = GenericStructuredBuffer<T, StorageBuffer>;
 
 // ========================================================
 
 inline VkIndexType vkIndexTypeForBuffer(const StructuredIndexBuffer<std::uint16_t> &) { return VK_INDEX_TYPE_UINT16; }
 inline VkIndexType vkIndexTypeForBuffer(const StructuredIndexBuffer<std::uint32_t> &) { return VK_INDEX_TYPE_UINT32; }
 
+// ========================================================
+// class UniformRingBuffer:
+// ========================================================
+
+// One host-visible, persistently mapped uniform buffer split into a region per
+// in-flight frame. Per-draw uniform data is sub-allocated from the current frame's
+// region with allocate()/push() and written straight through the mapping - no
+// staging copy and no GPU transfer. Bind the buffer once through a
+// VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC descriptor (offset 0, range = your
+// struct size) and pass Allocation::dynamicOffset to bindGraphicsDescriptorSets()
+// at draw time. Call beginFrame() once per frame to rotate regions; with as many
+// regions as frames in flight the GPU is never reading the one being written.
+class UniformRingBuffer final
+{
+public:
+
+    struct Allocation
+    {
+        void *        mappedPtr     = nullptr; // Write your uniform struct here.
+        std::uint32_t dynamicOffset = 0;       // Pass at descriptor set bind time.
+
+        bool isValid() const { return (mappedPtr != nullptr); }
+    };
+
+    explicit UniformRingBuffer(const VulkanContext & vkContext);
+    ~UniformRingBuffer();
+
+    UniformRingBuffer(const UniformRingBuffer &) = delete;
+    UniformRingBuffer & operator = (const UniformRingBuffer &) = delete;
+
+    // bytesPerFrame is the sub-allocation budget of a single frame region.
+    // framesInFlight should match the swap-chain depth.
+    void initialize(int bytesPerFrame, int framesInFlight = 3);
+    void shutdown();
+    bool isInitialized() const;
+
+    // Advances to the next frame region and rewinds its cursor.
+    void beginFrame();
+
+    // Sub-allocates from the current frame's region, aligned to
+    // minUniformBufferOffsetAlignment. Asserts if the region is exhausted.
+    Allocation allocate(int sizeBytes);
+
+    // allocate() + memcpy of the payload.
+    template<typename T>
+    Allocation push(const T & payload)
+    {
+        const Allocation alloc = allocate(sizeof(T));
+        std::memcpy(alloc.mappedPtr, &payload, sizeof(T));
+        return alloc;
+    }
+
+    VkBuffer bufferHandle() const  { return m_bufferHandle; }
+    operator VkBuffer() const      { return m_bufferHandle; }
+    int bytesPerFrame() const      { return m_bytesPerFrame; }
+    int offsetAlignment() const    { return m_offsetAlignment; } // minUniformBufferOffsetAlignment.
+    const VulkanContext & context() const { return *m_vkContext; }
+
+private:
+
+    VkBuffer              m_bufferHandle  = VK_NULL_HANDLE;
+    VkDeviceMemory        m_bufferMemHandle = VK_NULL_HANDLE;
+    std::uint8_t *        m_mappedBaseAddr  = nullptr;
+    int                   m_bytesPerFrame   = 0;
+    int                   m_framesInFlight  = 0;
+    int                   m_currentFrame    = 0;
+    int                   m_frameCursor     = 0;
+    int                   m_offsetAlignment = 0;
+    const VulkanContext * m_vkContext;
+};
+
 // ========================================================
 // StagingBuffer inline methods:
 // ========================================================
@@ -363,30 +444,17 @@ inline void StagingBuffer<BufferType>::initialize(const int sizeBytes)
 template<VkBufferUsageFlags BufferType>
 inline void StagingBuffer<BufferType>::shutdown()
 {
-    const auto device   = m_vkContext->deviceHandle();
-    const auto allocCBs = m_vkContext->allocationCallbacks();
-
-    // Buffer handles:
+    // Buffers and their memory go back to the context's sub-allocator:
     if (m_bufferHandle != VK_NULL_HANDLE)
     {
-        vkDestroyBuffer(device, m_bufferHandle, allocCBs);
-        m_bufferHandle = VK_NULL_HANDLE;
-    }
-    if (m_stagingBufferHandle != VK_NULL_HANDLE)
-    {
-        vkDestroyBuffer(device, m_stagingBufferHandle, allocCBs);
-        m_stagingBufferHandle = VK_NULL_HANDLE;
-    }
-
-    // Memory:
-    if (m_bufferMemHandle != VK_NULL_HANDLE)
-    {
-        vkFreeMemory(device, m_bufferMemHandle, allocCBs);
+        m_vkContext->destroyBuffer(m_bufferHandle, m_bufferMemHandle);
+        m_bufferHandle    = VK_NULL_HANDLE;
         m_bufferMemHandle = VK_NULL_HANDLE;
     }
-    if (m_stagingBufferMemHandle != VK_NULL_HANDLE)
+    if (m_stagingBufferHandle != VK_NULL_HANDLE)
     {
-        vkFreeMemory(device, m_stagingBufferMemHandle, allocCBs);
+        m_vkContext->destroyBuffer(m_stagingBufferHandle, m_stagingBufferMemHandle);
+        m_stagingBufferHandle    = VK_NULL_HANDLE;
         m_stagingBufferMemHandle = VK_NULL_HANDLE;
     }
 }
@@ -403,6 +471,12 @@ inline void StagingBuffer<BufferType>::uploadStagingToGpu(const CommandBuffer &
     m_vkContext->copyBuffer(cmdBuff, m_stagingBufferHandle, m_bufferHandle, m_bufferSizeBytes);
 }
 
+template <VkBufferUsageFlags BufferType>
+inline void StagingBuffer<BufferType>::uploadStagingToGpuAsync() const
+{
+    m_vkContext->asyncTransferCopyBuffer(m_stagingBufferHandle, m_bufferHandle, m_bufferSizeBytes);
+}
+
 template<VkBufferUsageFlags BufferType>
 inline int StagingBuffer<BufferType>::bufferSizeBytes() const
 {
@@ -526,6 +600,89 @@ inline int MultiStructuredShaderUniformBuffer<Types...>::calcPaddedBufferSize(co
     return m_paddedElemSize * totalElementCount;
 }
 
+// ========================================================
+// UniformRingBuffer inline methods:
+// ========================================================
+
+inline UniformRingBuffer::UniformRingBuffer(const VulkanContext & vkContext)
+    : m_vkContext{ &vkContext }
+{
+    // Uninitialized.
+}
+
+inline UniformRingBuffer::~UniformRingBuffer()
+{
+    shutdown();
+}
+
+inline void UniformRingBuffer::initialize(const int bytesPerFrame, const int framesInFlight)
+{
+    assert(!isInitialized());
+    assert(bytesPerFrame > 0);
+    assert(framesInFlight > 0);
+
+    const auto & deviceProps = m_vkContext->deviceProperties();
+    m_offsetAlignment = static_cast<int>(deviceProps.limits.minUniformBufferOffsetAlignment);
+
+    m_bytesPerFrame  = roundUpToMultiple(bytesPerFrame, m_offsetAlignment);
+    m_framesInFlight = framesInFlight;
+    m_currentFrame   = 0;
+    m_frameCursor    = 0;
+
+    const int totalSizeBytes = m_bytesPerFrame * m_framesInFlight;
+    m_vkContext->createBuffer(totalSizeBytes, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                              (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
+                              &m_bufferHandle, &m_bufferMemHandle);
+
+    // Host-visible requests get a dedicated allocation from the context's
+    // sub-allocator, so mapping the whole range at offset zero is fine.
+    void * mappedPtr = nullptr;
+    VKTB_CHECK(vkMapMemory(m_vkContext->deviceHandle(), m_bufferMemHandle,
+                           0, totalSizeBytes, 0, &mappedPtr));
+    m_mappedBaseAddr = static_cast<std::uint8_t *>(mappedPtr);
+}
+
+inline void UniformRingBuffer::shutdown()
+{
+    if (m_bufferHandle != VK_NULL_HANDLE)
+    {
+        vkUnmapMemory(m_vkContext->deviceHandle(), m_bufferMemHandle);
+        m_vkContext->destroyBuffer(m_bufferHandle, m_bufferMemHandle);
+        m_bufferHandle    = VK_NULL_HANDLE;
+        m_bufferMemHandle = VK_NULL_HANDLE;
+        m_mappedBaseAddr  = nullptr;
+    }
+}
+
+inline bool UniformRingBuffer::isInitialized() const
+{
+    return (m_bufferHandle != VK_NULL_HANDLE);
+}
+
+inline void UniformRingBuffer::beginFrame()
+{
+    assert(isInitialized());
+    m_currentFrame = (m_currentFrame + 1) % m_framesInFlight;
+    m_frameCursor  = 0;
+}
+
+inline UniformRingBuffer::Allocation UniformRingBuffer::allocate(const int sizeBytes)
+{
+    assert(isInitialized());
+    assert(sizeBytes > 0);
+
+    const int alignedSize = roundUpToMultiple(sizeBytes, m_offsetAlignment);
+    assert(m_frameCursor + alignedSize <= m_bytesPerFrame && "Uniform ring frame region exhausted!");
+
+    const int offsetInBuffer = (m_currentFrame * m_bytesPerFrame) + m_frameCursor;
+    m_frameCursor += alignedSize;
+
+    Allocation alloc;
+    alloc.mappedPtr     = m_mappedBaseAddr + offsetInBuffer;
+    alloc.dynamicOffset = static_cast<std::uint32_t>(offsetInBuffer);
+    return alloc;
+}
+
 // ========================================================
 
 } // namespace VkToolbox
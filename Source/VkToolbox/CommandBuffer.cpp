@@ -99,6 +99,21 @@ void CommandBuffer::beginRecording() const
     m_stateFlags = FlagRecordingState;
 }
 
+void CommandBuffer::beginRecording(const VkCommandBufferInheritanceInfo & inheritanceInfo,
+                                   const VkCommandBufferUsageFlags usageFlags) const
+{
+    assert(!isInRecordingState());
+
+    VkCommandBufferBeginInfo cmdBufBeginInfo;
+    cmdBufBeginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    cmdBufBeginInfo.pNext            = nullptr;
+    cmdBufBeginInfo.flags            = usageFlags;
+    cmdBufBeginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    VKTB_CHECK(vkBeginCommandBuffer(m_cmdBufferHandle, &cmdBufBeginInfo));
+    m_stateFlags = FlagRecordingState;
+}
+
 void CommandBuffer::endRecording() const
 {
     assert(!isInSubmissionState() && isInRecordingState());
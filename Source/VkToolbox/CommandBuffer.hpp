@@ -68,8 +68,10 @@ public:
     bool isInitialized() const;
     void reset() const;
 
-    // Command recording.
+    // Command recording. The inheritance overload is for secondary buffers
+    // recorded inside a render pass (see VulkanContext::mainRenderPassInheritanceInfo).
     void beginRecording() const;
+    void beginRecording(const VkCommandBufferInheritanceInfo & inheritanceInfo, VkCommandBufferUsageFlags usageFlags) const;
     void endRecording() const;
 
     bool isInRecordingState()  const;
@@ -81,6 +83,14 @@ public:
     // Submit and waits on a fence. Fence sourced from the context's main fence cache.
     void submitAndWaitComplete(VkQueue queue) const;
 
+    // Update a push constant range previously declared in the pipeline layout
+    // (see PipelineStateLayout::initialize). This is the cheapest way of handing
+    // small per-draw data like transform matrices to the shaders - no uniform
+    // buffer update or descriptor set binding involved.
+    template<typename T>
+    void pushConstants(VkPipelineLayout layout, VkShaderStageFlags stageFlags,
+                       const T & data, std::uint32_t offsetInBytes = 0) const;
+
     const VulkanContext & context() const { return *m_vkContext; }
     VkCommandPool commandPoolHandle() const { return m_cmdPoolHandle; }
 
@@ -165,6 +175,20 @@ inline bool CommandBuffer::isInSubmissionState() const
     return (m_stateFlags & FlagSubmissionState) != 0;
 }
 
+template<typename T>
+inline void CommandBuffer::pushConstants(VkPipelineLayout layout, const VkShaderStageFlags stageFlags,
+                                         const T & data, const std::uint32_t offsetInBytes) const
+{
+    // 128 bytes is the minimum guaranteed VkPhysicalDeviceLimits::maxPushConstantsSize.
+    static_assert(sizeof(T) <= 128, "Push constant data over the portable size budget!");
+
+    assert(layout != VK_NULL_HANDLE);
+    assert(isInRecordingState());
+
+    vkCmdPushConstants(m_cmdBufferHandle, layout, stageFlags,
+                       offsetInBytes, sizeof(T), &data);
+}
+
 // ========================================================
 
 } // namespace VkToolbox
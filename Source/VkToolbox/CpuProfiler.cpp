@@ -0,0 +1,233 @@
+
+// ================================================================================================
+// File: VkToolbox/CpuProfiler.cpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Hierarchical CPU frame profiler with scoped zone timers.
+// ================================================================================================
+
+#include "CpuProfiler.hpp"
+#include "Log.hpp"
+#include "Utils.hpp"
+
+namespace VkToolbox
+{
+
+// ========================================================
+// class CpuProfiler:
+// ========================================================
+
+bool CpuProfiler::sm_enabled = false;
+
+CpuProfiler & CpuProfiler::shared()
+{
+    static CpuProfiler theProfiler;
+    return theProfiler;
+}
+
+CpuProfiler::ThreadState * CpuProfiler::registerThisThread()
+{
+    std::lock_guard<std::mutex> lock{ m_threadsMutex };
+
+    m_threads.emplace_back(new ThreadState{});
+    ThreadState * state = m_threads.back().get();
+    state->threadIndex = narrowCast<int>(m_threads.size() - 1);
+    return state;
+}
+
+void CpuProfiler::pushEvent(const char * const zoneName)
+{
+    static thread_local ThreadState * tlsThreadState = nullptr;
+    if (tlsThreadState == nullptr)
+    {
+        tlsThreadState = registerThisThread();
+    }
+
+    ThreadState & thread = *tlsThreadState;
+    const std::uint32_t write = thread.writeIndex.load(std::memory_order_relaxed);
+
+    if ((write - thread.readIndex.load(std::memory_order_relaxed)) >= MaxEventsPerThread)
+    {
+        // Ring is full - the main thread hasn't drained fast enough. Drop the
+        // event; drainThreadEvents() recovers from the broken pairing.
+        thread.droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Event & ev = thread.events[write % MaxEventsPerThread];
+    ev.zoneName    = zoneName;
+    ev.timestampNs = timestampNow();
+
+    thread.writeIndex.store(write + 1, std::memory_order_release);
+}
+
+int CpuProfiler::findOrAddNode(ThreadState & thread, const int parentIndex, const char * const zoneName)
+{
+    const int nodeCount = narrowCast<int>(thread.tree.size());
+    for (int n = 0; n < nodeCount; ++n)
+    {
+        // Zone names are literals, so pointer comparison is enough.
+        if (thread.tree[n].parentIndex == parentIndex && thread.tree[n].zoneName == zoneName)
+        {
+            return n;
+        }
+    }
+
+    TreeNode newNode;
+    newNode.zoneName    = zoneName;
+    newNode.parentIndex = parentIndex;
+    newNode.depth       = (parentIndex < 0) ? 0 : (thread.tree[parentIndex].depth + 1);
+    newNode.callCount   = 0;
+    newNode.inclusiveMs = 0.0;
+    newNode.childMs     = 0.0;
+
+    thread.tree.push_back(newNode);
+    return nodeCount;
+}
+
+void CpuProfiler::drainThreadEvents(ThreadState & thread)
+{
+    const std::uint32_t write = thread.writeIndex.load(std::memory_order_acquire);
+
+    for (std::uint32_t i = thread.readIndex.load(std::memory_order_relaxed); i != write; ++i)
+    {
+        const Event & ev = thread.events[i % MaxEventsPerThread];
+
+        if (ev.zoneName != nullptr) // Zone enter
+        {
+            const int nodeIndex = findOrAddNode(thread, thread.currentNodeIndex, ev.zoneName);
+            thread.openZones.push_back({ ev.timestampNs, nodeIndex });
+            thread.currentNodeIndex = nodeIndex;
+        }
+        else // Zone exit
+        {
+            if (thread.openZones.empty())
+            {
+                continue; // The matching enter was lost to a ring overflow.
+            }
+
+            const OpenZone open = thread.openZones.back();
+            thread.openZones.pop_back();
+
+            TreeNode & node = thread.tree[open.nodeIndex];
+            const double elapsedMs = static_cast<double>(ev.timestampNs - open.startNs) * 0.000001;
+
+            node.callCount   += 1;
+            node.inclusiveMs += elapsedMs;
+            if (node.parentIndex >= 0)
+            {
+                thread.tree[node.parentIndex].childMs += elapsedMs;
+            }
+
+            thread.currentNodeIndex = node.parentIndex;
+
+            if (m_capturingTrace)
+            {
+                m_traceEvents.push_back({ node.zoneName, open.startNs, ev.timestampNs, thread.threadIndex });
+            }
+        }
+    }
+
+    thread.readIndex.store(write, std::memory_order_release);
+}
+
+void CpuProfiler::endFrame()
+{
+    if (!sm_enabled)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock{ m_threadsMutex };
+    for (const auto & thread : m_threads)
+    {
+        // Stats are per frame; the tree shape persists so node
+        // indexes held by still-open zones stay valid.
+        for (TreeNode & node : thread->tree)
+        {
+            node.callCount   = 0;
+            node.inclusiveMs = 0.0;
+            node.childMs     = 0.0;
+        }
+
+        drainThreadEvents(*thread);
+    }
+}
+
+void CpuProfiler::logFrameReport() const
+{
+    std::lock_guard<std::mutex> lock{ m_threadsMutex };
+    for (const auto & thread : m_threads)
+    {
+        Log::debugF("---- CPU frame report (thread %i) ----", thread->threadIndex);
+        logTreeNodes(thread->tree, -1);
+
+        const std::uint32_t dropped = thread->droppedEvents.load(std::memory_order_relaxed);
+        if (dropped != 0)
+        {
+            Log::warningF("CPU profiler dropped %u events on thread %i - ring too small?",
+                          dropped, thread->threadIndex);
+        }
+    }
+}
+
+void CpuProfiler::logTreeNodes(const std::vector<TreeNode> & tree, const int parentIndex)
+{
+    const int nodeCount = narrowCast<int>(tree.size());
+    for (int n = 0; n < nodeCount; ++n)
+    {
+        const TreeNode & node = tree[n];
+        if (node.parentIndex != parentIndex)
+        {
+            continue;
+        }
+        if (node.callCount != 0)
+        {
+            Log::debugF("%*s%s: %i calls, %.3f ms incl, %.3f ms excl",
+                        (node.depth * 2), "", node.zoneName, node.callCount,
+                        node.inclusiveMs, (node.inclusiveMs - node.childMs));
+        }
+        logTreeNodes(tree, n);
+    }
+}
+
+void CpuProfiler::beginTraceCapture()
+{
+    m_traceEvents.clear();
+    m_traceStartNs   = timestampNow();
+    m_capturingTrace = true;
+}
+
+bool CpuProfiler::saveTraceCapture(const char * const filePath)
+{
+    assert(filePath != nullptr && filePath[0] != '\0');
+    m_capturingTrace = false;
+
+    ScopedFileHandle file = openFile(filePath, "wt");
+    if (file == nullptr)
+    {
+        Log::errorF("Unable to open trace file '%s' for writing!", filePath);
+        return false;
+    }
+
+    // chrome://tracing "complete" events - timestamps in microseconds.
+    std::fprintf(file, "{\"traceEvents\":[");
+    const char * separator = "\n";
+    for (const TraceEvent & ev : m_traceEvents)
+    {
+        std::fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%i,\"ts\":%.3f,\"dur\":%.3f}",
+                     separator, ev.zoneName, ev.threadIndex,
+                     static_cast<double>(ev.startNs - m_traceStartNs) * 0.001,
+                     static_cast<double>(ev.endNs - ev.startNs) * 0.001);
+        separator = ",\n";
+    }
+    std::fprintf(file, "\n]}\n");
+
+    Log::debugF("Saved CPU trace capture to '%s' (%zu events).", filePath, m_traceEvents.size());
+    m_traceEvents.clear();
+    return true;
+}
+
+// ========================================================
+
+} // namespace VkToolbox
@@ -0,0 +1,197 @@
+#pragma once
+
+// ================================================================================================
+// File: VkToolbox/CpuProfiler.hpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Hierarchical CPU frame profiler with scoped zone timers.
+// ================================================================================================
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace VkToolbox
+{
+
+// ========================================================
+// class CpuProfiler:
+// ========================================================
+
+// Instrumentation profiler for CPU code. Zones are declared with
+// VKTB_PROFILE_SCOPE("Name") and cost two writes into a lock-free
+// per-thread event ring - cheap enough for hot paths. The rings are
+// drained once per frame by endFrame() on the main thread, which
+// aggregates them into per-thread call trees with call counts and
+// inclusive/exclusive times. Reports go through the log, or capture
+// a stretch of frames and save it as a chrome://tracing JSON file.
+//
+// Zone names must be string literals (they are compared by pointer
+// and must outlive the frame).
+class CpuProfiler final
+{
+public:
+
+    // Per-thread event ring capacity. When a thread produces more events than
+    // the main thread drains per frame, the excess zones are dropped.
+    static constexpr int MaxEventsPerThread = 8192;
+
+    // Master switch - when false every zone is a cheap early-out.
+    static bool sm_enabled;
+
+    // Global profiler shared by all the engine subsystems.
+    static CpuProfiler & shared();
+
+    // Aggregated call-tree node for one thread. Stats cover the last frame;
+    // the tree structure itself is stable across frames.
+    struct TreeNode
+    {
+        const char * zoneName;
+        int          parentIndex; // -1 for root zones.
+        int          depth;       // Nesting level - for indented reports.
+        int          callCount;
+        double       inclusiveMs;
+        double       childMs;     // Time spent in child zones (exclusive = inclusive - child).
+    };
+
+    // ========================================================
+    // class ScopedZone:
+    // ========================================================
+
+    // RAII zone bracket - use through VKTB_PROFILE_SCOPE.
+    class ScopedZone final
+    {
+    public:
+
+        explicit ScopedZone(const char * const zoneName)
+            : m_active{ sm_enabled }
+        {
+            if (m_active)
+            {
+                shared().pushEvent(zoneName);
+            }
+        }
+
+        ~ScopedZone()
+        {
+            if (m_active)
+            {
+                shared().pushEvent(nullptr); // null name = zone exit
+            }
+        }
+
+        ScopedZone(const ScopedZone &) = delete;
+        ScopedZone & operator = (const ScopedZone &) = delete;
+
+    private:
+
+        const bool m_active; // Latched so toggling sm_enabled mid-zone can't unbalance the rings.
+    };
+
+    // Drains every thread's event ring and rebuilds the aggregated call
+    // trees. Call once per frame, from the main thread only.
+    void endFrame();
+
+    // Logs the per-thread call trees: calls, inclusive and exclusive times.
+    void logFrameReport() const;
+
+    // Chrome trace capture - every zone completed between beginTraceCapture()
+    // and saveTraceCapture() is written out as chrome://tracing JSON.
+    void beginTraceCapture();
+    bool saveTraceCapture(const char * filePath);
+
+    // Nanosecond timestamp on the profiler clock.
+    static std::int64_t timestampNow()
+    {
+        const auto now = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+    }
+
+private:
+
+    CpuProfiler() = default;
+
+    CpuProfiler(const CpuProfiler &) = delete;
+    CpuProfiler & operator = (const CpuProfiler &) = delete;
+
+    // One ring enter/exit record. zoneName == nullptr marks an exit.
+    struct Event
+    {
+        const char * zoneName;
+        std::int64_t timestampNs;
+    };
+
+    // A zone that has been entered but not yet exited.
+    struct OpenZone
+    {
+        std::int64_t startNs;
+        int          nodeIndex;
+    };
+
+    struct ThreadState
+    {
+        // Single-producer/single-consumer ring: the owning thread writes at
+        // writeIndex, endFrame() on the main thread consumes up to it. The
+        // indexes increase monotonically; modulo gives the slot.
+        std::unique_ptr<Event[]>   events{ new Event[MaxEventsPerThread] };
+        std::atomic<std::uint32_t> writeIndex{ 0 };
+        std::atomic<std::uint32_t> readIndex{ 0 };
+        std::atomic<std::uint32_t> droppedEvents{ 0 };
+        int threadIndex = 0;
+
+        // Aggregation state - only ever touched by endFrame():
+        std::vector<TreeNode> tree;
+        std::vector<OpenZone> openZones; // May carry across frames for long-running zones.
+        int currentNodeIndex = -1;
+    };
+
+    // Completed zone kept for the Chrome trace.
+    struct TraceEvent
+    {
+        const char * zoneName;
+        std::int64_t startNs;
+        std::int64_t endNs;
+        int          threadIndex;
+    };
+
+    ThreadState * registerThisThread();
+    void pushEvent(const char * zoneName);
+    void drainThreadEvents(ThreadState & thread);
+    static int findOrAddNode(ThreadState & thread, int parentIndex, const char * zoneName);
+    static void logTreeNodes(const std::vector<TreeNode> & tree, int parentIndex);
+
+    // Thread rings, appended on first use by each thread.
+    // The mutex only guards registration and the list itself.
+    std::vector<std::unique_ptr<ThreadState>> m_threads;
+    mutable std::mutex m_threadsMutex;
+
+    // Chrome trace capture state (main thread only):
+    std::vector<TraceEvent> m_traceEvents;
+    std::int64_t m_traceStartNs = 0;
+    bool m_capturingTrace = false;
+};
+
+// ========================================================
+// VKTB_PROFILE_SCOPE macro:
+// ========================================================
+
+// Set to zero to strip all CPU profiling zones from the build.
+#define VKTB_CPU_PROFILER_ENABLED 1
+
+#if VKTB_CPU_PROFILER_ENABLED
+    #define VKTB_PROFILE_CONCAT_IMPL(a, b) a ## b
+    #define VKTB_PROFILE_CONCAT(a, b) VKTB_PROFILE_CONCAT_IMPL(a, b)
+
+    // Times the enclosing scope under the given zone name (a string literal).
+    #define VKTB_PROFILE_SCOPE(zoneName) \
+        const VkToolbox::CpuProfiler::ScopedZone VKTB_PROFILE_CONCAT(vktbProfileZone_, __LINE__){ zoneName }
+#else // !VKTB_CPU_PROFILER_ENABLED
+    #define VKTB_PROFILE_SCOPE(zoneName) /* nothing */
+#endif // VKTB_CPU_PROFILER_ENABLED
+
+// ========================================================
+
+} // namespace VkToolbox
@@ -24,6 +24,10 @@ namespace VkToolbox
 //    tied to a data source (buffer), so each shader will generally have its own unique set.
 //  + DescriptorSetPool is an optimized way of allocating DescriptorSets. Sets cannot be
 //    individually freed, they are instead reclaimed when the owning pool is destroyed.
+//  + DescriptorSetCache recycles sets through per-layout free-lists so long-lived
+//    sets (e.g. per-material) don't hit the driver on every allocation.
+//  + TransientDescriptorPool serves single-frame sets and recycles them all at
+//    once with a wholesale pool reset at the start of the next frame.
 // ----------------
 
 // ========================================================
@@ -135,6 +139,94 @@ struct DescriptorSets final
     }
 };
 
+// ========================================================
+// class DescriptorSetCache:
+// ========================================================
+
+// Recycling layer on top of DescriptorSetPool. Sets are requested from the
+// driver in chunks and handed out from per-layout free-lists, so a steady-state
+// allocate() is just a pointer pop. Recycling a set pushes it back onto its
+// free-list - the driver never sees individual frees. Everything is reclaimed
+// at once when the cache is shut down.
+class DescriptorSetCache final
+{
+public:
+
+    // How many sets a free-list miss requests from the driver in one call.
+    static constexpr int AllocationChunkSize = 16;
+
+    explicit DescriptorSetCache(const VulkanContext & vkContext);
+    ~DescriptorSetCache();
+
+    DescriptorSetCache(const DescriptorSetCache &) = delete;
+    DescriptorSetCache & operator = (const DescriptorSetCache &) = delete;
+
+    // maxSets should account for the chunked allocation - round it up
+    // to a multiple of AllocationChunkSize per layout you'll use.
+    void initialize(int maxSets, array_view<const VkDescriptorPoolSize> sizesAndTypes);
+    void shutdown();
+    bool isInitialized() const;
+
+    // Pops a recycled set for the given layout, bulk-allocating a fresh
+    // chunk from the underlying pool when the free-list runs dry.
+    VkDescriptorSet allocate(VkDescriptorSetLayout layout);
+
+    // Returns a set to its layout's free-list. The set must have come from this
+    // cache and must no longer be referenced by work still in flight on the GPU.
+    void recycle(VkDescriptorSet set, VkDescriptorSetLayout layout);
+
+    const VulkanContext & context() const { return m_pool.context(); }
+
+private:
+
+    struct LayoutFreeList
+    {
+        VkDescriptorSetLayout        layout;
+        std::vector<VkDescriptorSet> freeSets;
+    };
+
+    LayoutFreeList & freeListForLayout(VkDescriptorSetLayout layout);
+
+    DescriptorSetPool           m_pool;
+    std::vector<LayoutFreeList> m_freeLists; // Few distinct layouts - linear scan is fine.
+};
+
+// ========================================================
+// class TransientDescriptorPool:
+// ========================================================
+
+// Pool for descriptor sets that only live for a single frame. beginFrame()
+// recycles every set handed out since the last call with one wholesale
+// vkResetDescriptorPool, which is far cheaper than freeing sets one by one.
+// Keep one instance per in-flight frame so a reset never races the GPU.
+class TransientDescriptorPool final
+{
+public:
+
+    explicit TransientDescriptorPool(const VulkanContext & vkContext);
+    ~TransientDescriptorPool();
+
+    TransientDescriptorPool(const TransientDescriptorPool &) = delete;
+    TransientDescriptorPool & operator = (const TransientDescriptorPool &) = delete;
+
+    void initialize(int maxSets, array_view<const VkDescriptorPoolSize> sizesAndTypes);
+    void shutdown();
+    bool isInitialized() const;
+
+    // Resets the whole pool, invalidating every set allocated for the previous frame.
+    void beginFrame();
+
+    VkDescriptorSet allocate(VkDescriptorSetLayout layout);
+
+    const VulkanContext & context() const { return m_pool.context(); }
+
+private:
+
+    DescriptorSetPool m_pool;
+    int m_maxSets       = 0;
+    int m_setsAllocated = 0;
+};
+
 // ========================================================
 // DescriptorSetPool inline methods:
 // ========================================================
@@ -246,6 +338,153 @@ inline bool DescriptorSetLayout::isInitialized() const
     return (m_descriptorSetLayoutHandle != VK_NULL_HANDLE);
 }
 
+// ========================================================
+// DescriptorSetCache inline methods:
+// ========================================================
+
+inline DescriptorSetCache::DescriptorSetCache(const VulkanContext & vkContext)
+    : m_pool{ vkContext }
+{
+    // Uninitialized.
+}
+
+inline DescriptorSetCache::~DescriptorSetCache()
+{
+    shutdown();
+}
+
+inline void DescriptorSetCache::initialize(const int maxSets, array_view<const VkDescriptorPoolSize> sizesAndTypes)
+{
+    assert(!isInitialized());
+    m_pool.initialize(maxSets, sizesAndTypes);
+}
+
+inline void DescriptorSetCache::shutdown()
+{
+    m_freeLists.clear();
+    m_pool.shutdown(); // Reclaims every set at once.
+}
+
+inline bool DescriptorSetCache::isInitialized() const
+{
+    return m_pool.isInitialized();
+}
+
+inline DescriptorSetCache::LayoutFreeList & DescriptorSetCache::freeListForLayout(const VkDescriptorSetLayout layout)
+{
+    for (LayoutFreeList & freeList : m_freeLists)
+    {
+        if (freeList.layout == layout)
+        {
+            return freeList;
+        }
+    }
+
+    m_freeLists.push_back({ layout, {} });
+    return m_freeLists.back();
+}
+
+inline VkDescriptorSet DescriptorSetCache::allocate(const VkDescriptorSetLayout layout)
+{
+    assert(isInitialized());
+    assert(layout != VK_NULL_HANDLE);
+
+    LayoutFreeList & freeList = freeListForLayout(layout);
+    if (freeList.freeSets.empty())
+    {
+        VkDescriptorSetLayout layouts[AllocationChunkSize];
+        for (VkDescriptorSetLayout & l : layouts)
+        {
+            l = layout;
+        }
+
+        VkDescriptorSetAllocateInfo allocInfo;
+        allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.pNext              = nullptr;
+        allocInfo.descriptorPool     = m_pool.descriptorPoolHandle();
+        allocInfo.descriptorSetCount = AllocationChunkSize;
+        allocInfo.pSetLayouts        = layouts;
+
+        VkDescriptorSet newSets[AllocationChunkSize];
+        VKTB_CHECK(vkAllocateDescriptorSets(context().deviceHandle(), &allocInfo, newSets));
+
+        freeList.freeSets.insert(freeList.freeSets.end(), newSets, newSets + AllocationChunkSize);
+    }
+
+    const VkDescriptorSet set = freeList.freeSets.back();
+    freeList.freeSets.pop_back();
+    return set;
+}
+
+inline void DescriptorSetCache::recycle(const VkDescriptorSet set, const VkDescriptorSetLayout layout)
+{
+    assert(isInitialized());
+    assert(set != VK_NULL_HANDLE);
+
+    freeListForLayout(layout).freeSets.push_back(set);
+}
+
+// ========================================================
+// TransientDescriptorPool inline methods:
+// ========================================================
+
+inline TransientDescriptorPool::TransientDescriptorPool(const VulkanContext & vkContext)
+    : m_pool{ vkContext }
+{
+    // Uninitialized.
+}
+
+inline TransientDescriptorPool::~TransientDescriptorPool()
+{
+    shutdown();
+}
+
+inline void TransientDescriptorPool::initialize(const int maxSets, array_view<const VkDescriptorPoolSize> sizesAndTypes)
+{
+    assert(!isInitialized());
+    m_pool.initialize(maxSets, sizesAndTypes);
+    m_maxSets = maxSets;
+}
+
+inline void TransientDescriptorPool::shutdown()
+{
+    m_pool.shutdown();
+    m_maxSets       = 0;
+    m_setsAllocated = 0;
+}
+
+inline bool TransientDescriptorPool::isInitialized() const
+{
+    return m_pool.isInitialized();
+}
+
+inline void TransientDescriptorPool::beginFrame()
+{
+    assert(isInitialized());
+    m_pool.reset();
+    m_setsAllocated = 0;
+}
+
+inline VkDescriptorSet TransientDescriptorPool::allocate(const VkDescriptorSetLayout layout)
+{
+    assert(isInitialized());
+    assert(layout != VK_NULL_HANDLE);
+    assert(m_setsAllocated < m_maxSets && "Transient pool exhausted - raise maxSets!");
+
+    VkDescriptorSetAllocateInfo allocInfo;
+    allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.pNext              = nullptr;
+    allocInfo.descriptorPool     = m_pool.descriptorPoolHandle();
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts        = &layout;
+
+    VkDescriptorSet set = VK_NULL_HANDLE;
+    VKTB_CHECK(vkAllocateDescriptorSets(context().deviceHandle(), &allocInfo, &set));
+
+    ++m_setsAllocated;
+    return set;
+}
+
 // ========================================================
 
 } // namespace VkToolbox
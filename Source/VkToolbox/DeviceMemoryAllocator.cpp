@@ -0,0 +1,324 @@
+
+// ================================================================================================
+// File: VkToolbox/DeviceMemoryAllocator.cpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Block-based sub-allocator for VkDeviceMemory.
+// ================================================================================================
+
+#include "DeviceMemoryAllocator.hpp"
+#include "VulkanContext.hpp"
+
+#include <algorithm>
+
+namespace VkToolbox
+{
+
+// ========================================================
+// class DeviceMemoryAllocator:
+// ========================================================
+
+DeviceMemoryAllocator::DeviceMemoryAllocator(const VulkanContext & vkContext)
+    : m_vkContext{ &vkContext }
+{
+}
+
+DeviceMemoryAllocator::~DeviceMemoryAllocator()
+{
+    shutdown();
+}
+
+void DeviceMemoryAllocator::shutdown()
+{
+    const auto device   = m_vkContext->deviceHandle();
+    const auto allocCBs = m_vkContext->allocationCallbacks();
+
+    for (MemoryPool & pool : m_pools)
+    {
+        for (MemorySlab & slab : pool.slabs)
+        {
+            assert(slab.liveAllocCount == 0 && "Slab still has live sub-allocations!");
+            vkFreeMemory(device, slab.memory, allocCBs);
+        }
+    }
+    m_pools.clear();
+
+    for (DedicatedAlloc & dedicated : m_dedicatedAllocs)
+    {
+        vkFreeMemory(device, dedicated.memory, allocCBs);
+    }
+    m_dedicatedAllocs.clear();
+}
+
+VkDeviceMemory DeviceMemoryAllocator::newDeviceMemory(const VkDeviceSize sizeBytes,
+                                                      const std::uint32_t memoryTypeIndex) const
+{
+    VkMemoryAllocateInfo allocInfo;
+    allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.pNext           = nullptr;
+    allocInfo.allocationSize  = sizeBytes;
+    allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VKTB_CHECK(vkAllocateMemory(m_vkContext->deviceHandle(), &allocInfo,
+                                m_vkContext->allocationCallbacks(), &memory));
+    return memory;
+}
+
+DeviceMemoryAllocator::MemoryPool & DeviceMemoryAllocator::findOrCreatePool(const std::uint32_t memoryTypeIndex,
+                                                                            const ResourceUsage usage)
+{
+    for (MemoryPool & pool : m_pools)
+    {
+        if (pool.memoryTypeIndex == memoryTypeIndex && pool.usage == usage)
+        {
+            return pool;
+        }
+    }
+
+    MemoryPool newPool;
+    newPool.memoryTypeIndex = memoryTypeIndex;
+    newPool.usage           = usage;
+    m_pools.emplace_back(std::move(newPool));
+    return m_pools.back();
+}
+
+bool DeviceMemoryAllocator::allocFromSlab(MemorySlab & slab, const VkDeviceSize size,
+                                          const VkDeviceSize alignment, Allocation * outAlloc)
+{
+    // First fit over the sorted free ranges:
+    for (std::size_t r = 0; r < slab.freeRanges.size(); ++r)
+    {
+        MemoryRange & range = slab.freeRanges[r];
+
+        const VkDeviceSize alignedOffset = (range.offset + (alignment - 1)) & ~(alignment - 1);
+        const VkDeviceSize padding       = alignedOffset - range.offset;
+
+        if (padding + size > range.size)
+        {
+            continue;
+        }
+
+        outAlloc->memory = slab.memory;
+        outAlloc->offset = alignedOffset;
+        outAlloc->size   = size;
+
+        // Shrink/split the range. Alignment padding at the front is given back as
+        // a small leading free range so it can be merged again on free.
+        const VkDeviceSize tailOffset = alignedOffset + size;
+        const VkDeviceSize tailSize   = (range.offset + range.size) - tailOffset;
+
+        if (padding != 0)
+        {
+            range.size = padding;
+            if (tailSize != 0)
+            {
+                const MemoryRange tail = { tailOffset, tailSize };
+                slab.freeRanges.insert(slab.freeRanges.begin() + r + 1, tail);
+            }
+        }
+        else if (tailSize != 0)
+        {
+            range.offset = tailOffset;
+            range.size   = tailSize;
+        }
+        else
+        {
+            slab.freeRanges.erase(slab.freeRanges.begin() + r);
+        }
+
+        slab.usedBytes += size;
+        slab.liveAllocCount++;
+        return true;
+    }
+
+    return false;
+}
+
+DeviceMemoryAllocator::Allocation DeviceMemoryAllocator::allocate(const VkMemoryRequirements & memReqs,
+                                                                  const VkMemoryPropertyFlags memoryProperties,
+                                                                  const ResourceUsage usage)
+{
+    assert(memReqs.size != 0);
+    assert(isPowerOfTwo(memReqs.alignment));
+
+    const std::uint32_t memoryTypeIndex = m_vkContext->memoryTypeFromProperties(memReqs.memoryTypeBits, memoryProperties);
+    assert(memoryTypeIndex < UINT32_MAX && "Requested memory type not supported!");
+
+    // Resources get created by the parallel load threads as well as the main thread.
+    std::lock_guard<std::mutex> lock{ m_mutex };
+
+    // Host-visible memory might get mapped by the caller, which assumes offset zero,
+    // and oversized requests would fragment the slabs - both get dedicated memory.
+    if ((memoryProperties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0 ||
+        memReqs.size > DedicatedAllocThreshold)
+    {
+        return allocateDedicated(memReqs.size, memoryTypeIndex);
+    }
+
+    MemoryPool & pool = findOrCreatePool(memoryTypeIndex, usage);
+
+    Allocation alloc;
+    for (MemorySlab & slab : pool.slabs)
+    {
+        if (allocFromSlab(slab, memReqs.size, memReqs.alignment, &alloc))
+        {
+            return alloc;
+        }
+    }
+
+    // No slab could fit the request - allocate a fresh one:
+    MemorySlab newSlab;
+    newSlab.memory         = newDeviceMemory(DefaultSlabSize, memoryTypeIndex);
+    newSlab.size           = DefaultSlabSize;
+    newSlab.usedBytes      = 0;
+    newSlab.liveAllocCount = 0;
+    newSlab.freeRanges.push_back({ 0, DefaultSlabSize });
+    pool.slabs.emplace_back(std::move(newSlab));
+
+    Log::debugF("DeviceMemoryAllocator: New %zu MB slab for memory type %u (pool now has %zu slabs).",
+                std::size_t(DefaultSlabSize / (1024 * 1024)), memoryTypeIndex, pool.slabs.size());
+
+    const bool ok = allocFromSlab(pool.slabs.back(), memReqs.size, memReqs.alignment, &alloc);
+    assert(ok); (void)ok;
+    return alloc;
+}
+
+DeviceMemoryAllocator::Allocation DeviceMemoryAllocator::allocateDedicated(const VkDeviceSize sizeBytes,
+                                                                           const std::uint32_t memoryTypeIndex)
+{
+    Allocation alloc;
+    alloc.memory = newDeviceMemory(sizeBytes, memoryTypeIndex);
+    alloc.offset = 0;
+    alloc.size   = sizeBytes;
+
+    m_dedicatedAllocs.push_back({ alloc.memory, sizeBytes });
+    return alloc;
+}
+
+bool DeviceMemoryAllocator::freeDedicated(const Allocation & alloc)
+{
+    for (std::size_t i = 0; i < m_dedicatedAllocs.size(); ++i)
+    {
+        if (m_dedicatedAllocs[i].memory == alloc.memory)
+        {
+            vkFreeMemory(m_vkContext->deviceHandle(), alloc.memory, m_vkContext->allocationCallbacks());
+            m_dedicatedAllocs.erase(m_dedicatedAllocs.begin() + i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void DeviceMemoryAllocator::free(const Allocation & alloc)
+{
+    if (alloc.memory == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock{ m_mutex };
+
+    // Dedicated allocations are the common case for host-visible memory, check first:
+    if (freeDedicated(alloc))
+    {
+        return;
+    }
+
+    for (MemoryPool & pool : m_pools)
+    {
+        for (MemorySlab & slab : pool.slabs)
+        {
+            if (slab.memory != alloc.memory)
+            {
+                continue;
+            }
+
+            // Insert back in offset order, merging with the neighboring ranges when adjacent:
+            auto insertPos = std::lower_bound(slab.freeRanges.begin(), slab.freeRanges.end(), alloc.offset,
+                                              [](const MemoryRange & range, const VkDeviceSize offset) {
+                                                  return range.offset < offset;
+                                              });
+
+            MemoryRange freed = { alloc.offset, alloc.size };
+            if (insertPos != slab.freeRanges.begin())
+            {
+                MemoryRange & prev = *(insertPos - 1);
+                if (prev.offset + prev.size == freed.offset)
+                {
+                    freed.offset = prev.offset;
+                    freed.size  += prev.size;
+                    insertPos = slab.freeRanges.erase(insertPos - 1);
+                }
+            }
+            if (insertPos != slab.freeRanges.end())
+            {
+                MemoryRange & next = *insertPos;
+                if (freed.offset + freed.size == next.offset)
+                {
+                    freed.size += next.size;
+                    insertPos = slab.freeRanges.erase(insertPos);
+                }
+            }
+            slab.freeRanges.insert(insertPos, freed);
+
+            slab.usedBytes -= alloc.size;
+            slab.liveAllocCount--;
+            assert(slab.liveAllocCount >= 0);
+            return;
+        }
+    }
+
+    assert(false && "Allocation does not belong to this allocator!");
+}
+
+DeviceMemoryAllocator::Stats DeviceMemoryAllocator::queryStats() const
+{
+    Stats stats;
+    std::lock_guard<std::mutex> lock{ m_mutex };
+
+    for (const MemoryPool & pool : m_pools)
+    {
+        for (const MemorySlab & slab : pool.slabs)
+        {
+            stats.slabCount++;
+            stats.subAllocCount     += slab.liveAllocCount;
+            stats.slabReservedBytes += slab.size;
+            stats.slabUsedBytes     += slab.usedBytes;
+            stats.freeRangeCount    += narrowCast<int>(slab.freeRanges.size());
+
+            for (const MemoryRange & range : slab.freeRanges)
+            {
+                if (range.size > stats.largestFreeRange)
+                {
+                    stats.largestFreeRange = range.size;
+                }
+            }
+        }
+    }
+
+    stats.dedicatedCount = narrowCast<int>(m_dedicatedAllocs.size());
+    for (const DedicatedAlloc & dedicated : m_dedicatedAllocs)
+    {
+        stats.dedicatedBytes += dedicated.size;
+    }
+
+    return stats;
+}
+
+void DeviceMemoryAllocator::logStats() const
+{
+    const Stats stats = queryStats();
+
+    Log::debugF("------ DeviceMemoryAllocator stats ------");
+    Log::debugF("Slabs:             %i (%zu KB reserved, %zu KB used)", stats.slabCount,
+                std::size_t(stats.slabReservedBytes / 1024), std::size_t(stats.slabUsedBytes / 1024));
+    Log::debugF("Sub-allocations:   %i", stats.subAllocCount);
+    Log::debugF("Dedicated allocs:  %i (%zu KB)", stats.dedicatedCount, std::size_t(stats.dedicatedBytes / 1024));
+    Log::debugF("Free ranges:       %i (largest %zu KB)", stats.freeRangeCount, std::size_t(stats.largestFreeRange / 1024));
+    Log::debugF("-----------------------------------------");
+}
+
+// ========================================================
+
+} // namespace VkToolbox
@@ -0,0 +1,140 @@
+#pragma once
+
+// ================================================================================================
+// File: VkToolbox/DeviceMemoryAllocator.hpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Block-based sub-allocator for VkDeviceMemory.
+// ================================================================================================
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <mutex>
+
+#include "Log.hpp"
+#include "Utils.hpp"
+
+namespace VkToolbox
+{
+
+class VulkanContext;
+
+// ========================================================
+// class DeviceMemoryAllocator:
+// ========================================================
+
+// Sub-allocates device memory from large VkDeviceMemory slabs, so each buffer/image
+// doesn't pay for its own vkAllocateMemory call. Drivers impose a fairly low limit
+// on the total number of allocations (maxMemoryAllocationCount, commonly 4096),
+// which larger scenes like Sponza can easily exceed if every resource allocates.
+//
+// Slabs are kept in separate pools per memory type and per resource usage (buffers
+// and images never share a slab, which sidesteps bufferImageGranularity issues).
+// Host-visible memory that the caller might map is always given a dedicated
+// allocation, so mapping offsets remain zero for the existing buffer helpers.
+class DeviceMemoryAllocator final
+{
+public:
+
+    // Resource kind of the allocation - pools are split by this.
+    enum ResourceUsage
+    {
+        BufferResource,
+        ImageResource
+    };
+
+    // Handle to a sub-allocated (or dedicated) memory range.
+    struct Allocation
+    {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize   offset = 0;
+        VkDeviceSize   size   = 0;
+    };
+
+    // Occupancy/fragmentation counters for debug printing.
+    struct Stats
+    {
+        int          slabCount          = 0; // Number of live VkDeviceMemory slabs.
+        int          dedicatedCount     = 0; // Number of live dedicated allocations.
+        int          subAllocCount      = 0; // Number of live sub-allocations within the slabs.
+        int          freeRangeCount     = 0; // Total free ranges across all slabs (fragmentation measure).
+        VkDeviceSize slabReservedBytes  = 0; // Total bytes reserved by the slabs.
+        VkDeviceSize slabUsedBytes      = 0; // Bytes of the slabs actually in use.
+        VkDeviceSize dedicatedBytes     = 0; // Bytes held by dedicated allocations.
+        VkDeviceSize largestFreeRange   = 0; // Biggest single free range available in any slab.
+    };
+
+    // Slabs are allocated on demand with this size. Anything bigger than
+    // DedicatedAllocThreshold gets its own dedicated VkDeviceMemory instead.
+    static constexpr VkDeviceSize DefaultSlabSize         = 64 * 1024 * 1024;
+    static constexpr VkDeviceSize DedicatedAllocThreshold = DefaultSlabSize / 4;
+
+    explicit DeviceMemoryAllocator(const VulkanContext & vkContext);
+    ~DeviceMemoryAllocator();
+
+    // Not copyable.
+    DeviceMemoryAllocator(const DeviceMemoryAllocator &) = delete;
+    DeviceMemoryAllocator & operator = (const DeviceMemoryAllocator &) = delete;
+
+    // Frees all the slabs. Every sub-allocation must have been freed already.
+    void shutdown();
+
+    // Grab a memory range suitable for the given requirements. Never fails -
+    // aborts with a fatal error if the device is truly out of memory.
+    Allocation allocate(const VkMemoryRequirements & memReqs,
+                        VkMemoryPropertyFlags memoryProperties,
+                        ResourceUsage usage);
+
+    // Return a range previously acquired from allocate().
+    void free(const Allocation & alloc);
+
+    // Stats query and debug printing:
+    Stats queryStats() const;
+    void logStats() const;
+
+private:
+
+    struct MemoryRange
+    {
+        VkDeviceSize offset;
+        VkDeviceSize size;
+    };
+
+    struct MemorySlab
+    {
+        VkDeviceMemory           memory;
+        VkDeviceSize             size;
+        VkDeviceSize             usedBytes;
+        int                      liveAllocCount;
+        std::vector<MemoryRange> freeRanges; // Sorted by offset; adjacent ranges are merged on free.
+    };
+
+    struct MemoryPool
+    {
+        std::uint32_t           memoryTypeIndex;
+        ResourceUsage           usage;
+        std::vector<MemorySlab> slabs;
+    };
+
+    struct DedicatedAlloc
+    {
+        VkDeviceMemory memory;
+        VkDeviceSize   size;
+    };
+
+    VkDeviceMemory newDeviceMemory(VkDeviceSize sizeBytes, std::uint32_t memoryTypeIndex) const;
+    MemoryPool & findOrCreatePool(std::uint32_t memoryTypeIndex, ResourceUsage usage);
+    bool allocFromSlab(MemorySlab & slab, VkDeviceSize size, VkDeviceSize alignment, Allocation * outAlloc);
+
+    Allocation allocateDedicated(VkDeviceSize sizeBytes, std::uint32_t memoryTypeIndex);
+    bool freeDedicated(const Allocation & alloc);
+
+    const VulkanContext *       m_vkContext;
+    std::vector<MemoryPool>     m_pools;
+    std::vector<DedicatedAlloc> m_dedicatedAllocs;
+    mutable std::mutex          m_mutex; // allocate/free can be called from the resource load threads.
+};
+
+// ========================================================
+
+} // namespace VkToolbox
@@ -0,0 +1,194 @@
+
+// ================================================================================================
+// File: VkToolbox/FileWatcher.cpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Polls watched asset files and triggers targeted hot-reloads for the ones that changed.
+// ================================================================================================
+
+#include "FileWatcher.hpp"
+#include "Utils.hpp"
+#include "Log.hpp"
+
+#include <chrono>
+#include <cstring>
+
+#if defined(WIN32) || defined(WIN64)
+    #define NOMINMAX 1
+    #define WIN32_LEAN_AND_MEAN 1
+    #include <Windows.h>
+#else // !WIN32 && !WIN64
+    #include <sys/stat.h>
+#endif // WIN32 || WIN64
+
+namespace VkToolbox
+{
+
+// ========================================================
+// class FileWatcher:
+// ========================================================
+
+FileWatcher & FileWatcher::shared()
+{
+    static FileWatcher s_instance;
+    return s_instance;
+}
+
+std::int64_t FileWatcher::queryFileWriteTime(const char * const filePath)
+{
+    assert(filePath != nullptr);
+
+#if defined(WIN32) || defined(WIN64)
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesExA(filePath, GetFileExInfoStandard, &attributes))
+    {
+        return 0;
+    }
+
+    ULARGE_INTEGER writeTime;
+    writeTime.LowPart  = attributes.ftLastWriteTime.dwLowDateTime;
+    writeTime.HighPart = attributes.ftLastWriteTime.dwHighDateTime;
+    return static_cast<std::int64_t>(writeTime.QuadPart);
+#else // !WIN32 && !WIN64
+    struct stat fileStats;
+    if (stat(filePath, &fileStats) != 0)
+    {
+        return 0;
+    }
+    return static_cast<std::int64_t>(fileStats.st_mtime);
+#endif // WIN32 || WIN64
+}
+
+FileWatcher::WatchEntry * FileWatcher::findEntry(const Hash64 pathHash)
+{
+    for (WatchEntry & entry : m_entries)
+    {
+        if (entry.pathHash == pathHash)
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+FileWatcher::WatchEntry & FileWatcher::findOrAddEntry(const char * const filePath)
+{
+    const Hash64 pathHash{ filePath, std::strlen(filePath) };
+
+    if (WatchEntry * existing = findEntry(pathHash))
+    {
+        return *existing;
+    }
+
+    WatchEntry entry;
+    entry.filePath      = filePath;
+    entry.pathHash      = pathHash;
+    entry.lastWriteTime = queryFileWriteTime(filePath); // Registering never fires the callback.
+    m_entries.push_back(std::move(entry));
+
+    return m_entries.back();
+}
+
+void FileWatcher::watchFile(const char * const filePath, ChangedCallback onChanged)
+{
+    assert(filePath != nullptr);
+    assert(filePath[0] != '\0');
+
+    std::lock_guard<std::mutex> lock{ m_mutex };
+
+    WatchEntry & entry = findOrAddEntry(filePath);
+    entry.onChanged = std::move(onChanged);
+}
+
+void FileWatcher::addDependency(const char * const dependencyFilePath, const char * const dependentFilePath)
+{
+    assert(dependencyFilePath != nullptr);
+    assert(dependentFilePath  != nullptr);
+
+    const Hash64 dependentHash{ dependentFilePath, std::strlen(dependentFilePath) };
+
+    std::lock_guard<std::mutex> lock{ m_mutex };
+
+    WatchEntry & entry = findOrAddEntry(dependencyFilePath);
+    for (const Hash64 & existing : entry.dependents)
+    {
+        if (existing == dependentHash)
+        {
+            return; // Edge already recorded.
+        }
+    }
+    entry.dependents.push_back(dependentHash);
+}
+
+void FileWatcher::collectCallbacks(const WatchEntry & entry, std::vector<ChangedCallback> * outCallbacks)
+{
+    if (entry.onChanged != nullptr)
+    {
+        outCallbacks->push_back(entry.onChanged);
+    }
+
+    // Includes are always attributed to the root file being compiled, so
+    // one level of fan-out is enough - no transitive walk needed.
+    for (const Hash64 & dependentHash : entry.dependents)
+    {
+        const WatchEntry * dependent = findEntry(dependentHash);
+        if (dependent != nullptr && dependent->onChanged != nullptr)
+        {
+            outCallbacks->push_back(dependent->onChanged);
+        }
+    }
+}
+
+void FileWatcher::poll()
+{
+    const auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    std::vector<ChangedCallback> firedCallbacks;
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+
+        if (m_entries.empty() || (nowMs - m_lastPollTimeMs) < PollIntervalMs)
+        {
+            return;
+        }
+        m_lastPollTimeMs = nowMs;
+
+        const int entryCount = narrowCast<int>(m_entries.size());
+        const int statCount  = (entryCount < MaxFileStatsPerPoll ? entryCount : MaxFileStatsPerPoll);
+
+        for (int i = 0; i < statCount; ++i)
+        {
+            WatchEntry & entry = m_entries[m_nextPollIndex];
+            m_nextPollIndex = (m_nextPollIndex + 1) % entryCount;
+
+            const std::int64_t writeTime = queryFileWriteTime(entry.filePath.c_str());
+            if (writeTime == 0 || writeTime == entry.lastWriteTime)
+            {
+                continue;
+            }
+            entry.lastWriteTime = writeTime;
+
+            Log::debugF("FileWatcher: '%s' changed on disk.", entry.filePath.c_str());
+            collectCallbacks(entry, &firedCallbacks);
+        }
+    }
+
+    // Run outside the lock - a reload callback may re-enter the watcher
+    // (the shader compiler re-records #include dependencies, for one).
+    for (ChangedCallback & callback : firedCallbacks)
+    {
+        callback();
+    }
+}
+
+void FileWatcher::clear()
+{
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    m_entries.clear();
+    m_nextPollIndex = 0;
+}
+
+// ========================================================
+
+} // namespace VkToolbox
@@ -0,0 +1,106 @@
+#pragma once
+
+// ================================================================================================
+// File: VkToolbox/FileWatcher.hpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Polls watched asset files and triggers targeted hot-reloads for the ones that changed.
+// ================================================================================================
+
+#include "External.hpp"
+#include "Hashing.hpp"
+#include "InPlaceFunction.hpp"
+
+#include <mutex>
+#include <vector>
+
+namespace VkToolbox
+{
+
+// ========================================================
+// class FileWatcher:
+// ========================================================
+
+// Maps files changed on disk to reload actions, so a one-line GLSL edit
+// refreshes just that shader instead of paying for a reloadAll() sweep of
+// every registered resource. Watches are polled (write-timestamp checks),
+// not event-driven - poll() rate-limits itself and bounds the number of
+// file queries per call, so calling it every frame costs a handful of
+// stats at most. A file can also be registered as a dependency of a
+// watched file (shader #includes are recorded this way by the GLSL
+// compiler), in which case a change to the dependency fires the watchers
+// of every file that embeds it.
+class FileWatcher final
+{
+public:
+
+    using ChangedCallback = InPlaceFunction32<void()>;
+
+    // Global watcher shared by the whole engine.
+    static FileWatcher & shared();
+
+    // Watch a file; onChanged runs from poll() whenever its on-disk write
+    // time changes. Watching an already watched path replaces the callback.
+    void watchFile(const char * filePath, ChangedCallback onChanged);
+
+    // Record that dependencyFilePath is baked into dependentFilePath
+    // (e.g. a #included GLSL header) - a change to the dependency fires
+    // the dependent's watch callback. Safe to call from the load workers.
+    void addDependency(const char * dependencyFilePath, const char * dependentFilePath);
+
+    // Scan a batch of the watched files and fire the callbacks of the
+    // changed ones. Call once per frame - it early-outs between scans.
+    void poll();
+
+    // Drop every watch entry and dependency edge.
+    void clear();
+
+    // Hook a resource manager slot to the watcher: when the backing file
+    // changes, a targeted pushAsyncLoadRequest() for just that slot is
+    // issued. The usual begin/endResourceLoad bracketing rules still apply
+    // to whoever pumps poll() - textures in particular must only be polled
+    // while the staging command buffer is in the recording state.
+    template<typename Manager>
+    static void watchResourceFile(const typename Manager::ResourceIndex resIndex)
+    {
+        shared().watchFile(Manager::resourceRef(resIndex).resourceId().c_str(),
+                           [resIndex]() { Manager::pushAsyncLoadRequest(resIndex); });
+    }
+
+private:
+
+    FileWatcher() = default;
+
+    FileWatcher(const FileWatcher &) = delete;
+    FileWatcher & operator = (const FileWatcher &) = delete;
+
+    struct WatchEntry
+    {
+        str512              filePath;
+        Hash64              pathHash;
+        std::int64_t        lastWriteTime;
+        ChangedCallback     onChanged;  // Null for pure dependency entries.
+        std::vector<Hash64> dependents; // Watched files that embed this one.
+    };
+
+    WatchEntry * findEntry(Hash64 pathHash);
+    WatchEntry & findOrAddEntry(const char * filePath);
+    void collectCallbacks(const WatchEntry & entry, std::vector<ChangedCallback> * outCallbacks);
+
+    // Current on-disk write timestamp; zero if the file can't be queried.
+    static std::int64_t queryFileWriteTime(const char * filePath);
+
+    // Full scans happen at most this often, MaxFileStatsPerPoll files at
+    // a time round-robin, so large watch lists never hitch a frame.
+    static constexpr std::int64_t PollIntervalMs = 500;
+    static constexpr int MaxFileStatsPerPoll = 16;
+
+    std::vector<WatchEntry> m_entries;
+    int                     m_nextPollIndex  = 0;
+    std::int64_t            m_lastPollTimeMs = 0;
+    std::mutex              m_mutex;
+};
+
+// ========================================================
+
+} // namespace VkToolbox
@@ -0,0 +1,147 @@
+
+// ================================================================================================
+// File: VkToolbox/FrameStats.cpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Frame pacing and latency statistics (acquire/fence/submit/present timings).
+// ================================================================================================
+
+#include "FrameStats.hpp"
+#include "Log.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace VkToolbox
+{
+
+// ========================================================
+// class FrameStats:
+// ========================================================
+
+bool FrameStats::sm_enabled = true;
+
+FrameStats & FrameStats::shared()
+{
+    static FrameStats s_instance;
+    return s_instance;
+}
+
+const char * FrameStats::metricName(const Metric metric)
+{
+    switch (metric)
+    {
+    case AcquireWait : return "AcquireWait";
+    case FenceWait   : return "FenceWait";
+    case QueueSubmit : return "QueueSubmit";
+    case Present     : return "Present";
+    case FrameTotal  : return "FrameTotal";
+    default          : return "Unknown";
+    }
+}
+
+void FrameStats::addSample(const Metric metric, const double milliseconds)
+{
+    assert(metric >= 0 && metric < MetricCount);
+
+    std::lock_guard<std::mutex> lock{ m_mutex };
+
+    MetricWindow & window = m_metrics[metric];
+    window.samples[window.nextSample] = milliseconds;
+    window.nextSample = (window.nextSample + 1) % WindowSize;
+
+    if (window.sampleCount < WindowSize)
+    {
+        ++window.sampleCount;
+    }
+    if (milliseconds > window.worstMs)
+    {
+        window.worstMs = milliseconds;
+    }
+}
+
+void FrameStats::frameMark()
+{
+    if (!sm_enabled)
+    {
+        return;
+    }
+
+    const std::int64_t now = timestampNow();
+    if (m_lastFrameMarkNs != 0)
+    {
+        addSample(FrameTotal, (now - m_lastFrameMarkNs) * (1.0 / 1000000.0));
+    }
+    m_lastFrameMarkNs = now;
+}
+
+FrameStats::MetricSummary FrameStats::summaryFor(const Metric metric) const
+{
+    assert(metric >= 0 && metric < MetricCount);
+
+    double sorted[WindowSize];
+    MetricSummary summary;
+
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+
+        const MetricWindow & window = m_metrics[metric];
+        summary.sampleCount = window.sampleCount;
+        summary.worstMs     = window.worstMs;
+
+        if (window.sampleCount == 0)
+        {
+            return summary;
+        }
+
+        std::copy(window.samples, window.samples + window.sampleCount, sorted);
+    }
+
+    std::sort(sorted, sorted + summary.sampleCount);
+
+    double total = 0.0;
+    for (int s = 0; s < summary.sampleCount; ++s)
+    {
+        total += sorted[s];
+    }
+
+    const auto percentile = [&sorted, &summary](const double p)
+    {
+        const int index = static_cast<int>((summary.sampleCount - 1) * (p / 100.0));
+        return sorted[index];
+    };
+
+    summary.p50Ms     = percentile(50.0);
+    summary.p95Ms     = percentile(95.0);
+    summary.p99Ms     = percentile(99.0);
+    summary.averageMs = total / summary.sampleCount;
+
+    return summary;
+}
+
+void FrameStats::logReport() const
+{
+    Log::debugF("------------- Frame pacing statistics (last %i frames) -------------", WindowSize);
+    Log::debugF("%-12s %9s %9s %9s %9s %9s %8s", "Metric", "p50", "p95", "p99", "avg", "worst", "samples");
+
+    for (int m = 0; m < MetricCount; ++m)
+    {
+        const Metric metric = static_cast<Metric>(m);
+        const MetricSummary summary = summaryFor(metric);
+
+        if (summary.sampleCount == 0)
+        {
+            continue;
+        }
+
+        Log::debugF("%-12s %7.3fms %7.3fms %7.3fms %7.3fms %7.3fms %8i",
+                    metricName(metric), summary.p50Ms, summary.p95Ms, summary.p99Ms,
+                    summary.averageMs, summary.worstMs, summary.sampleCount);
+    }
+
+    Log::debugF("--------------------------------------------------------------------");
+}
+
+// ========================================================
+
+} // namespace VkToolbox
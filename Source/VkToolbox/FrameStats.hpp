@@ -0,0 +1,138 @@
+#pragma once
+
+// ================================================================================================
+// File: VkToolbox/FrameStats.hpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Frame pacing and latency statistics (acquire/fence/submit/present timings).
+// ================================================================================================
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace VkToolbox
+{
+
+// ========================================================
+// class FrameStats:
+// ========================================================
+
+// Rolling-window timing statistics for the per-frame synchronization points:
+// swap image acquire, fence waits, queue submit and present. VulkanContext
+// feeds the samples; apps can query p50/p95/p99 summaries at any time and a
+// full report is logged on context shutdown. This is what tells a pacing
+// stall (long acquire/present) apart from the GPU simply being busy.
+class FrameStats final
+{
+public:
+
+    enum Metric
+    {
+        AcquireWait, // vkAcquireNextImageKHR in beginFrame().
+        FenceWait,   // vkWaitForFences (AutoFence and the async transfer fence).
+        QueueSubmit, // vkQueueSubmit in endFrame().
+        Present,     // vkQueuePresentKHR in endFrame().
+        FrameTotal,  // Time between consecutive frameMark() calls (whole frame).
+
+        MetricCount
+    };
+
+    // Number of most recent samples kept per metric.
+    static constexpr int WindowSize = 256;
+
+    // Master switch - when false every sample is a cheap early-out.
+    static bool sm_enabled;
+
+    // Global collector shared by the whole engine.
+    static FrameStats & shared();
+
+    // Percentiles and extremes over the current sample window.
+    struct MetricSummary
+    {
+        double p50Ms        = 0.0;
+        double p95Ms        = 0.0;
+        double p99Ms        = 0.0;
+        double averageMs    = 0.0;
+        double worstMs      = 0.0; // Worst sample ever, not just within the window.
+        int    sampleCount  = 0;
+    };
+
+    // Push one timing sample. Thread-safe - fence waits can come
+    // from the parallel resource loaders.
+    void addSample(Metric metric, double milliseconds);
+
+    // Marks a frame boundary; the delta between consecutive marks
+    // becomes a FrameTotal sample. Called by beginFrame().
+    void frameMark();
+
+    // Compute the summary for one metric over its current window.
+    MetricSummary summaryFor(Metric metric) const;
+
+    // Logs a table with the summaries of every metric.
+    void logReport() const;
+
+    // Printable metric name for reports.
+    static const char * metricName(Metric metric);
+
+    // Nanosecond timestamp on the stats clock.
+    static std::int64_t timestampNow()
+    {
+        const auto now = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+    }
+
+    // ========================================================
+    // class ScopedTimer:
+    // ========================================================
+
+    // RAII bracket - adds the elapsed scope time as one sample of the metric.
+    class ScopedTimer final
+    {
+    public:
+
+        explicit ScopedTimer(const Metric metric)
+            : m_metric{ metric }
+            , m_startNs{ sm_enabled ? timestampNow() : 0 }
+        { }
+
+        ~ScopedTimer()
+        {
+            if (sm_enabled)
+            {
+                shared().addSample(m_metric, (timestampNow() - m_startNs) * (1.0 / 1000000.0));
+            }
+        }
+
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer & operator = (const ScopedTimer &) = delete;
+
+    private:
+
+        const Metric       m_metric;
+        const std::int64_t m_startNs;
+    };
+
+private:
+
+    FrameStats() = default;
+
+    FrameStats(const FrameStats &) = delete;
+    FrameStats & operator = (const FrameStats &) = delete;
+
+    struct MetricWindow
+    {
+        double samples[WindowSize] = {};
+        int    nextSample  = 0; // Ring cursor into samples[].
+        int    sampleCount = 0; // Grows until the window is full.
+        double worstMs     = 0.0;
+    };
+
+    MetricWindow m_metrics[MetricCount];
+    std::int64_t m_lastFrameMarkNs = 0;
+    mutable std::mutex m_mutex;
+};
+
+// ========================================================
+
+} // namespace VkToolbox
@@ -0,0 +1,168 @@
+#pragma once
+
+// ================================================================================================
+// File: VkToolbox/Frustum.hpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: View frustum with SIMD batch AABB culling tests.
+// ================================================================================================
+
+#include "Utils.hpp"
+#include "External.hpp"
+
+#include <cstdint>
+#include <emmintrin.h>
+
+namespace VkToolbox
+{
+
+// ========================================================
+// struct AabbSoA:
+// ========================================================
+
+// Structure-of-arrays AABB bounds in center/extent form, for the batch
+// frustum tests. All six arrays must be padded to a multiple of 4 entries
+// (the pad entries can be zeroed - they just waste a lane).
+struct AabbSoA
+{
+    const float * centerX;
+    const float * centerY;
+    const float * centerZ;
+    const float * extentX;
+    const float * extentY;
+    const float * extentZ;
+};
+
+// ========================================================
+// class Frustum:
+// ========================================================
+
+// The six planes of a view frustum, extracted from a combined
+// view-projection matrix (Gribb-Hartmann style). Planes are kept as
+// SoA components so the batch test can splat them into SSE registers.
+// To cull model-space AABBs without transforming them, build the
+// frustum from (viewProj * modelMatrix).
+class Frustum final
+{
+public:
+
+    static constexpr int PlaneCount = 6;
+
+    Frustum() = default;
+
+    explicit Frustum(const Matrix4 & viewProj)
+    {
+        setFromMatrix(viewProj);
+    }
+
+    // Extracts and normalizes the six planes from a column-major
+    // view-projection matrix (the Vectormath/OpenGL convention).
+    void setFromMatrix(const Matrix4 & viewProj)
+    {
+        // Rows of the column-major matrix:
+        const float r0[4] = { viewProj[0][0], viewProj[1][0], viewProj[2][0], viewProj[3][0] };
+        const float r1[4] = { viewProj[0][1], viewProj[1][1], viewProj[2][1], viewProj[3][1] };
+        const float r2[4] = { viewProj[0][2], viewProj[1][2], viewProj[2][2], viewProj[3][2] };
+        const float r3[4] = { viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3] };
+
+        setPlane(0, r3[0] + r0[0], r3[1] + r0[1], r3[2] + r0[2], r3[3] + r0[3]); // left
+        setPlane(1, r3[0] - r0[0], r3[1] - r0[1], r3[2] - r0[2], r3[3] - r0[3]); // right
+        setPlane(2, r3[0] + r1[0], r3[1] + r1[1], r3[2] + r1[2], r3[3] + r1[3]); // bottom
+        setPlane(3, r3[0] - r1[0], r3[1] - r1[1], r3[2] - r1[2], r3[3] - r1[3]); // top
+        setPlane(4, r3[0] + r2[0], r3[1] + r2[1], r3[2] + r2[2], r3[3] + r2[3]); // near
+        setPlane(5, r3[0] - r2[0], r3[1] - r2[1], r3[2] - r2[2], r3[3] - r2[3]); // far
+    }
+
+    // Scalar min/max-corner test for a single box. Conservative - returns
+    // true for anything intersecting or contained in the frustum.
+    bool isAabbVisible(const float mins[3], const float maxs[3]) const
+    {
+        const float cx = (mins[0] + maxs[0]) * 0.5f;
+        const float cy = (mins[1] + maxs[1]) * 0.5f;
+        const float cz = (mins[2] + maxs[2]) * 0.5f;
+        const float ex = (maxs[0] - mins[0]) * 0.5f;
+        const float ey = (maxs[1] - mins[1]) * 0.5f;
+        const float ez = (maxs[2] - mins[2]) * 0.5f;
+
+        for (int p = 0; p < PlaneCount; ++p)
+        {
+            const float dist   = (cx * m_planeX[p]) + (cy * m_planeY[p]) + (cz * m_planeZ[p]) + m_planeW[p];
+            const float radius = (ex * m_absPlaneX[p]) + (ey * m_absPlaneY[p]) + (ez * m_absPlaneZ[p]);
+            if (dist + radius < 0.0f)
+            {
+                return false; // Fully behind one of the planes.
+            }
+        }
+        return true;
+    }
+
+    // Tests 4 boxes per iteration against all six planes, writing one byte
+    // per box into outVisible (nonzero = visible). boxCount must be a
+    // multiple of 4 - pad the arrays and round up.
+    void cullAabbs(const AabbSoA & boxes, const int boxCount, std::uint8_t * outVisible) const
+    {
+        assert((boxCount % 4) == 0);
+        assert(outVisible != nullptr);
+
+        for (int i = 0; i < boxCount; i += 4)
+        {
+            const __m128 cx = _mm_loadu_ps(boxes.centerX + i);
+            const __m128 cy = _mm_loadu_ps(boxes.centerY + i);
+            const __m128 cz = _mm_loadu_ps(boxes.centerZ + i);
+            const __m128 ex = _mm_loadu_ps(boxes.extentX + i);
+            const __m128 ey = _mm_loadu_ps(boxes.extentY + i);
+            const __m128 ez = _mm_loadu_ps(boxes.extentZ + i);
+
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (int p = 0; p < PlaneCount; ++p)
+            {
+                __m128 dist = _mm_mul_ps(cx, _mm_set1_ps(m_planeX[p]));
+                dist = _mm_add_ps(dist, _mm_mul_ps(cy, _mm_set1_ps(m_planeY[p])));
+                dist = _mm_add_ps(dist, _mm_mul_ps(cz, _mm_set1_ps(m_planeZ[p])));
+                dist = _mm_add_ps(dist, _mm_set1_ps(m_planeW[p]));
+
+                __m128 radius = _mm_mul_ps(ex, _mm_set1_ps(m_absPlaneX[p]));
+                radius = _mm_add_ps(radius, _mm_mul_ps(ey, _mm_set1_ps(m_absPlaneY[p])));
+                radius = _mm_add_ps(radius, _mm_mul_ps(ez, _mm_set1_ps(m_absPlaneZ[p])));
+
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(dist, radius), _mm_setzero_ps()));
+            }
+
+            const int mask = _mm_movemask_ps(inside);
+            outVisible[i + 0] = static_cast<std::uint8_t>( mask       & 1);
+            outVisible[i + 1] = static_cast<std::uint8_t>((mask >> 1) & 1);
+            outVisible[i + 2] = static_cast<std::uint8_t>((mask >> 2) & 1);
+            outVisible[i + 3] = static_cast<std::uint8_t>((mask >> 3) & 1);
+        }
+    }
+
+private:
+
+    void setPlane(const int index, const float x, const float y, const float z, const float w)
+    {
+        const float invLen = 1.0f / std::sqrt((x * x) + (y * y) + (z * z));
+
+        m_planeX[index] = x * invLen;
+        m_planeY[index] = y * invLen;
+        m_planeZ[index] = z * invLen;
+        m_planeW[index] = w * invLen;
+
+        m_absPlaneX[index] = std::fabs(m_planeX[index]);
+        m_absPlaneY[index] = std::fabs(m_planeY[index]);
+        m_absPlaneZ[index] = std::fabs(m_planeZ[index]);
+    }
+
+    // Plane components as SoA (normal + distance), plus the absolute
+    // normals used for the center/extent projection radius.
+    float m_planeX[PlaneCount] = {};
+    float m_planeY[PlaneCount] = {};
+    float m_planeZ[PlaneCount] = {};
+    float m_planeW[PlaneCount] = {};
+    float m_absPlaneX[PlaneCount] = {};
+    float m_absPlaneY[PlaneCount] = {};
+    float m_absPlaneZ[PlaneCount] = {};
+};
+
+// ========================================================
+
+} // namespace VkToolbox
@@ -7,6 +7,8 @@
 // ================================================================================================
 
 #include "GlslShader.hpp"
+#include "CpuProfiler.hpp"
+#include "FileWatcher.hpp"
 
 // https://github.com/KhronosGroup/glslang
 #include "glslang/glslang/Public/ShaderLang.h"
@@ -168,6 +170,18 @@ static void GlslPrintWarnings(T & shdr, const char * const typeName, const char
 }
 
 namespace {
+
+// Names the shader whose compilation is running on this thread, so the
+// includer below can attribute #include dependencies to the right root
+// file. Thread-local since shaders compile in parallel on the job workers.
+thread_local const char * s_tlsCompilingShaderName = nullptr;
+
+struct ScopedCompilingShaderName final
+{
+    explicit ScopedCompilingShaderName(const char * const name) { s_tlsCompilingShaderName = name; }
+    ~ScopedCompilingShaderName() { s_tlsCompilingShaderName = nullptr; }
+};
+
 class MyGlslIncluder final
     : public glslang::TShader::Includer
 {
@@ -217,6 +231,13 @@ public:
             return nullptr;
         }
 
+        // Register the edge with the hot-reload watcher, so editing this
+        // header reloads only the shaders that actually pull it in.
+        if (s_tlsCompilingShaderName != nullptr)
+        {
+            FileWatcher::shared().addDependency(fullFilePath.c_str(), s_tlsCompilingShaderName);
+        }
+
         return new IncludeResult{ fullFilePath.c_str(), sourceCode.release(), sourceSize, nullptr };
     }
 
@@ -252,6 +273,7 @@ static bool GlslToSPIRV(const VkShaderStageFlagBits shaderType,
     glslang::TShader  shader(stage);
     glslang::TProgram program;
     MyGlslIncluder    myIncluder;
+    ScopedCompilingShaderName compilingShaderTLS{ shaderDebugName };
 
     assert(glslSourceStrings.size() == glslSourceStringLengths.size());
     const auto numOfStrings = narrowCast<int>(glslSourceStrings.size());
@@ -329,6 +351,197 @@ static bool GlslToSPIRV(const VkShaderStageFlagBits shaderType,
 
 #undef GLSL_COMPILER_ERROR_OUT
 
+// ========================================================
+// On-disk SPIR-V shader cache:
+// ========================================================
+
+#if VKTB_SPIRV_SHADER_CACHE_ENABLED
+
+struct SpirVCacheHeader final
+{
+    std::uint32_t magic;          // VSPC 4cc
+    std::uint32_t spirvWordCount; // Number of SPIR-V words following this header.
+    std::uint64_t sourceHash;     // Content hash of the GLSL source - also the cache file name.
+};
+
+// Scans GLSL source text for #include directives, resolving each one the same
+// way MyGlslIncluder does (<...> prepends the default include path, "..." is
+// taken as-is), and folds the included file's contents into the running hash,
+// recursing into nested includes. The key is computed before shader.parse()
+// runs the real includer, so this is the only chance to get header edits into
+// the cache key. Unresolvable includes are skipped here - the compiler will
+// report them properly if the cache misses.
+static std::uint64_t SpirVCacheHashIncludes(const char * const sourceText,
+                                            const int sourceLen,
+                                            std::uint64_t hash,
+                                            const int depth = 0)
+{
+    constexpr int MaxIncludeDepth = 16; // Cycle/runaway guard - matches no sane shader.
+    if (depth >= MaxIncludeDepth)
+    {
+        return hash;
+    }
+
+    const char * ptr = sourceText;
+    const char * const end = sourceText + sourceLen;
+
+    while (ptr < end)
+    {
+        // Start of line - skip leading whitespace:
+        while (ptr < end && (ptr[0] == ' ' || ptr[0] == '\t'))
+        {
+            ++ptr;
+        }
+
+        if (ptr < end && ptr[0] == '#')
+        {
+            ++ptr;
+            while (ptr < end && (ptr[0] == ' ' || ptr[0] == '\t'))
+            {
+                ++ptr;
+            }
+
+            constexpr int kIncludeLen = 7; // strlen("include")
+            if ((end - ptr) > kIncludeLen && std::strncmp(ptr, "include", kIncludeLen) == 0)
+            {
+                ptr += kIncludeLen;
+                while (ptr < end && (ptr[0] == ' ' || ptr[0] == '\t'))
+                {
+                    ++ptr;
+                }
+
+                const bool systemInclude = (ptr < end && ptr[0] == '<');
+                if (ptr < end && (ptr[0] == '<' || ptr[0] == '"'))
+                {
+                    const char closingChar = (systemInclude ? '>' : '"');
+                    const char * nameStart = ++ptr;
+                    while (ptr < end && ptr[0] != closingChar && ptr[0] != '\n')
+                    {
+                        ++ptr;
+                    }
+
+                    if (ptr < end && ptr[0] == closingChar && ptr != nameStart)
+                    {
+                        const int nameLen = narrowCast<int>(ptr - nameStart);
+
+                        str512 fullFilePath;
+                        fullFilePath.setf("%s%.*s",
+                                          (systemInclude ? GlslShaderPreproc::shaderIncludePath() : ""),
+                                          nameLen, nameStart);
+
+                        std::size_t includeSize = 0;
+                        std::unique_ptr<char[]> includeSource = loadTextFile(fullFilePath.c_str(), &includeSize);
+                        if (includeSource != nullptr && includeSize != 0)
+                        {
+                            hash = murmurHash64(includeSource.get(), includeSize, hash);
+                            hash = SpirVCacheHashIncludes(includeSource.get(), narrowCast<int>(includeSize),
+                                                          hash, depth + 1);
+                        }
+                    }
+                }
+            }
+        }
+
+        // Advance to the next line:
+        while (ptr < end && ptr[0] != '\n')
+        {
+            ++ptr;
+        }
+        if (ptr < end)
+        {
+            ++ptr;
+        }
+    }
+
+    return hash;
+}
+
+// The cache key hashes the global preprocessor defines string, the split stage
+// source and the contents of every file it #includes (transitively), so editing
+// any of them produces a different key and the stale entry is simply never
+// looked up again. This is what keeps reloadCurrent() picking up source edits
+// without any extra invalidation logic.
+static Hash64 SpirVCacheKey(const VkShaderStageFlagBits shaderType,
+                            const array_view<const char *> glslSourceStrings,
+                            const array_view<const int> glslSourceStringLengths)
+{
+    std::uint64_t hash = static_cast<std::uint64_t>(shaderType);
+    for (std::size_t i = 0; i < glslSourceStrings.size(); ++i)
+    {
+        hash = murmurHash64(glslSourceStrings[i], glslSourceStringLengths[i], hash);
+        hash = SpirVCacheHashIncludes(glslSourceStrings[i], glslSourceStringLengths[i], hash);
+    }
+    return Hash64{ hash };
+}
+
+static void SpirVCacheFilePath(const Hash64 cacheKey, str512 * outFilePath)
+{
+    char hashStr[24];
+    outFilePath->setf("%s%s.spv", VKTB_SHADER_CACHE_PATH, cacheKey.toString(hashStr));
+}
+
+static bool SpirVCacheTryLoad(const Hash64 cacheKey, std::vector<std::uint32_t> * outSpirVBinary)
+{
+    str512 filePath;
+    SpirVCacheFilePath(cacheKey, &filePath);
+
+    ScopedFileHandle fileIn = openFile(filePath.c_str(), "rb");
+    if (fileIn == nullptr)
+    {
+        return false; // Not cached yet - perfectly normal.
+    }
+
+    // The two-fwrite store isn't atomic - a crash mid-write can leave an
+    // empty or truncated file behind, so a short read is just a cache miss,
+    // not a programming error.
+    SpirVCacheHeader header = {};
+    const auto n = std::fread(&header, sizeof(header), 1, fileIn);
+
+    if (n != 1 || header.magic != 'CPSV' || header.sourceHash != cacheKey.value || header.spirvWordCount == 0)
+    {
+        Log::warningF("Shader cache file '%s' is corrupted! Recompiling from source.", filePath.c_str());
+        return false;
+    }
+
+    outSpirVBinary->resize(header.spirvWordCount);
+    if (!readArrayFromFile(fileIn, outSpirVBinary->data(), header.spirvWordCount))
+    {
+        Log::warningF("Shader cache file '%s' is truncated! Recompiling from source.", filePath.c_str());
+        outSpirVBinary->clear();
+        return false;
+    }
+
+    Log::debugF("SPIR-V cache hit for shader blob '%s'", filePath.c_str());
+    return true;
+}
+
+static void SpirVCacheStore(const Hash64 cacheKey, const std::vector<std::uint32_t> & spirvBinary)
+{
+    createDirectory(VKTB_SHADER_CACHE_PATH);
+
+    str512 filePath;
+    SpirVCacheFilePath(cacheKey, &filePath);
+
+    ScopedFileHandle fileOut = openFile(filePath.c_str(), "wb");
+    if (fileOut == nullptr)
+    {
+        Log::warningF("Could not create shader cache file '%s'.", filePath.c_str());
+        return;
+    }
+
+    SpirVCacheHeader header;
+    header.magic          = 'CPSV';
+    header.spirvWordCount = narrowCast<std::uint32_t>(spirvBinary.size());
+    header.sourceHash     = cacheKey.value;
+
+    writeStructToFile(fileOut, header);
+    writeArrayToFile(fileOut, spirvBinary.data(), spirvBinary.size());
+
+    Log::debugF("Cached %zu SPIR-V words into shader cache file '%s'", spirvBinary.size(), filePath.c_str());
+}
+
+#endif // VKTB_SPIRV_SHADER_CACHE_ENABLED
+
 // ========================================================
 // GlslShaderStage enum lists:
 // ========================================================
@@ -422,6 +635,8 @@ bool GlslShader::reloadCurrent()
 
 bool GlslShader::load()
 {
+    VKTB_PROFILE_SCOPE("GlslShader::load");
+
     if (isShutdown())
     {
         Log::warningF("GlslShader is already shutdown and cannot be loaded!");
@@ -455,14 +670,13 @@ bool GlslShader::load()
 
 void GlslShader::unload()
 {
-    // Release the old stage modules if needed:
+    // Release the old stage modules if needed. Destruction is deferred so
+    // a hot-reload can swap the stages while in-flight frames still use them.
     if (!m_stages.empty())
     {
-        const auto device   = context().deviceHandle();
-        const auto allocCBs = context().allocationCallbacks();
         for (int s = 0; s < m_stages.size(); ++s)
         {
-            vkDestroyShaderModule(device, m_stages[s].moduleHandle, allocCBs);
+            context().destroyDeferred(m_stages[s].moduleHandle, &vkDestroyShaderModule);
         }
         m_stages.clear();
     }
@@ -485,7 +699,8 @@ void GlslShader::clear()
     m_stages.clear();
 }
 
-int GlslShader::pipelineStages(array_view<VkPipelineShaderStageCreateInfo> outStages) const
+int GlslShader::pipelineStages(array_view<VkPipelineShaderStageCreateInfo> outStages,
+                               const VkSpecializationInfo * const specInfo) const
 {
     assert(outStages != nullptr);
     assert(outStages.size() >= GlslShaderStage::MaxStages);
@@ -499,7 +714,7 @@ int GlslShader::pipelineStages(array_view<VkPipelineShaderStageCreateInfo> outSt
         outStages[s].stage  = GlslShaderStage::VkShaderStageFlags[m_stages[s].id];
         outStages[s].module = m_stages[s].moduleHandle;
         outStages[s].pName  = "main";
-        outStages[s].pSpecializationInfo = nullptr;
+        outStages[s].pSpecializationInfo = specInfo;
     }
     return m_stages.size();
 }
@@ -511,10 +726,24 @@ VkShaderModule GlslShader::createShaderModule(const VulkanContext & vkContext,
                                               const array_view<const int> glslSourceStringLengths)
 {
     std::vector<std::uint32_t> spirvBinary;
-    if (!GlslToSPIRV(shaderType, shaderDebugName, glslSourceStrings, glslSourceStringLengths, &spirvBinary))
+    bool haveSpirV = false;
+
+    #if VKTB_SPIRV_SHADER_CACHE_ENABLED
+    const Hash64 cacheKey = SpirVCacheKey(shaderType, glslSourceStrings, glslSourceStringLengths);
+    haveSpirV = SpirVCacheTryLoad(cacheKey, &spirvBinary);
+    #endif // VKTB_SPIRV_SHADER_CACHE_ENABLED
+
+    if (!haveSpirV)
     {
-        Log::errorF("GLSL to SPIR-V compilation failed for shader '%s'", shaderDebugName);
-        return VK_NULL_HANDLE;
+        if (!GlslToSPIRV(shaderType, shaderDebugName, glslSourceStrings, glslSourceStringLengths, &spirvBinary))
+        {
+            Log::errorF("GLSL to SPIR-V compilation failed for shader '%s'", shaderDebugName);
+            return VK_NULL_HANDLE;
+        }
+
+        #if VKTB_SPIRV_SHADER_CACHE_ENABLED
+        SpirVCacheStore(cacheKey, spirvBinary);
+        #endif // VKTB_SPIRV_SHADER_CACHE_ENABLED
     }
 
     VkShaderModuleCreateInfo shaderModuleInfo;
@@ -21,6 +21,13 @@ namespace VkToolbox
 // If non-zero, failing to compile a shader will abort with a fatal error.
 #define VKTB_GLSL_COMPILER_ERRORS_ARE_FATAL 1
 
+// Directory where compiled SPIR-V binaries get cached between runs.
+#define VKTB_SHADER_CACHE_PATH "Source/Shaders/Cache/"
+
+// If non-zero, compiled SPIR-V binaries are saved to disk and reused on the next
+// run, skipping the expensive GLSL front-end for shaders that haven't changed.
+#define VKTB_SPIRV_SHADER_CACHE_ENABLED 1
+
 // ========================================================
 // struct GlslShaderStage:
 // ========================================================
@@ -161,6 +168,17 @@ public:
     int pipelineStages(array_view<VkPipelineShaderStageCreateInfo> outStages) const;
     int pipelineStages(std::array<VkPipelineShaderStageCreateInfo, GlslShaderStage::MaxStages> * outStages) const;
 
+    // Overloads attaching specialization constants to every stage (a stage simply ignores
+    // constant_ids it doesn't declare). Preferred over GlslShaderPreproc #define permutations
+    // when a 4-byte constant is all that varies - one compiled SPIR-V module then serves all
+    // the permutations instead of each one costing a full recompile and its own cache entry.
+    // See PipelineStateBuilder::setSpecConstant()/specInfo(). The specialization info must
+    // stay alive until the pipeline is created; null behaves like the overloads above.
+    int pipelineStages(array_view<VkPipelineShaderStageCreateInfo> outStages,
+                       const VkSpecializationInfo * specInfo) const;
+    int pipelineStages(std::array<VkPipelineShaderStageCreateInfo, GlslShaderStage::MaxStages> * outStages,
+                       const VkSpecializationInfo * specInfo) const;
+
 private:
 
     void clear();
@@ -258,6 +276,18 @@ inline int GlslShader::pipelineStages(std::array<VkPipelineShaderStageCreateInfo
     return pipelineStages(make_array_view(*outStages));
 }
 
+inline int GlslShader::pipelineStages(array_view<VkPipelineShaderStageCreateInfo> outStages) const
+{
+    return pipelineStages(outStages, nullptr);
+}
+
+inline int GlslShader::pipelineStages(std::array<VkPipelineShaderStageCreateInfo, GlslShaderStage::MaxStages> * outStages,
+                                      const VkSpecializationInfo * const specInfo) const
+{
+    assert(outStages != nullptr);
+    return pipelineStages(make_array_view(*outStages), specInfo);
+}
+
 // ========================================================
 
 } // namespace VkToolbox
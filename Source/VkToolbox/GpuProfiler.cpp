@@ -0,0 +1,181 @@
+
+// ================================================================================================
+// File: VkToolbox/GpuProfiler.cpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: GPU timestamp profiler - measures where the GPU frame time goes.
+// ================================================================================================
+
+#include "GpuProfiler.hpp"
+#include "VulkanContext.hpp"
+
+namespace VkToolbox
+{
+
+// ========================================================
+// class GpuProfiler:
+// ========================================================
+
+bool GpuProfiler::sm_enabled = false;
+
+GpuProfiler::~GpuProfiler()
+{
+    shutdown();
+}
+
+void GpuProfiler::initialize()
+{
+    assert(!isInitialized());
+
+    const VkPhysicalDeviceLimits & limits = m_vkContext->deviceProperties().limits;
+    if (limits.timestampPeriod <= 0.0f || !limits.timestampComputeAndGraphics)
+    {
+        Log::warningF("Device doesn't support timestamp queries - GPU profiler disabled.");
+        return;
+    }
+
+    // timestampPeriod is in nanoseconds per tick.
+    m_millisecondsPerTick = static_cast<double>(limits.timestampPeriod) * 0.000001;
+
+    VkQueryPoolCreateInfo poolInfo = {};
+    poolInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+    poolInfo.queryCount = MaxZonesPerFrame * 2;
+
+    for (FrameQueries & frame : m_frames)
+    {
+        VKTB_CHECK(vkCreateQueryPool(m_vkContext->deviceHandle(), &poolInfo,
+                                     m_vkContext->allocationCallbacks(), &frame.queryPool));
+    }
+
+    Log::debugF("GPU profiler initialized (%i zones per frame, %i frames in flight).",
+                MaxZonesPerFrame, FrameCount);
+}
+
+void GpuProfiler::shutdown()
+{
+    for (FrameQueries & frame : m_frames)
+    {
+        if (frame.queryPool != VK_NULL_HANDLE)
+        {
+            vkDestroyQueryPool(m_vkContext->deviceHandle(), frame.queryPool,
+                               m_vkContext->allocationCallbacks());
+            frame.queryPool = VK_NULL_HANDLE;
+        }
+        frame.zones.clear();
+    }
+
+    m_openZoneStack.clear();
+    m_results.clear();
+    m_currentFrame = 0;
+}
+
+void GpuProfiler::beginFrame(const CommandBuffer & cmdBuff)
+{
+    if (!sm_enabled || !isInitialized())
+    {
+        return;
+    }
+
+    assert(m_openZoneStack.empty() && "Unbalanced beginZone/endZone calls!");
+
+    // The next pool in the rotation was last written FrameCount frames
+    // ago - resolve whatever it holds before recycling it.
+    m_currentFrame = (m_currentFrame + 1) % FrameCount;
+    FrameQueries & frame = m_frames[m_currentFrame];
+    resolveFrame(frame);
+
+    frame.zones.clear();
+    vkCmdResetQueryPool(cmdBuff, frame.queryPool, 0, MaxZonesPerFrame * 2);
+}
+
+void GpuProfiler::beginZone(const CommandBuffer & cmdBuff, const char * const name)
+{
+    if (!sm_enabled || !isInitialized())
+    {
+        return;
+    }
+
+    assert(name != nullptr);
+    assert(m_openZoneStack.size() < MaxZoneDepth);
+
+    FrameQueries & frame = m_frames[m_currentFrame];
+    if (frame.zones.size() == MaxZonesPerFrame) // Out of zones - drop it.
+    {
+        m_openZoneStack.push(-1);
+        return;
+    }
+
+    const int zoneIndex = frame.zones.size();
+    frame.zones.push({ name, m_openZoneStack.size() });
+    m_openZoneStack.push(zoneIndex);
+
+    vkCmdWriteTimestamp(cmdBuff, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                        frame.queryPool, (zoneIndex * 2));
+}
+
+void GpuProfiler::endZone(const CommandBuffer & cmdBuff)
+{
+    if (!sm_enabled || !isInitialized())
+    {
+        return;
+    }
+
+    assert(!m_openZoneStack.empty() && "endZone without a matching beginZone!");
+
+    const int zoneIndex = m_openZoneStack.back();
+    m_openZoneStack.pop();
+
+    if (zoneIndex < 0) // The matching beginZone was dropped.
+    {
+        return;
+    }
+
+    FrameQueries & frame = m_frames[m_currentFrame];
+    vkCmdWriteTimestamp(cmdBuff, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                        frame.queryPool, (zoneIndex * 2) + 1);
+}
+
+void GpuProfiler::resolveFrame(FrameQueries & frame)
+{
+    m_results.clear();
+
+    const int zoneCount = frame.zones.size();
+    if (zoneCount == 0)
+    {
+        return;
+    }
+
+    // The wait bit is effectively free here since these timestamps are
+    // FrameCount frames old - the frame fences have long retired them.
+    std::uint64_t timestamps[MaxZonesPerFrame * 2];
+    VKTB_CHECK(vkGetQueryPoolResults(m_vkContext->deviceHandle(), frame.queryPool,
+                                     0, (zoneCount * 2),
+                                     sizeof(timestamps), timestamps, sizeof(std::uint64_t),
+                                     (VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT)));
+
+    for (int z = 0; z < zoneCount; ++z)
+    {
+        const std::uint64_t start = timestamps[(z * 2)];
+        const std::uint64_t end   = timestamps[(z * 2) + 1];
+
+        ZoneResult result;
+        result.name         = frame.zones[z].name;
+        result.milliseconds = static_cast<float>((end - start) * m_millisecondsPerTick);
+        result.depth        = frame.zones[z].depth;
+        m_results.push(result);
+    }
+}
+
+void GpuProfiler::logFrameReport() const
+{
+    Log::debugF("---- GPU frame report ----");
+    for (const ZoneResult & zone : m_results)
+    {
+        Log::debugF("%*s%s: %.3f ms", (zone.depth * 2), "", zone.name, zone.milliseconds);
+    }
+}
+
+// ========================================================
+
+} // namespace VkToolbox
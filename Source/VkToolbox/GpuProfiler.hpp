@@ -0,0 +1,133 @@
+#pragma once
+
+// ================================================================================================
+// File: VkToolbox/GpuProfiler.hpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: GPU timestamp profiler - measures where the GPU frame time goes.
+// ================================================================================================
+
+#include <vulkan/vulkan.h>
+
+#include "External.hpp"
+#include "FixedSizeArray.hpp"
+
+namespace VkToolbox
+{
+
+class VulkanContext;
+class CommandBuffer;
+
+// ========================================================
+// class GpuProfiler:
+// ========================================================
+
+// Timestamp-query profiler for GPU work. Zones are bracketed with
+// vkCmdWriteTimestamp pairs recorded into the frame's command buffer and
+// resolved a few frames later, once the GPU is guaranteed to have written
+// them - so reports lag the live frame by the swap-chain depth, which is
+// fine for profiling. Zones may nest; the report is indented accordingly.
+//
+// Usage, inside the frame command buffer recording:
+//
+//   profiler.beginFrame(cmdBuff);              // before any zones
+//   profiler.beginZone(cmdBuff, "RenderPass");
+//   ...
+//   profiler.endZone(cmdBuff);
+//
+// Then frameResults()/logFrameReport() after beginFrame() has resolved them.
+class GpuProfiler final
+{
+public:
+
+    // Maximum number of zones recorded per frame - excess zones are dropped.
+    static constexpr int MaxZonesPerFrame = 64;
+
+    // Maximum zone nesting depth.
+    static constexpr int MaxZoneDepth = 8;
+
+    // Master switch for all contexts - when false every profiler
+    // call is a cheap early-out. Toggleable at runtime.
+    static bool sm_enabled;
+
+    explicit GpuProfiler(const VulkanContext & vkContext)
+        : m_vkContext{ &vkContext }
+    { }
+
+    ~GpuProfiler();
+
+    // Not copyable.
+    GpuProfiler(const GpuProfiler &) = delete;
+    GpuProfiler & operator = (const GpuProfiler &) = delete;
+
+    // Creates the timestamp query pools. Leaves the profiler uninitialized
+    // (and every zone call a no-op) if the device can't do timestamp queries.
+    void initialize();
+    void shutdown();
+    bool isInitialized() const { return (m_frames[0].queryPool != VK_NULL_HANDLE); }
+
+    // Call at the top of the frame's command buffer, before any zones.
+    // Resolves the oldest in-flight frame's timestamps into frameResults()
+    // and recycles its query pool range for this frame.
+    void beginFrame(const CommandBuffer & cmdBuff);
+
+    // Bracket a stretch of GPU work. Every beginZone() needs a matching
+    // endZone() on the same command buffer, within the same frame.
+    // The name must point to a string literal or otherwise outlive the frame.
+    void beginZone(const CommandBuffer & cmdBuff, const char * name);
+    void endZone(const CommandBuffer & cmdBuff);
+
+    struct ZoneResult
+    {
+        const char * name;
+        float        milliseconds;
+        int          depth; // Nesting level - for indented reports.
+    };
+
+    // Results resolved by the most recent beginFrame().
+    array_view<const ZoneResult> frameResults() const
+    {
+        return make_array_view(m_results.data(), m_results.size());
+    }
+
+    // Dumps frameResults() through the log, one line per zone, indented by depth.
+    void logFrameReport() const;
+
+private:
+
+    // One pool per in-flight frame, matching the swap-chain depth, so a
+    // pool is only read back/reset after the GPU has long finished with it.
+    static constexpr int FrameCount = 3;
+
+    struct Zone
+    {
+        const char * name;
+        int          depth;
+        // Zone N uses query 2N for the start timestamp and 2N+1 for the end.
+    };
+
+    struct FrameQueries
+    {
+        VkQueryPool queryPool = VK_NULL_HANDLE;
+        FixedSizeArray<Zone, MaxZonesPerFrame> zones;
+    };
+
+    void resolveFrame(FrameQueries & frame);
+
+    const VulkanContext * m_vkContext;
+
+    FrameQueries m_frames[FrameCount];
+    int m_currentFrame = 0;
+
+    // Indexes of the currently open zones (-1 for dropped ones).
+    FixedSizeArray<int, MaxZoneDepth> m_openZoneStack;
+
+    // Timestamp-tick to millisecond conversion factor for this device.
+    double m_millisecondsPerTick = 0.0;
+
+    FixedSizeArray<ZoneResult, MaxZonesPerFrame> m_results;
+};
+
+// ========================================================
+
+} // namespace VkToolbox
@@ -11,7 +11,11 @@
 #include <cstdint>
 #include <cstring>
 #include <cstdio>
+#include <cassert>
+#include <algorithm>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace VkToolbox
 {
@@ -24,6 +28,43 @@ namespace VkToolbox
 std::uint32_t murmurHash32(const void * key, std::size_t len, std::uint32_t seed = 0);
 std::uint64_t murmurHash64(const void * key, std::size_t len, std::uint64_t seed = 0);
 
+// ========================================================
+// FNV-1a hash function (constexpr); See:
+// http://www.isthe.com/chongo/tech/comp/fnv/
+// ========================================================
+
+// Unlike the murmur hashes above, these are usable in constant expressions, so
+// string-literal resource ids hash at compile time. VS2015 constexpr follows
+// the C++11 rules (no loops), hence the recursive formulation. This is what
+// backs the Hash32/Hash64 string constructors and StrId - anything comparing
+// against a stored id hash must use the same function. Keep murmur for bulk
+// content hashing (pipeline state, shader source), where constexpr is useless.
+
+constexpr std::uint32_t Fnv1a32Seed  = 2166136261u;
+constexpr std::uint32_t Fnv1a32Prime = 16777619u;
+constexpr std::uint64_t Fnv1a64Seed  = 14695981039346656037ull;
+constexpr std::uint64_t Fnv1a64Prime = 1099511628211ull;
+
+constexpr std::uint32_t fnv1aHash32(const char * const s, const std::size_t len,
+                                    const std::uint32_t seed = Fnv1a32Seed)
+{
+    return (len == 0) ? seed : fnv1aHash32(s + 1, len - 1,
+            (seed ^ static_cast<std::uint8_t>(*s)) * Fnv1a32Prime);
+}
+
+constexpr std::uint64_t fnv1aHash64(const char * const s, const std::size_t len,
+                                    const std::uint64_t seed = Fnv1a64Seed)
+{
+    return (len == 0) ? seed : fnv1aHash64(s + 1, len - 1,
+            (seed ^ static_cast<std::uint8_t>(*s)) * Fnv1a64Prime);
+}
+
+// constexpr replacement for std::strlen.
+constexpr std::size_t constStrLength(const char * const s)
+{
+    return (*s == '\0') ? 0 : 1 + constStrLength(s + 1);
+}
+
 // ========================================================
 // struct Hash32:
 // ========================================================
@@ -32,22 +73,22 @@ struct Hash32 final
 {
     std::uint32_t value;
 
-    Hash32()
+    constexpr Hash32()
         : value{ 0 }
     { }
 
     // Using enable_if to disambiguate 0, since it also converts to pointer
     template<typename Integer, typename = std::enable_if_t<std::is_integral<Integer>::value>>
-    explicit Hash32(const Integer h)
+    constexpr explicit Hash32(const Integer h)
         : value{ static_cast<std::uint32_t>(h) }
     { }
 
-    explicit Hash32(const char * const s)
-        : value{ murmurHash32(s, std::strlen(s)) }
+    constexpr explicit Hash32(const char * const s)
+        : value{ fnv1aHash32(s, constStrLength(s)) }
     { }
 
-    Hash32(const char * const s, const std::size_t len)
-        : value{ murmurHash32(s, len) }
+    constexpr Hash32(const char * const s, const std::size_t len)
+        : value{ fnv1aHash32(s, len) }
     { }
 
     template<std::size_t Size>
@@ -58,9 +99,9 @@ struct Hash32 final
         return buffer;
     }
 
-    bool isNull() const { return value == 0; }
-    bool operator == (const Hash32 other) const { return this->value == other.value; }
-    bool operator != (const Hash32 other) const { return this->value != other.value; }
+    constexpr bool isNull() const { return value == 0; }
+    constexpr bool operator == (const Hash32 other) const { return this->value == other.value; }
+    constexpr bool operator != (const Hash32 other) const { return this->value != other.value; }
 };
 
 // ========================================================
@@ -71,21 +112,21 @@ struct Hash64 final
 {
     std::uint64_t value;
 
-    Hash64()
+    constexpr Hash64()
         : value{ 0 }
     { }
 
     template<typename Integer, typename = std::enable_if_t<std::is_integral<Integer>::value>>
-    explicit Hash64(const Integer h)
+    constexpr explicit Hash64(const Integer h)
         : value{ static_cast<std::uint64_t>(h) }
     { }
 
-    explicit Hash64(const char * const s)
-        : value{ murmurHash64(s, std::strlen(s)) }
+    constexpr explicit Hash64(const char * const s)
+        : value{ fnv1aHash64(s, constStrLength(s)) }
     { }
 
-    Hash64(const char * const s, const std::size_t len)
-        : value{ murmurHash64(s, len) }
+    constexpr Hash64(const char * const s, const std::size_t len)
+        : value{ fnv1aHash64(s, len) }
     { }
 
     template<std::size_t Size>
@@ -96,15 +137,20 @@ struct Hash64 final
         return buffer;
     }
 
-    bool isNull() const { return value == 0; }
-    bool operator == (const Hash64 other) const { return this->value == other.value; }
-    bool operator != (const Hash64 other) const { return this->value != other.value; }
+    constexpr bool isNull() const { return value == 0; }
+    constexpr bool operator == (const Hash64 other) const { return this->value == other.value; }
+    constexpr bool operator != (const Hash64 other) const { return this->value != other.value; }
 };
 
 // ========================================================
 // struct StrId:
 // ========================================================
 
+// The id hash uses the constexpr FNV-1a above, so a
+//   constexpr Hash64 kId{ "Assets/Models/something.bmesh" };
+// computed from a string literal matches the hash of a StrId constructed at
+// runtime from the same characters, and can be used with the hash-only
+// resource manager lookups without ever touching the string.
 template<typename StrType>
 struct StrId final
 {
@@ -145,4 +191,224 @@ struct StrId final
     bool isNull() const { return hash.isNull(); }
 };
 
+// ========================================================
+// class FlatHashIndex:
+// ========================================================
+
+// Open-addressing hash index used to accelerate lookups into an external item
+// store (this is what backs the ResourceManager registries). Only (hash, index)
+// pairs are stored, in a single contiguous power-of-two array with linear
+// probing, so the common lookup touches a couple of adjacent cache lines
+// instead of chasing bucket chains. Deletion is tombstone-free (backward
+// shifting), so the table never degrades from erase/insert churn. Full-hash
+// collisions are resolved by the caller-supplied predicate, which compares the
+// search key against the actual item in the store.
+template
+<
+    typename IndexType = std::uint32_t,
+    typename HashType  = std::uint64_t
+>
+class FlatHashIndex final
+{
+public:
+
+    // Returned by find() when the key is not in the table.
+    static constexpr IndexType NullIndex = static_cast<IndexType>(~static_cast<IndexType>(0));
+
+    // Capacity of the first allocation - grows by doubling from there.
+    static constexpr int MinCapacity = 64;
+
+    FlatHashIndex() = default;
+    FlatHashIndex(FlatHashIndex &&) = default;
+    FlatHashIndex(const FlatHashIndex &) = default;
+    FlatHashIndex & operator = (FlatHashIndex &&) = default;
+    FlatHashIndex & operator = (const FlatHashIndex &) = default;
+
+    // Grow the table upfront so inserting expectedCount entries never rehashes.
+    void reserve(const int expectedCount)
+    {
+        if (expectedCount > 0)
+        {
+            growIfNeeded(expectedCount);
+        }
+    }
+
+    // Fraction of the slots that may be occupied before the table doubles.
+    // Lower values trade memory for shorter probe sequences. Rehashes
+    // immediately if the current count already exceeds the new threshold.
+    void setMaxLoadFactor(const float factor)
+    {
+        assert(factor > 0.0f && factor < 1.0f);
+        m_maxLoadFactor = factor;
+        if (m_count > 0)
+        {
+            growIfNeeded(m_count);
+        }
+    }
+
+    float maxLoadFactor() const { return m_maxLoadFactor; }
+
+    void insert(const HashType hashKey, const IndexType index)
+    {
+        assert(index != NullIndex);
+        growIfNeeded(m_count + 1);
+        insertNoGrow(hashKey, index);
+        ++m_count;
+    }
+
+    // Probes for hashKey, calling pred(key, items[entry]) on every entry with a
+    // matching full hash until the predicate accepts one or the chain ends.
+    template<typename KeyType, typename ItemContainer, typename Predicate>
+    IndexType find(const HashType hashKey, const KeyType & key,
+                   const ItemContainer & items, Predicate && pred) const
+    {
+        if (m_count == 0)
+        {
+            return NullIndex;
+        }
+
+        const int mask = capacity() - 1;
+        for (int slot = desiredSlot(hashKey);; slot = (slot + 1) & mask)
+        {
+            const Entry & entry = m_table[slot];
+            if (entry.index == NullIndex)
+            {
+                return NullIndex; // Hit an empty slot - not in the table.
+            }
+            if (entry.hash == hashKey && pred(key, items[entry.index]))
+            {
+                return entry.index;
+            }
+        }
+    }
+
+    // Remove the entry matching both hash and index. Returns false if not found.
+    bool erase(const HashType hashKey, const IndexType index)
+    {
+        if (m_count == 0)
+        {
+            return false;
+        }
+
+        const int mask = capacity() - 1;
+        int slot = desiredSlot(hashKey);
+        for (;;)
+        {
+            const Entry & entry = m_table[slot];
+            if (entry.index == NullIndex)
+            {
+                return false; // Hit an empty slot - not in the table.
+            }
+            if (entry.hash == hashKey && entry.index == index)
+            {
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+
+        // Shift the rest of the probe chain back into the hole, so
+        // no tombstones are ever left behind to pollute future probes:
+        for (;;)
+        {
+            const int next = (slot + 1) & mask;
+            const Entry & nextEntry = m_table[next];
+            if (nextEntry.index == NullIndex || desiredSlot(nextEntry.hash) == next)
+            {
+                m_table[slot] = Entry{};
+                break;
+            }
+            m_table[slot] = nextEntry;
+            slot = next;
+        }
+
+        --m_count;
+        return true;
+    }
+
+    // Empty the table but keep the allocation.
+    void clear()
+    {
+        std::fill(m_table.begin(), m_table.end(), Entry{});
+        m_count = 0;
+    }
+
+    // Empty the table and release the memory.
+    void clearAndFree()
+    {
+        m_table.clear();
+        m_table.shrink_to_fit();
+        m_count = 0;
+    }
+
+    int size() const { return m_count; }
+    int capacity() const { return static_cast<int>(m_table.size()); }
+    bool empty() const { return m_count == 0; }
+
+private:
+
+    struct Entry
+    {
+        HashType  hash  = 0;
+        IndexType index = NullIndex; // NullIndex marks an empty slot.
+    };
+
+    int desiredSlot(const HashType hash) const
+    {
+        return static_cast<int>(hash & static_cast<HashType>(capacity() - 1));
+    }
+
+    void insertNoGrow(const HashType hashKey, const IndexType index)
+    {
+        const int mask = capacity() - 1;
+        int slot = desiredSlot(hashKey);
+        while (m_table[slot].index != NullIndex)
+        {
+            slot = (slot + 1) & mask;
+        }
+        m_table[slot].hash  = hashKey;
+        m_table[slot].index = index;
+    }
+
+    void growIfNeeded(const int newCount)
+    {
+        int newCapacity = (capacity() == 0) ? MinCapacity : capacity();
+        while (newCount > static_cast<int>(newCapacity * m_maxLoadFactor))
+        {
+            newCapacity *= 2;
+        }
+        if (newCapacity != capacity())
+        {
+            rehash(newCapacity);
+        }
+    }
+
+    void rehash(const int newCapacity)
+    {
+        assert((newCapacity & (newCapacity - 1)) == 0); // Power of two - desiredSlot masks.
+
+        std::vector<Entry> oldTable{ std::move(m_table) };
+        m_table = std::vector<Entry>(newCapacity);
+
+        for (const Entry & entry : oldTable)
+        {
+            if (entry.index != NullIndex)
+            {
+                insertNoGrow(entry.hash, entry.index);
+            }
+        }
+    }
+
+private:
+
+    std::vector<Entry> m_table;
+    int   m_count         = 0;
+    float m_maxLoadFactor = 0.75f;
+};
+
+template<typename IndexType, typename HashType>
+constexpr IndexType FlatHashIndex<IndexType, HashType>::NullIndex;
+
+template<typename IndexType, typename HashType>
+constexpr int FlatHashIndex<IndexType, HashType>::MinCapacity;
+
 } // namespace VkToolbox
@@ -8,12 +8,19 @@
 
 #include "Image.hpp"
 #include "Log.hpp"
+#include "JobSystem.hpp"
+#include "CpuProfiler.hpp"
 
 // STB image libraries:
 #include "stb/stb_image.h"
 #include "stb/stb_image_write.h"
 #include "stb/stb_image_resize.h"
 
+// SSE2 intrinsics for the fast mipmap downsampling path.
+#include <emmintrin.h>
+
+#include <climits>
+
 namespace VkToolbox
 {
 
@@ -413,8 +420,78 @@ void Image::flipHInPlace(const int surfaceIndex)
     }
 }
 
+// ========================================================
+// SIMD mipmap downsampling:
+// ========================================================
+
+// 2x2 box filter for RGBA8 surfaces, vectorized with SSE2 (baseline on x64).
+// Each iteration loads 4 source pixels from two adjacent rows and produces 2
+// averaged output pixels, so the whole level is done 8 input pixels at a time.
+// Used on the successive-halving path where each mip is built from the one
+// above it - for a power-of-two image the 2x2 box average is exact, so no
+// error accumulates down the chain.
+static void Image_downsampleBoxRGBA8_SSE2(const std::uint8_t * const src, const int srcWidth, const int srcHeight,
+                                          std::uint8_t * const dst, const int dstWidth, const int dstHeight)
+{
+    assert(srcWidth  >= 1 && srcHeight >= 1);
+    assert(dstWidth  == std::max(1, srcWidth  / 2));
+    assert(dstHeight == std::max(1, srcHeight / 2));
+
+    const int srcPitch  = srcWidth * 4;
+    const int dstPitch  = dstWidth * 4;
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi16(2);
+
+    for (int y = 0; y < dstHeight; ++y)
+    {
+        const std::uint8_t * const row0 = src + ((y * 2) * srcPitch);
+        const std::uint8_t * const row1 = (srcHeight > 1) ? (row0 + srcPitch) : row0;
+        std::uint8_t * const outRow = dst + (y * dstPitch);
+
+        int x = 0;
+        for (; x <= (dstWidth - 2); x += 2)
+        {
+            // 4 source pixels from each row -> 2 output pixels:
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + (x * 8)));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + (x * 8)));
+
+            // Widen to 16 bits and add the two rows together:
+            const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+            const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+
+            // Fold the horizontal pixel pairs, round and divide by 4:
+            const __m128i s0 = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+            const __m128i s1 = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+            __m128i avg = _mm_unpacklo_epi64(s0, s1);
+            avg = _mm_srli_epi16(_mm_add_epi16(avg, round), 2);
+
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(outRow + (x * 4)),
+                             _mm_packus_epi16(avg, avg));
+        }
+
+        // Scalar tail for the 1-pixel-wide levels of non-square images:
+        for (; x < dstWidth; ++x)
+        {
+            const std::uint8_t * const p00 = row0 + ((x * 2) * 4);
+            const std::uint8_t * const p01 = ((x * 2) + 1 < srcWidth) ? (p00 + 4) : p00;
+            const std::uint8_t * const p10 = row1 + ((x * 2) * 4);
+            const std::uint8_t * const p11 = ((x * 2) + 1 < srcWidth) ? (p10 + 4) : p10;
+
+            for (int c = 0; c < 4; ++c)
+            {
+                outRow[(x * 4) + c] = static_cast<std::uint8_t>(
+                        (p00[c] + p01[c] + p10[c] + p11[c] + 2) / 4);
+            }
+        }
+    }
+}
+
+// ========================================================
+
 void Image::generateMipmapSurfaces()
 {
+    VKTB_PROFILE_SCOPE("Image::generateMipmapSurfaces");
+
     assert(isValid());
 
     if (size().width == 1 && size().height == 1)
@@ -464,6 +541,11 @@ void Image::generateMipmapSurfaces()
     // Also update the image's memory statistics.
     m_memoryUsageBytes += mipmapBytes;
 
+    // The common RGBA8 power-of-two case goes through the vectorized 2x2 box
+    // filter, halving each level from the previous one. Everything else falls
+    // back to the scalar stbir resize from the base surface.
+    const bool useSimdFastPath = (m_format == Format::RGBA8 && isPowerOfTwo());
+
     // Now build the mipmap surfaces:
     std::uint8_t * mipDataPtr = m_rawDataMipmapSurfaces.get();
     targetWidth  = initialWidth;
@@ -475,23 +557,32 @@ void Image::generateMipmapSurfaces()
         targetWidth  = std::max(1, targetWidth  / 2);
         targetHeight = std::max(1, targetHeight / 2);
 
-        // NOTE:
-        // Should this be stbir_resize_uint8_srgb() instead?
-        // Have a flag in Image telling if it is sRGB, maybe?
-        stbir_resize_uint8(
-            // Source Image:
-            initialImage,
-            initialWidth,
-            initialHeight,
-            0,
-            // Destination Image:
-            mipDataPtr,
-            targetWidth,
-            targetHeight,
-            0,
-            // # Image channels:
-            channelCount()
-        );
+        if (useSimdFastPath)
+        {
+            const ImageSurface & prevSurf = m_surfaces[mipmapCount - 1];
+            Image_downsampleBoxRGBA8_SSE2(prevSurf.rawData, prevSurf.size.width, prevSurf.size.height,
+                                          mipDataPtr, targetWidth, targetHeight);
+        }
+        else
+        {
+            // NOTE:
+            // Should this be stbir_resize_uint8_srgb() instead?
+            // Have a flag in Image telling if it is sRGB, maybe?
+            stbir_resize_uint8(
+                // Source Image:
+                initialImage,
+                initialWidth,
+                initialHeight,
+                0,
+                // Destination Image:
+                mipDataPtr,
+                targetWidth,
+                targetHeight,
+                0,
+                // # Image channels:
+                channelCount()
+            );
+        }
 
         m_surfaces[mipmapCount].rawData     = mipDataPtr;
         m_surfaces[mipmapCount].sizeBytes   = targetWidth * targetHeight * bytesPerPixel();
@@ -847,11 +938,284 @@ struct FileHeaderDX10
 } // namespace DDS
 
 // ========================================================
-// DXTCompressedImage:
+// DXT block compression helpers:
 // ========================================================
 
-bool DXTCompressedImage::initFromFile(const char * const filePath)
+namespace DXTEncoder
+{
+
+// Hand-rolled BC1/BC3/BC4/BC5 block encoders using the classic bounding-box
+// endpoint selection with a small inset. Not as high quality as an exhaustive
+// search, but fast enough to run at load time, and the result is cached to
+// disk anyway (see DXTCompressedImage::saveCacheFile).
+
+// Fetches a 4x4 block of pixels from the source surface, expanding to RGBA and
+// clamping at the borders so non-multiple-of-4 surface sizes are handled.
+static void fetchBlockRGBA(const std::uint8_t * const srcPixels, const int width, const int height,
+                           const int channels, const int blockX, const int blockY,
+                           std::uint8_t outBlock[16 * 4])
+{
+    for (int py = 0; py < 4; ++py)
+    {
+        const int y = std::min(blockY + py, height - 1);
+        for (int px = 0; px < 4; ++px)
+        {
+            const int x = std::min(blockX + px, width - 1);
+            const std::uint8_t * pixel = srcPixels + (((y * width) + x) * channels);
+            std::uint8_t * outPixel = &outBlock[((py * 4) + px) * 4];
+
+            outPixel[0] = pixel[0];
+            outPixel[1] = (channels > 1) ? pixel[1] : pixel[0];
+            outPixel[2] = (channels > 2) ? pixel[2] : pixel[0];
+            outPixel[3] = (channels > 3) ? pixel[3] : 255;
+        }
+    }
+}
+
+static std::uint16_t packRGB565(const std::uint8_t r, const std::uint8_t g, const std::uint8_t b)
+{
+    return static_cast<std::uint16_t>(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+}
+
+static void unpackRGB565(const std::uint16_t color, std::uint8_t outRGB[3])
+{
+    // Expand back to 8 bits with bit replication, like the hardware decoder does.
+    const int r = (color >> 11) & 31;
+    const int g = (color >>  5) & 63;
+    const int b =  color        & 31;
+
+    outRGB[0] = static_cast<std::uint8_t>((r << 3) | (r >> 2));
+    outRGB[1] = static_cast<std::uint8_t>((g << 2) | (g >> 4));
+    outRGB[2] = static_cast<std::uint8_t>((b << 3) | (b >> 2));
+}
+
+// Encodes the RGB part of a 4x4 block as a BC1 color block (8 bytes).
+// Also the color half of a BC3/DXT5 block.
+static void encodeColorBlockBC1(const std::uint8_t block[16 * 4], std::uint8_t * out)
+{
+    int minColor[3] = { 255, 255, 255 };
+    int maxColor[3] = { 0, 0, 0 };
+
+    for (int i = 0; i < 16; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            minColor[c] = std::min(minColor[c], static_cast<int>(block[(i * 4) + c]));
+            maxColor[c] = std::max(maxColor[c], static_cast<int>(block[(i * 4) + c]));
+        }
+    }
+
+    // Inset the bounding box by 1/16th of its extents to reduce quantization noise:
+    for (int c = 0; c < 3; ++c)
+    {
+        const int inset = (maxColor[c] - minColor[c]) >> 4;
+        minColor[c] = std::min(minColor[c] + inset, 255);
+        maxColor[c] = std::max(maxColor[c] - inset, 0);
+    }
+
+    std::uint16_t c0 = packRGB565(static_cast<std::uint8_t>(maxColor[0]),
+                                  static_cast<std::uint8_t>(maxColor[1]),
+                                  static_cast<std::uint8_t>(maxColor[2]));
+    std::uint16_t c1 = packRGB565(static_cast<std::uint8_t>(minColor[0]),
+                                  static_cast<std::uint8_t>(minColor[1]),
+                                  static_cast<std::uint8_t>(minColor[2]));
+
+    // c0 > c1 selects the opaque 4-color mode.
+    if (c0 < c1)
+    {
+        std::swap(c0, c1);
+    }
+
+    // Build the 4-entry palette the same way the decoder will:
+    std::uint8_t palette[4][3];
+    unpackRGB565(c0, palette[0]);
+    unpackRGB565(c1, palette[1]);
+    for (int c = 0; c < 3; ++c)
+    {
+        palette[2][c] = static_cast<std::uint8_t>(((2 * palette[0][c]) + palette[1][c]) / 3);
+        palette[3][c] = static_cast<std::uint8_t>((palette[0][c] + (2 * palette[1][c])) / 3);
+    }
+
+    // Map each pixel to the nearest palette entry:
+    std::uint32_t indexes = 0;
+    for (int i = 15; i >= 0; --i)
+    {
+        const std::uint8_t * pixel = &block[i * 4];
+
+        int bestIndex = 0;
+        int bestDist  = INT_MAX;
+        for (int p = 0; p < 4; ++p)
+        {
+            const int dr = pixel[0] - palette[p][0];
+            const int dg = pixel[1] - palette[p][1];
+            const int db = pixel[2] - palette[p][2];
+            const int dist = (dr * dr) + (dg * dg) + (db * db);
+            if (dist < bestDist)
+            {
+                bestDist  = dist;
+                bestIndex = p;
+            }
+        }
+        indexes = (indexes << 2) | bestIndex;
+    }
+
+    std::memcpy(out + 0, &c0, 2);
+    std::memcpy(out + 2, &c1, 2);
+    std::memcpy(out + 4, &indexes, 4);
+}
+
+// Encodes a single channel of a 4x4 block as a BC4-style alpha block (8 bytes).
+// Used for the alpha half of BC3/DXT5 and for both channels of BC5/ATI2N.
+static void encodeAlphaBlockBC4(const std::uint8_t block[16 * 4], const int channel, std::uint8_t * out)
 {
+    int minAlpha = 255;
+    int maxAlpha = 0;
+
+    for (int i = 0; i < 16; ++i)
+    {
+        const int a = block[(i * 4) + channel];
+        minAlpha = std::min(minAlpha, a);
+        maxAlpha = std::max(maxAlpha, a);
+    }
+
+    // a0 > a1 selects the 8-interpolant mode:
+    // index 0 = a0, index 1 = a1, indexes 2-7 blend between them.
+    out[0] = static_cast<std::uint8_t>(maxAlpha);
+    out[1] = static_cast<std::uint8_t>(minAlpha);
+
+    std::uint64_t indexes = 0;
+    if (maxAlpha > minAlpha)
+    {
+        const int range = maxAlpha - minAlpha;
+        for (int i = 15; i >= 0; --i)
+        {
+            const int a = block[(i * 4) + channel];
+
+            // Nearest of the 8 evenly spaced interpolants, then remapped
+            // to the out-of-order BC4 index scheme described above.
+            const int step = (((maxAlpha - a) * 7) + (range / 2)) / range;
+
+            std::uint64_t index;
+            if      (step == 0) { index = 0; }
+            else if (step == 7) { index = 1; }
+            else                { index = step + 1; }
+
+            indexes = (indexes << 3) | index;
+        }
+    }
+
+    for (int b = 0; b < 6; ++b)
+    {
+        out[2 + b] = static_cast<std::uint8_t>((indexes >> (b * 8)) & 0xFF);
+    }
+}
+
+// Everything a strip job needs, referenced by pointer since the
+// job capture buffer is too small for the whole parameter set.
+struct SurfaceJobContext
+{
+    const std::uint8_t * srcPixels;
+    std::uint8_t *       destBlocks;
+    int                  width;
+    int                  height;
+    int                  channels;
+    std::uint32_t        blockSize;
+    Image::Format        format;
+};
+
+// Compresses the horizontal strips of 4x4 blocks in [firstRow, lastRow).
+static void compressBlockRows(const SurfaceJobContext & ctx, const int firstRow, const int lastRow)
+{
+    const int blocksPerRow = (ctx.width + 3) / 4;
+    std::uint8_t block[16 * 4];
+
+    for (int row = firstRow; row < lastRow; ++row)
+    {
+        std::uint8_t * dest = ctx.destBlocks + (row * blocksPerRow * ctx.blockSize);
+        for (int col = 0; col < blocksPerRow; ++col, dest += ctx.blockSize)
+        {
+            fetchBlockRGBA(ctx.srcPixels, ctx.width, ctx.height, ctx.channels, col * 4, row * 4, block);
+
+            switch (ctx.format)
+            {
+            case Image::Format::DXT1 :
+                encodeColorBlockBC1(block, dest);
+                break;
+            case Image::Format::DXT5 :
+                encodeAlphaBlockBC4(block, 3, dest);
+                encodeColorBlockBC1(block, dest + 8);
+                break;
+            case Image::Format::RGTC1_ATI1N :
+                encodeAlphaBlockBC4(block, 0, dest);
+                break;
+            case Image::Format::RGTC2_ATI2N :
+                encodeAlphaBlockBC4(block, 0, dest);
+                encodeAlphaBlockBC4(block, 1, dest + 8);
+                break;
+            default :
+                assert(false && "Format not supported by the block encoders!");
+            } // switch
+        }
+    }
+}
+
+// Compresses one whole surface, fanning the block rows out over the
+// JobSystem workers when the surface is large enough to be worth it.
+static void compressSurface(const SurfaceJobContext & ctx)
+{
+    const int blockRowCount = (ctx.height + 3) / 4;
+
+    // Below this many block rows the scheduling overhead dominates.
+    constexpr int MinRowsForJobs = 8;
+
+    if (blockRowCount >= MinRowsForJobs)
+    {
+        JobSystem & js = JobSystem::shared();
+        const int grainSize = std::max(1, blockRowCount / (js.workerCount() * 4));
+        const SurfaceJobContext * ctxPtr = &ctx; // parallelFor blocks, so the stack context stays alive.
+
+        js.parallelFor(0, blockRowCount, grainSize,
+                       [ctxPtr](const int rangeStart, const int rangeEnd)
+                       {
+                           compressBlockRows(*ctxPtr, rangeStart, rangeEnd);
+                       });
+    }
+    else
+    {
+        compressBlockRows(ctx, 0, blockRowCount);
+    }
+}
+
+#pragma pack(push, 1)
+
+// Header for the on-disk cache of compressed images ("DXTC" 4cc).
+// The compressed surfaces follow as one contiguous blob, in the
+// same layout produced by allocateImageStorage().
+struct CacheFileHeader
+{
+    std::uint32_t magic;
+    std::uint32_t format;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t mipMapCount;
+    std::uint32_t dataSizeBytes;
+};
+
+#pragma pack(pop)
+
+constexpr std::uint32_t CacheFileMagic = 'CTXD'; // DXTC
+
+} // namespace DXTEncoder
+
+// ========================================================
+// DDS file layout query:
+// ========================================================
+
+bool queryDDSFileLayout(const char * const filePath, DDSFileLayout * const outLayout)
+{
+    assert(filePath  != nullptr);
+    assert(outLayout != nullptr);
+
     ScopedFileHandle fileIn = openFile(filePath, "rb");
     if (fileIn == nullptr)
     {
@@ -874,22 +1238,24 @@ bool DXTCompressedImage::initFromFile(const char * const filePath)
     }
 
     bool dx10;
-    Format pixelFormat;
+    Image::Format pixelFormat;
     std::uint32_t blockSize;
+    std::uint64_t fileOffset = sizeof(DDS::FileHeader);
 
     if (header.pixelFormat.fourCC == '01XD') // 'DX10'
     {
         DDS::FileHeaderDX10 dx10Header;
         readStructFromFile(fileIn, &dx10Header);
+        fileOffset += sizeof(DDS::FileHeaderDX10);
 
         dx10 = true;
         switch (dx10Header.dxgiFormat)
         {
-        case 71 : { pixelFormat = Format::DXT1;        blockSize = 8;  break; }
-        case 74 : { pixelFormat = Format::DXT3;        blockSize = 16; break; }
-        case 77 : { pixelFormat = Format::DXT5;        blockSize = 16; break; }
-        case 80 : { pixelFormat = Format::RGTC1_ATI1N; blockSize = 8;  break; }
-        case 83 : { pixelFormat = Format::RGTC2_ATI2N; blockSize = 16; break; }
+        case 71 : { pixelFormat = Image::Format::DXT1;        blockSize = 8;  break; }
+        case 74 : { pixelFormat = Image::Format::DXT3;        blockSize = 16; break; }
+        case 77 : { pixelFormat = Image::Format::DXT5;        blockSize = 16; break; }
+        case 80 : { pixelFormat = Image::Format::RGTC1_ATI1N; blockSize = 8;  break; }
+        case 83 : { pixelFormat = Image::Format::RGTC2_ATI2N; blockSize = 16; break; }
         default :
             Log::errorF("%s: DDS-DX10 Compression format (%u) not supported!", filePath, dx10Header.dxgiFormat);
             return false;
@@ -900,45 +1266,212 @@ bool DXTCompressedImage::initFromFile(const char * const filePath)
         dx10 = false;
         switch (header.pixelFormat.fourCC)
         {
-        case '1TXD' : { pixelFormat = Format::DXT1; blockSize = 8;  break; }
-        case '3TXD' : { pixelFormat = Format::DXT3; blockSize = 16; break; }
-        case '5TXD' : { pixelFormat = Format::DXT5; blockSize = 16; break; }
+        case '1TXD' : { pixelFormat = Image::Format::DXT1; blockSize = 8;  break; }
+        case '3TXD' : { pixelFormat = Image::Format::DXT3; blockSize = 16; break; }
+        case '5TXD' : { pixelFormat = Image::Format::DXT5; blockSize = 16; break; }
         default :
             Log::errorF("%s: DDS Compression format (%#x) not supported!", filePath, header.pixelFormat.fourCC);
             return false;
         } // switch
     }
 
-    //
-    // Read in all the precomputed DDS mipmap levels:
-    //
+    Log::debugF("DDS layout '%s': (w:%u, h:%u, mipmaps:%u, blockSize:%u, format:%s, dx10:%c)",
+                filePath, header.width, header.height, header.mipMapCount, blockSize,
+                Image::FormatStrings[pixelFormat], (dx10 ? 'y' : 'n'));
+
+    outLayout->format       = pixelFormat;
+    outLayout->blockSize    = blockSize;
+    outLayout->surfaceCount = 0;
 
     std::uint32_t w = header.width;
     std::uint32_t h = header.height;
-    allocateImageStorage(w, h, header.mipMapCount, blockSize, pixelFormat);
 
-    Log::debugF("Load DDS '%s': (w:%u, h:%u, mipmaps:%u, blockSize:%u, format:%s, dx10:%c)",
-                filePath, w, h, header.mipMapCount, blockSize, Image::FormatStrings[pixelFormat], (dx10 ? 'y' : 'n'));
-
-    for (std::uint32_t i = 0; (i < header.mipMapCount) && (i < MaxSurfaces); ++i)
+    for (std::uint32_t i = 0; (i < header.mipMapCount) && (i < Image::MaxSurfaces); ++i)
     {
-        // Deduce # of bytes
         // Close to the higher mipmap levels, w or h may become 0; keep things at 1
         if (w == 0) { w = 1; }
         if (h == 0) { h = 1; }
-        const std::size_t numBytes = ((w + 3) / 4) * ((h + 3) / 4) * blockSize;
+        const std::uint32_t numBytes = ((w + 3) / 4) * ((h + 3) / 4) * blockSize;
 
+        DDSFileLayout::SurfaceRange & range = outLayout->surfaces[outLayout->surfaceCount++];
+        range.fileOffset  = fileOffset;
+        range.sizeBytes   = numBytes;
+        range.size.width  = w;
+        range.size.height = h;
+
+        fileOffset += numBytes;
+
+        // Next level is half the current size.
+        w /= 2;
+        h /= 2;
+    }
+
+    return true;
+}
+
+// ========================================================
+// DXTCompressedImage:
+// ========================================================
+
+bool DXTCompressedImage::initFromFile(const char * const filePath)
+{
+    DDSFileLayout layout;
+    if (!queryDDSFileLayout(filePath, &layout))
+    {
+        return false;
+    }
+
+    ScopedFileHandle fileIn = openFile(filePath, "rb");
+    if (fileIn == nullptr)
+    {
+        Log::errorF("Failed to load DXT image from '%s' - can't open file!", filePath);
+        return false;
+    }
+
+    //
+    // Read in all the precomputed DDS mipmap levels:
+    //
+
+    allocateImageStorage(layout.surfaces[0].size.width, layout.surfaces[0].size.height,
+                         layout.surfaceCount, layout.blockSize, layout.format);
+    assert(m_surfaces.size() == layout.surfaceCount);
+
+    std::fseek(fileIn, static_cast<long>(layout.surfaces[0].fileOffset), SEEK_SET);
+
+    for (int i = 0; i < layout.surfaceCount; ++i)
+    {
+        const std::size_t numBytes = layout.surfaces[i].sizeBytes;
         if (std::fread(m_surfaces[i].rawData, 1, numBytes, fileIn) != numBytes)
         {
             Log::errorF("%s: Failed to read %zu bytes from DDS file! Stopping...", filePath, numBytes);
             shutdown(); return false;
         }
+    }
 
-        // Next level is half the current size.
-        w /= 2;
-        h /= 2;
+    return true;
+}
+
+bool DXTCompressedImage::initFromUncompressed(const Image & source)
+{
+    assert(!isInitialized());
+
+    if (!source.isValid())
+    {
+        Log::errorF("DXT compression requires a valid source image!");
+        return false;
+    }
+
+    Format targetFormat;
+    std::uint32_t blockSize;
+    switch (source.format())
+    {
+    case Format::R8    : { targetFormat = Format::RGTC1_ATI1N; blockSize = 8;  break; }
+    case Format::RG8   : { targetFormat = Format::RGTC2_ATI2N; blockSize = 16; break; }
+    case Format::RGB8  : { targetFormat = Format::DXT1;        blockSize = 8;  break; }
+    case Format::RGBA8 : { targetFormat = Format::DXT5;        blockSize = 16; break; }
+    default :
+        Log::errorF("Image format %s cannot be DXT compressed!", Image::FormatStrings[source.format()]);
+        return false;
+    } // switch
+
+    const Size2D baseSize = source.size();
+    allocateImageStorage(baseSize.width, baseSize.height, source.surfaceCount(), blockSize, targetFormat);
+    assert(surfaceCount() == source.surfaceCount());
+
+    for (int s = 0; s < surfaceCount(); ++s)
+    {
+        const ImageSurface & srcSurf  = source.surface(s);
+        const ImageSurface & destSurf = m_surfaces[s];
+        assert(srcSurf.size == destSurf.size);
+
+        DXTEncoder::SurfaceJobContext ctx;
+        ctx.srcPixels  = srcSurf.rawData;
+        ctx.destBlocks = destSurf.rawData;
+        ctx.width      = srcSurf.size.width;
+        ctx.height     = srcSurf.size.height;
+        ctx.channels   = source.channelCount();
+        ctx.blockSize  = blockSize;
+        ctx.format     = targetFormat;
+        DXTEncoder::compressSurface(ctx);
+    }
+
+    return true;
+}
+
+bool DXTCompressedImage::initFromCacheFile(const char * const filePath)
+{
+    assert(!isInitialized());
+
+    // A nonexistent cache file is a normal miss - stay quiet
+    // and let the caller compress and cache the image.
+    if (!probeFile(filePath))
+    {
+        return false;
+    }
+
+    ScopedFileHandle fileIn = openFile(filePath, "rb");
+    if (fileIn == nullptr)
+    {
+        return false;
+    }
+
+    DXTEncoder::CacheFileHeader header = {};
+    readStructFromFile(fileIn, &header);
+
+    if (header.magic != DXTEncoder::CacheFileMagic)
+    {
+        Log::warningF("%s: Bad magic in DXT cache file! Recompressing...", filePath);
+        return false;
     }
 
+    const auto pixelFormat = static_cast<Format>(header.format);
+    std::uint32_t blockSize;
+    switch (pixelFormat)
+    {
+    case Format::DXT1        : { blockSize = 8;  break; }
+    case Format::DXT3        : { blockSize = 16; break; }
+    case Format::DXT5        : { blockSize = 16; break; }
+    case Format::RGTC1_ATI1N : { blockSize = 8;  break; }
+    case Format::RGTC2_ATI2N : { blockSize = 16; break; }
+    default :
+        Log::warningF("%s: Bad pixel format in DXT cache file! Recompressing...", filePath);
+        return false;
+    } // switch
+
+    allocateImageStorage(header.width, header.height, header.mipMapCount, blockSize, pixelFormat);
+
+    if (header.dataSizeBytes != m_memoryUsageBytes ||
+        std::fread(m_dxtCompressedData.get(), 1, m_memoryUsageBytes, fileIn) != m_memoryUsageBytes)
+    {
+        Log::warningF("%s: DXT cache file is truncated! Recompressing...", filePath);
+        shutdown();
+        return false;
+    }
+
+    return true;
+}
+
+bool DXTCompressedImage::saveCacheFile(const char * const filePath) const
+{
+    assert(isValid());
+
+    ScopedFileHandle fileOut = openFile(filePath, "wb");
+    if (fileOut == nullptr)
+    {
+        Log::errorF("Failed to open DXT cache file '%s' for writing!", filePath);
+        return false;
+    }
+
+    DXTEncoder::CacheFileHeader header;
+    header.magic         = DXTEncoder::CacheFileMagic;
+    header.format        = static_cast<std::uint32_t>(m_format);
+    header.width         = m_surfaces[0].size.width;
+    header.height        = m_surfaces[0].size.height;
+    header.mipMapCount   = m_surfaces.size();
+    header.dataSizeBytes = m_memoryUsageBytes;
+
+    writeStructToFile(fileOut, header);
+    writeArrayToFile(fileOut, m_dxtCompressedData.get(), m_memoryUsageBytes);
     return true;
 }
 
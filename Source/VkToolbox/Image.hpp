@@ -203,6 +203,7 @@ public:
         bool roundDownToPowerOfTwo = false; // Image is rounded DOWN to its nearest PoT size if not already.
         bool roundUpToPowerOfTwo   = false; // Image is rounded UP to its nearest PoT size if not already.
         bool generateMipmaps       = false; // Trigger mipmap surface generation after loading images from file.
+        bool compressToDXT         = false; // Texture loads run the image through DXTCompressedImage::initFromUncompressed().
     };
 
     // Global options for when loading Images with initFromFile().
@@ -418,6 +419,18 @@ public:
     bool initFromFile(const char * filePath);
     void shutdown();
 
+    // Compress an uncompressed image (and all of its mipmap surfaces) on the CPU.
+    // The target format is picked from the source channel count: R8 => ATI1N,
+    // RG8 => ATI2N, RGB8 => DXT1, RGBA8 => DXT5. The 4x4 block encoders run in
+    // parallel over the JobSystem workers for large surfaces.
+    bool initFromUncompressed(const Image & source);
+
+    // Load/save the compressed surfaces from/to a cache file on disk, so the CPU
+    // cost of initFromUncompressed() is only paid once per source image. A missing
+    // cache file is a normal cache miss, not an error, so it is not logged.
+    bool initFromCacheFile(const char * filePath);
+    bool saveCacheFile(const char * filePath) const;
+
     // Miscellaneous info queries:
     bool isInitialized() const;
     bool isValidAllSurfaces() const;
@@ -451,6 +464,34 @@ private:
     FixedSizeArray<ImageSurface, MaxSurfaces> m_surfaces;
 };
 
+// ========================================================
+// DDS file layout query:
+// ========================================================
+
+// Describes where each mipmap surface of a DDS file lives on disk, without
+// touching any of the pixel data. This is what lets the streamed texture
+// loader (Texture.cpp) issue asynchronous reads of the individual mip levels
+// straight into staging memory, bypassing the in-memory image copy.
+struct DDSFileLayout
+{
+    struct SurfaceRange
+    {
+        std::uint64_t fileOffset; // Absolute byte offset of the surface in the file.
+        std::uint32_t sizeBytes;  // Size of the compressed surface data.
+        Size2D        size;       // Width/height of the surface.
+    };
+
+    Image::Format format;
+    std::uint32_t blockSize;
+    int           surfaceCount;
+    SurfaceRange  surfaces[Image::MaxSurfaces];
+};
+
+// Parses just the DDS header(s) and fills outLayout. All the format
+// validation DXTCompressedImage::initFromFile() does lives here, so both
+// the streamed and the in-memory loaders reject the same files.
+bool queryDDSFileLayout(const char * filePath, DDSFileLayout * outLayout);
+
 // ========================================================
 // Image inline methods:
 // ========================================================
@@ -23,9 +23,16 @@ namespace VkToolbox
 // ========================================================
 
 JobQueue::JobQueue(const char * const threadName)
-    : m_terminating{ false }
+    : m_slots{ new Slot[QueueCapacity] }
+    , m_terminating{ false }
     , m_threadName{ threadName }
 {
+    static_assert((QueueCapacity & (QueueCapacity - 1)) == 0, "QueueCapacity must be a power of two!");
+
+    for (std::uint32_t s = 0; s < QueueCapacity; ++s)
+    {
+        m_slots[s].sequence.store(s, std::memory_order_relaxed);
+    }
 }
 
 JobQueue::~JobQueue()
@@ -33,10 +40,11 @@ JobQueue::~JobQueue()
     if (m_worker.joinable())
     {
         waitAll();
-        m_mutex.lock();
-        m_terminating = true;
-        m_condition.notify_one();
-        m_mutex.unlock();
+        {
+            std::lock_guard<std::mutex> lock{ m_wakeUpMutex };
+            m_terminating.store(true);
+        }
+        m_wakeUpCondition.notify_all();
         m_worker.join();
     }
 }
@@ -47,17 +55,103 @@ void JobQueue::launch()
     m_worker = std::thread{ &JobQueue::queueLoop, this };
 }
 
+bool JobQueue::tryPush(Job & job)
+{
+    std::uint32_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        Slot & slot = m_slots[pos & (QueueCapacity - 1)];
+        const auto seq = slot.sequence.load(std::memory_order_acquire);
+        const auto dif = static_cast<std::int32_t>(seq - pos);
+
+        if (dif == 0) // Slot free - try to claim the ticket:
+        {
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                slot.job = std::move(job);
+                slot.sequence.store(pos + 1, std::memory_order_release); // Publish.
+                return true;
+            }
+            // CAS failed - pos was reloaded, try again.
+        }
+        else if (dif < 0)
+        {
+            return false; // Ring is full.
+        }
+        else // Another producer claimed this ticket - reload:
+        {
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool JobQueue::tryPop(Job * outJob)
+{
+    Slot & slot = m_slots[m_dequeuePos & (QueueCapacity - 1)];
+    const auto seq = slot.sequence.load(std::memory_order_acquire);
+
+    if (static_cast<std::int32_t>(seq - (m_dequeuePos + 1)) < 0)
+    {
+        return false; // Ring is empty (or the next job is still being written).
+    }
+
+    (*outJob)  = std::move(slot.job);
+    slot.job   = nullptr; // Release any captures right away.
+    slot.sequence.store(m_dequeuePos + QueueCapacity, std::memory_order_release);
+
+    ++m_dequeuePos;
+    return true;
+}
+
 void JobQueue::pushJob(Job job)
 {
-    std::lock_guard<std::mutex> lock{ m_mutex };
-    m_queue.push(std::move(job));
-    m_condition.notify_one();
+    // The counter bump must happen under the wake mutex, like ~JobQueue()
+    // does for m_terminating - otherwise it can land between the worker's
+    // predicate check and its block, the notify is lost and the job sits
+    // in the ring until some future push (and waitAll() hangs with it).
+    {
+        std::lock_guard<std::mutex> lock{ m_wakeUpMutex };
+        m_pendingJobs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    while (!tryPush(job))
+    {
+        // Ring full - back off until the worker makes room.
+        std::this_thread::yield();
+    }
+
+    m_wakeUpCondition.notify_one();
+}
+
+void JobQueue::pushJobs(Job * const jobs, const int count)
+{
+    assert(jobs != nullptr);
+
+    // Under the wake mutex for the same reason as pushJob().
+    {
+        std::lock_guard<std::mutex> lock{ m_wakeUpMutex };
+        m_pendingJobs.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    for (int j = 0; j < count; ++j)
+    {
+        while (!tryPush(jobs[j]))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // Single wake for the whole batch.
+    m_wakeUpCondition.notify_one();
 }
 
 void JobQueue::waitAll()
 {
-    std::unique_lock<std::mutex> lock{ m_mutex };
-    m_condition.wait(lock, [this]() { return m_queue.empty(); });
+    std::unique_lock<std::mutex> lock{ m_wakeUpMutex };
+    m_wakeUpCondition.wait(lock, [this]()
+    {
+        return m_pendingJobs.load(std::memory_order_acquire) == 0;
+    });
 }
 
 void JobQueue::queueLoop()
@@ -70,23 +164,31 @@ void JobQueue::queueLoop()
     for (;;)
     {
         Job job;
-
+        if (tryPop(&job))
         {
-            std::unique_lock<std::mutex> lock{ m_mutex };
-            m_condition.wait(lock, [this] { return !m_queue.empty() || m_terminating; });
-            if (m_terminating)
+            job();
+            job = nullptr;
+
+            if (m_pendingJobs.fetch_sub(1, std::memory_order_release) == 1)
             {
-                break;
+                // Last pending job done - waitAll() callers may be sleeping.
+                // Taking the lock ensures a caller that read the old count is
+                // fully blocked before the notify, so the wake can't be lost.
+                std::lock_guard<std::mutex> lock{ m_wakeUpMutex };
+                m_wakeUpCondition.notify_all();
             }
-            job = m_queue.front();
+            continue;
         }
 
-        job();
+        std::unique_lock<std::mutex> lock{ m_wakeUpMutex };
+        m_wakeUpCondition.wait(lock, [this]()
+        {
+            return m_pendingJobs.load(std::memory_order_acquire) != 0 || m_terminating.load();
+        });
 
+        if (m_terminating.load())
         {
-            std::lock_guard<std::mutex> lock{ m_mutex };
-            m_queue.pop();
-            m_condition.notify_one();
+            break;
         }
     }
 }
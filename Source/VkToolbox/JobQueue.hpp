@@ -10,7 +10,7 @@
 #include "InPlaceFunction.hpp"
 
 #include <array>
-#include <queue>
+#include <atomic>
 #include <memory>
 
 #include <condition_variable>
@@ -36,9 +36,17 @@ public:
     // Launch the worker thread.
     void launch();
 
-    // Add a new job to the thread's queue.
+    // Add a new job to the thread's queue. Safe to call from any thread - the
+    // jobs sit in a bounded lock-free MPSC slot ring, so there is no mutex and
+    // no per-job allocation on this path. If the ring is full (QueueCapacity
+    // jobs already in flight) the call spins until the worker makes room.
     void pushJob(Job job);
 
+    // Publish a batch of jobs with a single wake of the worker thread,
+    // instead of one wake per job. Preferred when flooding many jobs at
+    // once (e.g. the texture load requests).
+    void pushJobs(Job * jobs, int count);
+
     // Wait until all work items have been completed.
     void waitAll();
 
@@ -47,15 +55,40 @@ public:
 
 private:
 
+    // Size of the job slot ring, which bounds the number of in-flight
+    // jobs. Must be a power of two (the ring indexes with a mask).
+    static constexpr std::uint32_t QueueCapacity = 4096;
+
+    // One ring entry. The sequence number tells producers/consumer whether
+    // the slot is free to write or holds a published job (Vyukov's bounded
+    // queue scheme), so out-of-order producers never hand the worker a
+    // half-written job.
+    struct Slot
+    {
+        std::atomic<std::uint32_t> sequence;
+        Job                        job;
+    };
+
+    // Single push/pop attempt. tryPush fails when the ring is full,
+    // tryPop when it is empty. tryPop is worker-thread only (SC).
+    bool tryPush(Job & job);
+    bool tryPop(Job * outJob);
+
     // Loop through all remaining jobs. This is the worker thread entry point.
     void queueLoop();
 
-    bool                    m_terminating;
-    std::thread             m_worker;
-    std::mutex              m_mutex;
-    std::condition_variable m_condition;
-    std::queue<Job>         m_queue;
-    const char * const      m_threadName;
+    std::unique_ptr<Slot[]>    m_slots;
+    std::atomic<std::uint32_t> m_enqueuePos{ 0 };
+    std::uint32_t              m_dequeuePos{ 0 }; // Owned by the worker thread.
+
+    // Pushed but not yet run to completion - this is what waitAll() drains.
+    std::atomic<int>           m_pendingJobs{ 0 };
+
+    std::atomic<bool>          m_terminating;
+    std::thread                m_worker;
+    std::mutex                 m_wakeUpMutex;
+    std::condition_variable    m_wakeUpCondition;
+    const char * const         m_threadName;
 };
 
 // ========================================================
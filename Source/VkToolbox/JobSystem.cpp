@@ -0,0 +1,346 @@
+
+// ================================================================================================
+// File: VkToolbox/JobSystem.cpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Work-stealing job scheduler.
+// ================================================================================================
+
+#include "JobSystem.hpp"
+#include "JobQueue.hpp" // For setThisThreadName
+#include "Log.hpp"
+
+#include <cstdio>
+
+namespace VkToolbox
+{
+
+// ========================================================
+// class JobSystem:
+// ========================================================
+
+namespace
+{
+
+// Which JobSystem (if any) owns the calling thread, and its worker slot in it.
+thread_local JobSystem * tls_ownerJobSystem = nullptr;
+thread_local int         tls_workerIndex    = -1;
+
+} // namespace
+
+JobSystem::JobSystem(const char * const name, const int workerCount)
+    : m_workerCount{ workerCount }
+    , m_name{ name }
+{
+}
+
+JobSystem::~JobSystem()
+{
+    shutdown();
+}
+
+void JobSystem::launch()
+{
+    assert(!isLaunched()); // Not already launched!
+
+    if (m_workerCount <= 0)
+    {
+        // Leave one core for the thread that drives us (usually the main thread).
+        const int coreCount = static_cast<int>(std::thread::hardware_concurrency());
+        m_workerCount = (coreCount > 1 ? coreCount - 1 : 1);
+    }
+
+    m_workers.reset(new Worker[m_workerCount]);
+    for (int w = 0; w < m_workerCount; ++w)
+    {
+        std::snprintf(m_workers[w].name, sizeof(m_workers[w].name), "%s_%i", m_name, w);
+        m_workers[w].thread = std::thread{ &JobSystem::workerLoop, this, w };
+    }
+
+    Log::debugF("JobSystem '%s' launched with %i worker threads.", m_name, m_workerCount);
+}
+
+void JobSystem::shutdown()
+{
+    if (!isLaunched())
+    {
+        return;
+    }
+
+    waitAll();
+
+    {
+        std::lock_guard<std::mutex> lock{ m_wakeUpMutex };
+        m_terminating = true;
+    }
+    m_wakeUpCondition.notify_all();
+
+    for (int w = 0; w < m_workerCount; ++w)
+    {
+        m_workers[w].thread.join();
+    }
+    m_workers = nullptr;
+}
+
+JobSystem::JobHandle JobSystem::pushJob(Job job)
+{
+    JobHandle counter = std::make_shared<JobCounter>();
+    counter->m_pendingJobs.store(1, std::memory_order_relaxed);
+    m_activeJobs.fetch_add(1);
+
+    WorkItem item;
+    item.fn      = std::move(job);
+    item.counter = counter;
+
+    enqueue(std::move(item));
+    return counter;
+}
+
+JobSystem::JobHandle JobSystem::pushJob(Job job, const JobHandle & dependsOn)
+{
+    if (dependsOn == nullptr)
+    {
+        return pushJob(std::move(job));
+    }
+
+    JobHandle counter = std::make_shared<JobCounter>();
+    counter->m_pendingJobs.store(1, std::memory_order_relaxed);
+    m_activeJobs.fetch_add(1);
+
+    WorkItem item;
+    item.fn      = std::move(job);
+    item.counter = counter;
+
+    {
+        // If the dependency is still in flight, park the job on it. runJob()
+        // takes the same lock before flushing the dependents, so the job is
+        // either submitted there or right below - never dropped, never twice.
+        std::lock_guard<std::mutex> lock{ dependsOn->m_dependentsMutex };
+        if (!dependsOn->isDone())
+        {
+            dependsOn->m_dependents.push_back(std::move(item));
+            return counter;
+        }
+    }
+
+    enqueue(std::move(item));
+    return counter;
+}
+
+void JobSystem::wait(const JobHandle & handle)
+{
+    if (handle == nullptr)
+    {
+        return;
+    }
+
+    const int ownWorkerIndex = thisWorkerIndex();
+    while (!handle->isDone())
+    {
+        if (!tryRunOneJob(ownWorkerIndex))
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::waitAll()
+{
+    const int ownWorkerIndex = thisWorkerIndex();
+    while (m_activeJobs.load(std::memory_order_acquire) != 0)
+    {
+        if (!tryRunOneJob(ownWorkerIndex))
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::parallelFor(const int rangeStart, const int rangeLength,
+                            const int grainSize, const RangeJob & fn)
+{
+    assert(grainSize > 0);
+
+    if (rangeLength <= 0)
+    {
+        return;
+    }
+
+    const int rangeEnd = rangeStart + rangeLength;
+    if (rangeLength <= grainSize || !isLaunched())
+    {
+        fn(rangeStart, rangeEnd);
+        return;
+    }
+
+    const int chunkCount = (rangeLength + grainSize - 1) / grainSize;
+
+    JobHandle counter = std::make_shared<JobCounter>();
+    counter->m_pendingJobs.store(chunkCount, std::memory_order_relaxed);
+    m_activeJobs.fetch_add(chunkCount);
+
+    // We block until every chunk has run, so referencing
+    // the caller's function object is safe.
+    const RangeJob * const fnPtr = &fn;
+
+    for (int chunkStart = rangeStart; chunkStart < rangeEnd; chunkStart += grainSize)
+    {
+        const int chunkEnd = (chunkStart + grainSize < rangeEnd) ? (chunkStart + grainSize) : rangeEnd;
+
+        WorkItem item;
+        item.fn      = [fnPtr, chunkStart, chunkEnd]() { (*fnPtr)(chunkStart, chunkEnd); };
+        item.counter = counter;
+
+        enqueue(std::move(item));
+    }
+
+    wait(counter);
+}
+
+void JobSystem::enqueue(WorkItem && item)
+{
+    assert(isLaunched());
+
+    // Workers push onto their own deque; outside threads spread the load round-robin.
+    int workerIndex = thisWorkerIndex();
+    if (workerIndex < 0)
+    {
+        workerIndex = m_submitRoundRobin.fetch_add(1) % m_workerCount;
+    }
+
+    Worker & worker = m_workers[workerIndex];
+    {
+        std::lock_guard<std::mutex> lock{ worker.mutex };
+        worker.deque.push_back(std::move(item));
+    }
+
+    // The counter bump happens under the wake mutex, like shutdown() does
+    // for m_terminating, so it can't slip between a sleeping worker's
+    // predicate check and its block and lose the notify. A missed wake
+    // here wouldn't hang (wait()/waitAll() run jobs inline), but it would
+    // quietly cost parallelism.
+    {
+        std::lock_guard<std::mutex> lock{ m_wakeUpMutex };
+        m_queuedJobs.fetch_add(1);
+    }
+    m_wakeUpCondition.notify_one();
+}
+
+bool JobSystem::tryRunOneJob(const int ownWorkerIndex)
+{
+    WorkItem item;
+    bool found = false;
+
+    // Newest-first from our own deque (best cache locality):
+    if (ownWorkerIndex >= 0)
+    {
+        Worker & own = m_workers[ownWorkerIndex];
+        std::lock_guard<std::mutex> lock{ own.mutex };
+        if (!own.deque.empty())
+        {
+            item = std::move(own.deque.back());
+            own.deque.pop_back();
+            found = true;
+        }
+    }
+
+    // Steal oldest-first from somebody else:
+    if (!found)
+    {
+        for (int w = 0; w < m_workerCount && !found; ++w)
+        {
+            if (w == ownWorkerIndex)
+            {
+                continue;
+            }
+
+            Worker & victim = m_workers[w];
+            std::lock_guard<std::mutex> lock{ victim.mutex };
+            if (!victim.deque.empty())
+            {
+                item = std::move(victim.deque.front());
+                victim.deque.pop_front();
+                found = true;
+            }
+        }
+    }
+
+    if (!found)
+    {
+        return false;
+    }
+
+    m_queuedJobs.fetch_sub(1);
+    runJob(item);
+    return true;
+}
+
+void JobSystem::runJob(WorkItem & item)
+{
+    item.fn();
+
+    JobCounter * counter = item.counter.get();
+    if (counter->m_pendingJobs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        // Last job chained to this counter - flush the dependents:
+        std::vector<WorkItem> readyJobs;
+        {
+            std::lock_guard<std::mutex> lock{ counter->m_dependentsMutex };
+            readyJobs.swap(counter->m_dependents);
+        }
+        for (WorkItem & ready : readyJobs)
+        {
+            enqueue(std::move(ready));
+        }
+    }
+
+    m_activeJobs.fetch_sub(1);
+}
+
+int JobSystem::thisWorkerIndex() const
+{
+    return (tls_ownerJobSystem == this ? tls_workerIndex : -1);
+}
+
+void JobSystem::workerLoop(const int workerIndex)
+{
+    tls_ownerJobSystem = this;
+    tls_workerIndex    = workerIndex;
+
+    setThisThreadName(m_workers[workerIndex].name);
+
+    for (;;)
+    {
+        if (tryRunOneJob(workerIndex))
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock{ m_wakeUpMutex };
+        m_wakeUpCondition.wait(lock, [this]()
+        {
+            return m_queuedJobs.load(std::memory_order_acquire) > 0 || m_terminating;
+        });
+
+        if (m_terminating)
+        {
+            break;
+        }
+    }
+}
+
+JobSystem & JobSystem::shared()
+{
+    struct SharedHolder
+    {
+        JobSystem jobSys{ "SharedJobSys" };
+        SharedHolder() { jobSys.launch(); }
+    };
+
+    static SharedHolder holder;
+    return holder.jobSys;
+}
+
+// ========================================================
+
+} // namespace VkToolbox
@@ -0,0 +1,164 @@
+#pragma once
+
+// ================================================================================================
+// File: VkToolbox/JobSystem.hpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Work-stealing job scheduler.
+// ================================================================================================
+
+#include "InPlaceFunction.hpp"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace VkToolbox
+{
+
+// ========================================================
+// class JobSystem:
+// ========================================================
+
+// Work-stealing scheduler: N worker threads, each with its own deque of jobs.
+// A worker pops from the back of its own deque and steals from the front of
+// the others when it runs dry. Unlike JobQueue there is no dedicated thread
+// per queue - jobs fan out over however many workers were launched.
+class JobSystem final
+{
+public:
+
+    // Same job type used by JobQueue, so call sites can migrate freely.
+    using Job = InPlaceFunction32<void()>;
+
+    // Range job for parallelFor - receives [rangeStart, rangeEnd).
+    using RangeJob = InPlaceFunction32<void(int, int)>;
+
+    class JobCounter;
+    using JobHandle = std::shared_ptr<JobCounter>;
+
+    // Worker count <= 0 picks a default based on the available hardware
+    // threads, leaving one core free for the thread that launches us.
+    explicit JobSystem(const char * name, int workerCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem & operator = (const JobSystem &) = delete;
+
+    // Launch the worker threads / join them. Pending jobs are completed on shutdown.
+    void launch();
+    void shutdown();
+    bool isLaunched() const;
+
+    // Add a new job. The returned handle can be waited on or used to chain dependent jobs.
+    JobHandle pushJob(Job job);
+
+    // Add a job that only starts running once the jobs chained to dependsOn have completed.
+    JobHandle pushJob(Job job, const JobHandle & dependsOn);
+
+    // Block until the jobs chained to the handle complete. The calling
+    // thread helps run queued jobs instead of just sleeping.
+    void wait(const JobHandle & handle);
+
+    // Wait until every queued job has been completed.
+    void waitAll();
+
+    // Split [rangeStart, rangeStart + rangeLength) into chunks of at most
+    // grainSize and run them across the workers, blocking until all chunks
+    // have completed. fn is called with the [chunkStart, chunkEnd) bounds.
+    void parallelFor(int rangeStart, int rangeLength, int grainSize, const RangeJob & fn);
+
+    int workerCount() const;
+
+    // Global scheduler shared by the engine subsystems. Launched on first use.
+    static JobSystem & shared();
+
+    // ========================================================
+    // class JobCounter:
+    // ========================================================
+
+    // Tracks completion of one or more jobs. Held by shared pointer
+    // (JobHandle) so handles can outlive the jobs they reference.
+    class JobCounter final
+    {
+    public:
+
+        bool isDone() const { return m_pendingJobs.load(std::memory_order_acquire) == 0; }
+
+    private:
+
+        friend class JobSystem;
+
+        struct DependentJob
+        {
+            Job       fn;
+            JobHandle counter;
+        };
+
+        std::atomic<int>          m_pendingJobs{ 0 };
+        std::mutex                m_dependentsMutex;
+        std::vector<DependentJob> m_dependents; // Submitted once the pending count hits zero.
+    };
+
+private:
+
+    using WorkItem = JobCounter::DependentJob;
+
+    struct Worker
+    {
+        std::thread          thread;
+        std::deque<WorkItem> deque;
+        std::mutex           mutex;
+        char                 name[64];
+    };
+
+    // Worker thread entry point.
+    void workerLoop(int workerIndex);
+
+    // Push a ready-to-run item onto one of the worker deques.
+    void enqueue(WorkItem && item);
+
+    // Pop or steal a single job and run it. Returns false if every deque was empty.
+    bool tryRunOneJob(int ownWorkerIndex);
+
+    // Run the job, decrement its counter and submit any dependents that became ready.
+    void runJob(WorkItem & item);
+
+    // Index of the calling thread if it is one of our workers, else -1.
+    int thisWorkerIndex() const;
+
+    std::unique_ptr<Worker[]>  m_workers;
+    int                        m_workerCount;
+    const char * const         m_name;
+
+    std::atomic<bool>          m_terminating{ false };
+    std::atomic<int>           m_queuedJobs{ 0 };  // Sitting in a deque, not yet picked up.
+    std::atomic<int>           m_activeJobs{ 0 };  // Queued + running + waiting on a dependency.
+    std::atomic<std::uint32_t> m_submitRoundRobin{ 0 };
+
+    std::mutex                 m_wakeUpMutex;
+    std::condition_variable    m_wakeUpCondition;
+};
+
+// ========================================================
+// JobSystem inline methods:
+// ========================================================
+
+inline bool JobSystem::isLaunched() const
+{
+    return (m_workers != nullptr);
+}
+
+inline int JobSystem::workerCount() const
+{
+    return m_workerCount;
+}
+
+// ========================================================
+
+} // namespace VkToolbox
@@ -8,8 +8,15 @@
 
 #include "Log.hpp"
 #include "Utils.hpp"
+#include "JobQueue.hpp" // For setThisThreadName().
 #include <cstdlib>
 
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 #if defined(WIN32) || defined(WIN64)
     #define NOMINMAX 1
     #define WIN32_LEAN_AND_MEAN 1
@@ -27,24 +34,235 @@ static constexpr int  PrintfBufferSize = 2048;
 static constexpr int  PrefixMaxLength  = 128;
 static VerbosityLevel s_verbosityLevel = VerbosityLevel::Debug;
 static FILE *         s_outputStream   = stdout;
+static bool           s_asyncMode      = false;
 
 // ========================================================
 
-static void printLine(const char * prefix, const char * message)
+// Write a finished line to the actual outputs. In async mode
+// only the background thread gets here.
+static void outputLine(const char * line)
 {
-    char buffer[PrintfBufferSize + PrefixMaxLength];
-    const std::size_t n = std::snprintf(buffer, arrayLength(buffer), "%s: %s\n", prefix, message);
-    buffer[n < arrayLength(buffer) ? n : arrayLength(buffer) - 1] = '\0';
-
     // Console or log file:
-    std::fputs(buffer, s_outputStream);
+    std::fputs(line, s_outputStream);
 
     // Visual Studio output window:
     #ifdef _MSC_VER
-    OutputDebugStringA(buffer);
+    OutputDebugStringA(line);
     #endif // _MSC_VER
 }
 
+// ========================================================
+// class AsyncLogBackend:
+// ========================================================
+
+// Bounded MPSC slot ring with a single drain thread - the same Vyukov
+// sequence-number scheme JobQueue uses, but the slots hold finished log
+// lines instead of jobs, so the producer path is a claim plus a string
+// copy and never touches a mutex or the (slow) output stream.
+class AsyncLogBackend final
+{
+public:
+
+    void start()
+    {
+        if (m_worker.joinable())
+        {
+            return; // Already running.
+        }
+
+        if (m_slots == nullptr)
+        {
+            static_assert((RingCapacity & (RingCapacity - 1)) == 0, "RingCapacity must be a power of two!");
+
+            m_slots.reset(new Slot[RingCapacity]);
+            for (std::uint32_t s = 0; s < RingCapacity; ++s)
+            {
+                m_slots[s].sequence.store(s, std::memory_order_relaxed);
+            }
+        }
+
+        m_terminating.store(false);
+        m_worker = std::thread{ &AsyncLogBackend::drainLoop, this };
+    }
+
+    void stop()
+    {
+        if (!m_worker.joinable())
+        {
+            return;
+        }
+
+        waitDrained();
+        {
+            std::lock_guard<std::mutex> lock{ m_wakeUpMutex };
+            m_terminating.store(true);
+        }
+        m_wakeUpCondition.notify_all();
+        m_worker.join();
+    }
+
+    ~AsyncLogBackend()
+    {
+        stop();
+    }
+
+    // Copies the line into the ring. Spins if the ring is full
+    // until the drain thread makes room, so lines are never dropped.
+    void pushLine(const char * const line)
+    {
+        // The counter bump must happen under the wake mutex, like stop()
+        // does for m_terminating - otherwise it can land between the drain
+        // thread's predicate check and its block, the notify is lost and
+        // flush()/stop() hang waiting on a line that never drains.
+        {
+            std::lock_guard<std::mutex> lock{ m_wakeUpMutex };
+            m_pendingLines.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        while (!tryPush(line))
+        {
+            std::this_thread::yield();
+        }
+
+        m_wakeUpCondition.notify_one();
+    }
+
+    // Blocks until every pushed line has reached the output stream.
+    void waitDrained()
+    {
+        std::unique_lock<std::mutex> lock{ m_wakeUpMutex };
+        m_wakeUpCondition.wait(lock, [this]()
+        {
+            return m_pendingLines.load(std::memory_order_acquire) == 0;
+        });
+    }
+
+private:
+
+    // Bounds the number of lines in flight. Must be a power of two.
+    static constexpr std::uint32_t RingCapacity = 1024;
+
+    struct Slot
+    {
+        std::atomic<std::uint32_t> sequence;
+        char line[PrintfBufferSize + PrefixMaxLength];
+    };
+
+    bool tryPush(const char * const line)
+    {
+        std::uint32_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Slot & slot = m_slots[pos & (RingCapacity - 1)];
+            const auto seq = slot.sequence.load(std::memory_order_acquire);
+            const auto dif = static_cast<std::int32_t>(seq - pos);
+
+            if (dif == 0) // Slot free - try to claim the ticket:
+            {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    std::snprintf(slot.line, arrayLength(slot.line), "%s", line);
+                    slot.sequence.store(pos + 1, std::memory_order_release); // Publish.
+                    return true;
+                }
+                // CAS failed - pos was reloaded, try again.
+            }
+            else if (dif < 0)
+            {
+                return false; // Ring is full.
+            }
+            else // Another producer claimed this ticket - reload:
+            {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Drain-thread only. Writes the line straight out of the slot,
+    // so the consumer side never copies.
+    bool tryDrainOne()
+    {
+        Slot & slot = m_slots[m_dequeuePos & (RingCapacity - 1)];
+        const auto seq = slot.sequence.load(std::memory_order_acquire);
+
+        if (static_cast<std::int32_t>(seq - (m_dequeuePos + 1)) < 0)
+        {
+            return false; // Ring is empty (or the next line is still being written).
+        }
+
+        outputLine(slot.line);
+        slot.sequence.store(m_dequeuePos + RingCapacity, std::memory_order_release);
+
+        ++m_dequeuePos;
+        return true;
+    }
+
+    void drainLoop()
+    {
+        setThisThreadName("AsyncLogThread");
+
+        for (;;)
+        {
+            if (tryDrainOne())
+            {
+                if (m_pendingLines.fetch_sub(1, std::memory_order_release) == 1)
+                {
+                    // Ring drained - flush() callers may be sleeping. Taking
+                    // the lock ensures a caller that read the old count is
+                    // fully blocked before the notify, so the wake can't be lost.
+                    std::fflush(s_outputStream);
+                    std::lock_guard<std::mutex> lock{ m_wakeUpMutex };
+                    m_wakeUpCondition.notify_all();
+                }
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock{ m_wakeUpMutex };
+            m_wakeUpCondition.wait(lock, [this]()
+            {
+                return m_pendingLines.load(std::memory_order_acquire) != 0 || m_terminating.load();
+            });
+
+            if (m_terminating.load())
+            {
+                break;
+            }
+        }
+    }
+
+    std::unique_ptr<Slot[]>    m_slots;
+    std::atomic<std::uint32_t> m_enqueuePos{ 0 };
+    std::uint32_t              m_dequeuePos{ 0 }; // Owned by the drain thread.
+
+    // Pushed but not yet written - this is what waitDrained() waits on.
+    std::atomic<int>           m_pendingLines{ 0 };
+
+    std::atomic<bool>          m_terminating{ false };
+    std::thread                m_worker;
+    std::mutex                 m_wakeUpMutex;
+    std::condition_variable    m_wakeUpCondition;
+};
+
+static AsyncLogBackend s_asyncBackend;
+
+// ========================================================
+
+static void printLine(const char * prefix, const char * message)
+{
+    char buffer[PrintfBufferSize + PrefixMaxLength];
+    const std::size_t n = std::snprintf(buffer, arrayLength(buffer), "%s: %s\n", prefix, message);
+    buffer[n < arrayLength(buffer) ? n : arrayLength(buffer) - 1] = '\0';
+
+    if (s_asyncMode)
+    {
+        s_asyncBackend.pushLine(buffer);
+    }
+    else
+    {
+        outputLine(buffer);
+    }
+}
+
 // ========================================================
 
 void setVerbosityLevel(const VerbosityLevel lvl)
@@ -62,6 +280,7 @@ VerbosityLevel verbosityLevel()
 void setOutputStream(FILE* stream)
 {
     assert(stream != nullptr);
+    flush(); // Don't let queued lines land on the new stream.
     s_outputStream = stream;
 }
 
@@ -72,6 +291,42 @@ FILE* outputStream()
 
 // ========================================================
 
+void setAsyncMode(const bool enabled)
+{
+    if (enabled == s_asyncMode)
+    {
+        return;
+    }
+
+    if (enabled)
+    {
+        s_asyncBackend.start();
+        s_asyncMode = true;
+    }
+    else
+    {
+        // Stop producing first, then drain whatever is still queued.
+        s_asyncMode = false;
+        s_asyncBackend.stop();
+    }
+}
+
+bool asyncMode()
+{
+    return s_asyncMode;
+}
+
+void flush()
+{
+    if (s_asyncMode)
+    {
+        s_asyncBackend.waitDrained();
+    }
+    std::fflush(s_outputStream);
+}
+
+// ========================================================
+
 void debugF(VKTB_PRINTF_LIKE const char * fmt, ...)
 {
     if (s_verbosityLevel < VerbosityLevel::Debug)
@@ -125,6 +380,10 @@ void errorF(VKTB_PRINTF_LIKE const char * fmt, ...)
 
 void fatalF(VKTB_PRINTF_LIKE const char * fmt, ...)
 {
+    // Back to synchronous output - this drains the async ring, so everything
+    // logged before the failure hits the stream ahead of the fatal line.
+    setAsyncMode(false);
+
     // Fatal errors always print, unless the log is silent.
     if (s_verbosityLevel != VerbosityLevel::Silent)
     {
@@ -43,6 +43,18 @@ VerbosityLevel verbosityLevel();
 void setOutputStream(FILE* stream);
 FILE* outputStream();
 
+// Default = off. When enabled, callers only pay for the printf formatting:
+// finished lines go into a lock-free ring and a background thread drains
+// them to the output stream, so heavily-logging load phases don't stall
+// on console I/O. fatalF() always flushes the ring and writes its message
+// synchronously before aborting, so no log output is ever lost to a crash.
+void setAsyncMode(bool enabled);
+bool asyncMode();
+
+// Block until every queued message has reached the output stream.
+// A no-op in synchronous mode.
+void flush();
+
 void debugF(VKTB_PRINTF_LIKE const char * fmt, ...);
 void warningF(VKTB_PRINTF_LIKE const char * fmt, ...);
 void errorF(VKTB_PRINTF_LIKE const char * fmt, ...);
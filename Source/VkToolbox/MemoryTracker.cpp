@@ -0,0 +1,292 @@
+
+// ================================================================================================
+// File: VkToolbox/MemoryTracker.cpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Host and device memory usage accounting for the Vulkan context.
+// ================================================================================================
+
+#include "MemoryTracker.hpp"
+#include "VulkanContext.hpp"
+#include "Log.hpp"
+
+#include <malloc.h> // _aligned_offset_malloc and friends
+#include <cassert>
+#include <cstring>
+
+namespace VkToolbox
+{
+
+// ========================================================
+// Host allocation block header:
+// ========================================================
+
+namespace
+{
+
+// Prefixed to every block handed out by the host callbacks. Kept to a fixed
+// 16 bytes so the user pointer right after it honors any sane alignment the
+// driver asks for (the _aligned_offset_* functions align the address at
+// HostAllocHeaderSize bytes past the start of the raw block).
+struct HostAllocHeader
+{
+    std::size_t sizeBytes;
+};
+constexpr std::size_t HostAllocHeaderSize = 16;
+static_assert(sizeof(HostAllocHeader) <= HostAllocHeaderSize, "Header larger than the space reserved for it!");
+
+inline HostAllocHeader * headerFromUserPtr(void * const userPtr)
+{
+    return reinterpret_cast<HostAllocHeader *>(static_cast<char *>(userPtr) - HostAllocHeaderSize);
+}
+
+} // namespace
+
+// ========================================================
+// class MemoryTracker:
+// ========================================================
+
+const char * const MemoryTracker::CategoryNames[CategoryCount] = {
+    "Textures",       // TextureMemory
+    "Vertex/Index",   // GeometryMemory
+    "Uniform",        // UniformMemory
+    "Storage",        // StorageMemory
+    "Staging",        // StagingMemory
+    "Depth targets",  // DepthTargetMemory
+    "Other",          // OtherMemory
+};
+
+MemoryTracker & MemoryTracker::shared()
+{
+    static MemoryTracker s_instance;
+    return s_instance;
+}
+
+MemoryTracker::MemoryTracker()
+{
+    for (int c = 0; c < CategoryCount; ++c)
+    {
+        m_deviceAllocCount[c] = 0;
+        m_deviceAllocBytes[c] = 0;
+    }
+
+    m_hostCallbacks.pUserData             = this;
+    m_hostCallbacks.pfnAllocation         = &MemoryTracker::hostAlloc;
+    m_hostCallbacks.pfnReallocation       = &MemoryTracker::hostRealloc;
+    m_hostCallbacks.pfnFree               = &MemoryTracker::hostFree;
+    m_hostCallbacks.pfnInternalAllocation = &MemoryTracker::hostInternalAlloc;
+    m_hostCallbacks.pfnInternalFree       = &MemoryTracker::hostInternalFree;
+}
+
+const VkAllocationCallbacks * MemoryTracker::hostAllocationCallbacks() const
+{
+    return &m_hostCallbacks;
+}
+
+void * VKAPI_CALL MemoryTracker::hostAlloc(void * const userData, const std::size_t size,
+                                           const std::size_t alignment, const VkSystemAllocationScope allocationScope)
+{
+    (void)allocationScope;
+    if (size == 0)
+    {
+        return nullptr;
+    }
+
+    char * const raw = static_cast<char *>(::_aligned_offset_malloc(size + HostAllocHeaderSize,
+                                                                    alignment, HostAllocHeaderSize));
+    if (raw == nullptr)
+    {
+        return nullptr; // The spec allows failing - the driver handles it.
+    }
+
+    void * const userPtr = raw + HostAllocHeaderSize;
+    headerFromUserPtr(userPtr)->sizeBytes = size;
+
+    auto * tracker = static_cast<MemoryTracker *>(userData);
+    tracker->m_hostAllocCount.fetch_add(1, std::memory_order_relaxed);
+    tracker->m_hostAllocBytes.fetch_add(size, std::memory_order_relaxed);
+    return userPtr;
+}
+
+void * VKAPI_CALL MemoryTracker::hostRealloc(void * const userData, void * const original, const std::size_t size,
+                                             const std::size_t alignment, const VkSystemAllocationScope allocationScope)
+{
+    if (original == nullptr)
+    {
+        return hostAlloc(userData, size, alignment, allocationScope);
+    }
+    if (size == 0)
+    {
+        hostFree(userData, original);
+        return nullptr;
+    }
+
+    const std::size_t oldSize = headerFromUserPtr(original)->sizeBytes;
+
+    char * const raw = static_cast<char *>(::_aligned_offset_realloc(static_cast<char *>(original) - HostAllocHeaderSize,
+                                                                     size + HostAllocHeaderSize,
+                                                                     alignment, HostAllocHeaderSize));
+    if (raw == nullptr)
+    {
+        return nullptr; // Original block is left untouched on failure.
+    }
+
+    void * const userPtr = raw + HostAllocHeaderSize;
+    headerFromUserPtr(userPtr)->sizeBytes = size;
+
+    auto * tracker = static_cast<MemoryTracker *>(userData);
+    tracker->m_hostAllocBytes.fetch_add(static_cast<std::int64_t>(size) - static_cast<std::int64_t>(oldSize),
+                                        std::memory_order_relaxed);
+    return userPtr;
+}
+
+void VKAPI_CALL MemoryTracker::hostFree(void * const userData, void * const memory)
+{
+    if (memory == nullptr)
+    {
+        return; // Freeing null is allowed and common.
+    }
+
+    HostAllocHeader * const header = headerFromUserPtr(memory);
+
+    auto * tracker = static_cast<MemoryTracker *>(userData);
+    tracker->m_hostAllocCount.fetch_sub(1, std::memory_order_relaxed);
+    tracker->m_hostAllocBytes.fetch_sub(header->sizeBytes, std::memory_order_relaxed);
+
+    ::_aligned_free(header);
+}
+
+void VKAPI_CALL MemoryTracker::hostInternalAlloc(void * const userData, const std::size_t size,
+                                                 const VkInternalAllocationType type,
+                                                 const VkSystemAllocationScope allocationScope)
+{
+    // Notification only - the driver did the allocating itself.
+    (void)type; (void)allocationScope;
+    auto * tracker = static_cast<MemoryTracker *>(userData);
+    tracker->m_hostInternalAllocBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void VKAPI_CALL MemoryTracker::hostInternalFree(void * const userData, const std::size_t size,
+                                                const VkInternalAllocationType type,
+                                                const VkSystemAllocationScope allocationScope)
+{
+    (void)type; (void)allocationScope;
+    auto * tracker = static_cast<MemoryTracker *>(userData);
+    tracker->m_hostInternalAllocBytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+void MemoryTracker::trackDeviceAlloc(const Category category, const VkDeviceSize sizeBytes)
+{
+    assert(category >= 0 && category < CategoryCount);
+    m_deviceAllocCount[category].fetch_add(1, std::memory_order_relaxed);
+    m_deviceAllocBytes[category].fetch_add(sizeBytes, std::memory_order_relaxed);
+}
+
+void MemoryTracker::trackDeviceFree(const Category category, const VkDeviceSize sizeBytes)
+{
+    assert(category >= 0 && category < CategoryCount);
+    m_deviceAllocCount[category].fetch_sub(1, std::memory_order_relaxed);
+    m_deviceAllocBytes[category].fetch_sub(sizeBytes, std::memory_order_relaxed);
+}
+
+MemoryTracker::Category MemoryTracker::categoryForBufferUsage(const VkBufferUsageFlags usage)
+{
+    if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
+    {
+        return UniformMemory;
+    }
+    if (usage & (VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT))
+    {
+        return GeometryMemory;
+    }
+    if (usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+    {
+        return StorageMemory;
+    }
+    if (usage == VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
+    {
+        return StagingMemory; // Transfer-source only = pure staging buffer.
+    }
+    return OtherMemory;
+}
+
+MemoryTracker::Category MemoryTracker::categoryForImageUsage(const VkImageUsageFlags usage)
+{
+    if (usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)
+    {
+        return DepthTargetMemory;
+    }
+    if (usage & VK_IMAGE_USAGE_SAMPLED_BIT)
+    {
+        return TextureMemory;
+    }
+    return OtherMemory;
+}
+
+MemoryTracker::Report MemoryTracker::queryReport() const
+{
+    Report report;
+    report.hostAllocCount         = m_hostAllocCount.load(std::memory_order_relaxed);
+    report.hostAllocBytes         = m_hostAllocBytes.load(std::memory_order_relaxed);
+    report.hostInternalAllocBytes = m_hostInternalAllocBytes.load(std::memory_order_relaxed);
+
+    for (int c = 0; c < CategoryCount; ++c)
+    {
+        report.deviceAllocCount[c] = m_deviceAllocCount[c].load(std::memory_order_relaxed);
+        report.deviceAllocBytes[c] = m_deviceAllocBytes[c].load(std::memory_order_relaxed);
+        report.deviceTotalBytes   += report.deviceAllocBytes[c];
+    }
+    return report;
+}
+
+void MemoryTracker::logReport(const VulkanContext & vkContext) const
+{
+    const Report report = queryReport();
+
+    Log::debugF("------ MemoryTracker report ------");
+    Log::debugF("Host allocations:  %lli (%zu KB live, %zu KB driver-internal)",
+                static_cast<long long>(report.hostAllocCount),
+                std::size_t(report.hostAllocBytes / 1024),
+                std::size_t(report.hostInternalAllocBytes / 1024));
+
+    Log::debugF("Device memory by category:");
+    for (int c = 0; c < CategoryCount; ++c)
+    {
+        if (report.deviceAllocCount[c] == 0 && report.deviceAllocBytes[c] == 0)
+        {
+            continue;
+        }
+        Log::debugF("-> %-13s %lli allocs, %zu KB", CategoryNames[c],
+                    static_cast<long long>(report.deviceAllocCount[c]),
+                    std::size_t(report.deviceAllocBytes[c] / 1024));
+    }
+    Log::debugF("Device total:      %zu KB", std::size_t(report.deviceTotalBytes / 1024));
+
+    // Heap budgets straight from the driver, when VK_EXT_memory_budget is there.
+    // 'usage' includes what other processes and the driver itself hold, which is
+    // exactly what our own counters above can't see.
+    const auto budget = vkContext.queryMemoryBudget();
+    if (budget.supported)
+    {
+        for (std::uint32_t h = 0; h < budget.heapCount; ++h)
+        {
+            const bool deviceLocal = (budget.heapFlags[h] & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+            Log::debugF("Heap %u (%s): %zu MB used of %zu MB budget", h,
+                        (deviceLocal ? "device-local" : "host"),
+                        std::size_t(budget.usageBytes[h]  / (1024 * 1024)),
+                        std::size_t(budget.budgetBytes[h] / (1024 * 1024)));
+        }
+    }
+    else
+    {
+        Log::debugF("VK_EXT_memory_budget not available - no heap budget info.");
+    }
+    Log::debugF("----------------------------------");
+
+    // Occupancy/fragmentation details from the slab sub-allocator:
+    vkContext.deviceMemoryAllocator().logStats();
+}
+
+// ========================================================
+
+} // namespace VkToolbox
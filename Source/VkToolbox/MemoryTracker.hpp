@@ -0,0 +1,126 @@
+#pragma once
+
+// ================================================================================================
+// File: VkToolbox/MemoryTracker.hpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Host and device memory usage accounting for the Vulkan context.
+// ================================================================================================
+
+#include <vulkan/vulkan.h>
+#include <atomic>
+#include <cstdint>
+
+namespace VkToolbox
+{
+
+class VulkanContext;
+
+// ========================================================
+// class MemoryTracker:
+// ========================================================
+
+// Accounts for every byte Vulkan touches on our behalf: host-side driver
+// allocations routed through VkAllocationCallbacks and device memory handed
+// out by VulkanContext::createBuffer/createImage, broken down by resource
+// category. VRAM creep that would otherwise only show up as late-frame
+// paging hitches becomes visible in logReport(), next to the actual heap
+// budgets when the driver exposes VK_EXT_memory_budget.
+//
+// The tracker is a process-wide singleton - the host callbacks have to
+// outlive every Vulkan object they allocated for, including the instance.
+// All counters are atomic; resources are created and destroyed from the
+// loader threads as well as the main thread.
+class MemoryTracker final
+{
+public:
+
+    // Device memory is bucketed by what the resource is used for, inferred
+    // from its usage flags (see categoryFor*Usage) so the createBuffer/
+    // createImage call sites don't need to be tagged by hand.
+    enum Category
+    {
+        TextureMemory,     // Sampled images.
+        GeometryMemory,    // Vertex/index buffers.
+        UniformMemory,     // Uniform buffers.
+        StorageMemory,     // SSBOs.
+        StagingMemory,     // Transfer-source-only staging buffers.
+        DepthTargetMemory, // Depth/stencil attachments.
+        OtherMemory,       // Anything that didn't match the above.
+
+        // Number of entries in this enum - internal use.
+        CategoryCount
+    };
+
+    static const char * const CategoryNames[CategoryCount];
+
+    // Point-in-time snapshot of the counters for the report API.
+    struct Report
+    {
+        // Host-side driver allocations made through the callbacks:
+        std::int64_t hostAllocCount         = 0; // Live allocations.
+        std::int64_t hostAllocBytes         = 0; // Live bytes.
+        std::int64_t hostInternalAllocBytes = 0; // Driver-internal, notification only.
+
+        // Device memory per category:
+        std::int64_t deviceAllocCount[CategoryCount] = {};
+        std::int64_t deviceAllocBytes[CategoryCount] = {};
+        std::int64_t deviceTotalBytes                = 0;
+    };
+
+    static MemoryTracker & shared();
+
+    // Counting VkAllocationCallbacks to hand to the API entry points.
+    // VulkanContext adopts these automatically when the caller didn't
+    // provide its own callbacks.
+    const VkAllocationCallbacks * hostAllocationCallbacks() const;
+
+    // Device memory accounting - fed by createBuffer/createImage and the
+    // depth buffer setup in VulkanContext.
+    void trackDeviceAlloc(Category category, VkDeviceSize sizeBytes);
+    void trackDeviceFree(Category category, VkDeviceSize sizeBytes);
+
+    // Best-effort category inference from the resource usage flags.
+    static Category categoryForBufferUsage(VkBufferUsageFlags usage);
+    static Category categoryForImageUsage(VkImageUsageFlags usage);
+
+    // Report API:
+    Report queryReport() const;
+    void logReport(const VulkanContext & vkContext) const;
+
+    // Not copyable.
+    MemoryTracker(const MemoryTracker &) = delete;
+    MemoryTracker & operator = (const MemoryTracker &) = delete;
+
+private:
+
+    MemoryTracker();
+
+    // VkAllocationCallbacks implementation. Each block is prefixed with a
+    // small header holding its size, so the free/realloc sides can keep the
+    // byte counters honest without any lookup table.
+    static void * VKAPI_CALL hostAlloc(void * userData, std::size_t size, std::size_t alignment,
+                                       VkSystemAllocationScope allocationScope);
+    static void * VKAPI_CALL hostRealloc(void * userData, void * original, std::size_t size,
+                                         std::size_t alignment, VkSystemAllocationScope allocationScope);
+    static void VKAPI_CALL hostFree(void * userData, void * memory);
+    static void VKAPI_CALL hostInternalAlloc(void * userData, std::size_t size, VkInternalAllocationType type,
+                                             VkSystemAllocationScope allocationScope);
+    static void VKAPI_CALL hostInternalFree(void * userData, std::size_t size, VkInternalAllocationType type,
+                                            VkSystemAllocationScope allocationScope);
+
+    VkAllocationCallbacks m_hostCallbacks = {};
+
+    // Host-side counters:
+    std::atomic<std::int64_t> m_hostAllocCount{ 0 };
+    std::atomic<std::int64_t> m_hostAllocBytes{ 0 };
+    std::atomic<std::int64_t> m_hostInternalAllocBytes{ 0 };
+
+    // Device-side counters:
+    std::atomic<std::int64_t> m_deviceAllocCount[CategoryCount];
+    std::atomic<std::int64_t> m_deviceAllocBytes[CategoryCount];
+};
+
+// ========================================================
+
+} // namespace VkToolbox
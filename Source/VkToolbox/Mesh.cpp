@@ -7,6 +7,10 @@
 // ================================================================================================
 
 #include "Mesh.hpp"
+#include "MeshOptimizer.hpp"
+#include "CpuProfiler.hpp"
+#include "JobSystem.hpp"
+#include <cfloat>  // For FLT_MAX
 #include <cstddef> // For offsetof()
 #include <cstring> // For mem-ops
 
@@ -87,6 +91,130 @@ const std::array<VkVertexInputAttributeDescription, 6> & MeshVertex::attributeDe
     return s_attributeDescriptions;
 }
 
+// ========================================================
+// MeshVertexPacked:
+// ========================================================
+
+// Scalar float -> half-float conversion (round towards zero,
+// denormals flushed, overflow clamped to infinity).
+static std::uint16_t floatToHalf(const float value)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    const std::uint32_t sign     = (bits >> 16) & 0x8000u;
+    const std::int32_t  exponent = ((bits >> 23) & 0xFF) - 127 + 15;
+    const std::uint32_t mantissa = bits & 0x7FFFFFu;
+
+    if (exponent <= 0)
+    {
+        return static_cast<std::uint16_t>(sign); // Too small - flush to zero.
+    }
+    if (exponent >= 31)
+    {
+        return static_cast<std::uint16_t>(sign | 0x7C00u); // Overflow to infinity.
+    }
+    return static_cast<std::uint16_t>(sign | (exponent << 10) | (mantissa >> 13));
+}
+
+// One signed [-1,1] float into a 10-bit two's complement SNORM field.
+static std::uint32_t packSnorm10(const float value)
+{
+    const float clamped = (value < -1.0f) ? -1.0f : ((value > 1.0f) ? 1.0f : value);
+    const int rounded = static_cast<int>((clamped * 511.0f) + ((clamped >= 0.0f) ? 0.5f : -0.5f));
+    return static_cast<std::uint32_t>(rounded) & 0x3FFu;
+}
+
+// xyz into the 10-bit fields, the w sign (+1/-1) into the 2-bit field.
+static std::uint32_t packSnorm_10_10_10_2(const float x, const float y, const float z, const float wSign)
+{
+    const std::uint32_t w = (wSign >= 0.0f) ? 1u : 3u; // +1 / -1 in 2-bit SNORM
+    return packSnorm10(x) | (packSnorm10(y) << 10) | (packSnorm10(z) << 20) | (w << 30);
+}
+
+static std::uint8_t floatToByteUnorm(const float value)
+{
+    const float clamped = (value < 0.0f) ? 0.0f : ((value > 1.0f) ? 1.0f : value);
+    return static_cast<std::uint8_t>((clamped * 255.0f) + 0.5f);
+}
+
+MeshVertexPacked packMeshVertex(const MeshVertex & vertex)
+{
+    MeshVertexPacked packed;
+    packed.position = vertex.position;
+
+    packed.texcoords[0] = floatToHalf(vertex.texcoords.x);
+    packed.texcoords[1] = floatToHalf(vertex.texcoords.y);
+
+    packed.color = Color32{ floatToByteUnorm(vertex.color.x),
+                            floatToByteUnorm(vertex.color.y),
+                            floatToByteUnorm(vertex.color.z),
+                            floatToByteUnorm(vertex.color.w) };
+
+    // The bitangent is dropped; its handedness relative to cross(N, T)
+    // goes into the tangent's 2-bit w so the shader can rebuild it.
+    const Float3 & n = vertex.normal;
+    const Float3 & t = vertex.tangent;
+    const Float3 & b = vertex.bitangent;
+
+    const float crossX = (n.y * t.z) - (n.z * t.y);
+    const float crossY = (n.z * t.x) - (n.x * t.z);
+    const float crossZ = (n.x * t.y) - (n.y * t.x);
+    const float handedness = (crossX * b.x) + (crossY * b.y) + (crossZ * b.z);
+
+    packed.normal  = packSnorm_10_10_10_2(n.x, n.y, n.z, 1.0f);
+    packed.tangent = packSnorm_10_10_10_2(t.x, t.y, t.z, handedness);
+
+    return packed;
+}
+
+const VkVertexInputBindingDescription & MeshVertexPacked::bindingDescription()
+{
+    static const VkVertexInputBindingDescription s_bindingDescription = {
+        /* binding   = */ 0,
+        /* stride    = */ sizeof(MeshVertexPacked),
+        /* inputRate = */ VK_VERTEX_INPUT_RATE_VERTEX,
+    };
+    return s_bindingDescription;
+}
+
+const std::array<VkVertexInputAttributeDescription, 5> & MeshVertexPacked::attributeDescriptions()
+{
+    static const std::array<VkVertexInputAttributeDescription, 5> s_attributeDescriptions = {{
+        {
+        /* location = */ VSInLocationPosition,
+        /* binding  = */ 0,
+        /* format   = */ VK_FORMAT_R32G32B32_SFLOAT,
+        /* offset   = */ offsetof(MeshVertexPacked, position),
+        },
+        {
+        /* location = */ VSInLocationTexCoords,
+        /* binding  = */ 0,
+        /* format   = */ VK_FORMAT_R16G16_SFLOAT,
+        /* offset   = */ offsetof(MeshVertexPacked, texcoords),
+        },
+        {
+        /* location = */ VSInLocationColor,
+        /* binding  = */ 0,
+        /* format   = */ VK_FORMAT_R8G8B8A8_UNORM,
+        /* offset   = */ offsetof(MeshVertexPacked, color),
+        },
+        {
+        /* location = */ VSInLocationNormal,
+        /* binding  = */ 0,
+        /* format   = */ VK_FORMAT_A2B10G10R10_SNORM_PACK32,
+        /* offset   = */ offsetof(MeshVertexPacked, normal),
+        },
+        {
+        /* location = */ VSInLocationTangent,
+        /* binding  = */ 0,
+        /* format   = */ VK_FORMAT_A2B10G10R10_SNORM_PACK32,
+        /* offset   = */ offsetof(MeshVertexPacked, tangent),
+        },
+    }};
+    return s_attributeDescriptions;
+}
+
 // ========================================================
 // ASSIMP importer helpers:
 // ========================================================
@@ -287,17 +415,15 @@ static void assimpImportMeshMain(const aiScene & inScene, const float vertexScal
     const int submeshCount = inScene.mNumMeshes;
     const aiMesh * const * inSubmeshes = inScene.mMeshes;
 
+    // Lay out the destination ranges first - this is just offset arithmetic
+    // and gives every submesh a disjoint slice of the shared vertex/index
+    // arrays, so the copy/convert work below can run on the job workers
+    // without any synchronization.
     for (int m = 0; m < submeshCount; ++m)
     {
         const int submeshVertCount = inSubmeshes[m]->mNumVertices;
         const int submeshIdxCount  = inSubmeshes[m]->mNumFaces * 3; // Always triangles (aiProcess_Triangulate)
 
-        MeshVertex * destVerts = outMesh.vertexes.data();
-        assimpImportCopyVerts(*inSubmeshes[m], vertexScaling, &destVerts[submeshVertStart]);
-
-        MeshIndex * destIndexes = outMesh.indexes.data();
-        assimpImportCopyIndexes(*inSubmeshes[m], submeshVertStart, &destIndexes[submeshIdxStart]);
-
         outMesh.submeshes[m] = MeshSubSection{
             submeshVertStart, submeshVertCount,
             submeshIdxStart,  submeshIdxCount,
@@ -308,6 +434,31 @@ static void assimpImportMeshMain(const aiScene & inScene, const float vertexScal
         submeshIdxStart  += submeshIdxCount;
     }
 
+    struct SubmeshJobContext
+    {
+        const aiMesh * const * inSubmeshes;
+        Mesh *                 outMesh;
+        float                  vertexScaling;
+    };
+
+    const SubmeshJobContext ctx{ inSubmeshes, &outMesh, vertexScaling };
+    const SubmeshJobContext * ctxPtr = &ctx; // parallelFor blocks, so the stack context stays alive.
+
+    JobSystem::shared().parallelFor(0, submeshCount, 1,
+        [ctxPtr](const int rangeStart, const int rangeEnd)
+        {
+            for (int m = rangeStart; m < rangeEnd; ++m)
+            {
+                const MeshSubSection & sm = ctxPtr->outMesh->submeshes[m];
+
+                MeshVertex * destVerts = ctxPtr->outMesh->vertexes.data();
+                assimpImportCopyVerts(*ctxPtr->inSubmeshes[m], ctxPtr->vertexScaling, &destVerts[sm.vertexStart]);
+
+                MeshIndex * destIndexes = ctxPtr->outMesh->indexes.data();
+                assimpImportCopyIndexes(*ctxPtr->inSubmeshes[m], sm.vertexStart, &destIndexes[sm.indexStart]);
+            }
+        });
+
     //
     // Materials import:
     //
@@ -389,25 +540,60 @@ static bool meshImportWithAssimp(const char * const filePath, const float vertex
 
 const char * const Mesh::BinaryFormatFileExt = ".bmesh";
 
+bool Mesh::sm_memoryMappedBinLoad = true;
+
 Mesh::Mesh(Mesh && other)
     : vertexes { std::move(other.vertexes)  }
     , indexes  { std::move(other.indexes)   }
     , submeshes{ std::move(other.submeshes) }
     , materials{ std::move(other.materials) }
+    , submeshAabbs{ std::move(other.submeshAabbs) }
+    , submeshLods{ std::move(other.submeshLods) }
+    , m_mappedFile{ std::move(other.m_mappedFile) }
+    , m_mappedVertexes{ other.m_mappedVertexes }
+    , m_mappedIndexes{ other.m_mappedIndexes }
+    , m_mappedSubmeshes{ other.m_mappedSubmeshes }
+    , m_mappedMaterials{ other.m_mappedMaterials }
+    , m_mappedAabbs{ other.m_mappedAabbs }
+    , m_mappedLods{ other.m_mappedLods }
 {
+    other.m_mappedVertexes  = {};
+    other.m_mappedIndexes   = {};
+    other.m_mappedSubmeshes = {};
+    other.m_mappedMaterials = {};
+    other.m_mappedAabbs     = {};
+    other.m_mappedLods      = {};
 }
 
 Mesh & Mesh::operator = (Mesh && other)
 {
-    vertexes  = std::move(other.vertexes);
-    indexes   = std::move(other.indexes);
-    submeshes = std::move(other.submeshes);
-    materials = std::move(other.materials);
+    vertexes   = std::move(other.vertexes);
+    indexes    = std::move(other.indexes);
+    submeshes  = std::move(other.submeshes);
+    materials  = std::move(other.materials);
+    submeshAabbs = std::move(other.submeshAabbs);
+    submeshLods  = std::move(other.submeshLods);
+    m_mappedFile      = std::move(other.m_mappedFile);
+    m_mappedVertexes  = other.m_mappedVertexes;
+    m_mappedIndexes   = other.m_mappedIndexes;
+    m_mappedSubmeshes = other.m_mappedSubmeshes;
+    m_mappedMaterials = other.m_mappedMaterials;
+    m_mappedAabbs     = other.m_mappedAabbs;
+    m_mappedLods      = other.m_mappedLods;
+
+    other.m_mappedVertexes  = {};
+    other.m_mappedIndexes   = {};
+    other.m_mappedSubmeshes = {};
+    other.m_mappedMaterials = {};
+    other.m_mappedAabbs     = {};
+    other.m_mappedLods      = {};
     return *this;
 }
 
 bool Mesh::initFromFile(const char * const filePath, const float vertexScaling)
 {
+    VKTB_PROFILE_SCOPE("Mesh::initFromFile");
+
     assert(filePath != nullptr && filePath[0] != '\0');
     if (!probeFile(filePath))
     {
@@ -422,12 +608,26 @@ bool Mesh::initFromFile(const char * const filePath, const float vertexScaling)
     else
     {
         // This can be very slow - prefer the binary format for large models.
-        return meshImportWithAssimp(filePath, vertexScaling, *this);
+        if (!meshImportWithAssimp(filePath, vertexScaling, *this))
+        {
+            return false;
+        }
+
+        // Cook the geometry for the GPU - the result is persisted by
+        // saveBinary() so cooked meshes get this for free at load time.
+        MeshOptimizer::optimizeMesh(*this);
+        computeSubmeshAabbs();
+        MeshOptimizer::buildLodChain(*this);
+        return true;
     }
 }
 
 bool Mesh::isInitialized() const
 {
+    if (isMemoryMapped())
+    {
+        return true;
+    }
     return (!vertexes.empty() && !indexes.empty() && !submeshes.empty());
 }
 
@@ -437,10 +637,22 @@ void Mesh::shutdown()
     indexes.clear();
     submeshes.clear();
     materials.clear();
+    submeshAabbs.clear();
+    submeshLods.clear();
+
+    m_mappedVertexes  = {};
+    m_mappedIndexes   = {};
+    m_mappedSubmeshes = {};
+    m_mappedMaterials = {};
+    m_mappedAabbs     = {};
+    m_mappedLods      = {};
+    m_mappedFile.unmap();
 }
 
 bool Mesh::saveBinary(const char * const filePath) const
 {
+    assert(!isMemoryMapped()); // Only the importer path (heap vectors) can save.
+
     ScopedFileHandle fileOut = openFile(filePath, "wb");
     if (fileOut == nullptr)
     {
@@ -461,11 +673,27 @@ bool Mesh::saveBinary(const char * const filePath) const
     writeArrayToFile(fileOut, submeshes.data(), submeshes.size());
     writeArrayToFile(fileOut, materials.data(), materials.size());
 
+    // Per-submesh AABBs go after the original arrays so files written
+    // before they existed keep the exact same layout up to this point.
+    assert(submeshAabbs.size() == submeshes.size());
+    writeArrayToFile(fileOut, submeshAabbs.data(), submeshAabbs.size());
+
+    // The LOD chains are the last section. Note that the reduced index sets
+    // themselves live inside the main index array above (appended after the
+    // full-detail indexes), so older loaders just carry them along unused.
+    assert(submeshLods.size() == submeshes.size());
+    writeArrayToFile(fileOut, submeshLods.data(), submeshLods.size());
+
     return true;
 }
 
 bool Mesh::loadBinary(const char * const filePath)
 {
+    if (sm_memoryMappedBinLoad)
+    {
+        return mapBinary(filePath);
+    }
+
     ScopedFileHandle fileIn = openFile(filePath, "rb");
     if (fileIn == nullptr)
     {
@@ -498,10 +726,161 @@ bool Mesh::loadBinary(const char * const filePath)
     readArrayFromFile(fileIn, submeshes.data(), submeshes.size());
     readArrayFromFile(fileIn, materials.data(), materials.size());
 
+    // Newer files append the per-submesh AABBs; older ones end here,
+    // in which case the boxes are recomputed from the geometry.
+    submeshAabbs.resize(header.submeshCount);
+    const auto aabbsRead = std::fread(submeshAabbs.data(), sizeof(MeshAabb), header.submeshCount, fileIn);
+    if (aabbsRead != static_cast<std::size_t>(header.submeshCount))
+    {
+        computeSubmeshAabbs();
+    }
+
+    // Same for the per-submesh LOD chains, added later still. Files without
+    // the section get a single full-detail level per submesh.
+    submeshLods.resize(header.submeshCount);
+    const auto lodsRead = std::fread(submeshLods.data(), sizeof(MeshSubmeshLods), header.submeshCount, fileIn);
+    if (lodsRead != static_cast<std::size_t>(header.submeshCount))
+    {
+        initDefaultSubmeshLods();
+    }
+
     Log::debugF("Finished loading binary mesh from '%s'.", filePath);
     return true;
 }
 
+bool Mesh::mapBinary(const char * const filePath)
+{
+    // Shutdown in case the Mesh object is being recycled.
+    if (isInitialized())
+    {
+        shutdown();
+    }
+
+    if (!m_mappedFile.map(filePath))
+    {
+        Log::errorF("Could not memory-map mesh file '%s'.", filePath);
+        return false;
+    }
+
+    const std::uint8_t * ptr = m_mappedFile.baseAddress();
+    const std::uint8_t * const endPtr = ptr + m_mappedFile.sizeBytes();
+
+    const auto * header = reinterpret_cast<const MeshBinaryHeader *>(ptr);
+    if (m_mappedFile.sizeBytes() < sizeof(MeshBinaryHeader) || header->magic != 'HSMB')
+    {
+        Log::errorF("File '%s' is not a binary mesh! Bad magic!", filePath);
+        m_mappedFile.unmap();
+        return false;
+    }
+    ptr += sizeof(MeshBinaryHeader);
+
+    // The geometry arrays are used straight out of the mapped file - zero copies.
+    m_mappedVertexes = make_array_view(reinterpret_cast<const MeshVertex *>(ptr), header->vertexCount);
+    ptr += header->vertexCount * sizeof(MeshVertex);
+
+    m_mappedIndexes = make_array_view(reinterpret_cast<const MeshIndex *>(ptr), header->indexCount);
+    ptr += header->indexCount * sizeof(MeshIndex);
+
+    m_mappedSubmeshes = make_array_view(reinterpret_cast<const MeshSubSection *>(ptr), header->submeshCount);
+    ptr += header->submeshCount * sizeof(MeshSubSection);
+
+    m_mappedMaterials = make_array_view(reinterpret_cast<const MeshMaterial *>(ptr), header->materialCount);
+    ptr += header->materialCount * sizeof(MeshMaterial);
+
+    if (ptr > endPtr)
+    {
+        Log::errorF("Binary mesh file '%s' is truncated!", filePath);
+        shutdown();
+        return false;
+    }
+
+    // Newer files append the per-submesh AABBs; recompute them for older ones.
+    if (ptr + (header->submeshCount * sizeof(MeshAabb)) <= endPtr)
+    {
+        m_mappedAabbs = make_array_view(reinterpret_cast<const MeshAabb *>(ptr), header->submeshCount);
+        ptr += header->submeshCount * sizeof(MeshAabb);
+    }
+    else
+    {
+        computeSubmeshAabbs();
+    }
+
+    // The LOD chains are the last trailing section; files cooked before
+    // them fall back to a single full-detail level per submesh.
+    if (ptr + (header->submeshCount * sizeof(MeshSubmeshLods)) <= endPtr)
+    {
+        m_mappedLods = make_array_view(reinterpret_cast<const MeshSubmeshLods *>(ptr), header->submeshCount);
+    }
+    else
+    {
+        initDefaultSubmeshLods();
+    }
+
+    Log::debugF("Memory-mapped binary mesh '%s' (%zu bytes).", filePath, m_mappedFile.sizeBytes());
+    return true;
+}
+
+void Mesh::computeSubmeshAabbs()
+{
+    const auto verts = vertexArray();
+    const auto subs  = submeshArray();
+
+    submeshAabbs.clear();
+    submeshAabbs.reserve(subs.size());
+
+    for (const MeshSubSection & sm : subs)
+    {
+        MeshAabb box;
+        box.mins = {  FLT_MAX,  FLT_MAX,  FLT_MAX };
+        box.maxs = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+        for (int v = sm.vertexStart; v < (sm.vertexStart + sm.vertexCount); ++v)
+        {
+            const Float3 & p = verts[v].position;
+            box.mins.x = std::min(box.mins.x, p.x);
+            box.mins.y = std::min(box.mins.y, p.y);
+            box.mins.z = std::min(box.mins.z, p.z);
+            box.maxs.x = std::max(box.maxs.x, p.x);
+            box.maxs.y = std::max(box.maxs.y, p.y);
+            box.maxs.z = std::max(box.maxs.z, p.z);
+        }
+
+        submeshAabbs.push_back(box);
+    }
+}
+
+void Mesh::initDefaultSubmeshLods()
+{
+    const auto subs = submeshArray();
+
+    submeshLods.clear();
+    submeshLods.reserve(subs.size());
+
+    for (const MeshSubSection & sm : subs)
+    {
+        MeshSubmeshLods chain = {};
+        chain.levelCount = 1;
+        chain.levels[0].indexStart = sm.indexStart;
+        chain.levels[0].indexCount = sm.indexCount;
+        submeshLods.push_back(chain);
+    }
+}
+
+void Mesh::buildPackedVertexes(std::vector<MeshVertexPacked> * outVertexes) const
+{
+    assert(outVertexes != nullptr);
+
+    const auto verts = vertexArray();
+
+    outVertexes->clear();
+    outVertexes->reserve(verts.size());
+
+    for (const MeshVertex & v : verts)
+    {
+        outVertexes->push_back(packMeshVertex(v));
+    }
+}
+
 // ========================================================
 // MeshMaterial:
 // ========================================================
@@ -57,6 +57,38 @@ struct MeshVertex
     static const std::array<VkVertexInputAttributeDescription, 6> & attributeDescriptions();
 };
 
+// Bandwidth-friendly alternative to MeshVertex - 28 bytes instead of 60.
+// Texcoords are half floats, the color is RGBA8 and the normal/tangent are
+// 10:10:10:2 SNORM packed words, with the bitangent reconstructed in the
+// vertex shader as cross(normal, tangent.xyz) * tangent.w. Convert a mesh
+// with Mesh::buildPackedVertexes() at import time; which format a model's
+// vertex buffer and PSO use is a per-model choice, so the two can be A/B'd.
+struct MeshVertexPacked
+{
+    Float3        position;     // VK_FORMAT_R32G32B32_SFLOAT
+    std::uint16_t texcoords[2]; // VK_FORMAT_R16G16_SFLOAT
+    Color32       color;        // VK_FORMAT_R8G8B8A8_UNORM
+    std::uint32_t normal;       // VK_FORMAT_A2B10G10R10_SNORM_PACK32
+    std::uint32_t tangent;      // VK_FORMAT_A2B10G10R10_SNORM_PACK32 (w = bitangent sign)
+
+    // Locations shared with MeshVertex - there's simply no bitangent
+    // attribute, the shader rebuilds it from normal and tangent.w.
+    static constexpr int VSInLocationPosition  = MeshVertex::VSInLocationPosition;
+    static constexpr int VSInLocationTexCoords = MeshVertex::VSInLocationTexCoords;
+    static constexpr int VSInLocationColor     = MeshVertex::VSInLocationColor;
+    static constexpr int VSInLocationNormal    = MeshVertex::VSInLocationNormal;
+    static constexpr int VSInLocationTangent   = MeshVertex::VSInLocationTangent;
+
+    static const VkVertexInputBindingDescription & bindingDescription();
+    static const std::array<VkVertexInputAttributeDescription, 5> & attributeDescriptions();
+};
+
+static_assert(sizeof(MeshVertexPacked) == 28, "Unexpected padding in MeshVertexPacked structure!");
+
+// Converts one fat import vertex into the packed format. The bitangent
+// handedness sign is recovered from the imported TBN frame.
+MeshVertexPacked packMeshVertex(const MeshVertex & vertex);
+
 struct MeshSubSection
 {
     int vertexStart;
@@ -66,6 +98,37 @@ struct MeshSubSection
     int materialIndex;
 };
 
+// Model-space bounding box of a MeshSubSection - computed at import time
+// and appended to the BMSH binary after the original arrays, so older
+// files stay readable (the loader recomputes the boxes when they are missing).
+struct MeshAabb
+{
+    Float3 mins;
+    Float3 maxs;
+};
+
+// A submesh's index range at one level of detail. The reduced index sets are
+// appended to the mesh's shared index array at import time, so every level
+// draws from the same vertex/index buffers - only the range changes.
+struct MeshLodRange
+{
+    int indexStart;
+    int indexCount;
+};
+
+// Total LOD levels per submesh, counting the full-detail one at level 0.
+constexpr int MeshMaxLodLevels = 4;
+
+// Per-submesh LOD chain - level 0 always aliases the MeshSubSection's own
+// index range, the reduced sets follow in decreasing detail. Built by
+// MeshOptimizer::buildLodChain() at import time and appended to the BMSH
+// binary after the AABBs. Must be a POD for the binary load/saving.
+struct MeshSubmeshLods
+{
+    int levelCount;
+    MeshLodRange levels[MeshMaxLodLevels];
+};
+
 struct MeshMaterialString
 {
     static constexpr int MaxChars = 64;
@@ -127,15 +190,70 @@ public:
 
     static const char * const BinaryFormatFileExt;
 
+    // If set, loadBinary() memory-maps the .bmesh file and the geometry arrays
+    // are used directly out of the mapping, instead of being copied into the
+    // heap vectors below. Always go through the *Array() views so both
+    // representations are handled transparently.
+    static bool sm_memoryMappedBinLoad;
+
+    // Only populated by the importer path (or loadBinary with memory mapping disabled).
     std::vector<MeshVertex>     vertexes;
     std::vector<MeshIndex>      indexes;
     std::vector<MeshSubSection> submeshes;
     std::vector<MeshMaterial>   materials;
+    std::vector<MeshAabb>       submeshAabbs;
+    std::vector<MeshSubmeshLods> submeshLods;
 
-    int vertexCount()   const { return static_cast<int>(vertexes.size());  }
-    int indexCount()    const { return static_cast<int>(indexes.size());   }
-    int submeshCount()  const { return static_cast<int>(submeshes.size()); }
-    int materialCount() const { return static_cast<int>(materials.size()); }
+    int vertexCount()   const { return static_cast<int>(vertexArray().size());   }
+    int indexCount()    const { return static_cast<int>(indexArray().size());    }
+
+    // Count of the full-detail indexes at the front of the index array, i.e.
+    // excluding the reduced LOD sets appended at its tail. Draw this many
+    // indexes from offset 0 to render the whole mesh at full detail when not
+    // going through the per-submesh ranges.
+    int fullDetailIndexCount() const
+    {
+        int count = 0;
+        for (const MeshSubSection & sm : submeshArray())
+        {
+            count += sm.indexCount; // Submesh ranges are laid out back to back from zero.
+        }
+        return count;
+    }
+    int submeshCount()  const { return static_cast<int>(submeshArray().size());  }
+    int materialCount() const { return static_cast<int>(materialArray().size()); }
+
+    // Zero-copy views over the geometry - these point straight into the mapped
+    // file when in memory-mapped mode, into the vectors above otherwise.
+    array_view<const MeshVertex> vertexArray() const
+    {
+        return isMemoryMapped() ? m_mappedVertexes : make_array_view(vertexes);
+    }
+    array_view<const MeshIndex> indexArray() const
+    {
+        return isMemoryMapped() ? m_mappedIndexes : make_array_view(indexes);
+    }
+    array_view<const MeshSubSection> submeshArray() const
+    {
+        return isMemoryMapped() ? m_mappedSubmeshes : make_array_view(submeshes);
+    }
+    array_view<const MeshMaterial> materialArray() const
+    {
+        return isMemoryMapped() ? m_mappedMaterials : make_array_view(materials);
+    }
+    array_view<const MeshAabb> submeshAabbArray() const
+    {
+        // Older mapped files don't carry AABBs - those fall back to the
+        // heap vector filled by computeSubmeshAabbs().
+        return (isMemoryMapped() && !m_mappedAabbs.empty()) ? m_mappedAabbs : make_array_view(submeshAabbs);
+    }
+    array_view<const MeshSubmeshLods> submeshLodArray() const
+    {
+        // Same deal as the AABBs for files that predate the LOD chains.
+        return (isMemoryMapped() && !m_mappedLods.empty()) ? m_mappedLods : make_array_view(submeshLods);
+    }
+
+    bool isMemoryMapped() const { return m_mappedFile.isMapped(); }
 
     Mesh() = default;
 
@@ -152,6 +270,34 @@ public:
     // Write/load the optimized binary representation from file.
     bool saveBinary(const char * filePath) const;
     bool loadBinary(const char * filePath);
+
+    // Rebuilds submeshAabbs from the vertex/submesh arrays. Called by the
+    // importer and by the binary loaders when a file predates the AABBs.
+    void computeSubmeshAabbs();
+
+    // Fills submeshLods with single-level chains aliasing each submesh's full
+    // index range. Used by the binary loaders when a file predates the LOD
+    // section (the reduced sets themselves are only built by the importer -
+    // see MeshOptimizer::buildLodChain).
+    void initDefaultSubmeshLods();
+
+    // Converts the whole vertex set into the compact MeshVertexPacked format.
+    // The fat vertexes are left untouched - the caller picks which set feeds
+    // its vertex buffer.
+    void buildPackedVertexes(std::vector<MeshVertexPacked> * outVertexes) const;
+
+private:
+
+    // Memory-mapped zero-copy loader for the binary format.
+    bool mapBinary(const char * filePath);
+
+    MemoryMappedFile m_mappedFile;
+    array_view<const MeshVertex>     m_mappedVertexes;
+    array_view<const MeshIndex>      m_mappedIndexes;
+    array_view<const MeshSubSection> m_mappedSubmeshes;
+    array_view<const MeshMaterial>   m_mappedMaterials;
+    array_view<const MeshAabb>       m_mappedAabbs;
+    array_view<const MeshSubmeshLods> m_mappedLods;
 };
 
 // ========================================================
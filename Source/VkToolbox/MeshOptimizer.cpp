@@ -0,0 +1,739 @@
+
+// ================================================================================================
+// File: VkToolbox/MeshOptimizer.cpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Import-time mesh optimization passes (vertex cache, overdraw, vertex fetch).
+// ================================================================================================
+
+#include "MeshOptimizer.hpp"
+#include "CpuProfiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace VkToolbox
+{
+
+namespace MeshOptimizer
+{
+
+// ========================================================
+// Forsyth vertex cache optimization:
+// ========================================================
+
+// Tuned as in Forsyth's original "Linear-Speed Vertex Cache Optimisation" writeup.
+constexpr int   CacheSize              = 32;
+constexpr float CacheDecayPower        = 1.5f;
+constexpr float LastTriScore           = 0.75f;
+constexpr float ValenceBoostScale      = 2.0f;
+constexpr float ValenceBoostPower      = 0.5f;
+
+struct OptVertex
+{
+    int   cachePosition; // -1 if not in the simulated cache
+    int   trisTotal;     // Triangles using this vertex
+    int   trisLeft;      // Of those, not yet emitted
+    int   triListOffset; // Into the shared triangle-list array
+    float score;
+};
+
+struct OptTriangle
+{
+    MeshIndex verts[3]; // Local (zero-based) vertex indexes
+    float     score;
+    bool      emitted;
+};
+
+static float vertexScore(const OptVertex & vertex)
+{
+    if (vertex.trisLeft == 0)
+    {
+        return -1.0f; // No triangle needs it anymore.
+    }
+
+    float score = 0.0f;
+    if (vertex.cachePosition >= 0)
+    {
+        if (vertex.cachePosition < 3)
+        {
+            // Was used by the last emitted triangle. A fixed score keeps the
+            // optimizer from simply chewing through one long triangle strip.
+            score = LastTriScore;
+        }
+        else
+        {
+            // Linear falloff towards the back of the cache, curved a little.
+            const float scaled = static_cast<float>(vertex.cachePosition - 3) / (CacheSize - 3);
+            score = std::pow(1.0f - scaled, CacheDecayPower);
+        }
+    }
+
+    // Boost vertexes with few remaining triangles so lone stragglers
+    // don't get stranded until the very end.
+    score += ValenceBoostScale * std::pow(static_cast<float>(vertex.trisLeft), -ValenceBoostPower);
+    return score;
+}
+
+void optimizeVertexCache(MeshIndex * const indexes, const int indexCount,
+                         const MeshIndex minVertex, const int vertexCount)
+{
+    assert(indexes != nullptr);
+    assert(indexCount > 0 && (indexCount % 3) == 0);
+    assert(vertexCount > 0);
+
+    const int triangleCount = indexCount / 3;
+
+    std::vector<OptVertex>   vertexes(vertexCount);
+    std::vector<OptTriangle> triangles(triangleCount);
+    std::vector<int>         vertexTriLists(indexCount); // Each index = one vertex-triangle pairing
+
+    // Count triangles per vertex:
+    for (int v = 0; v < vertexCount; ++v)
+    {
+        vertexes[v] = { -1, 0, 0, 0, 0.0f };
+    }
+    for (int t = 0; t < triangleCount; ++t)
+    {
+        OptTriangle & tri = triangles[t];
+        tri.emitted = false;
+        for (int c = 0; c < 3; ++c)
+        {
+            tri.verts[c] = indexes[(t * 3) + c] - minVertex;
+            assert(tri.verts[c] < static_cast<MeshIndex>(vertexCount));
+            vertexes[tri.verts[c]].trisTotal++;
+        }
+    }
+
+    // Build the per-vertex triangle lists:
+    int listOffset = 0;
+    for (int v = 0; v < vertexCount; ++v)
+    {
+        vertexes[v].triListOffset = listOffset;
+        listOffset += vertexes[v].trisTotal;
+        vertexes[v].trisLeft = vertexes[v].trisTotal;
+        vertexes[v].trisTotal = 0; // Reused as a fill cursor below.
+    }
+    for (int t = 0; t < triangleCount; ++t)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            OptVertex & vert = vertexes[triangles[t].verts[c]];
+            vertexTriLists[vert.triListOffset + vert.trisTotal++] = t;
+        }
+    }
+
+    // Initial scores:
+    for (int v = 0; v < vertexCount; ++v)
+    {
+        vertexes[v].score = vertexScore(vertexes[v]);
+    }
+    float bestScore = -1.0f;
+    int bestTriangle = -1;
+    for (int t = 0; t < triangleCount; ++t)
+    {
+        OptTriangle & tri = triangles[t];
+        tri.score = vertexes[tri.verts[0]].score +
+                    vertexes[tri.verts[1]].score +
+                    vertexes[tri.verts[2]].score;
+        if (tri.score > bestScore)
+        {
+            bestScore = tri.score;
+            bestTriangle = t;
+        }
+    }
+
+    // Simulated LRU cache (3 extra slots for the incoming triangle):
+    int cache[CacheSize + 3];
+    int cacheEntries = 0;
+
+    MeshIndex * outIndexes = indexes;
+
+    for (int emitted = 0; emitted < triangleCount; ++emitted)
+    {
+        if (bestTriangle < 0)
+        {
+            // Scores went stale (the greedy pick only scans the cache
+            // neighborhood) - rescan for the best remaining triangle.
+            bestScore = -1.0f;
+            for (int t = 0; t < triangleCount; ++t)
+            {
+                if (!triangles[t].emitted && triangles[t].score > bestScore)
+                {
+                    bestScore = triangles[t].score;
+                    bestTriangle = t;
+                }
+            }
+        }
+
+        OptTriangle & tri = triangles[bestTriangle];
+        tri.emitted = true;
+
+        for (int c = 0; c < 3; ++c)
+        {
+            const MeshIndex v = tri.verts[c];
+            *outIndexes++ = v + minVertex;
+
+            OptVertex & vert = vertexes[v];
+            vert.trisLeft--;
+
+            // Drop this triangle from the vertex's remaining list:
+            for (int i = 0; i < (vert.trisLeft + 1); ++i)
+            {
+                const int slot = vert.triListOffset + i;
+                if (vertexTriLists[slot] == bestTriangle)
+                {
+                    std::swap(vertexTriLists[slot], vertexTriLists[vert.triListOffset + vert.trisLeft]);
+                    break;
+                }
+            }
+
+            // Move to the front of the cache if not already resident:
+            if (vert.cachePosition < 0)
+            {
+                assert(cacheEntries < (CacheSize + 3));
+                cache[cacheEntries++] = v;
+            }
+        }
+
+        // Re-stack the cache: the new triangle's vertexes go in front,
+        // everything else shifts back and may fall off the end.
+        int stacked = 0;
+        int restacked[CacheSize + 3];
+        for (int c = 0; c < 3; ++c)
+        {
+            restacked[stacked++] = tri.verts[c];
+        }
+        for (int i = 0; i < cacheEntries; ++i)
+        {
+            const int v = cache[i];
+            if (v == static_cast<int>(tri.verts[0]) ||
+                v == static_cast<int>(tri.verts[1]) ||
+                v == static_cast<int>(tri.verts[2]))
+            {
+                continue;
+            }
+            if (stacked < (CacheSize + 3))
+            {
+                restacked[stacked++] = v;
+            }
+            else
+            {
+                vertexes[v].cachePosition = -1; // Evicted.
+            }
+        }
+
+        cacheEntries = std::min(stacked, CacheSize);
+        for (int i = 0; i < stacked; ++i)
+        {
+            vertexes[restacked[i]].cachePosition = (i < CacheSize) ? i : -1;
+            if (i < CacheSize)
+            {
+                cache[i] = restacked[i];
+            }
+        }
+
+        // Refresh the scores of the cached vertexes and of the triangles
+        // they touch, and pick the next best among those:
+        bestScore = -1.0f;
+        bestTriangle = -1;
+        for (int i = 0; i < cacheEntries; ++i)
+        {
+            OptVertex & vert = vertexes[cache[i]];
+            const float oldScore = vert.score;
+            vert.score = vertexScore(vert);
+            const float scoreDelta = vert.score - oldScore;
+
+            for (int t = 0; t < vert.trisLeft; ++t)
+            {
+                OptTriangle & candidate = triangles[vertexTriLists[vert.triListOffset + t]];
+                candidate.score += scoreDelta;
+                if (!candidate.emitted && candidate.score > bestScore)
+                {
+                    bestScore = candidate.score;
+                    bestTriangle = vertexTriLists[vert.triListOffset + t];
+                }
+            }
+        }
+    }
+}
+
+// ========================================================
+// Overdraw-aware cluster sorting:
+// ========================================================
+
+constexpr int OverdrawClusterTris = 64;
+
+void optimizeOverdraw(MeshIndex * const indexes, const int indexCount, const MeshVertex * const vertexes)
+{
+    assert(indexes != nullptr && vertexes != nullptr);
+    assert(indexCount > 0 && (indexCount % 3) == 0);
+
+    const int triangleCount = indexCount / 3;
+    const int clusterCount  = (triangleCount + OverdrawClusterTris - 1) / OverdrawClusterTris;
+    if (clusterCount < 2)
+    {
+        return; // Nothing to reorder.
+    }
+
+    struct Cluster
+    {
+        int   firstTriangle;
+        int   triangleCount;
+        float sortKey;
+    };
+    std::vector<Cluster> clusters(clusterCount);
+
+    // Mesh centroid, for the view-independent occlusion heuristic below:
+    float meshCenter[3] = { 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < indexCount; ++i)
+    {
+        const Float3 & p = vertexes[indexes[i]].position;
+        meshCenter[0] += p.x; meshCenter[1] += p.y; meshCenter[2] += p.z;
+    }
+    meshCenter[0] /= indexCount; meshCenter[1] /= indexCount; meshCenter[2] /= indexCount;
+
+    for (int c = 0; c < clusterCount; ++c)
+    {
+        Cluster & cluster = clusters[c];
+        cluster.firstTriangle = c * OverdrawClusterTris;
+        cluster.triangleCount = std::min(OverdrawClusterTris, triangleCount - cluster.firstTriangle);
+
+        // Area-weighted average normal and centroid of the cluster:
+        float normal[3]   = { 0.0f, 0.0f, 0.0f };
+        float centroid[3] = { 0.0f, 0.0f, 0.0f };
+
+        for (int t = 0; t < cluster.triangleCount; ++t)
+        {
+            const MeshIndex * const tri = &indexes[(cluster.firstTriangle + t) * 3];
+            const Float3 & a = vertexes[tri[0]].position;
+            const Float3 & b = vertexes[tri[1]].position;
+            const Float3 & d = vertexes[tri[2]].position;
+
+            const float e0[3] = { b.x - a.x, b.y - a.y, b.z - a.z };
+            const float e1[3] = { d.x - a.x, d.y - a.y, d.z - a.z };
+
+            normal[0] += (e0[1] * e1[2]) - (e0[2] * e1[1]);
+            normal[1] += (e0[2] * e1[0]) - (e0[0] * e1[2]);
+            normal[2] += (e0[0] * e1[1]) - (e0[1] * e1[0]);
+
+            centroid[0] += (a.x + b.x + d.x) / 3.0f;
+            centroid[1] += (a.y + b.y + d.y) / 3.0f;
+            centroid[2] += (a.z + b.z + d.z) / 3.0f;
+        }
+        centroid[0] /= cluster.triangleCount;
+        centroid[1] /= cluster.triangleCount;
+        centroid[2] /= cluster.triangleCount;
+
+        const float len = std::sqrt((normal[0] * normal[0]) + (normal[1] * normal[1]) + (normal[2] * normal[2]));
+        if (len > 0.0f)
+        {
+            normal[0] /= len; normal[1] /= len; normal[2] /= len;
+        }
+
+        // Project the centroid onto the cluster normal, relative to the mesh
+        // center. Clusters facing away from the body of the mesh (outer
+        // surfaces, the likely occluders) score high and draw first.
+        cluster.sortKey = ((centroid[0] - meshCenter[0]) * normal[0]) +
+                          ((centroid[1] - meshCenter[1]) * normal[1]) +
+                          ((centroid[2] - meshCenter[2]) * normal[2]);
+    }
+
+    std::sort(clusters.begin(), clusters.end(),
+              [](const Cluster & a, const Cluster & b) { return a.sortKey > b.sortKey; });
+
+    // Rebuild the index list in sorted cluster order (triangle order
+    // inside each cluster is untouched, preserving the cache pass):
+    std::vector<MeshIndex> reordered(indexCount);
+    MeshIndex * out = reordered.data();
+    for (const Cluster & cluster : clusters)
+    {
+        const MeshIndex * const src = &indexes[cluster.firstTriangle * 3];
+        std::memcpy(out, src, cluster.triangleCount * 3 * sizeof(MeshIndex));
+        out += cluster.triangleCount * 3;
+    }
+    std::memcpy(indexes, reordered.data(), indexCount * sizeof(MeshIndex));
+}
+
+// ========================================================
+// Vertex fetch reordering:
+// ========================================================
+
+void optimizeVertexFetch(MeshVertex * const vertexes, const int vertexCount,
+                         MeshIndex * const indexes, const int indexCount, const MeshIndex minVertex)
+{
+    assert(vertexes != nullptr && indexes != nullptr);
+    assert(vertexCount > 0 && indexCount > 0);
+
+    constexpr MeshIndex Unmapped = ~MeshIndex(0);
+    std::vector<MeshIndex> remap(vertexCount, Unmapped);
+
+    // New vertex order = order of first reference in the index list:
+    MeshIndex nextSlot = 0;
+    for (int i = 0; i < indexCount; ++i)
+    {
+        const MeshIndex local = indexes[i] - minVertex;
+        assert(local < static_cast<MeshIndex>(vertexCount));
+
+        if (remap[local] == Unmapped)
+        {
+            remap[local] = nextSlot++;
+        }
+        indexes[i] = remap[local] + minVertex;
+    }
+
+    std::vector<MeshVertex> reordered(vertexCount);
+    for (int v = 0; v < vertexCount; ++v)
+    {
+        if (remap[v] != Unmapped)
+        {
+            reordered[remap[v]] = vertexes[v];
+        }
+        else // Unreferenced vertex - keep it at the tail.
+        {
+            reordered[nextSlot++] = vertexes[v];
+        }
+    }
+    std::memcpy(vertexes, reordered.data(), vertexCount * sizeof(MeshVertex));
+}
+
+// ========================================================
+// Quadric-error-metric simplification:
+// ========================================================
+
+// Symmetric 4x4 error quadric - only the 10 unique coefficients are stored.
+struct Quadric
+{
+    float xx, xy, xz, xw;
+    float     yy, yz, yw;
+    float         zz, zw;
+    float             ww;
+};
+
+static void quadricAdd(Quadric & q, const Quadric & other)
+{
+    q.xx += other.xx; q.xy += other.xy; q.xz += other.xz; q.xw += other.xw;
+    q.yy += other.yy; q.yz += other.yz; q.yw += other.yw;
+    q.zz += other.zz; q.zw += other.zw;
+    q.ww += other.ww;
+}
+
+static void quadricAddPlane(Quadric & q, const float a, const float b,
+                            const float c, const float d, const float weight)
+{
+    q.xx += a * a * weight; q.xy += a * b * weight; q.xz += a * c * weight; q.xw += a * d * weight;
+    q.yy += b * b * weight; q.yz += b * c * weight; q.yw += b * d * weight;
+    q.zz += c * c * weight; q.zw += c * d * weight;
+    q.ww += d * d * weight;
+}
+
+// Squared distance-to-planes error of placing a vertex at point p.
+static float quadricEvaluate(const Quadric & q, const Float3 & p)
+{
+    return (q.xx * p.x * p.x) + (q.yy * p.y * p.y) + (q.zz * p.z * p.z) +
+           (2.0f * ((q.xy * p.x * p.y) + (q.xz * p.x * p.z) + (q.yz * p.y * p.z))) +
+           (2.0f * ((q.xw * p.x) + (q.yw * p.y) + (q.zw * p.z))) +
+           q.ww;
+}
+
+int simplifyIndexRange(const MeshVertex * const vertexes, const MeshIndex minVertex, const int vertexCount,
+                       const MeshIndex * const inIndexes, const int inIndexCount,
+                       MeshIndex * const outIndexes, const int targetIndexCount)
+{
+    assert(vertexes != nullptr && inIndexes != nullptr && outIndexes != nullptr);
+    assert(inIndexCount > 0 && (inIndexCount % 3) == 0);
+    assert(targetIndexCount > 0 && (targetIndexCount % 3) == 0);
+    assert(vertexCount > 0);
+
+    // Local (zero-based) triangle list we collapse in place:
+    std::vector<MeshIndex> tris(inIndexes, inIndexes + inIndexCount);
+    for (MeshIndex & idx : tris)
+    {
+        idx -= minVertex;
+        assert(idx < static_cast<MeshIndex>(vertexCount));
+    }
+
+    // Accumulate the area-weighted plane quadric of every face into its corners:
+    std::vector<Quadric> quadrics(vertexCount);
+    std::memset(quadrics.data(), 0, vertexCount * sizeof(Quadric));
+
+    for (int t = 0; t < inIndexCount; t += 3)
+    {
+        const Float3 & a = vertexes[tris[t + 0] + minVertex].position;
+        const Float3 & b = vertexes[tris[t + 1] + minVertex].position;
+        const Float3 & c = vertexes[tris[t + 2] + minVertex].position;
+
+        const float e0[3] = { b.x - a.x, b.y - a.y, b.z - a.z };
+        const float e1[3] = { c.x - a.x, c.y - a.y, c.z - a.z };
+
+        float n[3] = { (e0[1] * e1[2]) - (e0[2] * e1[1]),
+                       (e0[2] * e1[0]) - (e0[0] * e1[2]),
+                       (e0[0] * e1[1]) - (e0[1] * e1[0]) };
+
+        const float len = std::sqrt((n[0] * n[0]) + (n[1] * n[1]) + (n[2] * n[2]));
+        if (len <= 0.0f)
+        {
+            continue; // Degenerate input triangle - contributes no error.
+        }
+        n[0] /= len; n[1] /= len; n[2] /= len;
+
+        const float d = -((n[0] * a.x) + (n[1] * a.y) + (n[2] * a.z));
+        const float area = len * 0.5f;
+
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            quadricAddPlane(quadrics[tris[t + corner]], n[0], n[1], n[2], d, area);
+        }
+    }
+
+    // Vertexes on an open border (a directed edge with no opposite) are
+    // locked - collapsing them erodes the silhouette, and architectural
+    // meshes like Sponza are full of single-sided walls and drapes.
+    auto edgeKey = [](const MeshIndex from, const MeshIndex to)
+    {
+        return (static_cast<std::uint64_t>(from) << 32) | to;
+    };
+
+    std::vector<std::uint64_t> directedEdges;
+    directedEdges.reserve(inIndexCount);
+    for (int t = 0; t < inIndexCount; t += 3)
+    {
+        directedEdges.push_back(edgeKey(tris[t + 0], tris[t + 1]));
+        directedEdges.push_back(edgeKey(tris[t + 1], tris[t + 2]));
+        directedEdges.push_back(edgeKey(tris[t + 2], tris[t + 0]));
+    }
+    std::sort(directedEdges.begin(), directedEdges.end());
+
+    std::vector<std::uint8_t> locked(vertexCount, 0);
+    for (const std::uint64_t key : directedEdges)
+    {
+        const auto from = static_cast<MeshIndex>(key >> 32);
+        const auto to   = static_cast<MeshIndex>(key & 0xFFFFFFFFu);
+        if (!std::binary_search(directedEdges.begin(), directedEdges.end(), edgeKey(to, from)))
+        {
+            locked[from] = locked[to] = 1;
+        }
+    }
+
+    struct EdgeCollapse
+    {
+        MeshIndex from; // Collapsed away...
+        MeshIndex to;   // ...onto this one, whose position is unchanged.
+        float     cost;
+    };
+
+    std::vector<EdgeCollapse>  candidates;
+    std::vector<MeshIndex>     remap(vertexCount);
+    std::vector<std::uint8_t>  touched(vertexCount);
+
+    const int targetTriangles = targetIndexCount / 3;
+    int liveTriangles = static_cast<int>(tris.size()) / 3;
+
+    while (liveTriangles > targetTriangles)
+    {
+        // Rank every half-edge by the quadric error of snapping 'from' onto
+        // 'to'. Costs drift as quadrics merge, so they are rebuilt each pass
+        // instead of maintained in a heap - triangle counts roughly halve
+        // per pass, so the pass count stays tiny and the code simple. There
+        // is no triangle-flip test either; the cost ordering plus the locked
+        // boundaries keep the gross artifacts out, plenty for far-field LODs.
+        candidates.clear();
+        for (std::size_t t = 0; t < tris.size(); t += 3)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                const MeshIndex from = tris[t + c];
+                const MeshIndex to   = tris[t + ((c + 1) % 3)];
+                if (locked[from])
+                {
+                    continue;
+                }
+
+                Quadric q = quadrics[from];
+                quadricAdd(q, quadrics[to]);
+                const float cost = quadricEvaluate(q, vertexes[to + minVertex].position);
+                candidates.push_back({ from, to, cost });
+            }
+        }
+
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const EdgeCollapse & a, const EdgeCollapse & b) { return a.cost < b.cost; });
+
+        for (int v = 0; v < vertexCount; ++v)
+        {
+            remap[v] = static_cast<MeshIndex>(v);
+        }
+        std::memset(touched.data(), 0, vertexCount);
+
+        // Apply the cheapest non-conflicting collapses until the budget is met:
+        int collapsed = 0;
+        for (const EdgeCollapse & edge : candidates)
+        {
+            if ((liveTriangles - (collapsed * 2)) <= targetTriangles)
+            {
+                break; // Each collapse retires ~2 triangles - close enough.
+            }
+            if (touched[edge.from] || touched[edge.to])
+            {
+                continue; // An endpoint already took part in a collapse this pass.
+            }
+
+            remap[edge.from] = edge.to;
+            quadricAdd(quadrics[edge.to], quadrics[edge.from]);
+            touched[edge.from] = touched[edge.to] = 1;
+            ++collapsed;
+        }
+
+        if (collapsed == 0)
+        {
+            break; // Out of collapsible edges - the target is unreachable.
+        }
+
+        // Rewrite the triangle list, dropping the now-degenerate ones:
+        std::size_t out = 0;
+        for (std::size_t t = 0; t < tris.size(); t += 3)
+        {
+            const MeshIndex v0 = remap[tris[t + 0]];
+            const MeshIndex v1 = remap[tris[t + 1]];
+            const MeshIndex v2 = remap[tris[t + 2]];
+            if (v0 == v1 || v1 == v2 || v2 == v0)
+            {
+                continue;
+            }
+            tris[out++] = v0;
+            tris[out++] = v1;
+            tris[out++] = v2;
+        }
+        tris.resize(out);
+        liveTriangles = static_cast<int>(out) / 3;
+    }
+
+    for (std::size_t i = 0; i < tris.size(); ++i)
+    {
+        outIndexes[i] = tris[i] + minVertex;
+    }
+    return static_cast<int>(tris.size());
+}
+
+// ========================================================
+// LOD chain building:
+// ========================================================
+
+// Triangle budget of each reduced level, as a fraction of the full-detail set.
+constexpr float LodReductionFactors[] = { 0.5f, 0.25f, 0.125f };
+static_assert(arrayLength(LodReductionFactors) <= (MeshMaxLodLevels - 1),
+              "More reduction factors than LOD level slots!");
+
+// Submeshes below this many triangles aren't worth another level.
+constexpr int MinLodTriangles = 16;
+
+void buildLodChain(Mesh & mesh)
+{
+    VKTB_PROFILE_SCOPE("MeshOptimizer::buildLodChain");
+    assert(!mesh.isMemoryMapped()); // Importer path only.
+
+    // Start every chain off with just the full-detail level:
+    mesh.initDefaultSubmeshLods();
+
+    const int originalIndexCount = mesh.indexCount();
+    const int submeshCount       = mesh.submeshCount();
+
+    std::vector<MeshIndex> lodIndexes; // All the reduced sets, appended in one go at the end.
+    std::vector<MeshIndex> prevLevel;
+    std::vector<MeshIndex> scratch;
+
+    for (int m = 0; m < submeshCount; ++m)
+    {
+        const MeshSubSection & sm = mesh.submeshes[m];
+        MeshSubmeshLods & chain   = mesh.submeshLods[m];
+
+        if (sm.indexCount <= (MinLodTriangles * 3) || sm.vertexCount <= 0)
+        {
+            continue;
+        }
+
+        // Each level simplifies the previous one, not the original - errors
+        // compound a little but the work per level shrinks geometrically.
+        prevLevel.assign(mesh.indexes.begin() + sm.indexStart,
+                         mesh.indexes.begin() + sm.indexStart + sm.indexCount);
+
+        for (std::size_t level = 0; level < arrayLength(LodReductionFactors); ++level)
+        {
+            int targetIndexCount = static_cast<int>(sm.indexCount * LodReductionFactors[level]);
+            targetIndexCount = (targetIndexCount / 3) * 3;
+            if (targetIndexCount < (MinLodTriangles * 3))
+            {
+                targetIndexCount = MinLodTriangles * 3;
+            }
+
+            const int prevIndexCount = static_cast<int>(prevLevel.size());
+            if (prevIndexCount <= targetIndexCount)
+            {
+                break; // Already at or below this level's budget.
+            }
+
+            scratch.resize(prevIndexCount);
+            const int written = simplifyIndexRange(mesh.vertexes.data(), sm.vertexStart, sm.vertexCount,
+                                                   prevLevel.data(), prevIndexCount,
+                                                   scratch.data(), targetIndexCount);
+            if (written >= prevIndexCount)
+            {
+                break; // Simplification stalled (all edges locked or degenerate).
+            }
+            scratch.resize(written);
+
+            // The collapse emits a brand new triangle ordering, so each
+            // reduced set gets its own cache optimization pass.
+            optimizeVertexCache(scratch.data(), written, sm.vertexStart, sm.vertexCount);
+
+            MeshLodRange & range = chain.levels[chain.levelCount++];
+            range.indexStart = originalIndexCount + static_cast<int>(lodIndexes.size());
+            range.indexCount = written;
+
+            lodIndexes.insert(lodIndexes.end(), scratch.begin(), scratch.end());
+            prevLevel.swap(scratch);
+        }
+    }
+
+    // The reduced sets go after the full-detail indexes in the shared array.
+    // Submesh ranges are untouched, so older BMSH loaders stay compatible -
+    // they simply carry the extra indexes along unused.
+    mesh.indexes.insert(mesh.indexes.end(), lodIndexes.begin(), lodIndexes.end());
+
+    Log::debugF("LOD chain build done (%i submeshes, +%zu LOD indexes, +%.1f%% index memory).",
+                submeshCount, lodIndexes.size(),
+                (originalIndexCount > 0) ? (lodIndexes.size() * 100.0f / originalIndexCount) : 0.0f);
+}
+
+// ========================================================
+// Whole-mesh pipeline:
+// ========================================================
+
+void optimizeMesh(Mesh & mesh)
+{
+    VKTB_PROFILE_SCOPE("MeshOptimizer::optimizeMesh");
+    assert(!mesh.isMemoryMapped()); // Importer path only.
+
+    for (const MeshSubSection & sm : mesh.submeshes)
+    {
+        if (sm.indexCount <= 0 || sm.vertexCount <= 0)
+        {
+            continue;
+        }
+
+        MeshIndex * const submeshIndexes = mesh.indexes.data() + sm.indexStart;
+
+        optimizeVertexCache(submeshIndexes, sm.indexCount, sm.vertexStart, sm.vertexCount);
+        optimizeOverdraw(submeshIndexes, sm.indexCount, mesh.vertexes.data());
+        optimizeVertexFetch(mesh.vertexes.data() + sm.vertexStart, sm.vertexCount,
+                            submeshIndexes, sm.indexCount, sm.vertexStart);
+    }
+
+    Log::debugF("Mesh optimization pass done (%i submeshes, %i triangles).",
+                mesh.submeshCount(), mesh.indexCount() / 3);
+}
+
+} // namespace MeshOptimizer
+
+} // namespace VkToolbox
@@ -0,0 +1,70 @@
+#pragma once
+
+// ================================================================================================
+// File: VkToolbox/MeshOptimizer.hpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Import-time mesh optimization passes (vertex cache, overdraw, vertex fetch).
+// ================================================================================================
+
+#include "Mesh.hpp"
+
+namespace VkToolbox
+{
+
+// ========================================================
+// MeshOptimizer:
+// ========================================================
+
+// Post-import geometry optimization. These run once when a model is imported
+// and the result is persisted into the BMSH binary by Mesh::saveBinary(), so
+// cooked meshes pay nothing at load time. Each pass works on one submesh's
+// index/vertex range; optimizeMesh() runs the whole pipeline over a mesh.
+namespace MeshOptimizer
+{
+
+// Reorders the triangles of an index range for post-transform vertex cache
+// efficiency, using Forsyth's linear-speed greedy scoring. minVertex is the
+// first vertex the range references (the submesh vertexStart) - indexes are
+// expected to lie inside [minVertex, minVertex + vertexCount).
+void optimizeVertexCache(MeshIndex * indexes, int indexCount,
+                         MeshIndex minVertex, int vertexCount);
+
+// Groups consecutive (cache-optimized) triangles into clusters and sorts the
+// clusters so outward-facing surfaces tend to draw before the geometry they
+// occlude, reducing average overdraw without knowing the camera. Triangle
+// order inside a cluster is preserved, so the cache optimization survives.
+void optimizeOverdraw(MeshIndex * indexes, int indexCount, const MeshVertex * vertexes);
+
+// Reorders the vertex range into first-use order of the index range and
+// rewrites the indexes to match, so vertex fetch walks memory linearly.
+void optimizeVertexFetch(MeshVertex * vertexes, int vertexCount,
+                         MeshIndex * indexes, int indexCount, MeshIndex minVertex);
+
+// Quadric-error-metric half-edge collapse simplification of one index range.
+// Vertexes are never moved or duplicated - a collapse snaps one endpoint onto
+// the other - so the reduced set shares the original vertex buffer with the
+// full-detail geometry. Writes the surviving indexes to outIndexes (which must
+// hold at least inIndexCount entries) and returns how many were written; the
+// result can stay above targetIndexCount when no collapsible edges remain.
+int simplifyIndexRange(const MeshVertex * vertexes, MeshIndex minVertex, int vertexCount,
+                       const MeshIndex * inIndexes, int inIndexCount,
+                       MeshIndex * outIndexes, int targetIndexCount);
+
+// Builds the reduced LOD index sets of every submesh (roughly half, a quarter
+// and an eighth of the original triangles), appends them to the mesh's shared
+// index array and records the ranges in Mesh::submeshLods. Level 0 always
+// aliases the submesh's full-detail range. Persisted into the BMSH binary by
+// Mesh::saveBinary() like the other passes; Model3D::selectSubmeshLods() picks
+// a level per submesh from the camera distance at draw time.
+void buildLodChain(Mesh & mesh);
+
+// Runs all three passes over every submesh of an imported mesh.
+// Only valid for the importer path (heap vectors, not memory-mapped).
+void optimizeMesh(Mesh & mesh);
+
+} // namespace MeshOptimizer
+
+// ========================================================
+
+} // namespace VkToolbox
@@ -10,6 +10,8 @@
 #include "Utils.hpp"
 #include "Pool.hpp"
 
+#include <cmath>
+
 namespace VkToolbox
 {
 
@@ -22,9 +24,9 @@ RenderStates::RenderStates(const VulkanContext & vkContext)
     , diffuseTexSlot{ TextureManager::InvalidResIndex }
     , normalTexSlot{ TextureManager::InvalidResIndex }
     , specularTexSlot{ TextureManager::InvalidResIndex }
-    , diffuseSampler{ vkContext }
-    , normalSampler{ vkContext }
-    , specularSampler{ vkContext }
+    , diffuseSampler{ vkContext.defaultSampler() }
+    , normalSampler{ vkContext.defaultSampler() }
+    , specularSampler{ vkContext.defaultSampler() }
 {
 }
 
@@ -50,7 +52,8 @@ void RenderStates::setRenderProgram(const RenderProgram & renderProg)
 // ========================================================
 
 float Model3D::sm_importerScale    = 1.0f;
-bool  Model3D::sm_asyncTextureLoad = false;
+bool  Model3D::sm_asyncTextureLoad = true;
+float Model3D::sm_lodDistanceScale = 1.0f;
 
 Model3D::Model3D(const VulkanContext & vkContext, StrId<str> && id)
     : m_vkContext{ &vkContext }
@@ -83,6 +86,8 @@ Model3D & Model3D::operator = (Model3D && other)
 
 ModelDrawData * Model3D::allocateDrawData()
 {
+    const auto submeshes    = m_mesh.submeshArray();
+    const auto materials    = m_mesh.materialArray();
     const int materialCount = m_mesh.materialCount();
     const int submeshCount  = m_mesh.submeshCount();
 
@@ -92,19 +97,23 @@ ModelDrawData * Model3D::allocateDrawData()
     {
         for (int sm = 0; sm < submeshCount; ++sm)
         {
-            if (m_mesh.submeshes[sm].materialIndex == mat)
+            if (submeshes[sm].materialIndex == mat)
             {
-                assert(m_mesh.materials[mat].index == mat);
+                assert(materials[mat].index == mat);
                 ++indexesNeeded;
             }
         }
     }
 
+    // Submesh count rounded up to 4 boxes for the SIMD frustum tests:
+    const int paddedBoxCount = roundUpToMultiple(submeshCount, 4);
+
     const auto drawDataSize   = sizeof(ModelDrawData);
     const auto matBucketsSize = materialCount * sizeof(MaterialSortIndexes);
     const auto matRsSize      = materialCount * sizeof(RenderStates);
+    const auto cullDataSize   = sizeof(SubmeshCullBounds) + (paddedBoxCount * sizeof(float) * 6) + (paddedBoxCount * 2);
     const auto indexesSize    = indexesNeeded * sizeof(std::uint16_t);
-    const auto totalSize      = drawDataSize + matBucketsSize + matRsSize + indexesSize;
+    const auto totalSize      = drawDataSize + matBucketsSize + matRsSize + cullDataSize + indexesSize;
 
     auto * blob = static_cast<std::uint8_t *>(std::malloc(totalSize));
 
@@ -117,10 +126,58 @@ ModelDrawData * Model3D::allocateDrawData()
     newDrawData->materialRenderStates = reinterpret_cast<RenderStates *>(blob);
     blob += matRsSize;
 
+    // The culling bounds struct and its SoA arrays. The float arrays come
+    // before the visibility bytes and the uint16 indexes to stay aligned.
+    auto * cullBounds = reinterpret_cast<SubmeshCullBounds *>(blob);
+    blob += sizeof(SubmeshCullBounds);
+
+    cullBounds->boxCount = paddedBoxCount;
+    cullBounds->centerX  = reinterpret_cast<float *>(blob); blob += paddedBoxCount * sizeof(float);
+    cullBounds->centerY  = reinterpret_cast<float *>(blob); blob += paddedBoxCount * sizeof(float);
+    cullBounds->centerZ  = reinterpret_cast<float *>(blob); blob += paddedBoxCount * sizeof(float);
+    cullBounds->extentX  = reinterpret_cast<float *>(blob); blob += paddedBoxCount * sizeof(float);
+    cullBounds->extentY  = reinterpret_cast<float *>(blob); blob += paddedBoxCount * sizeof(float);
+    cullBounds->extentZ  = reinterpret_cast<float *>(blob); blob += paddedBoxCount * sizeof(float);
+    cullBounds->visibility = blob;                          blob += paddedBoxCount;
+    cullBounds->lodLevel   = blob;                          blob += paddedBoxCount;
+
+    const auto aabbs = m_mesh.submeshAabbArray();
+    assert(static_cast<int>(aabbs.size()) == submeshCount);
+
+    for (int sm = 0; sm < paddedBoxCount; ++sm)
+    {
+        if (sm < submeshCount)
+        {
+            const MeshAabb & box = aabbs[sm];
+            cullBounds->centerX[sm] = (box.mins.x + box.maxs.x) * 0.5f;
+            cullBounds->centerY[sm] = (box.mins.y + box.maxs.y) * 0.5f;
+            cullBounds->centerZ[sm] = (box.mins.z + box.maxs.z) * 0.5f;
+            cullBounds->extentX[sm] = (box.maxs.x - box.mins.x) * 0.5f;
+            cullBounds->extentY[sm] = (box.maxs.y - box.mins.y) * 0.5f;
+            cullBounds->extentZ[sm] = (box.maxs.z - box.mins.z) * 0.5f;
+        }
+        else // Zeroed pad entry - only occupies a SIMD lane.
+        {
+            cullBounds->centerX[sm] = 0.0f;
+            cullBounds->centerY[sm] = 0.0f;
+            cullBounds->centerZ[sm] = 0.0f;
+            cullBounds->extentX[sm] = 0.0f;
+            cullBounds->extentY[sm] = 0.0f;
+            cullBounds->extentZ[sm] = 0.0f;
+        }
+        cullBounds->visibility[sm] = 1; // Everything visible until the first cull.
+        cullBounds->lodLevel[sm]   = 0; // Full detail until the first LOD selection.
+    }
+    newDrawData->cullBounds = cullBounds;
+
     auto * idxPtr = reinterpret_cast<std::uint16_t *>(blob);
-    newDrawData->submeshIndexes = idxPtr;
+    newDrawData->submeshIndexes    = idxPtr;
+    newDrawData->submeshIndexCount = indexesNeeded;
 
-    // Sort the submeshes by material:
+    // Sort the submeshes by material. Each bucket keeps its entries in
+    // ascending submesh order, which is also ascending index-buffer order
+    // (the importer lays the submesh index ranges out back to back) - the
+    // invariant drawInstanceRange() relies on to merge contiguous draws.
     for (int mat = 0; mat < materialCount; ++mat)
     {
         construct(&newDrawData->materialRenderStates[mat], *m_vkContext);
@@ -131,9 +188,9 @@ ModelDrawData * Model3D::allocateDrawData()
 
         for (int sm = 0; sm < submeshCount; ++sm)
         {
-            if (m_mesh.submeshes[sm].materialIndex == mat)
+            if (submeshes[sm].materialIndex == mat)
             {
-                assert(m_mesh.materials[mat].index == mat);
+                assert(materials[mat].index == mat);
                 si.submeshIndexes[si.submeshCount++] = narrowCast<std::uint16_t>(sm);
             }
         }
@@ -181,7 +238,7 @@ bool Model3D::load()
     ModelDrawData & dd = *allocateDrawData();
 
     // Reference the required textures:
-    for (MeshMaterial & mat : m_mesh.materials)
+    for (const MeshMaterial & mat : m_mesh.materialArray())
     {
         str256 texName;
 
@@ -205,28 +262,26 @@ bool Model3D::load()
         //dd.samplers.push(Sampler{ *m_vkContext, Sampler::defaults() });
         //dd.samplers.push(Sampler{ *m_vkContext, Sampler::defaults() });
 
-        if (!sm_asyncTextureLoad) // Load immediately
+        const TextureManager::ResourceIndex texSlots[] = { diffuseTexSlot, normalTexSlot, specularTexSlot };
+        for (const auto texSlot : texSlots)
         {
-            if (!TextureManager::isLoaded(diffuseTexSlot))  { TextureManager::reload(diffuseTexSlot);  }
-            if (!TextureManager::isLoaded(normalTexSlot))   { TextureManager::reload(normalTexSlot);   }
-            if (!TextureManager::isLoaded(specularTexSlot)) { TextureManager::reload(specularTexSlot); }
-        }
-    }
+            if (TextureManager::isLoaded(texSlot))
+            {
+                continue;
+            }
 
-    /*
-    if (sm_asyncTextureLoad)
-    {
-        // Push the deferred load requests, must wait for completion!
-        for (auto texSlot : dd.textureSlots)
-        {
-            if (!TextureManager::isLoaded(texSlot) &&
-                !TextureManager::hasPendingAsyncLoadRequest(texSlot))
+            if (sm_asyncTextureLoad)
             {
+                // Fan the loads out over the job system workers. The caller must
+                // waitPendingAsyncLoadRequests() before endResourceLoad().
                 TextureManager::pushAsyncLoadRequest(texSlot);
             }
+            else // Load immediately
+            {
+                TextureManager::reload(texSlot);
+            }
         }
     }
-    */
 
     // Set up the vertex and index buffers:
     dd.buffersUploaded = false;
@@ -234,8 +289,10 @@ bool Model3D::load()
     dd.vertexBuffer.initialize(m_mesh.vertexCount());
     dd.indexBuffer.initialize(m_mesh.indexCount());
 
-    dd.vertexBuffer.writeN(make_array_view(m_mesh.vertexes));
-    dd.indexBuffer.writeN(make_array_view(m_mesh.indexes));
+    // In memory-mapped mode these views alias the mapped file, so the data
+    // goes straight from the OS file cache into the staging buffers.
+    dd.vertexBuffer.writeN(m_mesh.vertexArray());
+    dd.indexBuffer.writeN(m_mesh.indexArray());
 
     assert(dd.vertexBuffer.elementCount() == m_mesh.vertexCount());
     assert(dd.indexBuffer.elementCount()  == m_mesh.indexCount());
@@ -286,28 +343,157 @@ void Model3D::drawInstance(const CommandBuffer & cmdBuff) const
     {
         return;
     }
+    drawInstanceRange(cmdBuff, 0, m_drawData->submeshIndexCount);
+}
+
+void Model3D::drawInstanceRange(const CommandBuffer & cmdBuff, const int firstDrawIndex, const int drawIndexCount) const
+{
+    if (!isLoaded() || drawIndexCount <= 0)
+    {
+        return;
+    }
 
     ModelDrawData & dd = *m_drawData;
+    assert(firstDrawIndex >= 0 && (firstDrawIndex + drawIndexCount) <= dd.submeshIndexCount);
+
     m_vkContext->bindVertexBuffer(cmdBuff, dd.vertexBuffer);
     m_vkContext->bindIndexBuffer(cmdBuff, dd.indexBuffer, vkIndexTypeForBuffer(dd.indexBuffer));
 
-    const int materialCount = m_mesh.materialCount();
-    for (int mat = 0; mat < materialCount; ++mat)
+    const auto submeshes = m_mesh.submeshArray();
+    const auto lods      = m_mesh.submeshLodArray();
+
+    // The flat submesh index list is sorted by material, and inside each
+    // bucket the entries are in ascending index-buffer order (submesh index
+    // ranges are laid out sequentially in the mesh, see allocateDrawData).
+    // So besides only updating render states at bucket boundaries, runs of
+    // visible submeshes whose index ranges touch merge into a single draw.
+    // Full-detail ranges merge as before; the reduced LOD ranges live at the
+    // tail of the index buffer and rarely touch, which just means one draw
+    // per reduced submesh - a fine trade for the triangles saved.
+    int currentMaterial = -1;
+    int runIndexStart   = 0;
+    int runIndexCount   = 0;
+
+    for (int i = firstDrawIndex; i < (firstDrawIndex + drawIndexCount); ++i)
     {
-        setRenderStates(dd.materialRenderStates[mat]);
+        const std::size_t idx = dd.submeshIndexes[i];
+        if (!dd.cullBounds->visibility[idx])
+        {
+            continue; // Culled by the last cullSubmeshes() pass.
+        }
 
-        // Draw all submeshes affected by the material:
-        const int submeshCount = dd.materialDrawBuckets[mat].submeshCount;
-        for (int sm = 0; sm < submeshCount; ++sm)
+        const MeshSubSection & submesh = submeshes[idx];
+
+        // Index range of the level the last selectSubmeshLods() pass picked
+        // for this submesh (level 0 aliases the full-detail range).
+        const MeshSubmeshLods & chain = lods[idx];
+        const int level = (dd.cullBounds->lodLevel[idx] < chain.levelCount)
+                           ? dd.cullBounds->lodLevel[idx] : (chain.levelCount - 1);
+        const MeshLodRange & lodRange = chain.levels[level];
+
+        if (submesh.materialIndex == currentMaterial &&
+            lodRange.indexStart == (runIndexStart + runIndexCount))
+        {
+            runIndexCount += lodRange.indexCount; // Extends the current run.
+            continue;
+        }
+
+        // Run broken - flush what we have accumulated so far:
+        if (runIndexCount > 0)
+        {
+            m_vkContext->drawIndexed(cmdBuff, runIndexCount, 1, runIndexStart, 0, 0);
+        }
+
+        if (submesh.materialIndex != currentMaterial)
+        {
+            currentMaterial = submesh.materialIndex;
+            setRenderStates(dd.materialRenderStates[currentMaterial]);
+        }
+
+        runIndexStart = lodRange.indexStart;
+        runIndexCount = lodRange.indexCount;
+    }
+
+    if (runIndexCount > 0)
+    {
+        m_vkContext->drawIndexed(cmdBuff, runIndexCount, 1, runIndexStart, 0, 0);
+    }
+}
+
+void Model3D::cullSubmeshes(const Frustum & frustum) const
+{
+    if (!isLoaded())
+    {
+        return;
+    }
+
+    SubmeshCullBounds & bounds = *m_drawData->cullBounds;
+    frustum.cullAabbs(bounds.soaView(), bounds.boxCount, bounds.visibility);
+}
+
+void Model3D::selectSubmeshLods(const Point3 & modelSpaceEye) const
+{
+    if (!isLoaded())
+    {
+        return;
+    }
+
+    const auto lods = m_mesh.submeshLodArray();
+    SubmeshCullBounds & bounds = *m_drawData->cullBounds;
+
+    const int submeshCount = m_mesh.submeshCount();
+    assert(static_cast<int>(lods.size()) == submeshCount);
+
+    // Eye-distance-to-bounds-radius ratio at which each reduced level kicks
+    // in. Normalizing by the radius means a wall-sized submesh only drops
+    // detail when it is genuinely far away, while a pot does a few meters out.
+    static const float s_lodDistanceRatios[MeshMaxLodLevels - 1] = { 10.0f, 25.0f, 60.0f };
+
+    const float eyeX = modelSpaceEye[0];
+    const float eyeY = modelSpaceEye[1];
+    const float eyeZ = modelSpaceEye[2];
+
+    for (int sm = 0; sm < submeshCount; ++sm)
+    {
+        const MeshSubmeshLods & chain = lods[sm];
+        if (chain.levelCount <= 1)
         {
-            const std::size_t idx = dd.materialDrawBuckets[mat].submeshIndexes[sm];
-            const MeshSubSection & submesh = m_mesh.submeshes[idx];
+            bounds.lodLevel[sm] = 0;
+            continue;
+        }
+
+        const float dx = bounds.centerX[sm] - eyeX;
+        const float dy = bounds.centerY[sm] - eyeY;
+        const float dz = bounds.centerZ[sm] - eyeZ;
+        const float distance = std::sqrt((dx * dx) + (dy * dy) + (dz * dz));
+
+        const float ex = bounds.extentX[sm];
+        const float ey = bounds.extentY[sm];
+        const float ez = bounds.extentZ[sm];
+        const float radius = std::sqrt((ex * ex) + (ey * ey) + (ez * ez));
+
+        const float ratio = (radius > 0.0f) ? ((distance * sm_lodDistanceScale) / radius) : 0.0f;
 
-            m_vkContext->drawIndexed(cmdBuff, submesh.indexCount, 1, submesh.indexStart, 0, 0);
+        int level = 0;
+        while (level < (chain.levelCount - 1) && ratio > s_lodDistanceRatios[level])
+        {
+            ++level;
         }
+        bounds.lodLevel[sm] = static_cast<std::uint8_t>(level);
     }
 }
 
+void Model3D::resetSubmeshCulling() const
+{
+    if (!isLoaded())
+    {
+        return;
+    }
+
+    SubmeshCullBounds & bounds = *m_drawData->cullBounds;
+    std::memset(bounds.visibility, 1, bounds.boxCount);
+}
+
 void Model3D::setRenderStates(const RenderStates & rs) const
 {
     (void)rs;
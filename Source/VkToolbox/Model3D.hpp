@@ -10,6 +10,7 @@
 #include "Buffers.hpp"
 #include "DescriptorSets.hpp"
 #include "FixedSizeArray.hpp"
+#include "Frustum.hpp"
 #include "GlslShader.hpp"
 #include "Mesh.hpp"
 #include "PipelineState.hpp"
@@ -60,9 +61,11 @@ public:
     TextureManager::ResourceIndex normalTexSlot;
     TextureManager::ResourceIndex specularTexSlot;
 
-    Sampler diffuseSampler;
-    Sampler normalSampler;
-    Sampler specularSampler;
+    // Shared immutable handles from the context sampler cache - one material
+    // never needs its own VkSampler objects (see VulkanContext::sharedSampler).
+    VkSampler diffuseSampler;
+    VkSampler normalSampler;
+    VkSampler specularSampler;
 
 private:
 
@@ -72,8 +75,9 @@ private:
 
 // ========================================================
 
-using MeshVB = StructuredVertexBuffer<MeshVertex>;
-using MeshIB = StructuredIndexBuffer<MeshIndex>;
+using MeshVB       = StructuredVertexBuffer<MeshVertex>;
+using MeshPackedVB = StructuredVertexBuffer<MeshVertexPacked>;
+using MeshIB       = StructuredIndexBuffer<MeshIndex>;
 
 struct MaterialSortIndexes
 {
@@ -81,6 +85,29 @@ struct MaterialSortIndexes
     std::uint16_t * submeshIndexes;
 };
 
+// Per-submesh culling state: the mesh AABBs laid out as SoA center/extent
+// arrays for Frustum::cullAabbs(), plus the visibility list it produces.
+struct SubmeshCullBounds
+{
+    int boxCount; // Submesh count rounded up to a multiple of 4 for the SIMD tests.
+
+    // [boxCount] entries each, pad entries zeroed:
+    float * centerX;
+    float * centerY;
+    float * centerZ;
+    float * extentX;
+    float * extentY;
+    float * extentZ;
+
+    std::uint8_t * visibility; // [boxCount], nonzero = submesh gets drawn.
+    std::uint8_t * lodLevel;   // [boxCount], set by selectSubmeshLods(), 0 = full detail.
+
+    AabbSoA soaView() const
+    {
+        return { centerX, centerY, centerZ, extentX, extentY, extentZ };
+    }
+};
+
 struct ModelDrawData
 {
     mutable bool          buffersUploaded;
@@ -88,7 +115,9 @@ struct ModelDrawData
     MeshIB                indexBuffer;
     RenderStates        * materialRenderStates; // [num materials]
     MaterialSortIndexes * materialDrawBuckets;  // [num materials]
+    SubmeshCullBounds   * cullBounds;
     std::uint16_t       * submeshIndexes;       // [num submesh indexes]
+    int                   submeshIndexCount;
 
     explicit ModelDrawData(const VulkanContext & vkContext)
         : buffersUploaded{ false }
@@ -96,7 +125,9 @@ struct ModelDrawData
         , indexBuffer{ vkContext }
         , materialRenderStates{ nullptr }
         , materialDrawBuckets{ nullptr }
+        , cullBounds{ nullptr }
         , submeshIndexes{ nullptr }
+        , submeshIndexCount{ 0 }
     { }
 };
 
@@ -109,6 +140,10 @@ public:
     static float sm_importerScale;
     static bool  sm_asyncTextureLoad;
 
+    // Scales the distance thresholds of selectSubmeshLods() - above 1 the
+    // reduced LODs kick in closer to the camera, 0 pins everything at full detail.
+    static float sm_lodDistanceScale;
+
     Model3D(const VulkanContext & vkContext, const char * id);
     Model3D(const VulkanContext & vkContext, StrId<str> && id);
     ~Model3D();
@@ -138,6 +173,26 @@ public:
     void uploadBuffersToGpu(const CommandBuffer & cmdBuff, bool force = false) const;
     void drawInstance(const CommandBuffer & cmdBuff) const;
 
+    // Draws a subrange of the material-sorted submesh list - for splitting a
+    // model's draws across several command buffers/recording threads. The range
+    // indexes into ModelDrawData::submeshIndexes, not the raw mesh submesh list.
+    void drawInstanceRange(const CommandBuffer & cmdBuff, int firstDrawIndex, int drawIndexCount) const;
+
+    // Frustum-tests the submesh AABBs and updates the visibility list the draw
+    // methods consume. The boxes are in model space, so build the Frustum from
+    // the combined (viewProj * modelMatrix). Each model's cull is independent -
+    // fan the calls out with JobSystem::parallelFor when there are many models.
+    void cullSubmeshes(const Frustum & frustum) const;
+
+    // Picks a LOD level for each submesh from the distance between the eye
+    // and the submesh bounds, normalized by the bounds radius so large pieces
+    // hold on to detail longer. The eye must be in model space, just like the
+    // cull Frustum. Meshes cooked without LOD chains stay at full detail.
+    void selectSubmeshLods(const Point3 & modelSpaceEye) const;
+
+    // Marks every submesh visible again (the default state after load()).
+    void resetSubmeshCulling() const;
+
 private:
 
     void setRenderStates(const RenderStates & rs) const;
@@ -0,0 +1,195 @@
+
+// ================================================================================================
+// File: VkToolbox/PipelineState.cpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Vulkan PSO helpers.
+// ================================================================================================
+
+#include "PipelineState.hpp"
+
+namespace VkToolbox
+{
+
+// ========================================================
+// Shared pipeline registry:
+// ========================================================
+
+// Pipelines are deduplicated by the hash of their creation state, so two
+// PipelineStateObjects initialized from identical builders end up sharing a
+// single VkPipeline. Entries are refcounted; a slot sticks around after the
+// last reference is dropped so a later identical request can recycle it.
+// All pipeline creation happens on the main thread, so no locking needed.
+namespace
+{
+struct SharedPipelineEntry
+{
+    Hash64     stateHash;
+    VkPipeline pipelineHandle;
+    int        refCount;
+};
+std::vector<SharedPipelineEntry> s_sharedPipelines;
+} // namespace
+
+static SharedPipelineEntry * findSharedPipeline(const Hash64 stateHash)
+{
+    for (SharedPipelineEntry & entry : s_sharedPipelines)
+    {
+        if (entry.stateHash == stateHash)
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+// ========================================================
+// struct PipelineStateBuilder:
+// ========================================================
+
+Hash64 PipelineStateBuilder::stateHash() const
+{
+    std::uint64_t h = 0;
+    const auto feed = [&h](const void * const data, const std::size_t sizeBytes)
+    {
+        h = murmurHash64(data, sizeBytes, h);
+    };
+
+    // The CreateInfo structs can't just be hashed wholesale because they carry
+    // pointers (pNext, pStages, pViewports, ...) that differ between otherwise
+    // identical builders, so each struct is fed skipping sType/pNext and
+    // dereferencing the arrays it points to.
+    #define VKTB_FEED_STATE_TAIL(structType, structVar) \
+        feed(&(structVar).flags, sizeof(structType) - offsetof(structType, flags))
+
+    feed(&viewport, sizeof(viewport));
+    feed(&scissor,  sizeof(scissor));
+
+    // The module handle and stage bit identify a shader stage here (pName is
+    // always "main"). Whether a stage opted into the builder's specialization
+    // info matters too, since the same module specialized differently yields
+    // a different pipeline:
+    for (std::uint32_t s = 0; s < pipelineState.stageCount; ++s)
+    {
+        feed(&shaderPipelineStages[s].stage,  sizeof(shaderPipelineStages[s].stage));
+        feed(&shaderPipelineStages[s].module, sizeof(shaderPipelineStages[s].module));
+
+        const std::uint32_t specialized = (shaderPipelineStages[s].pSpecializationInfo != nullptr);
+        feed(&specialized, sizeof(specialized));
+    }
+
+    // Specialization constant values (shared by all stages that use them):
+    feed(&specializationInfo.mapEntryCount, sizeof(specializationInfo.mapEntryCount));
+    if (specializationInfo.mapEntryCount != 0)
+    {
+        feed(specMapEntries.data(), specializationInfo.mapEntryCount * sizeof(VkSpecializationMapEntry));
+        feed(specConstantData.data(), specializationInfo.dataSize);
+    }
+
+    feed(&vertexInputState.vertexBindingDescriptionCount,   sizeof(std::uint32_t));
+    feed(&vertexInputState.vertexAttributeDescriptionCount, sizeof(std::uint32_t));
+    if (vertexInputState.vertexBindingDescriptionCount != 0)
+    {
+        feed(vertexInputState.pVertexBindingDescriptions,
+             vertexInputState.vertexBindingDescriptionCount * sizeof(VkVertexInputBindingDescription));
+    }
+    if (vertexInputState.vertexAttributeDescriptionCount != 0)
+    {
+        feed(vertexInputState.pVertexAttributeDescriptions,
+             vertexInputState.vertexAttributeDescriptionCount * sizeof(VkVertexInputAttributeDescription));
+    }
+
+    VKTB_FEED_STATE_TAIL(VkPipelineInputAssemblyStateCreateInfo, inputAssemblyState);
+    VKTB_FEED_STATE_TAIL(VkPipelineRasterizationStateCreateInfo, rasterizerState);
+    VKTB_FEED_STATE_TAIL(VkPipelineDepthStencilStateCreateInfo,  depthStencilState);
+    VKTB_FEED_STATE_TAIL(VkPipelineTessellationStateCreateInfo,  tessellationState);
+
+    // Multi-sampling state has the pSampleMask pointer in the middle, feed around it:
+    feed(&multiSamplingState.flags,
+         offsetof(VkPipelineMultisampleStateCreateInfo, pSampleMask) -
+         offsetof(VkPipelineMultisampleStateCreateInfo, flags));
+    if (multiSamplingState.pSampleMask != nullptr)
+    {
+        feed(multiSamplingState.pSampleMask, sizeof(VkSampleMask));
+    }
+    feed(&multiSamplingState.alphaToCoverageEnable,
+         sizeof(VkPipelineMultisampleStateCreateInfo) -
+         offsetof(VkPipelineMultisampleStateCreateInfo, alphaToCoverageEnable));
+
+    // Same for the color blend state (pAttachments):
+    feed(&colorBlendState.flags,
+         offsetof(VkPipelineColorBlendStateCreateInfo, pAttachments) -
+         offsetof(VkPipelineColorBlendStateCreateInfo, flags));
+    if (colorBlendState.attachmentCount != 0)
+    {
+        feed(colorBlendState.pAttachments,
+             colorBlendState.attachmentCount * sizeof(VkPipelineColorBlendAttachmentState));
+    }
+    feed(colorBlendState.blendConstants, sizeof(colorBlendState.blendConstants));
+
+    // Top-level create info - the handles tie the hash to the layout/render pass:
+    feed(&pipelineState.flags,      sizeof(pipelineState.flags));
+    feed(&pipelineState.layout,     sizeof(pipelineState.layout));
+    feed(&pipelineState.renderPass, sizeof(pipelineState.renderPass));
+    feed(&pipelineState.subpass,    sizeof(pipelineState.subpass));
+
+    #undef VKTB_FEED_STATE_TAIL
+
+    return Hash64{ h };
+}
+
+// ========================================================
+// class PipelineStateObject:
+// ========================================================
+
+void PipelineStateObject::initialize(const PipelineStateBuilder & psoBuilder)
+{
+    assert(!isInitialized());
+
+    m_stateHash = psoBuilder.stateHash();
+
+    // Another call site might have already built an identical pipeline:
+    SharedPipelineEntry * entry = findSharedPipeline(m_stateHash);
+    if (entry != nullptr && entry->pipelineHandle != VK_NULL_HANDLE)
+    {
+        entry->refCount++;
+        m_pipelineHandle = entry->pipelineHandle;
+        return;
+    }
+
+    VKTB_CHECK(vkCreateGraphicsPipelines(context().deviceHandle(), context().pipelineCacheHandle(),
+                                         1, &psoBuilder.pipelineState,
+                                         context().allocationCallbacks(), &m_pipelineHandle));
+
+    if (entry != nullptr) // Recycle the stale slot
+    {
+        entry->pipelineHandle = m_pipelineHandle;
+        entry->refCount       = 1;
+    }
+    else
+    {
+        s_sharedPipelines.push_back({ m_stateHash, m_pipelineHandle, 1 });
+    }
+}
+
+void PipelineStateObject::shutdown()
+{
+    if (m_pipelineHandle == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    SharedPipelineEntry * entry = findSharedPipeline(m_stateHash);
+    assert(entry != nullptr && entry->pipelineHandle == m_pipelineHandle);
+
+    if (--entry->refCount == 0)
+    {
+        vkDestroyPipeline(context().deviceHandle(), entry->pipelineHandle, context().allocationCallbacks());
+        entry->pipelineHandle = VK_NULL_HANDLE;
+    }
+
+    m_pipelineHandle = VK_NULL_HANDLE;
+    m_stateHash      = {};
+}
+
+} // namespace VkToolbox
@@ -8,6 +8,7 @@
 // ================================================================================================
 
 #include "VulkanContext.hpp"
+#include "Hashing.hpp"
 
 namespace VkToolbox
 {
@@ -29,6 +30,13 @@ public:
     PipelineStateLayout & operator = (const PipelineStateLayout &) = delete;
 
     void initialize(array_view<const VkDescriptorSetLayout> descriptorSetLayouts);
+
+    // Overload declaring push constant ranges alongside the descriptor set
+    // layouts. Data for the ranges is supplied per-draw with
+    // CommandBuffer::pushConstants().
+    void initialize(array_view<const VkDescriptorSetLayout> descriptorSetLayouts,
+                    array_view<const VkPushConstantRange> pushConstantRanges);
+
     void shutdown();
     bool isInitialized() const;
 
@@ -48,12 +56,23 @@ private:
 
 struct PipelineStateBuilder final
 {
-    static constexpr int MaxColorBlends  = 6; // Arbitrary
-    static constexpr int MaxShaderStages = 6; // GlslShaderStage::MaxStages
+    static constexpr int MaxColorBlends   = 6;  // Arbitrary
+    static constexpr int MaxShaderStages  = 6;  // GlslShaderStage::MaxStages
+    static constexpr int MaxSpecConstants = 16; // Arbitrary
 
     std::array<VkPipelineColorBlendAttachmentState, MaxColorBlends>  colorBlendStates;
     std::array<VkPipelineShaderStageCreateInfo,     MaxShaderStages> shaderPipelineStages;
 
+    // Specialization constants patched into the SPIR-V modules at pipeline
+    // creation, so one compiled shader can serve several permutations that
+    // would otherwise each need their own #define recompile. All constants
+    // are 4 bytes wide (bool/int/uint/float), which is everything our GLSL
+    // declares with constant_id. Set them with setSpecConstant() and hand
+    // specInfo() to GlslShader::pipelineStages().
+    std::array<VkSpecializationMapEntry, MaxSpecConstants> specMapEntries;
+    std::array<std::uint32_t,            MaxSpecConstants> specConstantData;
+    VkSpecializationInfo                                   specializationInfo;
+
     VkViewport                             viewport;
     VkRect2D                               scissor;
     VkPipelineViewportStateCreateInfo      viewportState;
@@ -77,6 +96,21 @@ struct PipelineStateBuilder final
 
     // Explicitly set all the defaults for the pipeline state creation structs above.
     void defaults();
+
+    // Set or overwrite a specialization constant (layout(constant_id = N) in GLSL).
+    void setSpecConstant(std::uint32_t constantId, std::uint32_t value);
+    void setSpecConstant(std::uint32_t constantId, std::int32_t value);
+    void setSpecConstant(std::uint32_t constantId, float value);
+    void setSpecConstant(std::uint32_t constantId, bool value);
+
+    // Specialization info for the pipeline shader stages; null when no
+    // constants were set. Points into this builder, which must stay alive
+    // until the pipeline is created.
+    const VkSpecializationInfo * specInfo() const;
+
+    // Hash of all the state that defines the resulting pipeline. Two builders
+    // with the same hash produce identical VkPipelines and can share one.
+    Hash64 stateHash() const;
 };
 
 // ========================================================
@@ -107,6 +141,7 @@ public:
 private:
 
     VkPipeline m_pipelineHandle = VK_NULL_HANDLE;
+    Hash64 m_stateHash; // Key into the shared pipeline registry.
     const PipelineStateLayout * m_layout = nullptr;
 };
 
@@ -132,6 +167,12 @@ inline PipelineStateLayout::~PipelineStateLayout()
 }
 
 inline void PipelineStateLayout::initialize(array_view<const VkDescriptorSetLayout> descriptorSetLayouts)
+{
+    initialize(descriptorSetLayouts, {});
+}
+
+inline void PipelineStateLayout::initialize(array_view<const VkDescriptorSetLayout> descriptorSetLayouts,
+                                            array_view<const VkPushConstantRange> pushConstantRanges)
 {
     assert(!descriptorSetLayouts.empty());
     assert(!isInitialized());
@@ -142,8 +183,8 @@ inline void PipelineStateLayout::initialize(array_view<const VkDescriptorSetLayo
     pipelineLayoutInfo.flags                  = 0;
     pipelineLayoutInfo.setLayoutCount         = static_cast<std::uint32_t>(descriptorSetLayouts.size());
     pipelineLayoutInfo.pSetLayouts            = descriptorSetLayouts.data();
-    pipelineLayoutInfo.pushConstantRangeCount = 0;
-    pipelineLayoutInfo.pPushConstantRanges    = nullptr;
+    pipelineLayoutInfo.pushConstantRangeCount = static_cast<std::uint32_t>(pushConstantRanges.size());
+    pipelineLayoutInfo.pPushConstantRanges    = pushConstantRanges.data();
 
     VKTB_CHECK(vkCreatePipelineLayout(m_vkContext->deviceHandle(), &pipelineLayoutInfo,
                                       m_vkContext->allocationCallbacks(), &m_pipelineLayoutHandle));
@@ -181,6 +222,17 @@ inline void PipelineStateBuilder::defaults()
         shaderPipelineStages[i] = {};
     }
 
+    for (int i = 0; i < MaxSpecConstants; ++i)
+    {
+        specMapEntries[i]   = {};
+        specConstantData[i] = 0;
+    }
+
+    specializationInfo.mapEntryCount = 0;
+    specializationInfo.pMapEntries   = specMapEntries.data();
+    specializationInfo.dataSize      = 0;
+    specializationInfo.pData         = specConstantData.data();
+
     viewport.x = 0.0f;
     viewport.y = 0.0f;
     viewport.width = 0.0f;
@@ -290,6 +342,51 @@ inline void PipelineStateBuilder::defaults()
     pipelineState.basePipelineIndex = 0;
 }
 
+inline void PipelineStateBuilder::setSpecConstant(const std::uint32_t constantId, const std::uint32_t value)
+{
+    // Overwrite if the constant was already set:
+    for (std::uint32_t e = 0; e < specializationInfo.mapEntryCount; ++e)
+    {
+        if (specMapEntries[e].constantID == constantId)
+        {
+            specConstantData[e] = value;
+            return;
+        }
+    }
+
+    assert(specializationInfo.mapEntryCount < MaxSpecConstants);
+    const std::uint32_t e = specializationInfo.mapEntryCount++;
+
+    specMapEntries[e].constantID = constantId;
+    specMapEntries[e].offset     = e * sizeof(std::uint32_t);
+    specMapEntries[e].size       = sizeof(std::uint32_t);
+    specConstantData[e]          = value;
+
+    specializationInfo.dataSize = specializationInfo.mapEntryCount * sizeof(std::uint32_t);
+}
+
+inline void PipelineStateBuilder::setSpecConstant(const std::uint32_t constantId, const std::int32_t value)
+{
+    setSpecConstant(constantId, static_cast<std::uint32_t>(value));
+}
+
+inline void PipelineStateBuilder::setSpecConstant(const std::uint32_t constantId, const float value)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    setSpecConstant(constantId, bits);
+}
+
+inline void PipelineStateBuilder::setSpecConstant(const std::uint32_t constantId, const bool value)
+{
+    setSpecConstant(constantId, static_cast<std::uint32_t>(value ? VK_TRUE : VK_FALSE));
+}
+
+inline const VkSpecializationInfo * PipelineStateBuilder::specInfo() const
+{
+    return (specializationInfo.mapEntryCount != 0) ? &specializationInfo : nullptr;
+}
+
 // ========================================================
 // PipelineStateObject inline methods:
 // ========================================================
@@ -311,22 +408,6 @@ inline PipelineStateObject::~PipelineStateObject()
     shutdown();
 }
 
-inline void PipelineStateObject::initialize(const PipelineStateBuilder & psoBuilder)
-{
-    assert(!isInitialized());
-    VKTB_CHECK(vkCreateGraphicsPipelines(context().deviceHandle(), VK_NULL_HANDLE, 1, &psoBuilder.pipelineState,
-                                         context().allocationCallbacks(), &m_pipelineHandle));
-}
-
-inline void PipelineStateObject::shutdown()
-{
-    if (m_pipelineHandle != VK_NULL_HANDLE)
-    {
-        vkDestroyPipeline(context().deviceHandle(), m_pipelineHandle, context().allocationCallbacks());
-        m_pipelineHandle = VK_NULL_HANDLE;
-    }
-}
-
 inline bool PipelineStateObject::isInitialized() const
 {
     return (m_pipelineHandle != VK_NULL_HANDLE);
@@ -8,10 +8,12 @@
 // ================================================================================================
 
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <memory>
 #include <utility>
+#include <vector>
 
 namespace VkToolbox
 {
@@ -219,6 +221,229 @@ constexpr std::size_t Pool<T, Granularity>::pooledObjectSize()
     return sizeof(T);
 }
 
+// ========================================================
+// class FrameArena:
+// ========================================================
+
+//
+// Linear bump allocator for frame-transient memory.
+//
+// Where Pool<T> recycles fixed-size blocks with individual frees, the arena
+// hands out variable-size allocations by bumping a cursor through one big
+// buffer and reclaims everything wholesale with reset() - which the context
+// calls at the top of each frame. That makes per-frame scratch allocations
+// (temporary vectors, staging structs, sort keys) effectively free and keeps
+// malloc/free out of the steady-state frame loop.
+//
+// Never hold arena memory across a frame boundary - reset() invalidates it.
+//
+class FrameArena final
+{
+public:
+
+    static constexpr std::size_t DefaultCapacityBytes = 2 * 1024 * 1024;
+    static constexpr std::size_t DefaultAlignment     = alignof(std::max_align_t);
+
+    // Global arena reset by VulkanContext::beginFrame() -
+    // the one FrameArenaAllocator defaults to.
+    static FrameArena & shared()
+    {
+        static FrameArena s_instance;
+        return s_instance;
+    }
+
+    explicit FrameArena(const std::size_t capacityBytes = DefaultCapacityBytes)
+        : m_buffer{ new std::uint8_t[capacityBytes] }
+        , m_capacityBytes{ capacityBytes }
+    { }
+
+    ~FrameArena()
+    {
+        freeOverflowBlocks();
+    }
+
+    // Not copyable.
+    FrameArena(const FrameArena &) = delete;
+    FrameArena & operator = (const FrameArena &) = delete;
+
+    // Carve sizeBytes out of the arena. Never fails: requests that don't fit
+    // fall back to the heap and the arena grows itself on the next reset(),
+    // so overflow is a one-frame hiccup, not a crash.
+    void * allocate(const std::size_t sizeBytes, const std::size_t alignment = DefaultAlignment)
+    {
+        assert(sizeBytes != 0);
+        assert((alignment & (alignment - 1)) == 0); // Must be a power of two.
+
+        const auto bufferAddr  = reinterpret_cast<std::uintptr_t>(m_buffer.get());
+        const auto alignedAddr = (bufferAddr + m_offsetBytes + (alignment - 1)) & ~(alignment - 1);
+        const auto endOffset   = (alignedAddr - bufferAddr) + sizeBytes;
+
+        if (endOffset <= m_capacityBytes)
+        {
+            m_offsetBytes = endOffset;
+            if (m_offsetBytes > m_highWatermarkBytes)
+            {
+                m_highWatermarkBytes = m_offsetBytes;
+            }
+            return reinterpret_cast<void *>(alignedAddr);
+        }
+
+        return allocateOverflow(sizeBytes, alignment);
+    }
+
+    // Typed helper - uninitialized memory for 'count' objects of T.
+    template<typename T>
+    T * allocateT(const int count = 1)
+    {
+        return static_cast<T *>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // Rewind the arena to empty, invalidating every pointer handed out since
+    // the previous reset. Overflow blocks are returned to the heap and the
+    // main buffer is regrown to cover them next frame.
+    void reset()
+    {
+        if (!m_overflowBlocks.empty())
+        {
+            freeOverflowBlocks();
+
+            // Double until the overflowed frame would have fit.
+            std::size_t newCapacity = m_capacityBytes * 2;
+            while (newCapacity < m_highWatermarkBytes + m_overflowBytes)
+            {
+                newCapacity *= 2;
+            }
+
+            m_buffer.reset(new std::uint8_t[newCapacity]);
+            m_capacityBytes = newCapacity;
+            m_overflowBytes = 0;
+        }
+
+        m_offsetBytes = 0;
+    }
+
+    // Stats queries:
+    std::size_t capacityBytes()      const { return m_capacityBytes; }
+    std::size_t bytesUsed()          const { return m_offsetBytes; }
+    std::size_t highWatermarkBytes() const { return m_highWatermarkBytes; }
+
+private:
+
+    void * allocateOverflow(const std::size_t sizeBytes, const std::size_t alignment)
+    {
+        // Slow path - plain heap block, freed in bulk by the next reset().
+        auto block = new std::uint8_t[sizeBytes + alignment];
+        m_overflowBlocks.push_back(block);
+        m_overflowBytes += sizeBytes + alignment;
+
+        const auto blockAddr = reinterpret_cast<std::uintptr_t>(block);
+        return reinterpret_cast<void *>((blockAddr + (alignment - 1)) & ~(alignment - 1));
+    }
+
+    void freeOverflowBlocks()
+    {
+        for (std::uint8_t * block : m_overflowBlocks)
+        {
+            delete[] block;
+        }
+        m_overflowBlocks.clear();
+    }
+
+    std::unique_ptr<std::uint8_t[]> m_buffer;
+    std::size_t m_capacityBytes      = 0;
+    std::size_t m_offsetBytes        = 0;
+    std::size_t m_highWatermarkBytes = 0;
+
+    // Heap fallback blocks for requests that didn't fit this frame.
+    std::vector<std::uint8_t *> m_overflowBlocks;
+    std::size_t m_overflowBytes = 0;
+};
+
+// ========================================================
+// template class FrameArenaAllocator<T>:
+// ========================================================
+
+// STL-compatible adaptor so standard containers can ride a FrameArena.
+// deallocate() is a no-op - memory comes back wholesale on arena reset().
+// Defaults to the shared per-frame arena.
+template<typename T>
+class FrameArenaAllocator
+{
+public:
+
+    using value_type      = T;
+    using pointer         = T *;
+    using const_pointer   = const T *;
+    using reference       = T &;
+    using const_reference = const T &;
+    using size_type       = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    template<typename U>
+    struct rebind { using other = FrameArenaAllocator<U>; };
+
+    FrameArenaAllocator() noexcept
+        : m_arena{ &FrameArena::shared() }
+    { }
+
+    explicit FrameArenaAllocator(FrameArena & arena) noexcept
+        : m_arena{ &arena }
+    { }
+
+    template<typename U>
+    FrameArenaAllocator(const FrameArenaAllocator<U> & other) noexcept
+        : m_arena{ other.arena() }
+    { }
+
+    T * allocate(const std::size_t count)
+    {
+        return static_cast<T *>(m_arena->allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    void deallocate(T * /* ptr */, std::size_t /* count */)
+    {
+        // No-op - the arena reclaims everything on reset().
+    }
+
+    template<typename U, typename... Args>
+    void construct(U * ptr, Args&&... args)
+    {
+        ::new(ptr) U(std::forward<Args>(args)...);
+    }
+
+    template<typename U>
+    void destroy(U * ptr)
+    {
+        ptr->~U();
+    }
+
+    std::size_t max_size() const
+    {
+        return m_arena->capacityBytes() / sizeof(T);
+    }
+
+    FrameArena * arena() const { return m_arena; }
+
+private:
+
+    FrameArena * m_arena;
+};
+
+template<typename T, typename U>
+inline bool operator == (const FrameArenaAllocator<T> & a, const FrameArenaAllocator<U> & b)
+{
+    return a.arena() == b.arena();
+}
+template<typename T, typename U>
+inline bool operator != (const FrameArenaAllocator<T> & a, const FrameArenaAllocator<U> & b)
+{
+    return !(a == b);
+}
+
+// std::vector living in the frame arena - for per-frame temporaries only.
+template<typename T>
+using FrameVector = std::vector<T, FrameArenaAllocator<T>>;
+
 // ========================================================
 // construct() / destroy() helpers:
 // ========================================================
@@ -244,4 +469,13 @@ inline void destroy(T * obj)
     }
 }
 
+// Allocate from an arena and construct in place. There is no matching
+// per-object free - call destroy() before the arena reset if 'T' has a
+// non-trivial destructor, otherwise just let the reset reclaim it.
+template<typename T, typename... Args>
+inline T * constructInArena(FrameArena & arena, Args&&... args)
+{
+    return ::new(arena.allocateT<T>()) T(std::forward<Args>(args)...);
+}
+
 } // namespace VkToolbox
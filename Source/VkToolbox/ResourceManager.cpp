@@ -7,6 +7,8 @@
 // ================================================================================================
 
 #include "ResourceManager.hpp"
+#include "CpuProfiler.hpp"
+#include "FileWatcher.hpp"
 
 #ifdef _MSC_VER
     #include <intrin.h>
@@ -14,25 +16,17 @@
     {
         _InterlockedExchange8(reinterpret_cast<volatile char *>(dest), value);
     }
+    __forceinline bool compareExchangeByteAtomically(volatile std::uint8_t * dest,
+                                                     std::uint8_t expected, std::uint8_t desired)
+    {
+        return _InterlockedCompareExchange8(reinterpret_cast<volatile char *>(dest),
+                                            desired, expected) == static_cast<char>(expected);
+    }
 #endif // _MSC_VER
 
 namespace VkToolbox
 {
 
-// ========================================================
-
-template<typename T>
-const char * resourceManagerThreadName(); // unimplemented - fails to link
-
-template<> const char * resourceManagerThreadName<Texture>()
-{
-    return "TextureLoaderThread";
-}
-template<> const char * resourceManagerThreadName<GlslShader>()
-{
-    return "ShaderLoaderThread";
-}
-
 // ========================================================
 // ResourceManager common:
 // ========================================================
@@ -50,10 +44,19 @@ template<typename T>
 bool ResourceManager<T>::sm_inResourceLoadState(false);
 
 template<typename T>
-JobQueue ResourceManager<T>::sm_asyncLoadRequests(resourceManagerThreadName<T>());
+bool ResourceManager<T>::sm_watchSourceFiles(false);
 
 template<typename T>
-std::vector<std::uint8_t> ResourceManager<T>::sm_pendingAsyncRequestFlags;
+std::vector<std::uint8_t> ResourceManager<T>::sm_asyncLoadStates;
+
+template<typename T>
+std::vector<JobSystem::JobHandle> ResourceManager<T>::sm_pendingAsyncJobs;
+
+template<typename T>
+std::mutex ResourceManager<T>::sm_pendingAsyncJobsMutex;
+
+template<typename T>
+typename ResourceManager<T>::AsyncLoadCallback ResourceManager<T>::sm_asyncLoadCallback;
 
 // ========================================================
 
@@ -61,21 +64,23 @@ template<typename T>
 void ResourceManager<T>::initialize(const VulkanContext & vkContext)
 {
     sm_vkContext = &vkContext;
-    sm_asyncLoadRequests.launch();
 }
 
 template<typename T>
 void ResourceManager<T>::shutdown()
 {
+    waitPendingAsyncLoadRequests();
+
     sm_resourcesStore.clear();
     sm_resourcesStore.shrink_to_fit();
 
-    sm_pendingAsyncRequestFlags.clear();
-    sm_pendingAsyncRequestFlags.shrink_to_fit();
+    sm_asyncLoadStates.clear();
+    sm_asyncLoadStates.shrink_to_fit();
 
-    sm_resourcesLookupTable.clear_and_free();
+    sm_resourcesLookupTable.clearAndFree();
 
-    sm_vkContext = nullptr;
+    sm_asyncLoadCallback   = nullptr;
+    sm_vkContext           = nullptr;
     sm_inResourceLoadState = false;
 }
 
@@ -85,7 +90,11 @@ void ResourceManager<T>::preallocate(const int resourceCount)
     if (resourceCount > 0)
     {
         sm_resourcesStore.reserve(resourceCount);
-        sm_pendingAsyncRequestFlags.reserve(resourceCount);
+        sm_asyncLoadStates.reserve(resourceCount);
+
+        // Also size the lookup index so registering the hinted number of
+        // resources never rehashes in the middle of a load burst.
+        sm_resourcesLookupTable.reserve(resourceCount);
     }
 }
 
@@ -105,27 +114,69 @@ template<typename T>
 void ResourceManager<T>::pushAsyncLoadRequest(const ResourceIndex resIndex)
 {
     assert(resIndex < sm_resourcesStore.size());
-    writeByteAtomically(&sm_pendingAsyncRequestFlags[resIndex], true);
-    sm_asyncLoadRequests.pushJob([resIndex]()
+
+    // Idle -> Queued (or retry a previously failed slot). If the slot is
+    // already queued or loading on a worker, this request is redundant.
+    if (!compareExchangeByteAtomically(&sm_asyncLoadStates[resIndex], AsyncLoadIdle, AsyncLoadQueued) &&
+        !compareExchangeByteAtomically(&sm_asyncLoadStates[resIndex], AsyncLoadFailed, AsyncLoadQueued))
+    {
+        return;
+    }
+
+    JobSystem::JobHandle jobHandle = JobSystem::shared().pushJob([resIndex]()
     {
-        if (!mutableResourceRef(resIndex).load())
+        writeByteAtomically(&sm_asyncLoadStates[resIndex], AsyncLoadLoading);
+
+        const bool loaded = mutableResourceRef(resIndex).load();
+        if (!loaded)
         {
             Log::warningF("Async load request failed for resource at index %u", resIndex);
         }
-        writeByteAtomically(&sm_pendingAsyncRequestFlags[resIndex], false);
+
+        writeByteAtomically(&sm_asyncLoadStates[resIndex], loaded ? AsyncLoadIdle : AsyncLoadFailed);
+
+        if (sm_asyncLoadCallback != nullptr)
+        {
+            sm_asyncLoadCallback(resIndex, loaded);
+        }
     });
+
+    std::lock_guard<std::mutex> lock{ sm_pendingAsyncJobsMutex };
+    sm_pendingAsyncJobs.push_back(std::move(jobHandle));
 }
 
 template<typename T>
 void ResourceManager<T>::waitPendingAsyncLoadRequests()
 {
-    sm_asyncLoadRequests.waitAll();
+    std::vector<JobSystem::JobHandle> jobHandles;
+    {
+        std::lock_guard<std::mutex> lock{ sm_pendingAsyncJobsMutex };
+        jobHandles.swap(sm_pendingAsyncJobs);
+    }
+
+    for (const JobSystem::JobHandle & jobHandle : jobHandles)
+    {
+        JobSystem::shared().wait(jobHandle);
+    }
 }
 
 template<typename T>
 bool ResourceManager<T>::hasPendingAsyncLoadRequest(const ResourceIndex resIndex)
 {
-    return (sm_pendingAsyncRequestFlags[resIndex] != false);
+    const auto state = sm_asyncLoadStates[resIndex];
+    return (state == AsyncLoadQueued || state == AsyncLoadLoading);
+}
+
+template<typename T>
+void ResourceManager<T>::setAsyncLoadCallback(AsyncLoadCallback callback)
+{
+    sm_asyncLoadCallback = std::move(callback);
+}
+
+template<typename T>
+void ResourceManager<T>::setWatchSourceFiles(const bool enable)
+{
+    sm_watchSourceFiles = enable;
 }
 
 template<typename T>
@@ -134,11 +185,16 @@ typename ResourceManager<T>::ResourceIndex ResourceManager<T>::createNewSlot(Res
     const auto hashKey = id.hash.value;
 
     sm_resourcesStore.emplace_back(*sm_vkContext, std::move(id));
-    sm_pendingAsyncRequestFlags.push_back(false);
+    sm_asyncLoadStates.push_back(AsyncLoadIdle);
 
     const auto index = narrowCast<ResourceIndex>(sm_resourcesStore.size() - 1);
     sm_resourcesLookupTable.insert(hashKey, index);
 
+    if (sm_watchSourceFiles)
+    {
+        FileWatcher::watchResourceFile<ResourceManager<T>>(index);
+    }
+
     return index;
 }
 
@@ -153,7 +209,34 @@ bool ResourceManager<T>::findLoaded(const ResourceId & inResId, ResourceIndex *
                                                         return key == item.resourceId();
                                                     });
 
-    if (index == HashIndex::null_index)
+    if (index == HashIndex::NullIndex)
+    {
+        (*outResIndex) = InvalidResIndex;
+        return false; // Not registered
+    }
+
+    if (!sm_resourcesStore[index].isLoaded())
+    {
+        (*outResIndex) = InvalidResIndex;
+        return false; // Not loaded
+    }
+
+    (*outResIndex) = index;
+    return true;
+}
+
+template<typename T>
+bool ResourceManager<T>::findLoaded(const Hash64 inResIdHash, ResourceIndex * outResIndex)
+{
+    assert(!inResIdHash.isNull());
+    assert(outResIndex != nullptr);
+
+    const auto index = sm_resourcesLookupTable.find(inResIdHash.value, inResIdHash, sm_resourcesStore,
+                                                    [](const Hash64 key, const T & item) {
+                                                        return key == item.resourceId().hash;
+                                                    });
+
+    if (index == HashIndex::NullIndex)
     {
         (*outResIndex) = InvalidResIndex;
         return false; // Not registered
@@ -172,6 +255,8 @@ bool ResourceManager<T>::findLoaded(const ResourceId & inResId, ResourceIndex *
 template<typename T>
 bool ResourceManager<T>::findOrLoad(ResourceId inResId, ResourceIndex * outResIndex)
 {
+    VKTB_PROFILE_SCOPE("ResourceManager::findOrLoad");
+
     assert(!inResId.isNull());
     assert(outResIndex != nullptr);
     assert(sm_inResourceLoadState);
@@ -181,7 +266,7 @@ bool ResourceManager<T>::findOrLoad(ResourceId inResId, ResourceIndex * outResIn
                                                   return key == item.resourceId();
                                               });
 
-    if (index == HashIndex::null_index) // Register the slot if needed
+    if (index == HashIndex::NullIndex) // Register the slot if needed
     {
         index = createNewSlot(std::move(inResId));
     }
@@ -204,7 +289,7 @@ void ResourceManager<T>::registerSlot(ResourceId inResId, ResourceIndex * outRes
                                               });
 
     // Register new or just return existing:
-    if (index == HashIndex::null_index)
+    if (index == HashIndex::NullIndex)
     {
         index = createNewSlot(std::move(inResId));
     }
@@ -220,7 +305,7 @@ bool ResourceManager<T>::isRegistered(const ResourceId & inResId)
                                                     [](const ResourceId & key, const T & item) {
                                                         return key == item.resourceId();
                                                     });
-    return index != HashIndex::null_index;
+    return index != HashIndex::NullIndex;
 }
 
 template<typename T>
@@ -280,7 +365,7 @@ void ResourceManager<T>::unregisterAll()
 {
     unloadAll();
     sm_resourcesLookupTable.clear();
-    sm_pendingAsyncRequestFlags.clear();
+    sm_asyncLoadStates.clear();
     sm_resourcesStore.clear();
 }
 
@@ -345,11 +430,9 @@ void ResourceManager<Texture>::endResourceLoad()
     assert(sm_inResourceLoadState);
     sm_inResourceLoadState = false;
 
-    const CommandBuffer & cmdBuff = sm_vkContext->mainTextureStagingCmdBuffer();
-    cmdBuff.endRecording();
-
-    cmdBuff.submitAndWaitComplete(sm_vkContext->graphisQueue());
-    cmdBuff.reset();
+    // Submits the main staging buffer plus any per-thread staging buffers the
+    // async load workers created, in one batch, and waits for completion.
+    sm_vkContext->submitAllTextureStagingCmdBuffers();
 
     #if DEBUG
     int releasedCount = 0;
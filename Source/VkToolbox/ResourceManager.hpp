@@ -9,9 +9,10 @@
 
 #include "Texture.hpp"
 #include "GlslShader.hpp"
-#include "JobQueue.hpp"
+#include "JobSystem.hpp"
 
 #include <cstdint>
+#include <mutex>
 #include <vector>
 
 namespace VkToolbox
@@ -42,9 +43,11 @@ public:
     static void endResourceLoad();
 
     // Push an async job to load (or reload) an already registered resource.
-    // It is not safe to attempt using the resource before the request has completed.
-    // Call waitPendingAsyncLoadRequests() to finish all pending jobs. This must also
-    // happen between beginResourceLoad/endResourceLoad.
+    // Requests fan out over the shared JobSystem workers, so several resources
+    // load in parallel. It is not safe to attempt using the resource before the
+    // request has completed. Call waitPendingAsyncLoadRequests() to finish all
+    // pending jobs. This must also happen between beginResourceLoad/endResourceLoad.
+    // Pushing a request for a slot that is already queued or loading is a no-op.
     static void pushAsyncLoadRequest(ResourceIndex resIndex);
 
     // Wait all pending requests to finish loading, so you can safely call endResourceLoad().
@@ -53,12 +56,29 @@ public:
     // Check if the given resource was already queued for async load and hasn't finished yet.
     static bool hasPendingAsyncLoadRequest(ResourceIndex resIndex);
 
+    // Optional hook invoked on the worker thread whenever an async load
+    // request completes, successfully or not. Set to null to disable.
+    using AsyncLoadCallback = InPlaceFunction32<void(ResourceIndex, bool)>;
+    static void setAsyncLoadCallback(AsyncLoadCallback callback);
+
+    // When enabled, every slot registered from now on is also registered
+    // with the FileWatcher, so a change to the backing file on disk pushes
+    // a targeted async reload of just that slot - no reloadAll() sweep.
+    // Shaders are safe to watch at any time; only enable it for textures
+    // if the app brackets FileWatcher::poll() with begin/endResourceLoad.
+    static void setWatchSourceFiles(bool enable);
+
     // Preallocate storage for a number of resources. The parameter is merely a hint.
     static void preallocate(int resourceCount);
 
     // Test if a slot for the resource is registered AND the resource is loaded.
     static bool findLoaded(const ResourceId & inResId, ResourceIndex * outResIndex);
 
+    // Same, but for callers holding a precomputed id hash (e.g. a compile-time
+    // hashed string literal - see Hashing.hpp). Never touches the id characters,
+    // so this is the variant to call from per-frame code.
+    static bool findLoaded(Hash64 inResIdHash, ResourceIndex * outResIndex);
+
     // Find existing resource. If no slot registered, one is created. If not loaded yet, load the resource.
     static bool findOrLoad(ResourceId inResId, ResourceIndex * outResIndex);
 
@@ -94,6 +114,11 @@ public:
     //       since the underlaying store might be moved or reallocated!
     static const T & resourceRef(ResourceIndex resIndex);
 
+    // Mutable variant of resourceRef() - used by the load/unload internals
+    // and by subsystems that tweak per-resource load parameters before a
+    // reload (e.g. the texture residency manager). Same storage caveat.
+    static T & mutableResourceRef(ResourceIndex resIndex);
+
     // Convert a resource reference back into an index.
     static ResourceIndex indexOf(const T & ref);
 
@@ -105,19 +130,33 @@ private:
     // Expand the resource store by one item and also register the new index into the LUT.
     static ResourceIndex createNewSlot(ResourceId id);
 
-    // Internal variant of resourceRef() for load/unload mutable calls.
-    static T & mutableResourceRef(ResourceIndex resIndex);
-
 private:
 
-    using HashIndex = hash_index<ResourceIndex, std::uint64_t>;
-
-    static const VulkanContext *     sm_vkContext;
-    static std::vector<T>            sm_resourcesStore;
-    static HashIndex                 sm_resourcesLookupTable;
-    static bool                      sm_inResourceLoadState;
-    static JobQueue                  sm_asyncLoadRequests;
-    static std::vector<std::uint8_t> sm_pendingAsyncRequestFlags;
+    using HashIndex = FlatHashIndex<ResourceIndex, std::uint64_t>;
+
+    // Per-slot async load state machine. Transitions are done with atomic
+    // byte ops since the flags are shared with the JobSystem workers:
+    //   Idle -> Queued   (pushAsyncLoadRequest, main thread)
+    //   Queued -> Loading (worker picks the job up)
+    //   Loading -> Idle | Failed (worker, load result)
+    //   Failed -> Queued (pushAsyncLoadRequest retries a failed slot)
+    enum AsyncLoadState : std::uint8_t
+    {
+        AsyncLoadIdle,
+        AsyncLoadQueued,
+        AsyncLoadLoading,
+        AsyncLoadFailed
+    };
+
+    static const VulkanContext *               sm_vkContext;
+    static std::vector<T>                      sm_resourcesStore;
+    static HashIndex                           sm_resourcesLookupTable;
+    static bool                                sm_inResourceLoadState;
+    static bool                                sm_watchSourceFiles;
+    static std::vector<std::uint8_t>           sm_asyncLoadStates;
+    static std::vector<JobSystem::JobHandle>   sm_pendingAsyncJobs;
+    static std::mutex                          sm_pendingAsyncJobsMutex;
+    static AsyncLoadCallback                   sm_asyncLoadCallback;
 };
 
 // ========================================================
@@ -0,0 +1,209 @@
+
+// ================================================================================================
+// File: VkToolbox/Scene.cpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Flat scene container with data-parallel instance update and culling.
+// ================================================================================================
+
+#include "Scene.hpp"
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace VkToolbox
+{
+
+// ========================================================
+// class Scene:
+// ========================================================
+
+int Scene::registerModel(const Model3D * const model)
+{
+    assert(model != nullptr);
+    assert(model->isLoaded()); // Need the mesh AABBs below.
+
+    // Union of the submesh boxes = model-space bounds of the whole model:
+    MeshAabb modelAabb;
+    modelAabb.mins = { FLT_MAX, FLT_MAX, FLT_MAX };
+    modelAabb.maxs = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+    for (const MeshAabb & aabb : model->mesh().submeshAabbArray())
+    {
+        modelAabb.mins.x = std::min(modelAabb.mins.x, aabb.mins.x);
+        modelAabb.mins.y = std::min(modelAabb.mins.y, aabb.mins.y);
+        modelAabb.mins.z = std::min(modelAabb.mins.z, aabb.mins.z);
+        modelAabb.maxs.x = std::max(modelAabb.maxs.x, aabb.maxs.x);
+        modelAabb.maxs.y = std::max(modelAabb.maxs.y, aabb.maxs.y);
+        modelAabb.maxs.z = std::max(modelAabb.maxs.z, aabb.maxs.z);
+    }
+
+    const int modelIndex = narrowCast<int>(m_models.size());
+    m_models.push_back(model);
+    m_modelAabbs.push_back(modelAabb);
+    return modelIndex;
+}
+
+void Scene::reserveInstances(const int count)
+{
+    const int paddedCount = roundUpToMultiple(count, 4);
+
+    m_instanceModels.reserve(count);
+    m_instanceFlags.reserve(count);
+    m_instanceTransforms.reserve(count);
+    m_uniformOffsets.reserve(count);
+    m_visibleList.reserve(count);
+
+    m_boundsCenterX.reserve(paddedCount);
+    m_boundsCenterY.reserve(paddedCount);
+    m_boundsCenterZ.reserve(paddedCount);
+    m_boundsExtentX.reserve(paddedCount);
+    m_boundsExtentY.reserve(paddedCount);
+    m_boundsExtentZ.reserve(paddedCount);
+    m_visibility.reserve(paddedCount);
+}
+
+int Scene::addInstance(const int modelIndex, const Matrix4 & transform, const std::uint32_t flags)
+{
+    assert(modelIndex >= 0 && modelIndex < modelCount());
+
+    const int instanceIndex = m_instanceCount++;
+    m_paddedInstanceCount   = roundUpToMultiple(m_instanceCount, 4);
+
+    m_instanceModels.push_back(narrowCast<std::uint16_t>(modelIndex));
+    m_instanceFlags.push_back(flags);
+    m_instanceTransforms.push_back(transform);
+    m_uniformOffsets.push_back(0);
+
+    // Grow the padded SoA bounds arrays (pad entries stay zeroed):
+    m_boundsCenterX.resize(m_paddedInstanceCount, 0.0f);
+    m_boundsCenterY.resize(m_paddedInstanceCount, 0.0f);
+    m_boundsCenterZ.resize(m_paddedInstanceCount, 0.0f);
+    m_boundsExtentX.resize(m_paddedInstanceCount, 0.0f);
+    m_boundsExtentY.resize(m_paddedInstanceCount, 0.0f);
+    m_boundsExtentZ.resize(m_paddedInstanceCount, 0.0f);
+    m_visibility.resize(m_paddedInstanceCount, 0);
+
+    // Seed the bounds now, so static instances never need an updateInstances() pass:
+    updateInstanceBounds(instanceIndex);
+    return instanceIndex;
+}
+
+void Scene::updateInstanceBounds(const int instanceIndex)
+{
+    const MeshAabb & localAabb = m_modelAabbs[m_instanceModels[instanceIndex]];
+    const Matrix4 &  transform = m_instanceTransforms[instanceIndex];
+
+    const float cx = (localAabb.mins.x + localAabb.maxs.x) * 0.5f;
+    const float cy = (localAabb.mins.y + localAabb.maxs.y) * 0.5f;
+    const float cz = (localAabb.mins.z + localAabb.maxs.z) * 0.5f;
+    const float ex = (localAabb.maxs.x - localAabb.mins.x) * 0.5f;
+    const float ey = (localAabb.maxs.y - localAabb.mins.y) * 0.5f;
+    const float ez = (localAabb.maxs.z - localAabb.mins.z) * 0.5f;
+
+    // Transform the center and project the extents onto the rotated axes
+    // (absolute 3x3) - the standard transformed-AABB-of-an-AABB trick. The
+    // matrix is column-major, same convention as Frustum::setFromMatrix().
+    m_boundsCenterX[instanceIndex] = (transform[0][0] * cx) + (transform[1][0] * cy) + (transform[2][0] * cz) + transform[3][0];
+    m_boundsCenterY[instanceIndex] = (transform[0][1] * cx) + (transform[1][1] * cy) + (transform[2][1] * cz) + transform[3][1];
+    m_boundsCenterZ[instanceIndex] = (transform[0][2] * cx) + (transform[1][2] * cy) + (transform[2][2] * cz) + transform[3][2];
+
+    m_boundsExtentX[instanceIndex] = (std::fabs(transform[0][0]) * ex) + (std::fabs(transform[1][0]) * ey) + (std::fabs(transform[2][0]) * ez);
+    m_boundsExtentY[instanceIndex] = (std::fabs(transform[0][1]) * ex) + (std::fabs(transform[1][1]) * ey) + (std::fabs(transform[2][1]) * ez);
+    m_boundsExtentZ[instanceIndex] = (std::fabs(transform[0][2]) * ex) + (std::fabs(transform[1][2]) * ey) + (std::fabs(transform[2][2]) * ez);
+}
+
+void Scene::updateInstances()
+{
+    JobSystem::shared().parallelFor(0, m_instanceCount, UpdateGrainSize,
+        [this](const int chunkStart, const int chunkEnd)
+        {
+            for (int i = chunkStart; i < chunkEnd; ++i)
+            {
+                if (m_instanceFlags[i] & FlagStatic)
+                {
+                    continue; // Bounds were seeded by addInstance() and can't go stale.
+                }
+                updateInstanceBounds(i);
+            }
+        });
+}
+
+void Scene::cullInstances(const Frustum & frustum)
+{
+    const AabbSoA boxes = {
+        m_boundsCenterX.data(), m_boundsCenterY.data(), m_boundsCenterZ.data(),
+        m_boundsExtentX.data(), m_boundsExtentY.data(), m_boundsExtentZ.data()
+    };
+    frustum.cullAabbs(boxes, m_paddedInstanceCount, m_visibility.data());
+
+    // Compact the survivors so the uniform write and draw submission can walk
+    // them linearly without re-testing bytes:
+    m_visibleList.clear();
+    for (int i = 0; i < m_instanceCount; ++i)
+    {
+        if (m_visibility[i] && !(m_instanceFlags[i] & FlagHidden))
+        {
+            m_visibleList.push_back(i);
+        }
+    }
+}
+
+void Scene::writeInstanceUniforms(UniformRingBuffer & uniformRing, const Matrix4 & viewProj)
+{
+    const int visibleCount = visibleInstanceCount();
+    if (visibleCount == 0)
+    {
+        return;
+    }
+
+    // One ring allocation covers every visible instance for the frame. Blocks
+    // are spaced by the dynamic-offset alignment so each one is individually
+    // addressable at descriptor bind time.
+    m_uniformBlockStride = roundUpToMultiple(narrowCast<int>(sizeof(InstanceUniforms)),
+                                             uniformRing.offsetAlignment());
+
+    const auto alloc = uniformRing.allocate(visibleCount * m_uniformBlockStride);
+
+    m_uniformWriteBase  = static_cast<std::uint8_t *>(alloc.mappedPtr);
+    m_uniformBaseOffset = alloc.dynamicOffset;
+    m_uniformViewProj   = viewProj;
+
+    JobSystem::shared().parallelFor(0, visibleCount, UpdateGrainSize,
+        [this](const int chunkStart, const int chunkEnd)
+        {
+            for (int slot = chunkStart; slot < chunkEnd; ++slot)
+            {
+                const int instanceIndex = m_visibleList[slot];
+                const Matrix4 & modelMatrix = m_instanceTransforms[instanceIndex];
+
+                auto * block = reinterpret_cast<InstanceUniforms *>(m_uniformWriteBase + (slot * m_uniformBlockStride));
+                block->modelMatrix = modelMatrix;
+                block->mvpMatrix   = m_uniformViewProj * modelMatrix;
+
+                m_uniformOffsets[instanceIndex] = m_uniformBaseOffset + (slot * m_uniformBlockStride);
+            }
+        });
+
+    m_uniformWriteBase = nullptr;
+}
+
+void Scene::drawInstances(const CommandBuffer & cmdBuff, VkPipelineLayout pipelineLayout,
+                          array_view<const VkDescriptorSet> descriptorSets) const
+{
+    const VulkanContext & ctx = *m_vkContext;
+
+    for (const int instanceIndex : m_visibleList)
+    {
+        const std::uint32_t dynamicOffsets[] = { m_uniformOffsets[instanceIndex] };
+        ctx.bindGraphicsDescriptorSets(cmdBuff, pipelineLayout, descriptorSets, make_array_view(dynamicOffsets));
+
+        m_models[m_instanceModels[instanceIndex]]->drawInstance(cmdBuff);
+    }
+}
+
+// ========================================================
+
+} // namespace VkToolbox
@@ -0,0 +1,194 @@
+#pragma once
+
+// ================================================================================================
+// File: VkToolbox/Scene.hpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Flat scene container with data-parallel instance update and culling.
+// ================================================================================================
+
+#include "Buffers.hpp"
+#include "Frustum.hpp"
+#include "Model3D.hpp"
+
+namespace VkToolbox
+{
+
+// ========================================================
+// class Scene:
+// ========================================================
+
+// Flat container for many instances of a few models. Instance state lives in
+// structure-of-arrays form (model index, transform, world-space bounds, flags),
+// so the per-frame passes - bounds update, SIMD frustum cull, uniform writes -
+// are linear sweeps over packed arrays that batch cleanly over the JobSystem
+// workers. No per-instance heap objects and no virtual dispatch anywhere;
+// this is meant to stay flat at tens of thousands of instances.
+//
+// Per-frame flow, after the app has moved whatever instances it animates:
+//
+//   scene.updateInstances();                        // world bounds from transforms (parallel)
+//   scene.cullInstances(Frustum{ camera.vpMatrix });
+//   scene.writeInstanceUniforms(ring, camera.vpMatrix);
+//   scene.drawInstances(cmdBuff, layout, sets);     // linear walk of the culled list
+//
+class Scene final
+{
+public:
+
+    // Instance flag bits:
+    enum : std::uint32_t
+    {
+        FlagStatic = 1 << 0, // Transform never changes - updateInstances() skips its bounds rebuild.
+        FlagHidden = 1 << 1, // Excluded from the visible list regardless of the frustum test.
+    };
+
+    // Per-instance uniform block written by writeInstanceUniforms(). Bind the
+    // ring through a VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC descriptor with
+    // range = sizeof(InstanceUniforms) and let drawInstances() feed the offsets.
+    struct InstanceUniforms
+    {
+        Matrix4 modelMatrix;
+        Matrix4 mvpMatrix;
+    };
+
+    explicit Scene(const VulkanContext & vkContext);
+
+    Scene(const Scene &) = delete;
+    Scene & operator = (const Scene &) = delete;
+
+    // Models are registered once, up front, and referenced by the returned
+    // index. The model must be loaded (its mesh AABBs seed the instance
+    // bounds) and must outlive the scene.
+    int registerModel(const Model3D * model);
+    int modelCount() const;
+
+    // Instances:
+    void reserveInstances(int count);
+    int addInstance(int modelIndex, const Matrix4 & transform, std::uint32_t flags = 0);
+    int instanceCount() const;
+
+    const Matrix4 & instanceTransform(int instanceIndex) const;
+    void setInstanceTransform(int instanceIndex, const Matrix4 & transform);
+
+    std::uint32_t instanceFlags(int instanceIndex) const;
+    void setInstanceFlags(int instanceIndex, std::uint32_t flags);
+
+    // Rebuilds the world-space bounds of every non-static instance from its
+    // transform and the model-space AABB of its model. Fans out over the
+    // JobSystem workers in contiguous chunks - call once per frame, after
+    // the app is done moving instances and before cullInstances().
+    void updateInstances();
+
+    // SIMD frustum test of the instance bounds (4 boxes per iteration), then
+    // compacts the survivors into the visible list the later passes iterate.
+    // Build the Frustum from the camera view-projection - instance bounds
+    // are already in world space.
+    void cullInstances(const Frustum & frustum);
+    int visibleInstanceCount() const;
+
+    // Writes the InstanceUniforms block of every visible instance into a
+    // single ring-buffer allocation for the frame (parallel fill), recording
+    // each instance's dynamic offset for drawInstances().
+    void writeInstanceUniforms(UniformRingBuffer & uniformRing, const Matrix4 & viewProj);
+
+    // Submits the visible instances in one linear sweep: per instance, bind
+    // the descriptor sets with its uniform block offset and draw the model.
+    // descriptorSets must contain the dynamic uniform descriptor wired to the
+    // ring buffer handed to writeInstanceUniforms().
+    void drawInstances(const CommandBuffer & cmdBuff, VkPipelineLayout pipelineLayout,
+                       array_view<const VkDescriptorSet> descriptorSets) const;
+
+private:
+
+    void updateInstanceBounds(int instanceIndex);
+
+    // Chunk size for the parallelFor fan-outs. Big enough that a chunk is
+    // worth stealing, small enough to balance across the workers.
+    static constexpr int UpdateGrainSize = 512;
+
+    const VulkanContext * m_vkContext;
+
+    // Registered models and their model-space AABBs (union of the mesh submesh
+    // boxes), indexed by the instances below:
+    std::vector<const Model3D *> m_models;
+    std::vector<MeshAabb>        m_modelAabbs;
+
+    // Instance state as SoA. The bounds arrays are padded to a multiple of 4
+    // entries for Frustum::cullAabbs(), pad entries zeroed.
+    int m_instanceCount       = 0;
+    int m_paddedInstanceCount = 0;
+
+    std::vector<std::uint16_t> m_instanceModels;
+    std::vector<std::uint32_t> m_instanceFlags;
+    std::vector<Matrix4>       m_instanceTransforms;
+
+    std::vector<float> m_boundsCenterX;
+    std::vector<float> m_boundsCenterY;
+    std::vector<float> m_boundsCenterZ;
+    std::vector<float> m_boundsExtentX;
+    std::vector<float> m_boundsExtentY;
+    std::vector<float> m_boundsExtentZ;
+
+    std::vector<std::uint8_t>  m_visibility;     // [padded count], nonzero = passed the frustum test.
+    std::vector<int>           m_visibleList;    // Compacted indexes of the drawable instances.
+    std::vector<std::uint32_t> m_uniformOffsets; // Dynamic offset of each instance's uniform block.
+
+    // Scratch state for the parallel uniform fill (valid during writeInstanceUniforms only):
+    std::uint8_t * m_uniformWriteBase   = nullptr;
+    std::uint32_t  m_uniformBaseOffset  = 0;
+    int            m_uniformBlockStride = 0;
+    Matrix4        m_uniformViewProj    = Matrix4::identity();
+};
+
+// ========================================================
+// Scene inline methods:
+// ========================================================
+
+inline Scene::Scene(const VulkanContext & vkContext)
+    : m_vkContext{ &vkContext }
+{
+}
+
+inline int Scene::modelCount() const
+{
+    return narrowCast<int>(m_models.size());
+}
+
+inline int Scene::instanceCount() const
+{
+    return m_instanceCount;
+}
+
+inline const Matrix4 & Scene::instanceTransform(const int instanceIndex) const
+{
+    assert(instanceIndex >= 0 && instanceIndex < m_instanceCount);
+    return m_instanceTransforms[instanceIndex];
+}
+
+inline void Scene::setInstanceTransform(const int instanceIndex, const Matrix4 & transform)
+{
+    assert(instanceIndex >= 0 && instanceIndex < m_instanceCount);
+    m_instanceTransforms[instanceIndex] = transform;
+}
+
+inline std::uint32_t Scene::instanceFlags(const int instanceIndex) const
+{
+    assert(instanceIndex >= 0 && instanceIndex < m_instanceCount);
+    return m_instanceFlags[instanceIndex];
+}
+
+inline void Scene::setInstanceFlags(const int instanceIndex, const std::uint32_t flags)
+{
+    assert(instanceIndex >= 0 && instanceIndex < m_instanceCount);
+    m_instanceFlags[instanceIndex] = flags;
+}
+
+inline int Scene::visibleInstanceCount() const
+{
+    return narrowCast<int>(m_visibleList.size());
+}
+
+// ========================================================
+
+} // namespace VkToolbox
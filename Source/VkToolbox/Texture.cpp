@@ -9,6 +9,8 @@
 #include "Texture.hpp"
 #include "ResourceManager.hpp"
 
+#include <mutex>
+
 namespace VkToolbox
 {
 
@@ -88,6 +90,12 @@ const VkSamplerCreateInfo & Sampler::defaults()
 
 std::uint32_t Texture::sm_stagingChainHead = TextureManager::InvalidResIndex;
 
+bool Texture::sm_streamDDSFiles = true;
+
+// Textures can now be loaded concurrently by the async load workers,
+// so pushes onto the shared staging chain have to be serialized.
+static std::mutex s_stagingChainMutex;
+
 const char * const Texture::LayerSuffixes[] = {
     "diff",
     "ddn",
@@ -111,6 +119,8 @@ Texture::Texture(const VulkanContext & vkContext, StrId<str> && id)
     , m_imageViewType{ VK_IMAGE_VIEW_TYPE_2D }
     , m_imageMipmapCount{ 0 }
     , m_imageLayerCount{ 0 }
+    , m_residentMipLimit{ 0 }
+    , m_droppedMipCount{ 0 }
     , m_dontGenMipmaps{ false }
 {
 }
@@ -129,6 +139,8 @@ Texture::Texture(Texture && other)
     , m_imageViewType{ other.m_imageViewType }
     , m_imageMipmapCount{ other.m_imageMipmapCount }
     , m_imageLayerCount{ other.m_imageLayerCount }
+    , m_residentMipLimit{ other.m_residentMipLimit }
+    , m_droppedMipCount{ other.m_droppedMipCount }
     , m_dontGenMipmaps{ other.m_dontGenMipmaps }
 {
     other.clear();
@@ -151,6 +163,8 @@ Texture & Texture::operator = (Texture && other)
     m_imageViewType          = other.m_imageViewType;
     m_imageMipmapCount       = other.m_imageMipmapCount;
     m_imageLayerCount        = other.m_imageLayerCount;
+    m_residentMipLimit       = other.m_residentMipLimit;
+    m_droppedMipCount        = other.m_droppedMipCount;
     m_dontGenMipmaps         = other.m_dontGenMipmaps;
 
     other.clear();
@@ -178,6 +192,44 @@ bool Texture::isArrayTextureName(const str_ref & name)
     }
 }
 
+// Runs an uncompressed image file through the DXT block compressor, caching
+// the compressed result on disk next to the source image so the compression
+// cost is only paid on the first load (or whenever the cache file is deleted).
+static bool loadDXTCompressedWithCache(const char * const imageFile, const bool genMipmaps,
+                                       DXTCompressedImage * outCompressedImage)
+{
+    str256 cacheFileName;
+    cacheFileName.setf("%s.dxtc", imageFile);
+
+    if (outCompressedImage->initFromCacheFile(cacheFileName.c_str()))
+    {
+        return true;
+    }
+
+    // Cache miss - load the source image and compress it now:
+    Image uncompressedImage;
+    if (!uncompressedImage.initFromFile(imageFile))
+    {
+        Log::warningF("Failed to load texture: %s", imageFile);
+        return false;
+    }
+
+    if (genMipmaps && !uncompressedImage.isMipmapped())
+    {
+        uncompressedImage.generateMipmapSurfaces();
+    }
+
+    if (!outCompressedImage->initFromUncompressed(uncompressedImage))
+    {
+        return false;
+    }
+
+    outCompressedImage->saveCacheFile(cacheFileName.c_str());
+    return true;
+}
+
+// ========================================================
+
 bool Texture::load()
 {
     if (isShutdown())
@@ -202,6 +254,13 @@ bool Texture::load()
 
     if (name.ends_with(".dds"))
     {
+        // Fast path: stream the mip levels straight into the staging memory
+        // with overlapped reads, skipping the in-memory image copy.
+        if (sm_streamDDSFiles && loadFromDDSStreamed(name.c_str()))
+        {
+            return true;
+        }
+
         DXTCompressedImage compressedImage;
         if (!compressedImage.initFromFile(name.c_str()))
         {
@@ -213,6 +272,16 @@ bool Texture::load()
     }
     else // Default loader from PNG/JPEG/etc:
     {
+        if (Image::sm_loadOptions.compressToDXT)
+        {
+            DXTCompressedImage compressedImage;
+            if (!loadDXTCompressedWithCache(name.c_str(), generateMipmapsOnLoad(), &compressedImage))
+            {
+                return false;
+            }
+            return loadFromImageInMemory(compressedImage);
+        }
+
         Image uncompressedImage;
         if (!uncompressedImage.initFromFile(name.c_str()))
         {
@@ -258,6 +327,21 @@ bool Texture::loadAsArrayTexture()
         const str32 ext{ texName, extIdx, texName.length() - extIdx };
         texName.truncate(extIdx); // Get rid of the extension
 
+        if (Image::sm_loadOptions.compressToDXT)
+        {
+            DXTCompressedImage compressedImages[MaxLayers];
+            for (int l = 0; l < MaxLayers; ++l)
+            {
+                layerName.setf("%s_%s%s", texName.c_str(), LayerSuffixes[l], ext.c_str());
+                if (!loadDXTCompressedWithCache(layerName.c_str(), generateMipmapsOnLoad(), &compressedImages[l]))
+                {
+                    return false;
+                }
+            }
+
+            return loadAsArrayTextureFromImagesInMemory(compressedImages, MaxLayers);
+        }
+
         Image uncompressedImages[MaxLayers];
         for (int l = 0; l < MaxLayers; ++l)
         {
@@ -279,26 +363,104 @@ bool Texture::loadAsArrayTexture()
     }
 }
 
+bool Texture::loadFromDDSStreamed(const char * const filePath)
+{
+    DDSFileLayout layout;
+    if (!queryDDSFileLayout(filePath, &layout))
+    {
+        return false;
+    }
+
+    AsyncFileReader file;
+    if (!file.open(filePath))
+    {
+        Log::warningF("Can't open DDS file '%s' for overlapped reading!", filePath);
+        return false;
+    }
+
+    // Same in-place reload concern as initVkTextureData().
+    if (isLoaded())
+    {
+        unload();
+    }
+
+    // When a resident mip limit is set the largest levels are never even
+    // read from disk - the file layout gives us the offset of each surface,
+    // so the load shrinks to just the tail of the mip chain.
+    const int skipCount     = surfaceSkipCount(layout.surfaceCount);
+    const int residentCount = layout.surfaceCount - skipCount;
+
+    std::size_t memorySizeBytes = 0;
+    for (int s = skipCount; s < layout.surfaceCount; ++s)
+    {
+        memorySizeBytes += layout.surfaces[s].sizeBytes;
+    }
+
+    const StagingAlloc staging = acquireStagingSpace(memorySizeBytes);
+
+    // Surfaces are laid out in the staging memory in the usual order (base
+    // level first), which is what initVkTextureFromStaging() expects. The
+    // reads themselves are queued smallest mip first, so the tail levels are
+    // resident long before the big base level lands - the order an eventual
+    // progressive per-frame upload (the virtual texturing idea in Plan.txt)
+    // would want them in.
+    ImageSurface surfaces[Image::MaxSurfaces];
+    auto * destPixels = static_cast<std::uint8_t *>(staging.mappedPtr);
+    for (int s = 0; s < residentCount; ++s)
+    {
+        surfaces[s].rawData   = destPixels;
+        surfaces[s].sizeBytes = layout.surfaces[s + skipCount].sizeBytes;
+        surfaces[s].size      = layout.surfaces[s + skipCount].size;
+        destPixels += surfaces[s].sizeBytes;
+    }
+
+    static_assert(AsyncFileReader::MaxPendingReads >= Image::MaxSurfaces, "One read per mip level!");
+
+    bool readsQueued = true;
+    for (int s = residentCount - 1; s >= 0; --s)
+    {
+        if (!file.queueRead(surfaces[s].rawData, layout.surfaces[s + skipCount].fileOffset,
+                            layout.surfaces[s + skipCount].sizeBytes))
+        {
+            readsQueued = false;
+            break;
+        }
+    }
+
+    // waitAll() also flags reads that came back short.
+    const bool readsCompleted = file.waitAll();
+    finishStagingWrites(staging);
+
+    if (!readsQueued || !readsCompleted)
+    {
+        Log::warningF("Streamed read of DDS file '%s' failed!", filePath);
+        releaseStagingResources(); // Frees the dedicated staging buffer, if one was created.
+        return false;
+    }
+
+    const ImageSurface * surfacesPtr = surfaces;
+    initVkTextureFromStaging(staging, &surfacesPtr, residentCount, /* layerCount = */ 1,
+                             toVkImageFormat(layout.format), layout.surfaces[skipCount].size);
+
+    m_droppedMipCount = narrowCast<std::uint16_t>(skipCount);
+    return true;
+}
+
 void Texture::unload()
 {
     if (isShutdown()) { return; }
 
-    const auto device   = m_vkContext->deviceHandle();
-    const auto allocCBs = m_vkContext->allocationCallbacks();
-
+    // Deferred destruction - a texture hot-reload replaces the image while
+    // the frames already submitted may still be sampling from the old one.
     if (m_imageViewHandle != VK_NULL_HANDLE)
     {
-        vkDestroyImageView(device, m_imageViewHandle, allocCBs);
+        m_vkContext->destroyDeferred(m_imageViewHandle, &vkDestroyImageView);
         m_imageViewHandle = VK_NULL_HANDLE;
     }
     if (m_imageHandle != VK_NULL_HANDLE)
     {
-        vkDestroyImage(device, m_imageHandle, allocCBs);
-        m_imageHandle = VK_NULL_HANDLE;
-    }
-    if (m_imageMemHandle != VK_NULL_HANDLE)
-    {
-        vkFreeMemory(device, m_imageMemHandle, allocCBs);
+        m_vkContext->destroyImageDeferred(m_imageHandle, m_imageMemHandle);
+        m_imageHandle    = VK_NULL_HANDLE;
         m_imageMemHandle = VK_NULL_HANDLE;
     }
 
@@ -307,17 +469,11 @@ void Texture::unload()
 
 void Texture::releaseStagingResources()
 {
-    const auto device   = m_vkContext->deviceHandle();
-    const auto allocCBs = m_vkContext->allocationCallbacks();
-
     if (m_stagingBufferHandle != VK_NULL_HANDLE)
     {
-        vkDestroyBuffer(device, m_stagingBufferHandle, allocCBs);
-        m_stagingBufferHandle = VK_NULL_HANDLE;
-    }
-    if (m_stagingBufferMemHandle != VK_NULL_HANDLE)
-    {
-        vkFreeMemory(device, m_stagingBufferMemHandle, allocCBs);
+        // Also deferred - the staging copy might still be in a submitted command buffer.
+        m_vkContext->destroyBufferDeferred(m_stagingBufferHandle, m_stagingBufferMemHandle);
+        m_stagingBufferHandle    = VK_NULL_HANDLE;
         m_stagingBufferMemHandle = VK_NULL_HANDLE;
     }
 
@@ -344,6 +500,59 @@ void Texture::clear()
     m_stagingBufferHandle    = VK_NULL_HANDLE;
     m_stagingBufferMemHandle = VK_NULL_HANDLE;
     m_stagingLinkNext        = TextureManager::InvalidResIndex;
+    m_residentMipLimit       = 0;
+    m_droppedMipCount        = 0;
+}
+
+Texture::StagingAlloc Texture::acquireStagingSpace(const std::size_t memorySizeBytes)
+{
+    //
+    // Grab staging space for the raw image data. The common case is a
+    // sub-allocation from the shared staging ring; a dedicated host-visible
+    // buffer is only created when the request doesn't fit (huge texture, or
+    // the ring was exhausted by the current load batch).
+    //
+    StagingAlloc staging;
+
+    StagingRingBuffer & stagingRing = m_vkContext->textureStagingRingBuffer();
+    const auto ringAlloc = stagingRing.allocate(memorySizeBytes);
+
+    if (ringAlloc.isValid())
+    {
+        staging.bufferHandle = stagingRing.bufferHandle();
+        staging.baseOffset   = ringAlloc.offsetInBuffer;
+        staging.mappedPtr    = ringAlloc.mappedPtr;
+        staging.isRingAlloc  = true;
+    }
+    else // Dedicated staging buffer fallback:
+    {
+        VkMemoryRequirements memReqs;
+        constexpr auto memoryType = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        m_vkContext->createBuffer(memorySizeBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, memoryType,
+                                  &m_stagingBufferHandle, &m_stagingBufferMemHandle, &memReqs);
+
+        if (memReqs.size < memorySizeBytes)
+        {
+            Log::fatalF("Buffer memReqs.size (%zu) < Image memorySizeBytes (%zu)!",
+                        std::size_t(memReqs.size), memorySizeBytes);
+        }
+
+        staging.bufferHandle = m_stagingBufferHandle;
+        staging.baseOffset   = 0;
+        staging.isRingAlloc  = false;
+        VKTB_CHECK(vkMapMemory(m_vkContext->deviceHandle(), m_stagingBufferMemHandle,
+                               0, memReqs.size, 0, &staging.mappedPtr));
+    }
+
+    return staging;
+}
+
+void Texture::finishStagingWrites(const StagingAlloc & staging)
+{
+    if (!staging.isRingAlloc) // The staging ring stays persistently mapped.
+    {
+        vkUnmapMemory(m_vkContext->deviceHandle(), m_stagingBufferMemHandle);
+    }
 }
 
 void Texture::initVkTextureData(const ImageSurface * const * surfaces, const int surfaceCount,
@@ -358,46 +567,60 @@ void Texture::initVkTextureData(const ImageSurface * const * surfaces, const int
         unload();
     }
 
-    const VkDevice device = m_vkContext->deviceHandle();
-    const CommandBuffer & cmdBuff = m_vkContext->mainTextureStagingCmdBuffer();
+    // Honor the resident mip limit: the largest levels are dropped and only
+    // the tail of each layer's mip chain goes into staging / the image.
+    const int skipCount     = surfaceSkipCount(surfaceCount);
+    const int residentCount = surfaceCount - skipCount;
 
-    //
-    // Create a host-visible staging buffer that will contain the raw image data:
-    //
-    VkMemoryRequirements memReqs;
-    constexpr auto memoryType = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-    m_vkContext->createBuffer(memorySizeBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, memoryType,
-                              &m_stagingBufferHandle, &m_stagingBufferMemHandle, &memReqs);
-
-    if (memReqs.size < memorySizeBytes)
+    std::size_t residentSizeBytes = memorySizeBytes;
+    FixedSizeArray<const ImageSurface *, MaxLayers> residentSurfaces;
+    for (int l = 0; l < layerCount; ++l)
     {
-        Log::fatalF("Buffer memReqs.size (%zu) < Image memorySizeBytes (%zu)!",
-                    std::size_t(memReqs.size), memorySizeBytes);
+        for (int s = 0; s < skipCount; ++s)
+        {
+            residentSizeBytes -= surfaces[l][s].sizeBytes;
+        }
+        residentSurfaces.push(surfaces[l] + skipCount);
     }
 
+    const StagingAlloc staging = acquireStagingSpace(residentSizeBytes);
+
     //
-    // Copy texture data into the staging buffer:
+    // Copy texture data into the staging memory:
     //
-    void * pMappedMem;
-    VKTB_CHECK(vkMapMemory(device, m_stagingBufferMemHandle, 0, memReqs.size, 0, &pMappedMem));
     {
-        auto * destPixels = static_cast<std::uint8_t *>(pMappedMem);
+        auto * destPixels = static_cast<std::uint8_t *>(staging.mappedPtr);
         for (int l = 0; l < layerCount; ++l)
         {
-            for (int s = 0; s < surfaceCount; ++s)
+            for (int s = 0; s < residentCount; ++s)
             {
-                const ImageSurface & surface = surfaces[l][s];
+                const ImageSurface & surface = residentSurfaces[l][s];
                 std::memcpy(destPixels, surface.rawData, surface.sizeBytes);
                 destPixels += surface.sizeBytes;
             }
         }
     }
-    vkUnmapMemory(device, m_stagingBufferMemHandle);
+
+    finishStagingWrites(staging);
+
+    const Size2D residentSize = (skipCount > 0 ? residentSurfaces[0][0].size : imageSize);
+    initVkTextureFromStaging(staging, residentSurfaces.data(), residentCount, layerCount,
+                             imageFormat, residentSize);
+
+    m_droppedMipCount = narrowCast<std::uint16_t>(skipCount);
+}
+
+void Texture::initVkTextureFromStaging(const StagingAlloc & staging,
+                                       const ImageSurface * const * surfaces, const int surfaceCount,
+                                       const int layerCount, const VkFormat imageFormat, const Size2D imageSize)
+{
+    const VkDevice device = m_vkContext->deviceHandle();
+    const CommandBuffer & cmdBuff = m_vkContext->textureStagingCmdBufferForThisThread();
 
     //
     // Setup buffer copy regions for each mip level:
     //
-    VkDeviceSize bufferOffset = 0;
+    VkDeviceSize bufferOffset = staging.baseOffset;
     FixedSizeArray<VkBufferImageCopy, MaxLayers * Image::MaxSurfaces> bufferCopyRegions;
     for (int l = 0; l < layerCount; ++l)
     {
@@ -450,7 +673,7 @@ void Texture::initVkTextureData(const ImageSurface * const * surfaces, const int
                                    0, surfaceCount, 0, layerCount);
 
     // Copy mip levels from staging buffer:
-    vkCmdCopyBufferToImage(cmdBuff, m_stagingBufferHandle,
+    vkCmdCopyBufferToImage(cmdBuff, staging.bufferHandle,
                            m_imageHandle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                            bufferCopyRegions.size(), bufferCopyRegions.data());
 
@@ -491,10 +714,15 @@ void Texture::initVkTextureData(const ImageSurface * const * surfaces, const int
     m_imageLayerCount  = narrowCast<std::uint16_t>(layerCount);
     m_imageViewType    = (layerCount > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D);
 
-    // Link itself to the staging chain, so that the staging resources
-    // get freed later on by the TextureManager.
-    m_stagingLinkNext   = sm_stagingChainHead;
-    sm_stagingChainHead = TextureManager::indexOf(*this);
+    // If a dedicated staging buffer was created, link into the staging chain so
+    // it gets freed by the TextureManager after the batch submit. Ring space
+    // needs no per-texture cleanup - it is reclaimed in bulk with the fence.
+    if (!staging.isRingAlloc)
+    {
+        std::lock_guard<std::mutex> lock{ s_stagingChainMutex };
+        m_stagingLinkNext   = sm_stagingChainHead;
+        sm_stagingChainHead = TextureManager::indexOf(*this);
+    }
 }
 
 VkFormat Texture::toVkImageFormat(const Image::Format format)
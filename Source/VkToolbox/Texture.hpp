@@ -74,6 +74,12 @@ public:
     };
     static const char * const LayerSuffixes[];
 
+    // If set, load() streams ".dds" files with overlapped reads straight into
+    // the staging memory (one read per mip level, smallest first), instead of
+    // reading the whole file into a DXTCompressedImage and memcpy'ing it over.
+    // The in-memory path remains as a fallback for when the reads fail.
+    static bool sm_streamDDSFiles;
+
     // Static initialization and shutdown for internal shared state.
     static void initClass();
     static void shutdownClass();
@@ -120,6 +126,20 @@ public:
     void setGenerateMipmapsOnLoad(bool trueIfShouldGenMipmaps);
     bool generateMipmapsOnLoad() const;
 
+    // Mip residency control: when a limit is set, load() only brings in the
+    // smallest N mip levels of the source image and the larger ones are
+    // dropped - the VkImage is created with just the resident levels. Zero
+    // (the default) loads everything. Changing the limit takes effect on the
+    // next load/reload. See TextureResidency.hpp for the subsystem that
+    // drives this per-texture based on usage and the VRAM budget.
+    void setResidentMipLimit(int mipCount);
+    int residentMipLimit() const;
+
+    // Number of mip levels the last load dropped to honor the resident mip
+    // limit. Zero means the full mip chain is resident.
+    int droppedMipCount() const;
+    bool isFullyResident() const;
+
     // Explicitly load as an array texture.
     // m_resId has only the texture base name + extension, e.g.:
     //   'background.dds'
@@ -152,9 +172,35 @@ private:
 
     void clear();
     static bool isArrayTextureName(const str_ref & name);
+
+    // One texture's slice of host-visible staging memory - either a
+    // sub-allocation from the context's shared staging ring or a dedicated
+    // buffer when the request doesn't fit (see acquireStagingSpace).
+    struct StagingAlloc
+    {
+        VkBuffer     bufferHandle;
+        VkDeviceSize baseOffset;
+        void *       mappedPtr;
+        bool         isRingAlloc;
+    };
+
+    StagingAlloc acquireStagingSpace(std::size_t memorySizeBytes);
+    void finishStagingWrites(const StagingAlloc & staging);
+
+    // Number of leading (largest) surfaces the load paths must skip to honor
+    // the resident mip limit. Zero when no limit is set or the chain fits.
+    int surfaceSkipCount(int surfaceCount) const;
+
+    // Streamed ".dds" loader - overlapped per-mip reads directly into the
+    // staging memory, no intermediate image object (see sm_streamDDSFiles).
+    bool loadFromDDSStreamed(const char * filePath);
+
     void initVkTextureData(const ImageSurface * const * surfaces, int surfaceCount,
                            int layerCount, VkFormat imageFormat, Size2D imageSize,
                            std::size_t memorySizeBytes);
+    void initVkTextureFromStaging(const StagingAlloc & staging,
+                                  const ImageSurface * const * surfaces, int surfaceCount,
+                                  int layerCount, VkFormat imageFormat, Size2D imageSize);
 
     const VulkanContext * m_vkContext;
     StrId<str> m_resId;
@@ -175,6 +221,8 @@ private:
 
     std::uint16_t m_imageMipmapCount;
     std::uint16_t m_imageLayerCount;
+    std::uint16_t m_residentMipLimit; // 0 = no limit, load the full mip chain.
+    std::uint16_t m_droppedMipCount;  // Largest mips dropped by the last load.
     bool m_dontGenMipmaps;
 };
 
@@ -298,6 +346,36 @@ inline bool Texture::generateMipmapsOnLoad() const
     return !m_dontGenMipmaps;
 }
 
+inline void Texture::setResidentMipLimit(const int mipCount)
+{
+    assert(mipCount >= 0);
+    m_residentMipLimit = narrowCast<std::uint16_t>(mipCount);
+}
+
+inline int Texture::residentMipLimit() const
+{
+    return static_cast<int>(m_residentMipLimit);
+}
+
+inline int Texture::droppedMipCount() const
+{
+    return static_cast<int>(m_droppedMipCount);
+}
+
+inline bool Texture::isFullyResident() const
+{
+    return (m_droppedMipCount == 0);
+}
+
+inline int Texture::surfaceSkipCount(const int surfaceCount) const
+{
+    if (m_residentMipLimit == 0 || surfaceCount <= m_residentMipLimit)
+    {
+        return 0; // No limit set or the whole chain already fits.
+    }
+    return surfaceCount - m_residentMipLimit;
+}
+
 template<typename ImageType>
 inline bool Texture::loadFromImageInMemory(const ImageType & image)
 {
@@ -0,0 +1,231 @@
+
+// ================================================================================================
+// File: VkToolbox/TextureResidency.cpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Streams texture mip levels in and out based on usage and the VRAM budget.
+// ================================================================================================
+
+#include "TextureResidency.hpp"
+#include "MemoryTracker.hpp"
+
+#include <algorithm>
+
+namespace VkToolbox
+{
+
+// ========================================================
+// class TextureResidencyManager:
+// ========================================================
+
+int TextureResidencyManager::sm_initialResidentMips = 5; // 16x16 base for a square power-of-two chain.
+int TextureResidencyManager::sm_maxReloadsPerUpdate = 2;
+std::int64_t TextureResidencyManager::sm_deviceMemoryBudgetBytes = 0;
+
+TextureResidencyManager & TextureResidencyManager::shared()
+{
+    static TextureResidencyManager s_theManager;
+    return s_theManager;
+}
+
+TextureResidencyManager::TextureEntry * TextureResidencyManager::findEntry(const TextureManager::ResourceIndex resIndex)
+{
+    for (TextureEntry & entry : m_entries)
+    {
+        if (entry.resIndex == resIndex)
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void TextureResidencyManager::manage(const TextureManager::ResourceIndex resIndex)
+{
+    assert(resIndex != TextureManager::InvalidResIndex);
+    assert(sm_initialResidentMips > 0);
+
+    if (findEntry(resIndex) != nullptr)
+    {
+        return; // Already managed.
+    }
+
+    // Cap the slot at the initial residency. If the texture was already
+    // loaded in full this only takes effect on its next reload.
+    TextureManager::mutableResourceRef(resIndex).setResidentMipLimit(sm_initialResidentMips);
+
+    TextureEntry entry;
+    entry.resIndex        = resIndex;
+    entry.residentMips    = narrowCast<std::uint16_t>(sm_initialResidentMips);
+    entry.fullyResident   = false;
+    entry.touched         = false;
+    entry.viewDistance    = 0.0f;
+    entry.lastTouchUpdate = m_updateCount;
+    m_entries.push_back(entry);
+}
+
+void TextureResidencyManager::touch(const TextureManager::ResourceIndex resIndex, const float viewDistance)
+{
+    TextureEntry * entry = findEntry(resIndex);
+    if (entry == nullptr)
+    {
+        return; // Not under residency management.
+    }
+
+    // Keep the closest sighting of the frame - a texture on a nearby wall
+    // and a distant one should promote the near use first.
+    if (!entry->touched || viewDistance < entry->viewDistance)
+    {
+        entry->viewDistance = viewDistance;
+    }
+
+    entry->touched         = true;
+    entry->lastTouchUpdate = m_updateCount;
+}
+
+void TextureResidencyManager::queueReload(const int entryIndex, const int newMipLimit)
+{
+    const TextureEntry & entry = m_entries[entryIndex];
+
+    // Just records the new target - the async load requests are pushed in
+    // one batch at the end of update(), inside the resource load bracket.
+    Texture & texture = TextureManager::mutableResourceRef(entry.resIndex);
+    texture.setResidentMipLimit(newMipLimit);
+
+    m_reloadList.push_back(entryIndex);
+}
+
+void TextureResidencyManager::update()
+{
+    ++m_updateCount;
+    if (m_entries.empty())
+    {
+        return;
+    }
+
+    const int entryCount = managedTextureCount();
+    int reloadsLeft      = sm_maxReloadsPerUpdate;
+    m_reloadList.clear();
+
+    //
+    // Demotions first, so memory given back this round is already committed
+    // before anything grows. The stalest entries (longest since their last
+    // touch) lose one mip level each. Old images retire through the deferred
+    // destruction queue, so the tracker only sees the freed bytes a few
+    // frames later - an over-budget situation converges over several updates
+    // rather than instantly, which also spreads out the reload cost.
+    //
+    if (sm_deviceMemoryBudgetBytes > 0 && reloadsLeft > 0)
+    {
+        const MemoryTracker::Report report = MemoryTracker::shared().queryReport();
+        if (report.deviceAllocBytes[MemoryTracker::TextureMemory] > sm_deviceMemoryBudgetBytes)
+        {
+            m_candidateList.clear();
+            for (int i = 0; i < entryCount; ++i)
+            {
+                if (m_entries[i].residentMips > sm_initialResidentMips && TextureManager::isLoaded(m_entries[i].resIndex))
+                {
+                    m_candidateList.push_back(i);
+                }
+            }
+
+            std::sort(m_candidateList.begin(), m_candidateList.end(),
+                [this](const int a, const int b)
+                {
+                    return m_entries[a].lastTouchUpdate < m_entries[b].lastTouchUpdate;
+                });
+
+            for (const int i : m_candidateList)
+            {
+                if (reloadsLeft == 0)
+                {
+                    break;
+                }
+                queueReload(i, m_entries[i].residentMips - 1);
+                --reloadsLeft;
+            }
+        }
+    }
+
+    //
+    // Promotions: textures the renderer touched since the last update and
+    // that still miss mip levels come in one level at a time, nearest first.
+    //
+    if (reloadsLeft > 0)
+    {
+        m_candidateList.clear();
+        for (int i = 0; i < entryCount; ++i)
+        {
+            const TextureEntry & entry = m_entries[i];
+            if (entry.touched && !entry.fullyResident && TextureManager::isLoaded(entry.resIndex))
+            {
+                m_candidateList.push_back(i);
+            }
+        }
+
+        std::sort(m_candidateList.begin(), m_candidateList.end(),
+            [this](const int a, const int b)
+            {
+                return m_entries[a].viewDistance < m_entries[b].viewDistance;
+            });
+
+        for (const int i : m_candidateList)
+        {
+            if (reloadsLeft == 0)
+            {
+                break;
+            }
+            if (std::find(m_reloadList.begin(), m_reloadList.end(), i) != m_reloadList.end())
+            {
+                continue; // Just demoted - don't immediately pull the mip back in.
+            }
+            queueReload(i, m_entries[i].residentMips + 1);
+            --reloadsLeft;
+        }
+    }
+
+    //
+    // Finish the round: fan the reloads out over the JobSystem workers so
+    // the file reads and decompression run in parallel, then wait for the
+    // staging copies to be submitted.
+    //
+    if (!m_reloadList.empty())
+    {
+        TextureManager::beginResourceLoad();
+        for (const int i : m_reloadList)
+        {
+            TextureManager::pushAsyncLoadRequest(m_entries[i].resIndex);
+        }
+        TextureManager::waitPendingAsyncLoadRequests();
+        TextureManager::endResourceLoad();
+
+        // Sync the entries with what actually landed:
+        for (const int i : m_reloadList)
+        {
+            TextureEntry & entry = m_entries[i];
+            const Texture & texture = TextureManager::resourceRef(entry.resIndex);
+            if (texture.isLoaded())
+            {
+                entry.residentMips  = narrowCast<std::uint16_t>(texture.mipmapCount());
+                entry.fullyResident = texture.isFullyResident();
+            }
+            // Failed reloads keep the old entry state - pushAsyncLoadRequest
+            // retries failed slots, so a later update can try again.
+        }
+    }
+
+    // Reset the per-frame touch flags:
+    for (TextureEntry & entry : m_entries)
+    {
+        entry.touched = false;
+    }
+}
+
+void TextureResidencyManager::clear()
+{
+    m_entries.clear();
+    m_candidateList.clear();
+    m_reloadList.clear();
+}
+
+} // namespace VkToolbox
@@ -0,0 +1,109 @@
+#pragma once
+
+// ================================================================================================
+// File: VkToolbox/TextureResidency.hpp
+// Author: Guilherme R. Lampert
+// Created on: 31/08/17
+// Brief: Streams texture mip levels in and out based on usage and the VRAM budget.
+// ================================================================================================
+
+#include "ResourceManager.hpp"
+
+namespace VkToolbox
+{
+
+// ========================================================
+// class TextureResidencyManager:
+// ========================================================
+
+// Keeps the mip residency of managed textures proportional to how much they
+// actually matter to the frame. A managed texture first loads with only the
+// sm_initialResidentMips smallest mips resident; touch() hints from the
+// renderer (closest view distance this frame) then drive update() to stream
+// the larger mips in one level at a time, nearest textures first. When the
+// memory tracker reports the texture category over sm_deviceMemoryBudgetBytes,
+// the stalest managed textures are demoted back down a level instead.
+//
+// Promotions and demotions are plain TextureManager reloads with a different
+// per-texture resident mip limit (see Texture::setResidentMipLimit) - the
+// image is recreated and the old one retired through the usual deferred-
+// destruction path, so frames in flight keep sampling the old mips. The
+// file reads and decompression of a round fan out over the JobSystem
+// workers; update() only blocks for the final staging submit and caps the
+// number of reloads per call, so the per-frame cost stays bounded.
+//
+// All methods are main-thread only, same as the rest of the resource
+// load machinery.
+class TextureResidencyManager final
+{
+public:
+
+    // Tunables - change them before the first manage() call:
+    static int sm_initialResidentMips;              // Mips a managed texture first loads with (smallest first).
+    static int sm_maxReloadsPerUpdate;              // Promotion/demotion reloads allowed per update() call.
+    static std::int64_t sm_deviceMemoryBudgetBytes; // Texture VRAM budget; <= 0 disables demotion.
+
+    // Global manager shared by the whole engine.
+    static TextureResidencyManager & shared();
+
+    // Put a registered TextureManager slot under residency management. Caps
+    // the slot's resident mips at sm_initialResidentMips - call before the
+    // texture is first loaded to get the cheap initial load. Managing an
+    // already managed slot is a no-op.
+    void manage(TextureManager::ResourceIndex resIndex);
+    int managedTextureCount() const;
+
+    // Usage hint from the renderer: the texture was referenced this frame,
+    // seen from the given view distance. Cheap - just updates the slot's
+    // entry; un-managed slots are ignored.
+    void touch(TextureManager::ResourceIndex resIndex, float viewDistance);
+
+    // Runs one round of promotions (touched textures, nearest first) and
+    // demotions (stalest textures while over budget). Call once per frame
+    // from the main thread, outside the frame render pass - the reloads
+    // record into the texture staging buffers.
+    void update();
+
+    // Drop every managed entry (the textures keep their current residency).
+    void clear();
+
+private:
+
+    TextureResidencyManager() = default;
+
+    TextureResidencyManager(const TextureResidencyManager &) = delete;
+    TextureResidencyManager & operator = (const TextureResidencyManager &) = delete;
+
+    struct TextureEntry
+    {
+        TextureManager::ResourceIndex resIndex;
+        std::uint16_t residentMips;    // Current resident mip limit of the slot.
+        bool          fullyResident;   // Whole mip chain is loaded - nothing left to promote.
+        bool          touched;         // Referenced since the last update().
+        float         viewDistance;    // Closest touch since the last update().
+        std::uint32_t lastTouchUpdate; // m_updateCount at the last touch - staleness for demotion.
+    };
+
+    TextureEntry * findEntry(TextureManager::ResourceIndex resIndex);
+    void queueReload(int entryIndex, int newMipLimit);
+
+    std::vector<TextureEntry> m_entries;
+    std::uint32_t m_updateCount = 0;
+
+    // Scratch for update() - candidate and in-flight entry indexes:
+    std::vector<int> m_candidateList;
+    std::vector<int> m_reloadList;
+};
+
+// ========================================================
+// TextureResidencyManager inline methods:
+// ========================================================
+
+inline int TextureResidencyManager::managedTextureCount() const
+{
+    return narrowCast<int>(m_entries.size());
+}
+
+// ========================================================
+
+} // namespace VkToolbox
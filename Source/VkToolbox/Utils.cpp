@@ -12,6 +12,12 @@
 #include <direct.h>
 #include <sys/stat.h>
 
+#if defined(WIN32) || defined(WIN64)
+    #define NOMINMAX 1
+    #define WIN32_LEAN_AND_MEAN 1
+    #include <Windows.h>
+#endif // WIN32 || WIN64
+
 namespace VkToolbox
 {
 
@@ -85,6 +91,32 @@ bool probeFile(const char * const filename)
     return (buf.st_mode & _S_IFREG) != 0;
 }
 
+bool createDirectory(const char * const dirPath)
+{
+    assert(dirPath != nullptr);
+    assert(dirPath[0] != '\0');
+
+    // _mkdir/_stat don't like trailing path separators, so strip them first.
+    char path[512];
+    std::size_t len = std::strlen(dirPath);
+    assert(len < sizeof(path));
+
+    std::memcpy(path, dirPath, len + 1);
+    while (len > 0 && (path[len - 1] == '/' || path[len - 1] == '\\'))
+    {
+        path[--len] = '\0';
+    }
+
+    if (_mkdir(path) == 0)
+    {
+        return true;
+    }
+
+    // Fine if it already exists.
+    struct _stat buf;
+    return (_stat(path, &buf) == 0) && ((buf.st_mode & _S_IFDIR) != 0);
+}
+
 const char * currentPath(str * inOutPathStr)
 {
     assert(inOutPathStr != nullptr);
@@ -96,4 +128,199 @@ const char * currentPath(str * inOutPathStr)
     return inOutPathStr->c_str();
 }
 
+// ========================================================
+// class MemoryMappedFile:
+// ========================================================
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    unmap();
+}
+
+MemoryMappedFile::MemoryMappedFile(MemoryMappedFile && other)
+    : m_fileHandle{ other.m_fileHandle }
+    , m_mappingHandle{ other.m_mappingHandle }
+    , m_baseAddress{ other.m_baseAddress }
+    , m_sizeBytes{ other.m_sizeBytes }
+{
+    other.m_fileHandle    = nullptr;
+    other.m_mappingHandle = nullptr;
+    other.m_baseAddress   = nullptr;
+    other.m_sizeBytes     = 0;
+}
+
+MemoryMappedFile & MemoryMappedFile::operator = (MemoryMappedFile && other)
+{
+    unmap();
+
+    m_fileHandle    = other.m_fileHandle;
+    m_mappingHandle = other.m_mappingHandle;
+    m_baseAddress   = other.m_baseAddress;
+    m_sizeBytes     = other.m_sizeBytes;
+
+    other.m_fileHandle    = nullptr;
+    other.m_mappingHandle = nullptr;
+    other.m_baseAddress   = nullptr;
+    other.m_sizeBytes     = 0;
+
+    return *this;
+}
+
+bool MemoryMappedFile::map(const char * const filename)
+{
+    assert(filename != nullptr);
+    assert(!isMapped());
+
+    HANDLE fileHandle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr)
+    {
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    const void * baseAddress = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (baseAddress == nullptr)
+    {
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    m_fileHandle    = fileHandle;
+    m_mappingHandle = mappingHandle;
+    m_baseAddress   = baseAddress;
+    m_sizeBytes     = static_cast<std::size_t>(fileSize.QuadPart);
+
+    return true;
+}
+
+void MemoryMappedFile::unmap()
+{
+    if (m_baseAddress != nullptr)
+    {
+        UnmapViewOfFile(m_baseAddress);
+        m_baseAddress = nullptr;
+    }
+    if (m_mappingHandle != nullptr)
+    {
+        CloseHandle(m_mappingHandle);
+        m_mappingHandle = nullptr;
+    }
+    if (m_fileHandle != nullptr)
+    {
+        CloseHandle(m_fileHandle);
+        m_fileHandle = nullptr;
+    }
+    m_sizeBytes = 0;
+}
+
+// ========================================================
+// class AsyncFileReader:
+// ========================================================
+
+AsyncFileReader::~AsyncFileReader()
+{
+    close();
+}
+
+bool AsyncFileReader::open(const char * const filename)
+{
+    assert(filename != nullptr);
+    assert(!isOpen());
+
+    HANDLE fileHandle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    m_fileHandle = fileHandle;
+    return true;
+}
+
+void AsyncFileReader::close()
+{
+    if (m_fileHandle != nullptr)
+    {
+        waitAll(); // Can't pull the handle from under reads still in flight.
+        CloseHandle(m_fileHandle);
+        m_fileHandle = nullptr;
+    }
+}
+
+bool AsyncFileReader::queueRead(void * const destBuffer, const std::uint64_t fileOffset, const std::uint32_t sizeBytes)
+{
+    assert(destBuffer != nullptr);
+    assert(sizeBytes != 0);
+    assert(isOpen());
+
+    if (m_pendingCount == MaxPendingReads)
+    {
+        return false;
+    }
+
+    PendingRead & pending = m_pendingReads[m_pendingCount];
+    static_assert(sizeof(OVERLAPPED) <= sizeof(pending.overlappedStorage), "Grow PendingRead::overlappedStorage!");
+
+    auto * overlapped = reinterpret_cast<OVERLAPPED *>(pending.overlappedStorage);
+    std::memset(overlapped, 0, sizeof(OVERLAPPED));
+    overlapped->Offset     = static_cast<DWORD>(fileOffset & 0xFFFFFFFF);
+    overlapped->OffsetHigh = static_cast<DWORD>(fileOffset >> 32);
+    overlapped->hEvent     = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+
+    if (overlapped->hEvent == nullptr)
+    {
+        return false;
+    }
+
+    // A synchronous completion (cached file) is fine too - GetOverlappedResult
+    // in waitAll() handles both cases, so only a hard failure is an error here.
+    if (!ReadFile(m_fileHandle, destBuffer, sizeBytes, nullptr, overlapped) &&
+        GetLastError() != ERROR_IO_PENDING)
+    {
+        CloseHandle(overlapped->hEvent);
+        return false;
+    }
+
+    pending.expectedBytes = sizeBytes;
+    ++m_pendingCount;
+    return true;
+}
+
+bool AsyncFileReader::waitAll()
+{
+    bool allSucceeded = true;
+
+    for (int r = 0; r < m_pendingCount; ++r)
+    {
+        auto * overlapped = reinterpret_cast<OVERLAPPED *>(m_pendingReads[r].overlappedStorage);
+
+        DWORD bytesRead = 0;
+        if (!GetOverlappedResult(m_fileHandle, overlapped, &bytesRead, TRUE) ||
+            bytesRead != m_pendingReads[r].expectedBytes)
+        {
+            allSucceeded = false;
+        }
+        CloseHandle(overlapped->hEvent);
+    }
+
+    m_pendingCount = 0;
+    return allSucceeded;
+}
+
 } // namespace VkToolbox
@@ -9,6 +9,7 @@
 
 #include <cassert>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 
@@ -164,6 +165,14 @@ inline T alignSize(const T size, const T alignment)
     return size + (alignment - 1);
 }
 
+// Rounds the size up to the next multiple of the alignment (PoT alignments only).
+template<typename T>
+inline T roundUpToMultiple(const T size, const T alignment)
+{
+    assert(isPowerOfTwo(alignment));
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
 // Aligned if the pointer is evenly divisible by the alignment value.
 // Same as '(ptr % align) == 0' (The '&' trick works with PoT alignments only!).
 inline bool isAlignedPtr(const void * ptr, const std::size_t alignment)
@@ -237,6 +246,9 @@ inline bool strStartsWith(const char * const str, const char * const prefix)
 // Test if the file exists.
 bool probeFile(const char * filename);
 
+// Create a directory if it doesn't already exist. Not recursive - the parent path must exist.
+bool createDirectory(const char * dirPath);
+
 // Get the CWD.
 const char * currentPath(str * inOutPathStr);
 
@@ -305,4 +317,88 @@ public:
     operator FILE*() const { return m_fileHandle; }
 };
 
+// Read-only memory-mapped view of a whole file (Win32 file mapping).
+// Lets loaders use big binary assets straight out of the OS file cache
+// without copying them into heap-allocated buffers first. Move-only.
+class MemoryMappedFile final
+{
+public:
+
+    MemoryMappedFile() = default;
+    ~MemoryMappedFile();
+
+    MemoryMappedFile(MemoryMappedFile && other);
+    MemoryMappedFile & operator = (MemoryMappedFile && other);
+
+    MemoryMappedFile(const MemoryMappedFile &) = delete;
+    MemoryMappedFile & operator = (const MemoryMappedFile &) = delete;
+
+    bool map(const char * filename);
+    void unmap();
+
+    bool isMapped() const { return m_baseAddress != nullptr; }
+    std::size_t sizeBytes() const { return m_sizeBytes; }
+
+    const std::uint8_t * baseAddress() const
+    {
+        return static_cast<const std::uint8_t *>(m_baseAddress);
+    }
+
+private:
+
+    // Win32 HANDLEs - kept as void pointers so we don't drag Windows.h into this header.
+    void *       m_fileHandle    = nullptr;
+    void *       m_mappingHandle = nullptr;
+    const void * m_baseAddress   = nullptr;
+    std::size_t  m_sizeBytes     = 0;
+};
+
+// Overlapped (asynchronous) read access to a file (Win32 OVERLAPPED I/O).
+// Lets the streamed texture loader issue several reads straight into
+// persistently-mapped staging memory and only block once, when everything
+// is already in flight. Not movable - the OS writes back into the queued
+// request blocks stored inside this object.
+class AsyncFileReader final
+{
+public:
+
+    // Enough for one read per mipmap surface of a texture.
+    static constexpr int MaxPendingReads = 16;
+
+    AsyncFileReader() = default;
+    ~AsyncFileReader();
+
+    AsyncFileReader(const AsyncFileReader &) = delete;
+    AsyncFileReader & operator = (const AsyncFileReader &) = delete;
+
+    bool open(const char * filename);
+    void close(); // Implies waitAll() if reads are still pending.
+
+    bool isOpen() const { return m_fileHandle != nullptr; }
+
+    // Begins an asynchronous read of sizeBytes at fileOffset into destBuffer.
+    // The destination must stay valid until waitAll()/close(). Fails if the
+    // pending queue is full or the OS rejects the request.
+    bool queueRead(void * destBuffer, std::uint64_t fileOffset, std::uint32_t sizeBytes);
+
+    // Blocks until every queued read has completed, then empties the queue.
+    // Returns false if any read failed or came back short.
+    bool waitAll();
+
+private:
+
+    struct PendingRead
+    {
+        // Opaque storage for a Win32 OVERLAPPED block (and its event handle),
+        // kept as raw bytes so we don't drag Windows.h into this header.
+        // Sized/checked against the real thing in Utils.cpp.
+        alignas(8) std::uint8_t overlappedStorage[32];
+        std::uint32_t expectedBytes;
+    };
+
+    void * m_fileHandle = nullptr; // Win32 HANDLE
+    int m_pendingCount  = 0;
+    PendingRead m_pendingReads[MaxPendingReads];
+};
+
 } // namespace VkToolbox
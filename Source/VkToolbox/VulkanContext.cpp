@@ -15,7 +15,10 @@
 #include "VulkanContext.hpp"
 #include "OSWindow.hpp"
 
+#include "FrameStats.hpp"
 #include "GlslShader.hpp"
+#include "GpuProfiler.hpp"
+#include "Pool.hpp"
 #include "Texture.hpp"
 
 // For Win32SurfaceKH extension stuff.
@@ -32,11 +35,15 @@ namespace VkToolbox
 // VulkanContext statics:
 // ========================================================
 
-const char *  VulkanContext::sm_appName             = "VulkanApp";
-std::uint32_t VulkanContext::sm_appVersion          = VK_MAKE_VERSION(1, 0, 0);
-std::uint32_t VulkanContext::sm_multiSampleCount    = VK_SAMPLE_COUNT_1_BIT;
-VkFormat      VulkanContext::sm_depthBufferFormat   = VK_FORMAT_D24_UNORM_S8_UINT;
-bool          VulkanContext::sm_useTripleBufferHint = true;
+const char *     VulkanContext::sm_appName              = "VulkanApp";
+std::uint32_t    VulkanContext::sm_appVersion           = VK_MAKE_VERSION(1, 0, 0);
+std::uint32_t    VulkanContext::sm_multiSampleCount     = VK_SAMPLE_COUNT_1_BIT;
+VkFormat         VulkanContext::sm_depthBufferFormat    = VK_FORMAT_D24_UNORM_S8_UINT;
+bool             VulkanContext::sm_useTripleBufferHint  = true;
+VkPresentModeKHR VulkanContext::sm_preferredPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+std::uint32_t    VulkanContext::sm_swapChainImageCount  = 0;
+int              VulkanContext::sm_preferredGpuIndex    = -1;
+bool             VulkanContext::sm_depthPrePassEnabled  = false;
 
 #if DEBUG
 VulkanContext::ValidationMode VulkanContext::sm_validationMode = VulkanContext::Debug;
@@ -55,16 +62,28 @@ VulkanContext::VulkanContext(const OSWindow & window, const Size2D fbSize, const
     , m_mainFenceCache{ new FenceCache{ *this } }
     , m_mainTextureStagingCmdBufferPool{ *this }
     , m_mainTextureStagingCmdBuffer{ *this }
+    , m_mainThreadId{ std::this_thread::get_id() }
 {
     Log::debugF("Initializing Vulkan API context...");
 
+    // No user-provided callbacks - route the driver's host-side allocations
+    // through the memory tracker so they show up in its usage report.
+    if (m_allocationCallbacks == nullptr)
+    {
+        m_allocationCallbacks = MemoryTracker::shared().hostAllocationCallbacks();
+    }
+
     m_swapChain.framebufferSize = fbSize;
+    m_depthPrePassEnabled = sm_depthPrePassEnabled;
 
     initInstanceLayerProperties();
     initInstance();
     initEnumerateGpus();
     initSwapChainExtensions();
     initDevice();
+    initPipelineCache();
+    m_defaultSampler = sharedSampler(Sampler::defaults());
+    m_deviceMemAllocator.reset(new DeviceMemoryAllocator{ *this });
     initSwapChain();
     initCommandPoolAndBuffers();
     initDepthBuffer();
@@ -72,9 +91,13 @@ VulkanContext::VulkanContext(const OSWindow & window, const Size2D fbSize, const
     initFramebuffers();
     initSemaphores();
 
+    m_gpuProfiler.reset(new GpuProfiler{ *this });
+    m_gpuProfiler->initialize();
+
     // Finish the frame/depth buffer layout transitions
     m_mainTextureStagingCmdBuffer.endRecording();
-    m_mainTextureStagingCmdBuffer.submitAndWaitComplete(m_gpuGraphicsQueue);
+    enqueueSubmit(m_mainTextureStagingCmdBuffer);
+    flushPendingSubmits();
     m_mainTextureStagingCmdBuffer.reset();
 
     Log::debugF("VulkanContext initialized successfully!");
@@ -89,16 +112,69 @@ VulkanContext::~VulkanContext()
 {
     Log::debugF("Destroying Vulkan API context...");
 
+    // Anything still in the pending list was enqueued but never reached the
+    // GPU - that's a missing flushPendingSubmits() somewhere in the app.
+    assert(m_pendingSubmits.empty());
+
+    // Final frame pacing and memory usage reports, while the log is still up.
+    if (isDebug())
+    {
+        FrameStats::shared().logReport();
+        MemoryTracker::shared().logReport(*this);
+    }
+
+    // Whatever is still pending in the deferred-destruction queue goes now.
+    // The app base class has already drained the GPU when the main loop exited.
+    executeDeferredDestructions(/* flushAll = */ true);
+
     // The depth/frame-buffer owns its images and views.
     destroyFramebuffers();
     destroyDepthBuffer();
 
     // Have to explicitly shutdown because they depend on the device, destroyed below.
+    if (m_transferCompleteFence != VK_NULL_HANDLE)
+    {
+        m_mainFenceCache->recycleFence(m_transferCompleteFence);
+        m_transferCompleteFence = VK_NULL_HANDLE;
+    }
+    if (m_computeCompleteFence != VK_NULL_HANDLE)
+    {
+        m_mainFenceCache->recycleFence(m_computeCompleteFence);
+        m_computeCompleteFence = VK_NULL_HANDLE;
+    }
     m_mainRenderPass.shutdown();
     m_mainFenceCache->shutdown();
 
     m_mainTextureStagingCmdBuffer.shutdown();
     m_mainTextureStagingCmdBufferPool.shutdown();
+    m_threadStagingCmdBuffers.clear(); // Usually empty already - cleared after each staging submit.
+
+    if (m_transferCmdBuffer != nullptr)
+    {
+        m_transferCmdBuffer->shutdown();
+    }
+    if (m_transferCmdBufferPool != nullptr)
+    {
+        m_transferCmdBufferPool->shutdown();
+    }
+
+    if (m_computeCmdBuffer != nullptr)
+    {
+        m_computeCmdBuffer->shutdown();
+    }
+    if (m_computeCmdBufferPool != nullptr)
+    {
+        m_computeCmdBufferPool->shutdown();
+    }
+
+    if (m_textureStagingRing != nullptr)
+    {
+        m_textureStagingRing->shutdown();
+    }
+    if (m_gpuProfiler != nullptr)
+    {
+        m_gpuProfiler->shutdown();
+    }
 
     if (m_imageAvailableSemaphore != VK_NULL_HANDLE)
     {
@@ -108,10 +184,53 @@ VulkanContext::~VulkanContext()
     {
         vkDestroySemaphore(m_device, m_renderFinishedSemaphore, m_allocationCallbacks);
     }
+    if (m_transferFinishedSemaphore != VK_NULL_HANDLE)
+    {
+        vkDestroySemaphore(m_device, m_transferFinishedSemaphore, m_allocationCallbacks);
+    }
+    if (m_computeFinishedSemaphore != VK_NULL_HANDLE)
+    {
+        vkDestroySemaphore(m_device, m_computeFinishedSemaphore, m_allocationCallbacks);
+    }
+    #if defined(VK_KHR_timeline_semaphore)
+    if (m_graphicsTimeline != VK_NULL_HANDLE)
+    {
+        vkDestroySemaphore(m_device, m_graphicsTimeline, m_allocationCallbacks);
+    }
+    if (m_transferTimeline != VK_NULL_HANDLE)
+    {
+        vkDestroySemaphore(m_device, m_transferTimeline, m_allocationCallbacks);
+    }
+    if (m_computeTimeline != VK_NULL_HANDLE)
+    {
+        vkDestroySemaphore(m_device, m_computeTimeline, m_allocationCallbacks);
+    }
+    #endif // VK_KHR_timeline_semaphore
     if (m_swapChain.handle != VK_NULL_HANDLE)
     {
         vkDestroySwapchainKHR(m_device, m_swapChain.handle, m_allocationCallbacks);
     }
+    for (const CachedSampler & cachedSampler : m_sharedSamplers)
+    {
+        vkDestroySampler(m_device, cachedSampler.handle, m_allocationCallbacks);
+    }
+    m_sharedSamplers.clear();
+    m_defaultSampler = VK_NULL_HANDLE;
+
+    if (m_pipelineCacheHandle != VK_NULL_HANDLE)
+    {
+        savePipelineCacheToDisk();
+        vkDestroyPipelineCache(m_device, m_pipelineCacheHandle, m_allocationCallbacks);
+    }
+    if (m_deviceMemAllocator != nullptr)
+    {
+        if (isDebug())
+        {
+            m_deviceMemAllocator->logStats();
+        }
+        m_deviceMemAllocator->shutdown();
+        m_deviceMemAllocator = nullptr;
+    }
     if (m_device != VK_NULL_HANDLE)
     {
         vkDestroyDevice(m_device, m_allocationCallbacks);
@@ -195,11 +314,33 @@ void VulkanContext::initInstance()
     const char * const instanceLayerNamesDebug[] = {
         "VK_LAYER_LUNARG_standard_validation"
     };
-    const char * const instanceExtensionNames[] = {
+    std::vector<const char *> instanceExtensionNames = {
         "VK_KHR_surface",
         "VK_KHR_win32_surface"
     };
-    const auto instanceExtensionCount = static_cast<std::uint32_t>(arrayLength(instanceExtensionNames));
+
+    // Optional: needed by the VK_EXT_memory_budget heap queries (see
+    // queryMemoryBudget()). Only enabled when the loader exposes it.
+    {
+        std::uint32_t availExtensionCount = 0;
+        std::vector<VkExtensionProperties> availExtensions;
+
+        vkEnumerateInstanceExtensionProperties(nullptr, &availExtensionCount, nullptr);
+        if (availExtensionCount != 0)
+        {
+            availExtensions.resize(availExtensionCount);
+            vkEnumerateInstanceExtensionProperties(nullptr, &availExtensionCount, availExtensions.data());
+        }
+
+        for (const VkExtensionProperties & ext : availExtensions)
+        {
+            if (std::strcmp(ext.extensionName, "VK_KHR_get_physical_device_properties2") == 0)
+            {
+                instanceExtensionNames.push_back("VK_KHR_get_physical_device_properties2");
+                break;
+            }
+        }
+    }
 
     if (isDebug())
     {
@@ -228,8 +369,8 @@ void VulkanContext::initInstance()
     instInfo.pApplicationInfo        = &appInfo;
     instInfo.enabledLayerCount       = instanceLayerCount;
     instInfo.ppEnabledLayerNames     = instanceLayerNames;
-    instInfo.enabledExtensionCount   = instanceExtensionCount;
-    instInfo.ppEnabledExtensionNames = instanceExtensionNames;
+    instInfo.enabledExtensionCount   = narrowCast<std::uint32_t>(instanceExtensionNames.size());
+    instInfo.ppEnabledExtensionNames = instanceExtensionNames.data();
 
     VKTB_CHECK(vkCreateInstance(&instInfo, m_allocationCallbacks, &m_instance));
     assert(m_instance != VK_NULL_HANDLE);
@@ -239,32 +380,128 @@ void VulkanContext::initInstance()
 
 void VulkanContext::initDevice()
 {
-    const char * const deviceExtensionNames[] = {
+    // Extensions we unconditionally require:
+    std::vector<const char *> deviceExtensionNames = {
         "VK_KHR_swapchain"
     };
-    const auto deviceExtensionCount = static_cast<std::uint32_t>(arrayLength(deviceExtensionNames));
+
+    // Query what the driver actually exposes so the optional ones
+    // can be enabled when present:
+    std::uint32_t availExtensionCount = 0;
+    std::vector<VkExtensionProperties> availExtensions;
+
+    vkEnumerateDeviceExtensionProperties(m_gpuPhysDevice, nullptr, &availExtensionCount, nullptr);
+    if (availExtensionCount != 0)
+    {
+        availExtensions.resize(availExtensionCount);
+        vkEnumerateDeviceExtensionProperties(m_gpuPhysDevice, nullptr, &availExtensionCount, availExtensions.data());
+    }
+
+    const auto hasDeviceExtension = [&availExtensions](const char * const name)
+    {
+        for (const VkExtensionProperties & ext : availExtensions)
+        {
+            if (std::strcmp(ext.extensionName, name) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    };
 
     // Dummy priorities - don't care atm
     const float queuePriorities[] = { 0.0f, 0.0f };
 
-    VkDeviceQueueCreateInfo queueCreateInfo  = {};
-    queueCreateInfo.sType                    = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-    queueCreateInfo.queueCount               = 1;
-    queueCreateInfo.pQueuePriorities         = queuePriorities;
-    queueCreateInfo.queueFamilyIndex         = m_gpuGraphicsQueue.familyIndex;
+    VkDeviceQueueCreateInfo queueCreateInfos[3] = {};
+    std::uint32_t queueCreateInfoCount          = 1;
+
+    queueCreateInfos[0].sType                = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queueCreateInfos[0].queueCount           = 1;
+    queueCreateInfos[0].pQueuePriorities     = queuePriorities;
+    queueCreateInfos[0].queueFamilyIndex     = m_gpuGraphicsQueue.familyIndex;
+
+    // Second queue from the transfer-only family, for async uploads:
+    if (hasDedicatedTransferQueue())
+    {
+        queueCreateInfos[queueCreateInfoCount]                  = queueCreateInfos[0];
+        queueCreateInfos[queueCreateInfoCount].queueFamilyIndex = m_gpuTransferQueue.familyIndex;
+        ++queueCreateInfoCount;
+    }
+
+    // And one from the compute family, for async compute batches:
+    if (hasDedicatedComputeQueue())
+    {
+        queueCreateInfos[queueCreateInfoCount]                  = queueCreateInfos[0];
+        queueCreateInfos[queueCreateInfoCount].queueFamilyIndex = m_gpuComputeQueue.familyIndex;
+        ++queueCreateInfoCount;
+    }
 
     VkDeviceCreateInfo deviceCreateInfo      = {};
     deviceCreateInfo.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    deviceCreateInfo.queueCreateInfoCount    = 1;
-    deviceCreateInfo.pQueueCreateInfos       = &queueCreateInfo;
-    deviceCreateInfo.enabledExtensionCount   = deviceExtensionCount;
-    deviceCreateInfo.ppEnabledExtensionNames = deviceExtensionNames;
+    deviceCreateInfo.queueCreateInfoCount    = queueCreateInfoCount;
+    deviceCreateInfo.pQueueCreateInfos       = queueCreateInfos;
     deviceCreateInfo.pEnabledFeatures        = &m_gpuInfo.features;
 
+    // Optional: bindless-style descriptor arrays (see BindlessTextures.hpp).
+    // The guard keeps us compiling against SDK headers that predate the
+    // extension. VK_EXT_descriptor_indexing depends on VK_KHR_maintenance3.
+    #if defined(VK_EXT_descriptor_indexing)
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures = {};
+    if (hasDeviceExtension(VK_KHR_MAINTENANCE3_EXTENSION_NAME) &&
+        hasDeviceExtension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME))
+    {
+        deviceExtensionNames.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+        deviceExtensionNames.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+
+        descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+        descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+        descriptorIndexingFeatures.descriptorBindingPartiallyBound           = VK_TRUE;
+        descriptorIndexingFeatures.runtimeDescriptorArray                    = VK_TRUE;
+        deviceCreateInfo.pNext = &descriptorIndexingFeatures;
+
+        m_descriptorIndexingSupported = true;
+        Log::debugF("VK_EXT_descriptor_indexing found - enabling the bindless texture path.");
+    }
+    #else // !VK_EXT_descriptor_indexing
+    (void)hasDeviceExtension;
+    #endif // VK_EXT_descriptor_indexing
+
+    // Optional: per-heap budget/usage queries for the memory tracker report.
+    // Guarded the same way - older SDK headers don't declare the extension.
+    #if defined(VK_EXT_memory_budget)
+    if (hasDeviceExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME))
+    {
+        deviceExtensionNames.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        m_memoryBudgetSupported = true;
+        Log::debugF("VK_EXT_memory_budget found - enabling VRAM budget queries.");
+    }
+    #endif // VK_EXT_memory_budget
+
+    // Optional: timeline semaphores collapse the fence-per-submission
+    // tracking into one counter per queue (see hasTimelineSemaphores()).
+    #if defined(VK_KHR_timeline_semaphore)
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures = {};
+    if (hasDeviceExtension(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME))
+    {
+        deviceExtensionNames.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+
+        timelineSemaphoreFeatures.sType             = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+        timelineSemaphoreFeatures.timelineSemaphore = VK_TRUE;
+        timelineSemaphoreFeatures.pNext             = const_cast<void *>(deviceCreateInfo.pNext);
+        deviceCreateInfo.pNext = &timelineSemaphoreFeatures;
+
+        m_timelineSemaphoresSupported = true;
+        Log::debugF("VK_KHR_timeline_semaphore found - using timeline submission tracking.");
+    }
+    #endif // VK_KHR_timeline_semaphore
+
+    deviceCreateInfo.enabledExtensionCount   = narrowCast<std::uint32_t>(deviceExtensionNames.size());
+    deviceCreateInfo.ppEnabledExtensionNames = deviceExtensionNames.data();
+
     VKTB_CHECK(vkCreateDevice(m_gpuPhysDevice, &deviceCreateInfo, m_allocationCallbacks, &m_device));
     assert(m_device != VK_NULL_HANDLE);
 
-    Log::debugF("VK Device created for GPU 0!");
+    Log::debugF("VK Device created for GPU '%s'!", m_gpuInfo.properties.deviceName);
 
     // Get the GPU queue handles:
     vkGetDeviceQueue(m_device, m_gpuGraphicsQueue.familyIndex, 0, &m_gpuGraphicsQueue.queue);
@@ -280,6 +517,184 @@ void VulkanContext::initDevice()
         vkGetDeviceQueue(m_device, m_gpuPresentQueue.familyIndex, 0, &m_gpuPresentQueue.queue);
         assert(m_gpuPresentQueue.queue != VK_NULL_HANDLE);
     }
+
+    if (hasDedicatedTransferQueue())
+    {
+        vkGetDeviceQueue(m_device, m_gpuTransferQueue.familyIndex, 0, &m_gpuTransferQueue.queue);
+        assert(m_gpuTransferQueue.queue != VK_NULL_HANDLE);
+        Log::debugF("Dedicated transfer queue found (family %i) - async uploads enabled.", m_gpuTransferQueue.familyIndex);
+    }
+
+    if (hasDedicatedComputeQueue())
+    {
+        vkGetDeviceQueue(m_device, m_gpuComputeQueue.familyIndex, 0, &m_gpuComputeQueue.queue);
+        assert(m_gpuComputeQueue.queue != VK_NULL_HANDLE);
+        Log::debugF("Dedicated compute queue found (family %i) - async compute enabled.", m_gpuComputeQueue.familyIndex);
+    }
+
+    #if defined(VK_KHR_timeline_semaphore)
+    if (m_timelineSemaphoresSupported)
+    {
+        initTimelineSemaphores();
+    }
+    #endif // VK_KHR_timeline_semaphore
+}
+
+#if defined(VK_KHR_timeline_semaphore)
+
+void VulkanContext::initTimelineSemaphores()
+{
+    assert(m_device != VK_NULL_HANDLE);
+
+    m_pfnWaitSemaphores = reinterpret_cast<PFN_vkWaitSemaphoresKHR>(
+        vkGetDeviceProcAddr(m_device, "vkWaitSemaphoresKHR"));
+    m_pfnGetSemaphoreCounterValue = reinterpret_cast<PFN_vkGetSemaphoreCounterValueKHR>(
+        vkGetDeviceProcAddr(m_device, "vkGetSemaphoreCounterValueKHR"));
+
+    if (m_pfnWaitSemaphores == nullptr || m_pfnGetSemaphoreCounterValue == nullptr)
+    {
+        Log::warningF("Couldn't resolve the timeline semaphore entry points - falling back to fences.");
+        m_timelineSemaphoresSupported = false;
+        return;
+    }
+
+    VkSemaphoreTypeCreateInfoKHR semaphoreTypeInfo = {};
+    semaphoreTypeInfo.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+    semaphoreTypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+    semaphoreTypeInfo.initialValue  = 0;
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreCreateInfo.pNext = &semaphoreTypeInfo;
+
+    VKTB_CHECK(vkCreateSemaphore(m_device, &semaphoreCreateInfo, m_allocationCallbacks, &m_graphicsTimeline));
+    if (hasDedicatedTransferQueue())
+    {
+        VKTB_CHECK(vkCreateSemaphore(m_device, &semaphoreCreateInfo, m_allocationCallbacks, &m_transferTimeline));
+    }
+    if (hasDedicatedComputeQueue())
+    {
+        VKTB_CHECK(vkCreateSemaphore(m_device, &semaphoreCreateInfo, m_allocationCallbacks, &m_computeTimeline));
+    }
+}
+
+void VulkanContext::waitTimelineValue(VkSemaphore timeline, const std::uint64_t value) const
+{
+    assert(timeline != VK_NULL_HANDLE);
+
+    VkSemaphoreWaitInfoKHR waitInfo = {};
+    waitInfo.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores    = &timeline;
+    waitInfo.pValues        = &value;
+
+    VKTB_CHECK(m_pfnWaitSemaphores(m_device, &waitInfo, InfiniteFenceWaitTimeout));
+}
+
+std::uint64_t VulkanContext::queryTimelineValue(VkSemaphore timeline) const
+{
+    assert(timeline != VK_NULL_HANDLE);
+
+    std::uint64_t value = 0;
+    VKTB_CHECK(m_pfnGetSemaphoreCounterValue(m_device, timeline, &value));
+    return value;
+}
+
+#endif // VK_KHR_timeline_semaphore
+
+// Rates a physical device for the capability-based GPU selection in
+// initEnumerateGpus(). Higher is better; zero means the device can't
+// do our rendering at all (no graphics queue or no swap-chain support).
+static std::uint64_t scorePhysicalDevice(const VkPhysicalDevice gpu)
+{
+    // A graphics-capable queue family is non-negotiable:
+    std::uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(gpu, &queueFamilyCount, nullptr);
+
+    std::vector<VkQueueFamilyProperties> queueProps(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(gpu, &queueFamilyCount, queueProps.data());
+
+    bool hasGraphicsQueue          = false;
+    bool hasComputeQueue           = false;
+    bool hasDedicatedTransferQueue = false;
+
+    for (const VkQueueFamilyProperties & q : queueProps)
+    {
+        if (q.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+        {
+            hasGraphicsQueue = true;
+        }
+        if (q.queueFlags & VK_QUEUE_COMPUTE_BIT)
+        {
+            hasComputeQueue = true;
+        }
+        if ((q.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(q.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+        {
+            hasDedicatedTransferQueue = true;
+        }
+    }
+
+    if (!hasGraphicsQueue)
+    {
+        return 0;
+    }
+
+    // So is being able to present - check for the swap-chain extension:
+    std::uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(gpu, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(gpu, nullptr, &extensionCount, extensions.data());
+
+    bool hasSwapChainExtension = false;
+    for (const VkExtensionProperties & ext : extensions)
+    {
+        if (std::strcmp(ext.extensionName, "VK_KHR_swapchain") == 0)
+        {
+            hasSwapChainExtension = true;
+            break;
+        }
+    }
+
+    if (!hasSwapChainExtension)
+    {
+        return 0;
+    }
+
+    // Device type is the dominant factor - a discrete part always beats
+    // an integrated one, which beats a virtual/software implementation:
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(gpu, &props);
+
+    std::uint64_t score = 0;
+    switch (props.deviceType)
+    {
+    case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU   : score += 10000000; break;
+    case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU : score += 1000000;  break;
+    case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU    : score += 100000;   break;
+    default : break; // CPU/other only wins if nothing better shows up.
+    }
+
+    // Total device-local heap size in megabytes breaks ties between
+    // devices of the same type in favor of the one with more VRAM:
+    VkPhysicalDeviceMemoryProperties memProps;
+    vkGetPhysicalDeviceMemoryProperties(gpu, &memProps);
+
+    VkDeviceSize deviceLocalBytes = 0;
+    for (std::uint32_t h = 0; h < memProps.memoryHeapCount; ++h)
+    {
+        if (memProps.memoryHeaps[h].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+        {
+            deviceLocalBytes += memProps.memoryHeaps[h].size;
+        }
+    }
+    score += (deviceLocalBytes / (1024 * 1024));
+
+    // Small bonuses for extra queue capabilities we can take advantage of:
+    if (hasComputeQueue)           { score += 1000; }
+    if (hasDedicatedTransferQueue) { score += 1000; }
+
+    return score;
 }
 
 void VulkanContext::initEnumerateGpus()
@@ -296,27 +711,62 @@ void VulkanContext::initEnumerateGpus()
     VKTB_CHECK(vkEnumeratePhysicalDevices(m_instance, &gpuCount, gpus.data()));
     assert(gpuCount >= 1);
 
-    // For now we only care about GPU 0 - no support for multi-GPU systems.
+    Log::debugF("Found %i physical GPUs", gpuCount);
+
+    // Don't just grab GPU 0 - on mixed iGPU/dGPU machines that routinely lands
+    // us on the integrated part. Rate every device and take the best scoring
+    // one, unless the user explicitly pinned an index via sm_preferredGpuIndex.
+    std::uint32_t selectedGpu = UINT32_MAX;
+    if (sm_preferredGpuIndex >= 0 && static_cast<std::uint32_t>(sm_preferredGpuIndex) < gpuCount)
+    {
+        selectedGpu = static_cast<std::uint32_t>(sm_preferredGpuIndex);
+        Log::debugF("GPU %u selected by user override.", selectedGpu);
+    }
+    else
+    {
+        if (sm_preferredGpuIndex >= 0)
+        {
+            Log::warningF("Preferred GPU index %i is out of range (%u GPUs found) - auto-selecting.",
+                          sm_preferredGpuIndex, gpuCount);
+        }
+
+        std::uint64_t bestScore = 0;
+        for (std::uint32_t g = 0; g < gpuCount; ++g)
+        {
+            const std::uint64_t score = scorePhysicalDevice(gpus[g]);
+            Log::debugF("GPU %u score: %llu", g, static_cast<unsigned long long>(score));
+
+            if (score > bestScore)
+            {
+                bestScore   = score;
+                selectedGpu = g;
+            }
+        }
+
+        if (selectedGpu == UINT32_MAX)
+        {
+            Log::fatalF("No GPU with a graphics queue and swap-chain support was found!");
+        }
+    }
 
-    vkGetPhysicalDeviceQueueFamilyProperties(gpus[0], &queueFamilyCount, nullptr);
+    vkGetPhysicalDeviceQueueFamilyProperties(gpus[selectedGpu], &queueFamilyCount, nullptr);
     assert(queueFamilyCount >= 1);
 
     m_gpuQueueProperties.resize(queueFamilyCount);
 
-    vkGetPhysicalDeviceQueueFamilyProperties(gpus[0], &queueFamilyCount, m_gpuQueueProperties.data());
+    vkGetPhysicalDeviceQueueFamilyProperties(gpus[selectedGpu], &queueFamilyCount, m_gpuQueueProperties.data());
     assert(queueFamilyCount >= 1);
 
     // This is as good a place as any to do this:
-    vkGetPhysicalDeviceFeatures(gpus[0], &m_gpuInfo.features);
-    vkGetPhysicalDeviceProperties(gpus[0], &m_gpuInfo.properties);
-    vkGetPhysicalDeviceMemoryProperties(gpus[0], &m_gpuInfo.memoryProperties);
+    vkGetPhysicalDeviceFeatures(gpus[selectedGpu], &m_gpuInfo.features);
+    vkGetPhysicalDeviceProperties(gpus[selectedGpu], &m_gpuInfo.properties);
+    vkGetPhysicalDeviceMemoryProperties(gpus[selectedGpu], &m_gpuInfo.memoryProperties);
 
     // Minimal debug printing:
-    Log::debugF("Found %i physical GPUs", gpuCount);
-    Log::debugF("GPU 0 has %i queues", queueFamilyCount);
-    Log::debugF("GPU 0 name: %s", m_gpuInfo.properties.deviceName);
+    Log::debugF("GPU %u has %i queues", selectedGpu, queueFamilyCount);
+    Log::debugF("GPU %u name: %s", selectedGpu, m_gpuInfo.properties.deviceName);
 
-    m_gpuPhysDevice = gpus[0];
+    m_gpuPhysDevice = gpus[selectedGpu];
     m_gpuQueueFamilyCount = queueFamilyCount;
 }
 
@@ -386,6 +836,31 @@ void VulkanContext::initSwapChainExtensions()
         Log::fatalF("Could not find a VK queue for both graphics and present!");
     }
 
+    // Also look for a transfer-only family (no graphics/compute bits) to run
+    // asynchronous uploads on. Optional - not every GPU exposes one.
+    for (std::uint32_t q = 0; q < m_gpuQueueFamilyCount; ++q)
+    {
+        const VkQueueFlags flags = m_gpuQueueProperties[q].queueFlags;
+        if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+        {
+            m_gpuTransferQueue.familyIndex = static_cast<std::int32_t>(q);
+            break;
+        }
+    }
+
+    // And a compute-capable family without the graphics bit, so compute
+    // dispatches can overlap rasterization instead of serializing behind it
+    // on the graphics queue. Compute-only and compute+transfer both qualify.
+    for (std::uint32_t q = 0; q < m_gpuQueueFamilyCount; ++q)
+    {
+        const VkQueueFlags flags = m_gpuQueueProperties[q].queueFlags;
+        if ((flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT))
+        {
+            m_gpuComputeQueue.familyIndex = static_cast<std::int32_t>(q);
+            break;
+        }
+    }
+
     // Get the list of VkFormats that are supported:
     std::uint32_t formatCount = 0;
     VKTB_CHECK(vkGetPhysicalDeviceSurfaceFormatsKHR(m_gpuPhysDevice, m_renderSurface, &formatCount, nullptr));
@@ -397,8 +872,8 @@ void VulkanContext::initSwapChainExtensions()
 
     if (isDebug())
     {
-        Log::debugF("GPU 0 Present Queue family index:  %i", m_gpuPresentQueue.familyIndex);
-        Log::debugF("GPU 0 Graphics Queue family index: %i", m_gpuGraphicsQueue.familyIndex);
+        Log::debugF("GPU Present Queue family index:  %i", m_gpuPresentQueue.familyIndex);
+        Log::debugF("GPU Graphics Queue family index: %i", m_gpuGraphicsQueue.familyIndex);
 
         Log::debugF("------ VK render surface formats supported ------");
         for (std::uint32_t f = 0; f < formatCount; ++f)
@@ -424,7 +899,7 @@ void VulkanContext::initSwapChainExtensions()
     Log::debugF("RenderSurfaceFormat=%s", vkFormatToString(m_renderSurfaceFormat));
 }
 
-void VulkanContext::initSwapChain()
+void VulkanContext::initSwapChain(const VkSwapchainKHR oldSwapChain)
 {
     VkSurfaceCapabilitiesKHR surfCapabilities;
     VKTB_CHECK(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_gpuPhysDevice, m_renderSurface, &surfCapabilities));
@@ -460,19 +935,20 @@ void VulkanContext::initSwapChain()
     }
     Log::debugF("SwapChainExtent={%u,%u}", swapChainExtent.width, swapChainExtent.height);
 
-    // If mailbox mode is available, use it, as is the lowest-latency non-
-    // tearing mode. If not, try IMMEDIATE which will usually be available,
+    // Use the configured present mode if the surface supports it. The default
+    // preference is MAILBOX, the lowest-latency non-tearing mode. If the
+    // preferred mode is missing, try IMMEDIATE which will usually be available,
     // and is the fastest (though it tears). If not, fall back to FIFO which is
     // always available.
     VkPresentModeKHR swapChainPresentMode = VK_PRESENT_MODE_FIFO_KHR;
     for (std::uint32_t i = 0; i < presentModeCount; ++i)
     {
-        if (presentModes[i] == VK_PRESENT_MODE_MAILBOX_KHR)
+        if (presentModes[i] == sm_preferredPresentMode)
         {
-            swapChainPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+            swapChainPresentMode = sm_preferredPresentMode;
             break;
         }
-        if ((swapChainPresentMode != VK_PRESENT_MODE_MAILBOX_KHR) &&
+        if ((swapChainPresentMode == VK_PRESENT_MODE_FIFO_KHR) &&
             (presentModes[i] == VK_PRESENT_MODE_IMMEDIATE_KHR))
         {
             swapChainPresentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
@@ -487,7 +963,13 @@ void VulkanContext::initSwapChain()
     };
     Log::debugF("KHRPresentMode=%s", presentModeNames[std::uint32_t(swapChainPresentMode)]);
 
-    std::uint32_t desiredNumberOfSwapChainImages = (sm_useTripleBufferHint ? 3 : surfCapabilities.minImageCount);
+    std::uint32_t desiredNumberOfSwapChainImages = sm_swapChainImageCount;
+    if (desiredNumberOfSwapChainImages == 0)
+    {
+        desiredNumberOfSwapChainImages = (sm_useTripleBufferHint ? 3 : surfCapabilities.minImageCount);
+    }
+    clamp(&desiredNumberOfSwapChainImages, surfCapabilities.minImageCount,
+          static_cast<std::uint32_t>(m_swapChain.buffers.size()));
     if (surfCapabilities.maxImageCount > 0 && desiredNumberOfSwapChainImages > surfCapabilities.maxImageCount)
     {
         desiredNumberOfSwapChainImages = surfCapabilities.maxImageCount;
@@ -519,7 +1001,7 @@ void VulkanContext::initSwapChain()
     swapChainCreateInfo.compositeAlpha           = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     swapChainCreateInfo.imageArrayLayers         = 1;
     swapChainCreateInfo.presentMode              = swapChainPresentMode;
-    swapChainCreateInfo.oldSwapchain             = VK_NULL_HANDLE;
+    swapChainCreateInfo.oldSwapchain             = oldSwapChain;
     swapChainCreateInfo.clipped                  = VK_TRUE;
     swapChainCreateInfo.imageColorSpace          = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
     swapChainCreateInfo.imageUsage               = imageUsage;
@@ -580,6 +1062,60 @@ void VulkanContext::initSwapChain()
     Log::debugF("Swap-chain created with %u image buffers.", m_swapChain.bufferCount);
 }
 
+void VulkanContext::recreateSwapChain(const Size2D newFramebufferSize)
+{
+    assert(m_swapChain.handle != VK_NULL_HANDLE); // Must have been fully initialized first.
+
+    if (newFramebufferSize.width <= 0 || newFramebufferSize.height <= 0)
+    {
+        return; // Window minimized - keep the old swap-chain around until it comes back.
+    }
+    if (newFramebufferSize == m_swapChain.framebufferSize)
+    {
+        return; // Spurious resize event, nothing to do.
+    }
+
+    Log::debugF("Re-creating swap-chain for new framebuffer size {w=%i, h=%i}...",
+                newFramebufferSize.width, newFramebufferSize.height);
+
+    // Only the rendering queues reference the swap-chain images, so draining
+    // those is enough - no need for a device-wide vkDeviceWaitIdle here.
+    vkQueueWaitIdle(m_gpuGraphicsQueue);
+    if (m_gpuPresentQueue.familyIndex != m_gpuGraphicsQueue.familyIndex)
+    {
+        vkQueueWaitIdle(m_gpuPresentQueue);
+    }
+
+    // The framebuffers, image views and depth-buffer reference the old swap
+    // images directly, so those get rebuilt. The old swap-chain itself stays
+    // alive and is handed to vkCreateSwapchainKHR via oldSwapchain, letting
+    // the driver recycle its images instead of allocating from scratch.
+    destroyFramebuffers();
+    destroyDepthBuffer();
+
+    const VkSwapchainKHR oldSwapChain = m_swapChain.handle;
+    m_swapChain.handle          = VK_NULL_HANDLE;
+    m_swapChain.bufferIndex     = 0;
+    m_swapChain.bufferCount     = 0;
+    m_swapChain.buffers.fill(SwapChainBuffer{});
+    m_swapChain.framebufferSize = newFramebufferSize;
+
+    initSwapChain(oldSwapChain);
+
+    // initDepthBuffer() records the depth image layout transition into the
+    // main staging buffer, same as during context startup.
+    m_mainTextureStagingCmdBuffer.beginRecording();
+    initDepthBuffer();
+    initFramebuffers();
+
+    m_mainTextureStagingCmdBuffer.endRecording();
+    enqueueSubmit(m_mainTextureStagingCmdBuffer);
+    flushPendingSubmits();
+    m_mainTextureStagingCmdBuffer.reset();
+
+    vkDestroySwapchainKHR(m_device, oldSwapChain, m_allocationCallbacks);
+}
+
 void VulkanContext::initDepthBuffer()
 {
     VkImageCreateInfo imageCreateInfo = {};
@@ -660,6 +1196,11 @@ void VulkanContext::initDepthBuffer()
     VKTB_CHECK(vkAllocateMemory(m_device, &memAllocInfo, m_allocationCallbacks, &m_depthBuffer.memory));
     assert(m_depthBuffer.memory != VK_NULL_HANDLE);
 
+    // The depth buffer bypasses createImage/the sub-allocator, so it feeds
+    // the memory tracker directly:
+    m_depthBuffer.memorySize = memReqs.size;
+    MemoryTracker::shared().trackDeviceAlloc(MemoryTracker::DepthTargetMemory, m_depthBuffer.memorySize);
+
     // Bind memory:
     VKTB_CHECK(vkBindImageMemory(m_device, m_depthBuffer.image, m_depthBuffer.memory, 0));
 
@@ -691,6 +1232,9 @@ void VulkanContext::destroyDepthBuffer()
     {
         vkFreeMemory(m_device, m_depthBuffer.memory, m_allocationCallbacks);
         m_depthBuffer.memory = VK_NULL_HANDLE;
+
+        MemoryTracker::shared().trackDeviceFree(MemoryTracker::DepthTargetMemory, m_depthBuffer.memorySize);
+        m_depthBuffer.memorySize = 0;
     }
 }
 
@@ -731,10 +1275,12 @@ void VulkanContext::destroyFramebuffers()
         if (scBuffer.view != VK_NULL_HANDLE)
         {
             vkDestroyImageView(m_device, scBuffer.view, m_allocationCallbacks);
+            scBuffer.view = VK_NULL_HANDLE;
         }
         if (scBuffer.framebuffer != VK_NULL_HANDLE)
         {
             vkDestroyFramebuffer(m_device, scBuffer.framebuffer, m_allocationCallbacks);
+            scBuffer.framebuffer = VK_NULL_HANDLE;
         }
     }
 }
@@ -774,38 +1320,62 @@ void VulkanContext::initRenderPass()
     attachments[1].finalLayout           = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
     attachments[1].flags                 = 0;
 
-    VkSubpassDescription subpass         = {};
-    subpass.pipelineBindPoint            = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpass.flags                        = 0;
-    subpass.inputAttachmentCount         = 0;
-    subpass.pInputAttachments            = nullptr;
-    subpass.colorAttachmentCount         = 1;
-    subpass.pColorAttachments            = &colorReference;
-    subpass.pResolveAttachments          = nullptr;
-    subpass.pDepthStencilAttachment      = &depthReference;
-    subpass.preserveAttachmentCount      = 0;
-    subpass.pPreserveAttachments         = nullptr;
-
-    VkSubpassDependency dependency       = {};
-    dependency.srcSubpass                = VK_SUBPASS_EXTERNAL;
-    dependency.dstSubpass                = 0;
-    dependency.srcStageMask              = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.srcAccessMask             = 0;
-    dependency.dstStageMask              = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.dstAccessMask             = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    // With the depth pre-pass enabled the color shading subpass moves to
+    // slot 1, behind a depth-only subpass in slot 0 (see colorSubpassIndex()).
+    VkSubpassDescription subpasses[2]    = {};
+    std::uint32_t subpassCount           = 0;
+
+    if (m_depthPrePassEnabled)
+    {
+        VkSubpassDescription & prePass   = subpasses[subpassCount++];
+        prePass.pipelineBindPoint        = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        prePass.colorAttachmentCount     = 0; // Depth-only - null fragment stage.
+        prePass.pColorAttachments        = nullptr;
+        prePass.pDepthStencilAttachment  = &depthReference;
+    }
+
+    VkSubpassDescription & colorPass     = subpasses[subpassCount++];
+    colorPass.pipelineBindPoint          = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    colorPass.colorAttachmentCount       = 1;
+    colorPass.pColorAttachments          = &colorReference;
+    colorPass.pDepthStencilAttachment    = &depthReference;
+
+    VkSubpassDependency dependencies[2]  = {};
+    std::uint32_t dependencyCount        = 0;
+
+    VkSubpassDependency & extDependency  = dependencies[dependencyCount++];
+    extDependency.srcSubpass             = VK_SUBPASS_EXTERNAL;
+    extDependency.dstSubpass             = colorSubpassIndex();
+    extDependency.srcStageMask           = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    extDependency.srcAccessMask          = 0;
+    extDependency.dstStageMask           = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    extDependency.dstAccessMask          = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+    if (m_depthPrePassEnabled)
+    {
+        // Shading must see the depth the pre-pass wrote:
+        VkSubpassDependency & depDepth   = dependencies[dependencyCount++];
+        depDepth.srcSubpass              = depthPrePassSubpassIndex();
+        depDepth.dstSubpass              = colorSubpassIndex();
+        depDepth.srcStageMask            = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        depDepth.srcAccessMask           = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        depDepth.dstStageMask            = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        depDepth.dstAccessMask           = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+        depDepth.dependencyFlags         = VK_DEPENDENCY_BY_REGION_BIT;
+    }
 
     VkRenderPassCreateInfo rpCreateInfo  = {};
     rpCreateInfo.sType                   = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
     rpCreateInfo.attachmentCount         = static_cast<std::uint32_t>(arrayLength(attachments));
     rpCreateInfo.pAttachments            = attachments;
-    rpCreateInfo.subpassCount            = 1;
-    rpCreateInfo.pSubpasses              = &subpass;
-    rpCreateInfo.dependencyCount         = 1;
-    rpCreateInfo.pDependencies           = &dependency;
+    rpCreateInfo.subpassCount            = subpassCount;
+    rpCreateInfo.pSubpasses              = subpasses;
+    rpCreateInfo.dependencyCount         = dependencyCount;
+    rpCreateInfo.pDependencies           = dependencies;
 
     m_mainRenderPass.initialize(rpCreateInfo);
 
-    Log::debugF("Main render-pass initialized.");
+    Log::debugF("Main render-pass initialized%s.", (m_depthPrePassEnabled ? " with a depth pre-pass subpass" : ""));
 }
 
 void VulkanContext::initCommandPoolAndBuffers()
@@ -817,6 +1387,26 @@ void VulkanContext::initCommandPoolAndBuffers()
     m_mainTextureStagingCmdBuffer.initialize(VK_COMMAND_BUFFER_LEVEL_PRIMARY, m_mainTextureStagingCmdBufferPool);
     m_mainTextureStagingCmdBuffer.beginRecording();
 
+    // Shared staging memory that texture uploads sub-allocate from:
+    m_textureStagingRing.reset(new StagingRingBuffer{ *this });
+    m_textureStagingRing->initialize(StagingRingBuffer::DefaultSizeBytes);
+
+    // Command pool/buffer targeting the transfer-only queue, for async uploads:
+    if (hasDedicatedTransferQueue())
+    {
+        m_transferCmdBufferPool.reset(new CommandPool{ *this, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+                                                       m_gpuTransferQueue.familyIndex });
+        m_transferCmdBuffer.reset(new CommandBuffer{ *this, VK_COMMAND_BUFFER_LEVEL_PRIMARY, *m_transferCmdBufferPool });
+    }
+
+    // And the same for the compute queue, for async compute batches:
+    if (hasDedicatedComputeQueue())
+    {
+        m_computeCmdBufferPool.reset(new CommandPool{ *this, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+                                                      m_gpuComputeQueue.familyIndex });
+        m_computeCmdBuffer.reset(new CommandBuffer{ *this, VK_COMMAND_BUFFER_LEVEL_PRIMARY, *m_computeCmdBufferPool });
+    }
+
     Log::debugF("Main command pool and texture staging buffer initialized for queue %i.", m_gpuGraphicsQueue.familyIndex);
 }
 
@@ -828,46 +1418,280 @@ void VulkanContext::initSemaphores()
     VKTB_CHECK(vkCreateSemaphore(m_device, &semaphoreInfo, m_allocationCallbacks, &m_imageAvailableSemaphore));
     VKTB_CHECK(vkCreateSemaphore(m_device, &semaphoreInfo, m_allocationCallbacks, &m_renderFinishedSemaphore));
 
+    if (hasDedicatedTransferQueue())
+    {
+        VKTB_CHECK(vkCreateSemaphore(m_device, &semaphoreInfo, m_allocationCallbacks, &m_transferFinishedSemaphore));
+    }
+    if (hasDedicatedComputeQueue())
+    {
+        VKTB_CHECK(vkCreateSemaphore(m_device, &semaphoreInfo, m_allocationCallbacks, &m_computeFinishedSemaphore));
+    }
+
     Log::debugF("Frame semaphores initialized.");
 }
 
-void VulkanContext::beginFrame()
+void VulkanContext::initPipelineCache()
 {
-    ++m_frameNumber;
+    // Seed the cache with the blob saved by the previous run, if we have one.
+    // The driver validates the header internally and ignores incompatible data,
+    // so a stale file from another GPU or driver version is harmless.
+    std::size_t initialDataSize = 0;
+    std::unique_ptr<char[]> initialData;
 
-    const VkResult res = vkAcquireNextImageKHR(m_device, m_swapChain.handle,
-                                               InfiniteFenceWaitTimeout, m_imageAvailableSemaphore,
-                                               VK_NULL_HANDLE, &m_swapChain.bufferIndex);
-
-    #if DEBUG
-    if (res != VK_SUCCESS)
+    ScopedFileHandle fileIn = openFile(VKTB_PIPELINE_CACHE_FILE, "rb");
+    if (fileIn != nullptr)
     {
-        Log::warningF("vkAcquireNextImageKHR failed: %s", vkResultToString(res));
-    }
-    #else // !DEBUG
-    (void)res;
-    #endif // DEBUG
-}
+        std::fseek(fileIn, 0, SEEK_END);
+        initialDataSize = std::ftell(fileIn);
+        std::fseek(fileIn, 0, SEEK_SET);
 
-void VulkanContext::endFrame(array_view<const VkCommandBuffer> submitBuffers, VkFence fence)
+        if (initialDataSize != 0)
+        {
+            initialData.reset(new char[initialDataSize]);
+            if (std::fread(initialData.get(), 1, initialDataSize, fileIn) != initialDataSize)
+            {
+                Log::warningF("Failed to read pipeline cache file '%s' - starting empty.", VKTB_PIPELINE_CACHE_FILE);
+                initialDataSize = 0;
+                initialData     = nullptr;
+            }
+        }
+    }
+
+    VkPipelineCacheCreateInfo cacheCreateInfo;
+    cacheCreateInfo.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheCreateInfo.pNext           = nullptr;
+    cacheCreateInfo.flags           = 0;
+    cacheCreateInfo.initialDataSize = initialDataSize;
+    cacheCreateInfo.pInitialData    = initialData.get();
+
+    VKTB_CHECK(vkCreatePipelineCache(m_device, &cacheCreateInfo,
+                                     m_allocationCallbacks, &m_pipelineCacheHandle));
+
+    Log::debugF("Pipeline cache initialized (%zu bytes of preloaded data).", initialDataSize);
+}
+
+void VulkanContext::savePipelineCacheToDisk() const
+{
+    assert(m_pipelineCacheHandle != VK_NULL_HANDLE);
+
+    std::size_t cacheDataSize = 0;
+    VKTB_CHECK(vkGetPipelineCacheData(m_device, m_pipelineCacheHandle, &cacheDataSize, nullptr));
+    if (cacheDataSize == 0)
+    {
+        return; // Nothing worth saving.
+    }
+
+    std::unique_ptr<char[]> cacheData{ new char[cacheDataSize] };
+    VKTB_CHECK(vkGetPipelineCacheData(m_device, m_pipelineCacheHandle, &cacheDataSize, cacheData.get()));
+
+    ScopedFileHandle fileOut = openFile(VKTB_PIPELINE_CACHE_FILE, "wb");
+    if (fileOut == nullptr)
+    {
+        Log::warningF("Could not create pipeline cache file '%s'.", VKTB_PIPELINE_CACHE_FILE);
+        return;
+    }
+
+    writeArrayToFile(fileOut, cacheData.get(), cacheDataSize);
+    Log::debugF("Saved %zu bytes of pipeline cache data to '%s'.", cacheDataSize, VKTB_PIPELINE_CACHE_FILE);
+}
+
+VkSampler VulkanContext::sharedSampler(const VkSamplerCreateInfo & samplerDesc) const
+{
+    assert(samplerDesc.sType == VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO);
+    assert(samplerDesc.pNext == nullptr); // Extension structs would defeat the hash.
+
+    // Everything after sType/pNext is tightly packed 4-byte fields, so the
+    // whole span hashes in one go without picking up pointers or padding.
+    const std::size_t payloadOffset = offsetof(VkSamplerCreateInfo, flags);
+    const std::uint64_t paramsHash  = murmurHash64(
+        reinterpret_cast<const std::uint8_t *>(&samplerDesc) + payloadOffset,
+        sizeof(VkSamplerCreateInfo) - payloadOffset);
+
+    std::lock_guard<std::mutex> lock{ m_sharedSamplersMutex };
+
+    for (const CachedSampler & cachedSampler : m_sharedSamplers)
+    {
+        if (cachedSampler.paramsHash == paramsHash)
+        {
+            return cachedSampler.handle;
+        }
+    }
+
+    VkSampler newSampler = VK_NULL_HANDLE;
+    VKTB_CHECK(vkCreateSampler(m_device, &samplerDesc, m_allocationCallbacks, &newSampler));
+    assert(newSampler != VK_NULL_HANDLE);
+
+    m_sharedSamplers.push_back({ paramsHash, newSampler });
+    return newSampler;
+}
+
+void VulkanContext::beginFrame()
+{
+    ++m_frameNumber;
+    FrameStats::shared().frameMark();
+
+    // Everything allocated from the frame arena last frame dies here.
+    FrameArena::shared().reset();
+
+    // Destroy GPU resources that were retired long enough ago
+    // that no in-flight frame can still be referencing them.
+    executeDeferredDestructions(/* flushAll = */ false);
+
+    VkResult res;
+    {
+        FrameStats::ScopedTimer timer{ FrameStats::AcquireWait };
+        res = vkAcquireNextImageKHR(m_device, m_swapChain.handle,
+                                    InfiniteFenceWaitTimeout, m_imageAvailableSemaphore,
+                                    VK_NULL_HANDLE, &m_swapChain.bufferIndex);
+    }
+
+    #if DEBUG
+    if (res != VK_SUCCESS)
+    {
+        Log::warningF("vkAcquireNextImageKHR failed: %s", vkResultToString(res));
+    }
+    #else // !DEBUG
+    (void)res;
+    #endif // DEBUG
+}
+
+void VulkanContext::endFrame(array_view<const VkCommandBuffer> submitBuffers, VkFence fence)
 {
-    const VkSemaphore waitSemaphores[]      = { m_imageAvailableSemaphore };
-    const VkSemaphore signalSemaphores[]    = { m_renderFinishedSemaphore };
-    const VkSwapchainKHR swapChains[]       = { m_swapChain.handle };
-    const VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+    const VkSwapchainKHR swapChains[] = { m_swapChain.handle };
+
+    VkSemaphore signalSemaphores[2]    = { m_renderFinishedSemaphore };
+    std::uint32_t signalSemaphoreCount = 1;
+
+    VkSemaphore waitSemaphores[3]      = { m_imageAvailableSemaphore };
+    VkPipelineStageFlags waitStages[3] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+    std::uint32_t waitSemaphoreCount   = 1;
+
+    #if defined(VK_KHR_timeline_semaphore)
+    std::uint64_t waitValues[3]   = {}; // Entries for binary semaphores are ignored.
+    std::uint64_t signalValues[2] = {};
+    #endif // VK_KHR_timeline_semaphore
+
+    // If a transfer or compute batch was submitted since the last frame, also
+    // wait for those, so the graphics queue never consumes half-uploaded
+    // resources or compute results that haven't been produced yet. In timeline
+    // mode the wait is on the counter value the batch signaled; in fence mode
+    // on its binary semaphore.
+    if (m_asyncTransferSubmitted)
+    {
+        #if defined(VK_KHR_timeline_semaphore)
+        if (m_timelineSemaphoresSupported)
+        {
+            waitSemaphores[waitSemaphoreCount] = m_transferTimeline;
+            waitValues[waitSemaphoreCount]     = m_transferTimelineValue;
+        }
+        else
+        #endif // VK_KHR_timeline_semaphore
+        {
+            waitSemaphores[waitSemaphoreCount] = m_transferFinishedSemaphore;
+        }
+        waitStages[waitSemaphoreCount] = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        ++waitSemaphoreCount;
+        m_asyncTransferSubmitted = false;
+    }
+    if (m_asyncComputeSubmitted)
+    {
+        #if defined(VK_KHR_timeline_semaphore)
+        if (m_timelineSemaphoresSupported)
+        {
+            waitSemaphores[waitSemaphoreCount] = m_computeTimeline;
+            waitValues[waitSemaphoreCount]     = m_computeTimelineValue;
+        }
+        else
+        #endif // VK_KHR_timeline_semaphore
+        {
+            waitSemaphores[waitSemaphoreCount] = m_computeFinishedSemaphore;
+        }
+        waitStages[waitSemaphoreCount] = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        ++waitSemaphoreCount;
+        m_asyncComputeSubmitted = false;
+    }
 
     VkSubmitInfo submitInfo;
     submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     submitInfo.pNext                = nullptr;
-    submitInfo.waitSemaphoreCount   = 1;
+    submitInfo.waitSemaphoreCount   = waitSemaphoreCount;
     submitInfo.pWaitSemaphores      = waitSemaphores;
     submitInfo.pWaitDstStageMask    = waitStages;
     submitInfo.commandBufferCount   = static_cast<std::uint32_t>(submitBuffers.size());
     submitInfo.pCommandBuffers      = submitBuffers.data();
-    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.signalSemaphoreCount = signalSemaphoreCount;
     submitInfo.pSignalSemaphores    = signalSemaphores;
 
-    VKTB_CHECK(vkQueueSubmit(m_gpuGraphicsQueue, 1, &submitInfo, fence));
+    #if defined(VK_KHR_timeline_semaphore)
+    VkTimelineSemaphoreSubmitInfoKHR timelineInfo = {};
+    std::uint64_t frameSignalValue = 0;
+    if (m_timelineSemaphoresSupported)
+    {
+        // The frame submission also bumps the graphics timeline - that value
+        // is what retires this frame's deferred destructions.
+        frameSignalValue = ++m_graphicsTimelineValue;
+        signalSemaphores[signalSemaphoreCount] = m_graphicsTimeline;
+        signalValues[signalSemaphoreCount]     = frameSignalValue;
+        ++signalSemaphoreCount;
+
+        timelineInfo.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+        timelineInfo.waitSemaphoreValueCount   = waitSemaphoreCount;
+        timelineInfo.pWaitSemaphoreValues      = waitValues;
+        timelineInfo.signalSemaphoreValueCount = signalSemaphoreCount;
+        timelineInfo.pSignalSemaphoreValues    = signalValues;
+
+        submitInfo.pNext                = &timelineInfo;
+        submitInfo.signalSemaphoreCount = signalSemaphoreCount;
+    }
+    #endif // VK_KHR_timeline_semaphore
+
+    {
+        FrameStats::ScopedTimer timer{ FrameStats::QueueSubmit };
+        if (m_pendingSubmits.empty())
+        {
+            VKTB_CHECK(vkQueueSubmit(m_gpuGraphicsQueue, 1, &submitInfo, fence));
+        }
+        else
+        {
+            // Upload buffers enqueued since the last flush ride along in the
+            // same vkQueueSubmit, ahead of the frame's buffers. The frame
+            // fence covers them, so the caller's usual frame pacing is the
+            // only synchronization needed before staging memory is reused.
+            std::vector<VkSubmitInfo> batches;
+            batches.reserve(m_pendingSubmits.size() + 1);
+
+            for (const VkCommandBuffer & pending : m_pendingSubmits)
+            {
+                VkSubmitInfo batch          = {};
+                batch.sType                 = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+                batch.commandBufferCount    = 1;
+                batch.pCommandBuffers       = &pending;
+                batches.push_back(batch);
+            }
+            batches.push_back(submitInfo);
+
+            VKTB_CHECK(vkQueueSubmit(m_gpuGraphicsQueue, narrowCast<std::uint32_t>(batches.size()),
+                                     batches.data(), fence));
+            m_pendingSubmits.clear();
+        }
+    }
+
+    #if defined(VK_KHR_timeline_semaphore)
+    if (m_timelineSemaphoresSupported)
+    {
+        // Stamp the handles retired during this frame with the value the
+        // frame submission signals - executeDeferredDestructions() frees
+        // them once the graphics counter has passed it.
+        std::lock_guard<std::mutex> lock{ m_deferredDestroyMutex };
+        for (DeferredDestroyEntry & entry : m_deferredDestroyQueue)
+        {
+            if (entry.timelineValue == 0)
+            {
+                entry.timelineValue = frameSignalValue;
+            }
+        }
+    }
+    #endif // VK_KHR_timeline_semaphore
 
     VkPresentInfoKHR presentInfo;
     presentInfo.sType               = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -879,7 +1703,11 @@ void VulkanContext::endFrame(array_view<const VkCommandBuffer> submitBuffers, Vk
     presentInfo.pImageIndices       = &m_swapChain.bufferIndex;
     presentInfo.pResults            = nullptr;
 
-    const VkResult res = vkQueuePresentKHR(m_gpuPresentQueue, &presentInfo);
+    VkResult res;
+    {
+        FrameStats::ScopedTimer timer{ FrameStats::Present };
+        res = vkQueuePresentKHR(m_gpuPresentQueue, &presentInfo);
+    }
 
     #if DEBUG
     if (res != VK_SUCCESS)
@@ -913,6 +1741,45 @@ std::uint32_t VulkanContext::memoryTypeFromProperties(const std::uint32_t typeBi
     return UINT32_MAX;
 }
 
+VulkanContext::MemoryBudget VulkanContext::queryMemoryBudget() const
+{
+    MemoryBudget result;
+    result.heapCount = m_gpuInfo.memoryProperties.memoryHeapCount;
+    for (std::uint32_t h = 0; h < result.heapCount; ++h)
+    {
+        result.heapFlags[h] = m_gpuInfo.memoryProperties.memoryHeaps[h].flags;
+    }
+
+    #if defined(VK_EXT_memory_budget)
+    if (m_memoryBudgetSupported)
+    {
+        const auto pfnGetMemoryProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceMemoryProperties2KHR>(
+            vkGetInstanceProcAddr(m_instance, "vkGetPhysicalDeviceMemoryProperties2KHR"));
+
+        if (pfnGetMemoryProperties2 != nullptr)
+        {
+            VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProps = {};
+            budgetProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+            VkPhysicalDeviceMemoryProperties2KHR memProps2 = {};
+            memProps2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR;
+            memProps2.pNext = &budgetProps;
+
+            pfnGetMemoryProperties2(m_gpuPhysDevice, &memProps2);
+
+            for (std::uint32_t h = 0; h < result.heapCount; ++h)
+            {
+                result.budgetBytes[h] = budgetProps.heapBudget[h];
+                result.usageBytes[h]  = budgetProps.heapUsage[h];
+            }
+            result.supported = true;
+        }
+    }
+    #endif // VK_EXT_memory_budget
+
+    return result;
+}
+
 void VulkanContext::changeImageLayout(const CommandBuffer & cmdBuff, VkImage image, const VkImageAspectFlags aspectMask,
                                       const VkImageLayout oldImageLayout, const VkImageLayout newImageLayout,
                                       const int baseMipLevel, const int mipLevelCount,
@@ -1019,15 +1886,16 @@ void VulkanContext::createImage(const VkImageCreateInfo & imageInfo, const VkMem
     VkMemoryRequirements memRequirements = {};
     vkGetImageMemoryRequirements(m_device, *outImage, &memRequirements);
 
-    VkMemoryAllocateInfo allocInfo;
-    allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.pNext           = nullptr;
-    allocInfo.allocationSize  = memRequirements.size;
-    allocInfo.memoryTypeIndex = memoryTypeFromProperties(memRequirements.memoryTypeBits, memoryProperties);
-    assert(allocInfo.memoryTypeIndex < UINT32_MAX && "Requested memory type not supported!");
+    const auto alloc = m_deviceMemAllocator->allocate(memRequirements, memoryProperties,
+                                                      DeviceMemoryAllocator::ImageResource);
+
+    VKTB_CHECK(vkBindImageMemory(m_device, *outImage, alloc.memory, alloc.offset));
 
-    VKTB_CHECK(vkAllocateMemory(m_device, &allocInfo, m_allocationCallbacks, outImageMemory));
-    VKTB_CHECK(vkBindImageMemory(m_device, *outImage, *outImageMemory, 0));
+    const auto category = MemoryTracker::categoryForImageUsage(imageInfo.usage);
+    MemoryTracker::shared().trackDeviceAlloc(category, alloc.size);
+
+    registerMemoryBinding(reinterpret_cast<std::uint64_t>(*outImage), alloc, category);
+    (*outImageMemory) = alloc.memory;
 }
 
 void VulkanContext::copyBuffer(const CommandBuffer & cmdBuff, VkBuffer srcBuffer,
@@ -1063,15 +1931,16 @@ void VulkanContext::createBuffer(const VkDeviceSize sizeBytes, const VkBufferUsa
     VkMemoryRequirements memRequirements = {};
     vkGetBufferMemoryRequirements(m_device, *outBuffer, &memRequirements);
 
-    VkMemoryAllocateInfo allocInfo;
-    allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.pNext           = nullptr;
-    allocInfo.allocationSize  = memRequirements.size;
-    allocInfo.memoryTypeIndex = memoryTypeFromProperties(memRequirements.memoryTypeBits, memoryProperties);
-    assert(allocInfo.memoryTypeIndex < UINT32_MAX && "Requested memory type not supported!");
+    const auto alloc = m_deviceMemAllocator->allocate(memRequirements, memoryProperties,
+                                                      DeviceMemoryAllocator::BufferResource);
+
+    VKTB_CHECK(vkBindBufferMemory(m_device, *outBuffer, alloc.memory, alloc.offset));
+
+    const auto category = MemoryTracker::categoryForBufferUsage(usage);
+    MemoryTracker::shared().trackDeviceAlloc(category, alloc.size);
 
-    VKTB_CHECK(vkAllocateMemory(m_device, &allocInfo, m_allocationCallbacks, outBufferMemory));
-    VKTB_CHECK(vkBindBufferMemory(m_device, *outBuffer, *outBufferMemory, 0));
+    registerMemoryBinding(reinterpret_cast<std::uint64_t>(*outBuffer), alloc, category);
+    (*outBufferMemory) = alloc.memory;
 
     if (outOptMemReqs != nullptr)
     {
@@ -1079,6 +1948,583 @@ void VulkanContext::createBuffer(const VkDeviceSize sizeBytes, const VkBufferUsa
     }
 }
 
+const CommandBuffer & VulkanContext::textureStagingCmdBufferForThisThread() const
+{
+    const std::thread::id thisThread = std::this_thread::get_id();
+    if (thisThread == m_mainThreadId)
+    {
+        return m_mainTextureStagingCmdBuffer;
+    }
+
+    std::lock_guard<std::mutex> lock{ m_threadStagingCmdBuffersMutex };
+
+    for (const ThreadStagingCmdBuffer & entry : m_threadStagingCmdBuffers)
+    {
+        if (entry.owningThread == thisThread)
+        {
+            return *entry.cmdBuffer;
+        }
+    }
+
+    // First use on this thread - set up a pool/buffer pair already in the
+    // recording state, mirroring what beginResourceLoad does for the main buffer.
+    // The CommandBuffer lives on the heap, so the reference stays valid even
+    // if another thread grows the vector.
+    ThreadStagingCmdBuffer entry;
+    entry.owningThread = thisThread;
+    entry.pool.reset(new CommandPool{ *this, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+                                      m_gpuGraphicsQueue.familyIndex });
+    entry.cmdBuffer.reset(new CommandBuffer{ *this, VK_COMMAND_BUFFER_LEVEL_PRIMARY, *entry.pool });
+    entry.cmdBuffer->beginRecording();
+
+    m_threadStagingCmdBuffers.push_back(std::move(entry));
+    return *m_threadStagingCmdBuffers.back().cmdBuffer;
+}
+
+void VulkanContext::submitAllTextureStagingCmdBuffers() const
+{
+    assert(m_mainTextureStagingCmdBuffer.isInRecordingState());
+    m_mainTextureStagingCmdBuffer.endRecording();
+
+    {
+        std::lock_guard<std::mutex> lock{ m_threadStagingCmdBuffersMutex };
+
+        enqueueSubmit(m_mainTextureStagingCmdBuffer);
+        for (const ThreadStagingCmdBuffer & entry : m_threadStagingCmdBuffers)
+        {
+            entry.cmdBuffer->endRecording();
+            enqueueSubmit(*entry.cmdBuffer);
+        }
+    }
+
+    // The flush also picks up whatever else the load phase enqueued (model
+    // uploads and the like), so everything shares the one queue submission.
+    flushPendingSubmits();
+
+    m_mainTextureStagingCmdBuffer.reset();
+
+    // The flush above waits the submission out (timeline counter value
+    // or fence), so the GPU is done reading the staging ring and
+    // everything the batch carved out can now be recycled.
+    m_textureStagingRing->retireCompletedAllocations();
+
+    // The per-thread buffers are cheap to recreate, so just drop
+    // them - the next parallel load phase makes fresh ones.
+    std::lock_guard<std::mutex> lock{ m_threadStagingCmdBuffersMutex };
+    m_threadStagingCmdBuffers.clear();
+}
+
+void VulkanContext::enqueueSubmit(const CommandBuffer & cmdBuff) const
+{
+    assert(std::this_thread::get_id() == m_mainThreadId); // Pending list is not thread-safe by design.
+    assert(cmdBuff.isInSubmissionState()); // Must be done recording.
+
+    m_pendingSubmits.push_back(cmdBuff.commandBufferHandle());
+}
+
+void VulkanContext::flushPendingSubmits() const
+{
+    assert(std::this_thread::get_id() == m_mainThreadId);
+
+    if (m_pendingSubmits.empty())
+    {
+        return;
+    }
+
+    // One VkSubmitInfo batch per enqueued buffer, a single vkQueueSubmit
+    // call for all of them, and one wait - a timeline counter tick when
+    // available, a recycled fence otherwise.
+    std::vector<VkSubmitInfo> batches;
+    batches.reserve(m_pendingSubmits.size());
+
+    for (const VkCommandBuffer & pending : m_pendingSubmits)
+    {
+        VkSubmitInfo batch;
+        batch.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        batch.pNext                = nullptr;
+        batch.waitSemaphoreCount   = 0;
+        batch.pWaitSemaphores      = nullptr;
+        batch.pWaitDstStageMask    = nullptr;
+        batch.commandBufferCount   = 1;
+        batch.pCommandBuffers      = &pending;
+        batch.signalSemaphoreCount = 0;
+        batch.pSignalSemaphores    = nullptr;
+        batches.push_back(batch);
+    }
+
+    #if defined(VK_KHR_timeline_semaphore)
+    if (m_timelineSemaphoresSupported)
+    {
+        // Tag the last batch with the next graphics counter value and block
+        // on that - no fence object to allocate, reset or recycle.
+        const std::uint64_t signalValue = ++m_graphicsTimelineValue;
+
+        VkTimelineSemaphoreSubmitInfoKHR timelineInfo = {};
+        timelineInfo.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues    = &signalValue;
+
+        VkSubmitInfo & lastBatch       = batches.back();
+        lastBatch.pNext                = &timelineInfo;
+        lastBatch.signalSemaphoreCount = 1;
+        lastBatch.pSignalSemaphores    = &m_graphicsTimeline;
+
+        VKTB_CHECK(vkQueueSubmit(m_gpuGraphicsQueue, narrowCast<std::uint32_t>(batches.size()),
+                                 batches.data(), VK_NULL_HANDLE));
+        waitTimelineValue(m_graphicsTimeline, signalValue);
+    }
+    else
+    #endif // VK_KHR_timeline_semaphore
+    {
+        AutoFence fence{ mainFenceCache() };
+        VKTB_CHECK(vkQueueSubmit(m_gpuGraphicsQueue, narrowCast<std::uint32_t>(batches.size()),
+                                 batches.data(), fence));
+    }
+
+    m_pendingSubmits.clear();
+}
+
+const CommandBuffer & VulkanContext::beginAsyncTransfer() const
+{
+    assert(hasDedicatedTransferQueue());
+    assert(!m_asyncTransferSubmitted); // Previous batch must be consumed by an endFrame() first.
+
+    #if defined(VK_KHR_timeline_semaphore)
+    if (m_timelineSemaphoresSupported)
+    {
+        // Same wait, keyed on the counter value the previous batch signaled.
+        if (m_transferTimelineValue != 0)
+        {
+            FrameStats::ScopedTimer timer{ FrameStats::FenceWait };
+            waitTimelineValue(m_transferTimeline, m_transferTimelineValue);
+            m_transferCmdBuffer->reset();
+        }
+
+        m_transferCmdBuffer->beginRecording();
+        return *m_transferCmdBuffer;
+    }
+    #endif // VK_KHR_timeline_semaphore
+
+    if (m_transferCompleteFence != VK_NULL_HANDLE)
+    {
+        // Normally signaled long ago - this only blocks if transfers are
+        // being pushed faster than the transfer queue can drain them.
+        FrameStats::ScopedTimer timer{ FrameStats::FenceWait };
+        VKTB_CHECK(vkWaitForFences(m_device, 1, &m_transferCompleteFence, VK_TRUE, InfiniteFenceWaitTimeout));
+        m_mainFenceCache->recycleFence(m_transferCompleteFence);
+        m_transferCompleteFence = VK_NULL_HANDLE;
+        m_transferCmdBuffer->reset();
+    }
+
+    m_transferCmdBuffer->beginRecording();
+    return *m_transferCmdBuffer;
+}
+
+void VulkanContext::asyncTransferCopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, const VkDeviceSize sizeToCopy) const
+{
+    assert(m_transferCmdBuffer != nullptr && m_transferCmdBuffer->isInRecordingState());
+
+    copyBuffer(*m_transferCmdBuffer, srcBuffer, dstBuffer, sizeToCopy);
+
+    // Release ownership of the destination to the graphics family. The matching
+    // acquire is recorded on the graphics side by recordPendingTransferAcquires().
+    VkBufferMemoryBarrier barrier;
+    barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.pNext               = nullptr;
+    barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask       = 0;
+    barrier.srcQueueFamilyIndex = static_cast<std::uint32_t>(m_gpuTransferQueue.familyIndex);
+    barrier.dstQueueFamilyIndex = static_cast<std::uint32_t>(m_gpuGraphicsQueue.familyIndex);
+    barrier.buffer              = dstBuffer;
+    barrier.offset              = 0;
+    barrier.size                = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(m_transferCmdBuffer->commandBufferHandle(),
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+    m_pendingTransferAcquires.push_back(dstBuffer);
+}
+
+void VulkanContext::endAsyncTransfer() const
+{
+    assert(m_transferCmdBuffer != nullptr && m_transferCmdBuffer->isInRecordingState());
+    m_transferCmdBuffer->endRecording();
+
+    const VkCommandBuffer cmdBuffers[]   = { m_transferCmdBuffer->commandBufferHandle() };
+    const VkSemaphore signalSemaphores[] = { m_transferFinishedSemaphore };
+
+    VkSubmitInfo submitInfo;
+    submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext                = nullptr;
+    submitInfo.waitSemaphoreCount   = 0;
+    submitInfo.pWaitSemaphores      = nullptr;
+    submitInfo.pWaitDstStageMask    = nullptr;
+    submitInfo.commandBufferCount   = 1;
+    submitInfo.pCommandBuffers      = cmdBuffers;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores    = signalSemaphores;
+
+    // No CPU wait in either mode - the completion is only checked by the next
+    // beginAsyncTransfer(), and endFrame() makes the graphics queue wait GPU-side.
+    #if defined(VK_KHR_timeline_semaphore)
+    if (m_timelineSemaphoresSupported)
+    {
+        // One counter value serves both sides: endFrame() waits on it from
+        // the graphics queue and the next beginAsyncTransfer() from the CPU.
+        // No fence and no binary semaphore juggling.
+        const std::uint64_t signalValue = ++m_transferTimelineValue;
+
+        VkTimelineSemaphoreSubmitInfoKHR timelineInfo = {};
+        timelineInfo.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues    = &signalValue;
+
+        submitInfo.pNext             = &timelineInfo;
+        submitInfo.pSignalSemaphores = &m_transferTimeline;
+        VKTB_CHECK(vkQueueSubmit(m_gpuTransferQueue, 1, &submitInfo, VK_NULL_HANDLE));
+    }
+    else
+    #endif // VK_KHR_timeline_semaphore
+    {
+        m_transferCompleteFence = m_mainFenceCache->allocRecyclableFence();
+        VKTB_CHECK(vkQueueSubmit(m_gpuTransferQueue, 1, &submitInfo, m_transferCompleteFence));
+    }
+
+    m_asyncTransferSubmitted = true;
+}
+
+void VulkanContext::recordPendingTransferAcquires(const CommandBuffer & cmdBuff) const
+{
+    if (m_pendingTransferAcquires.empty())
+    {
+        return;
+    }
+    assert(cmdBuff.isInRecordingState());
+
+    std::vector<VkBufferMemoryBarrier> barriers;
+    barriers.reserve(m_pendingTransferAcquires.size());
+
+    for (VkBuffer buffer : m_pendingTransferAcquires)
+    {
+        VkBufferMemoryBarrier barrier;
+        barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.pNext               = nullptr;
+        barrier.srcAccessMask       = 0;
+        barrier.dstAccessMask       = VK_ACCESS_MEMORY_READ_BIT;
+        barrier.srcQueueFamilyIndex = static_cast<std::uint32_t>(m_gpuTransferQueue.familyIndex);
+        barrier.dstQueueFamilyIndex = static_cast<std::uint32_t>(m_gpuGraphicsQueue.familyIndex);
+        barrier.buffer              = buffer;
+        barrier.offset              = 0;
+        barrier.size                = VK_WHOLE_SIZE;
+        barriers.push_back(barrier);
+    }
+
+    vkCmdPipelineBarrier(cmdBuff.commandBufferHandle(),
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         0, 0, nullptr, static_cast<std::uint32_t>(barriers.size()), barriers.data(), 0, nullptr);
+
+    m_pendingTransferAcquires.clear();
+}
+
+const CommandBuffer & VulkanContext::beginAsyncCompute() const
+{
+    assert(hasDedicatedComputeQueue());
+    assert(!m_asyncComputeSubmitted); // Previous batch must be consumed by an endFrame() first.
+
+    #if defined(VK_KHR_timeline_semaphore)
+    if (m_timelineSemaphoresSupported)
+    {
+        // Same wait, keyed on the counter value the previous batch signaled.
+        if (m_computeTimelineValue != 0)
+        {
+            FrameStats::ScopedTimer timer{ FrameStats::FenceWait };
+            waitTimelineValue(m_computeTimeline, m_computeTimelineValue);
+            m_computeCmdBuffer->reset();
+        }
+
+        m_computeCmdBuffer->beginRecording();
+        return *m_computeCmdBuffer;
+    }
+    #endif // VK_KHR_timeline_semaphore
+
+    if (m_computeCompleteFence != VK_NULL_HANDLE)
+    {
+        // Normally signaled long ago - this only blocks if compute batches
+        // are being pushed faster than the compute queue can drain them.
+        FrameStats::ScopedTimer timer{ FrameStats::FenceWait };
+        VKTB_CHECK(vkWaitForFences(m_device, 1, &m_computeCompleteFence, VK_TRUE, InfiniteFenceWaitTimeout));
+        m_mainFenceCache->recycleFence(m_computeCompleteFence);
+        m_computeCompleteFence = VK_NULL_HANDLE;
+        m_computeCmdBuffer->reset();
+    }
+
+    m_computeCmdBuffer->beginRecording();
+    return *m_computeCmdBuffer;
+}
+
+void VulkanContext::asyncComputeReleaseBuffer(VkBuffer buffer) const
+{
+    assert(m_computeCmdBuffer != nullptr && m_computeCmdBuffer->isInRecordingState());
+
+    // Release ownership of the written buffer to the graphics family. The
+    // matching acquire is recorded by recordPendingComputeAcquires().
+    VkBufferMemoryBarrier barrier;
+    barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.pNext               = nullptr;
+    barrier.srcAccessMask       = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask       = 0;
+    barrier.srcQueueFamilyIndex = static_cast<std::uint32_t>(m_gpuComputeQueue.familyIndex);
+    barrier.dstQueueFamilyIndex = static_cast<std::uint32_t>(m_gpuGraphicsQueue.familyIndex);
+    barrier.buffer              = buffer;
+    barrier.offset              = 0;
+    barrier.size                = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(m_computeCmdBuffer->commandBufferHandle(),
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+    m_pendingComputeAcquires.push_back(buffer);
+}
+
+void VulkanContext::endAsyncCompute() const
+{
+    assert(m_computeCmdBuffer != nullptr && m_computeCmdBuffer->isInRecordingState());
+    m_computeCmdBuffer->endRecording();
+
+    const VkCommandBuffer cmdBuffers[]   = { m_computeCmdBuffer->commandBufferHandle() };
+    const VkSemaphore signalSemaphores[] = { m_computeFinishedSemaphore };
+
+    VkSubmitInfo submitInfo;
+    submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext                = nullptr;
+    submitInfo.waitSemaphoreCount   = 0;
+    submitInfo.pWaitSemaphores      = nullptr;
+    submitInfo.pWaitDstStageMask    = nullptr;
+    submitInfo.commandBufferCount   = 1;
+    submitInfo.pCommandBuffers      = cmdBuffers;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores    = signalSemaphores;
+
+    // No CPU wait in either mode - the completion is only checked by the next
+    // beginAsyncCompute(), and endFrame() makes the graphics queue wait GPU-side,
+    // so the batch runs alongside whatever the graphics queue is rasterizing.
+    #if defined(VK_KHR_timeline_semaphore)
+    if (m_timelineSemaphoresSupported)
+    {
+        // One counter value serves both sides: endFrame() waits on it from
+        // the graphics queue and the next beginAsyncCompute() from the CPU.
+        const std::uint64_t signalValue = ++m_computeTimelineValue;
+
+        VkTimelineSemaphoreSubmitInfoKHR timelineInfo = {};
+        timelineInfo.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues    = &signalValue;
+
+        submitInfo.pNext             = &timelineInfo;
+        submitInfo.pSignalSemaphores = &m_computeTimeline;
+        VKTB_CHECK(vkQueueSubmit(m_gpuComputeQueue, 1, &submitInfo, VK_NULL_HANDLE));
+    }
+    else
+    #endif // VK_KHR_timeline_semaphore
+    {
+        m_computeCompleteFence = m_mainFenceCache->allocRecyclableFence();
+        VKTB_CHECK(vkQueueSubmit(m_gpuComputeQueue, 1, &submitInfo, m_computeCompleteFence));
+    }
+
+    m_asyncComputeSubmitted = true;
+}
+
+void VulkanContext::recordPendingComputeAcquires(const CommandBuffer & cmdBuff) const
+{
+    if (m_pendingComputeAcquires.empty())
+    {
+        return;
+    }
+    assert(cmdBuff.isInRecordingState());
+
+    std::vector<VkBufferMemoryBarrier> barriers;
+    barriers.reserve(m_pendingComputeAcquires.size());
+
+    for (VkBuffer buffer : m_pendingComputeAcquires)
+    {
+        VkBufferMemoryBarrier barrier;
+        barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.pNext               = nullptr;
+        barrier.srcAccessMask       = 0;
+        barrier.dstAccessMask       = VK_ACCESS_MEMORY_READ_BIT;
+        barrier.srcQueueFamilyIndex = static_cast<std::uint32_t>(m_gpuComputeQueue.familyIndex);
+        barrier.dstQueueFamilyIndex = static_cast<std::uint32_t>(m_gpuGraphicsQueue.familyIndex);
+        barrier.buffer              = buffer;
+        barrier.offset              = 0;
+        barrier.size                = VK_WHOLE_SIZE;
+        barriers.push_back(barrier);
+    }
+
+    vkCmdPipelineBarrier(cmdBuff.commandBufferHandle(),
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         0, 0, nullptr, static_cast<std::uint32_t>(barriers.size()), barriers.data(), 0, nullptr);
+
+    m_pendingComputeAcquires.clear();
+}
+
+void VulkanContext::destroyBuffer(VkBuffer buffer, VkDeviceMemory bufferMemory) const
+{
+    assert(buffer != VK_NULL_HANDLE);
+
+    const auto binding = unregisterMemoryBinding(reinterpret_cast<std::uint64_t>(buffer));
+    assert(binding.allocation.memory == bufferMemory); (void)bufferMemory;
+
+    vkDestroyBuffer(m_device, buffer, m_allocationCallbacks);
+    m_deviceMemAllocator->free(binding.allocation);
+
+    MemoryTracker::shared().trackDeviceFree(binding.category, binding.allocation.size);
+}
+
+void VulkanContext::destroyImage(VkImage image, VkDeviceMemory imageMemory) const
+{
+    assert(image != VK_NULL_HANDLE);
+
+    const auto binding = unregisterMemoryBinding(reinterpret_cast<std::uint64_t>(image));
+    assert(binding.allocation.memory == imageMemory); (void)imageMemory;
+
+    vkDestroyImage(m_device, image, m_allocationCallbacks);
+    m_deviceMemAllocator->free(binding.allocation);
+
+    MemoryTracker::shared().trackDeviceFree(binding.category, binding.allocation.size);
+}
+
+void VulkanContext::destroyBufferDeferred(VkBuffer buffer, VkDeviceMemory bufferMemory) const
+{
+    if (buffer == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    DeferredDestroyEntry entry;
+    entry.frameNumber   = m_frameNumber;
+    entry.timelineValue = 0; // Stamped by the next endFrame() in timeline mode.
+    entry.handle        = (std::uint64_t)buffer;
+    entry.memHandle     = (std::uint64_t)bufferMemory;
+    entry.vkDestroyFn   = nullptr;
+    entry.invoke      = [](const VulkanContext & ctx, const DeferredDestroyEntry & e)
+    {
+        ctx.destroyBuffer((VkBuffer)e.handle, (VkDeviceMemory)e.memHandle);
+    };
+
+    enqueueDeferredDestroy(entry);
+}
+
+void VulkanContext::destroyImageDeferred(VkImage image, VkDeviceMemory imageMemory) const
+{
+    if (image == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    DeferredDestroyEntry entry;
+    entry.frameNumber   = m_frameNumber;
+    entry.timelineValue = 0; // Stamped by the next endFrame() in timeline mode.
+    entry.handle        = (std::uint64_t)image;
+    entry.memHandle     = (std::uint64_t)imageMemory;
+    entry.vkDestroyFn   = nullptr;
+    entry.invoke      = [](const VulkanContext & ctx, const DeferredDestroyEntry & e)
+    {
+        ctx.destroyImage((VkImage)e.handle, (VkDeviceMemory)e.memHandle);
+    };
+
+    enqueueDeferredDestroy(entry);
+}
+
+void VulkanContext::enqueueDeferredDestroy(const DeferredDestroyEntry & entry) const
+{
+    assert(entry.invoke != nullptr);
+
+    std::lock_guard<std::mutex> lock{ m_deferredDestroyMutex };
+    m_deferredDestroyQueue.push_back(entry);
+}
+
+void VulkanContext::executeDeferredDestructions(const bool flushAll) const
+{
+    std::lock_guard<std::mutex> lock{ m_deferredDestroyMutex };
+
+    if (m_deferredDestroyQueue.empty())
+    {
+        return;
+    }
+
+    #if defined(VK_KHR_timeline_semaphore)
+    if (m_timelineSemaphoresSupported && !flushAll)
+    {
+        // Timeline mode: an entry is safe to destroy once the graphics counter
+        // has passed the value endFrame() stamped on it - i.e. the last frame
+        // that could have referenced the handle has actually executed. Sharper
+        // than counting frames: a stalled pipeline can't retire things early
+        // and a fast one doesn't hold them longer than needed.
+        const std::uint64_t completedValue = queryTimelineValue(m_graphicsTimeline);
+
+        std::size_t keepCount = 0;
+        for (std::size_t e = 0; e < m_deferredDestroyQueue.size(); ++e)
+        {
+            const DeferredDestroyEntry & entry = m_deferredDestroyQueue[e];
+            if (entry.timelineValue != 0 && entry.timelineValue <= completedValue)
+            {
+                entry.invoke(*this, entry);
+            }
+            else
+            {
+                m_deferredDestroyQueue[keepCount++] = entry;
+            }
+        }
+        m_deferredDestroyQueue.resize(keepCount);
+        return;
+    }
+    #endif // VK_KHR_timeline_semaphore
+
+    // Retire in place, compacting the survivors to the front of the queue.
+    std::size_t keepCount = 0;
+    for (std::size_t e = 0; e < m_deferredDestroyQueue.size(); ++e)
+    {
+        const DeferredDestroyEntry & entry = m_deferredDestroyQueue[e];
+        if (flushAll || (m_frameNumber - entry.frameNumber) >= FramesBeforeDestruction)
+        {
+            entry.invoke(*this, entry);
+        }
+        else
+        {
+            m_deferredDestroyQueue[keepCount++] = entry;
+        }
+    }
+    m_deferredDestroyQueue.resize(keepCount);
+}
+
+void VulkanContext::registerMemoryBinding(const std::uint64_t resourceHandle,
+                                          const DeviceMemoryAllocator::Allocation & alloc,
+                                          const MemoryTracker::Category category) const
+{
+    std::lock_guard<std::mutex> lock{ m_deviceMemBindingsMutex };
+    m_deviceMemBindings.push_back({ resourceHandle, alloc, category });
+}
+
+VulkanContext::ResourceMemoryBinding VulkanContext::unregisterMemoryBinding(const std::uint64_t resourceHandle) const
+{
+    std::lock_guard<std::mutex> lock{ m_deviceMemBindingsMutex };
+
+    // Search newest-first; resources are commonly destroyed in reverse creation order.
+    for (std::size_t i = m_deviceMemBindings.size(); i-- > 0; )
+    {
+        if (m_deviceMemBindings[i].resourceHandle == resourceHandle)
+        {
+            const auto binding = m_deviceMemBindings[i];
+            m_deviceMemBindings.erase(m_deviceMemBindings.begin() + i);
+            return binding;
+        }
+    }
+
+    Log::fatalF("No device memory binding registered for resource handle %#llx!",
+                static_cast<unsigned long long>(resourceHandle));
+}
+
 void VulkanContext::logInstanceLayerProperties() const
 {
     Log::debugF("------ VK Instance Layer properties ------");
@@ -1129,6 +2575,104 @@ void VulkanContext::shutdownClass()
     GlslShader::shutdownClass();
 }
 
+// ========================================================
+// class StagingRingBuffer:
+// ========================================================
+
+StagingRingBuffer::~StagingRingBuffer()
+{
+    shutdown();
+}
+
+void StagingRingBuffer::initialize(const VkDeviceSize ringSizeBytes)
+{
+    assert(!isInitialized());
+    assert(ringSizeBytes != 0);
+
+    constexpr auto memoryType = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    m_vkContext->createBuffer(ringSizeBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, memoryType,
+                              &m_bufferHandle, &m_bufferMemHandle);
+
+    // Mapped once here and for its whole lifetime - host-visible
+    // allocations always get dedicated memory, so offset zero is the
+    // start of our buffer.
+    VKTB_CHECK(vkMapMemory(m_vkContext->deviceHandle(), m_bufferMemHandle,
+                           0, ringSizeBytes, 0, &m_mappedBaseAddr));
+
+    m_ringSizeBytes = ringSizeBytes;
+    m_ringHead = 0;
+    m_ringTail = 0;
+
+    Log::debugF("Texture staging ring buffer initialized (%zu KB).", std::size_t(ringSizeBytes / 1024));
+}
+
+void StagingRingBuffer::shutdown()
+{
+    if (m_bufferHandle != VK_NULL_HANDLE)
+    {
+        vkUnmapMemory(m_vkContext->deviceHandle(), m_bufferMemHandle);
+        m_vkContext->destroyBuffer(m_bufferHandle, m_bufferMemHandle);
+
+        m_bufferHandle    = VK_NULL_HANDLE;
+        m_bufferMemHandle = VK_NULL_HANDLE;
+        m_mappedBaseAddr  = nullptr;
+        m_ringSizeBytes   = 0;
+    }
+}
+
+StagingRingBuffer::Allocation StagingRingBuffer::allocate(const VkDeviceSize sizeBytes)
+{
+    assert(isInitialized());
+    assert(sizeBytes != 0);
+
+    const std::uint64_t alignedSize = roundUpToMultiple(sizeBytes, AllocationAlignment);
+    if (alignedSize > m_ringSizeBytes)
+    {
+        return {};
+    }
+
+    std::uint64_t oldHead = m_ringHead.load(std::memory_order_relaxed);
+    std::uint64_t allocStart;
+
+    for (;;)
+    {
+        allocStart = oldHead;
+
+        // If the block would straddle the end of the buffer, skip
+        // ahead to the beginning - allocations must be contiguous.
+        const std::uint64_t offsetInRing = allocStart % m_ringSizeBytes;
+        if (offsetInRing + alignedSize > m_ringSizeBytes)
+        {
+            allocStart += m_ringSizeBytes - offsetInRing;
+        }
+
+        const std::uint64_t newHead = allocStart + alignedSize;
+
+        // Out of space - the oldest data in the ring hasn't been
+        // submitted/retired yet, so we can't wrap over it.
+        if (newHead - m_ringTail.load(std::memory_order_relaxed) > m_ringSizeBytes)
+        {
+            return {};
+        }
+
+        if (m_ringHead.compare_exchange_weak(oldHead, newHead, std::memory_order_relaxed))
+        {
+            break;
+        }
+    }
+
+    Allocation alloc;
+    alloc.offsetInBuffer = allocStart % m_ringSizeBytes;
+    alloc.mappedPtr      = static_cast<std::uint8_t *>(m_mappedBaseAddr) + alloc.offsetInBuffer;
+    return alloc;
+}
+
+void StagingRingBuffer::retireCompletedAllocations()
+{
+    // Everything allocated so far has been consumed by the GPU.
+    m_ringTail.store(m_ringHead.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
 // ========================================================
 // class FenceCache:
 // ========================================================
@@ -1218,8 +2762,12 @@ bool AutoFence::wait(const std::uint64_t timeout)
     assert(isWaitable());
     assert(m_cache != nullptr);
 
-    const VkResult res = vkWaitForFences(m_cache->context().deviceHandle(),
-                                         1, &m_fenceHandle, VK_TRUE, timeout);
+    VkResult res;
+    {
+        FrameStats::ScopedTimer timer{ FrameStats::FenceWait };
+        res = vkWaitForFences(m_cache->context().deviceHandle(),
+                              1, &m_fenceHandle, VK_TRUE, timeout);
+    }
 
     if (res == VK_TIMEOUT)
     {
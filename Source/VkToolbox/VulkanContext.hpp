@@ -8,7 +8,10 @@
 // ================================================================================================
 
 #include <vulkan/vulkan.h>
+#include <atomic>
 #include <vector>
+#include <mutex>
+#include <thread>
 
 #include "Log.hpp"
 #include "Utils.hpp"
@@ -18,12 +21,19 @@
 #include "Image.hpp"
 #include "RenderPass.hpp"
 #include "CommandBuffer.hpp"
+#include "DeviceMemoryAllocator.hpp"
+#include "MemoryTracker.hpp"
 
 namespace VkToolbox
 {
 
 class OSWindow;
 class FenceCache;
+class StagingRingBuffer;
+class GpuProfiler;
+
+// File where the device pipeline cache is serialized between runs.
+#define VKTB_PIPELINE_CACHE_FILE "vk_pipeline_cache.bin"
 
 // ========================================================
 // class VulkanContext:
@@ -42,12 +52,16 @@ public:
     };
 
     // Shared configurations for all contexts - these must be set before construction.
-    static const char *   sm_appName;
-    static std::uint32_t  sm_appVersion;
-    static std::uint32_t  sm_multiSampleCount;
-    static VkFormat       sm_depthBufferFormat;
-    static bool           sm_useTripleBufferHint;
-    static ValidationMode sm_validationMode;
+    static const char *     sm_appName;
+    static std::uint32_t    sm_appVersion;
+    static std::uint32_t    sm_multiSampleCount;
+    static VkFormat         sm_depthBufferFormat;
+    static bool             sm_useTripleBufferHint;
+    static VkPresentModeKHR sm_preferredPresentMode; // Falls back to FIFO if the surface doesn't support it.
+    static std::uint32_t    sm_swapChainImageCount;  // Zero derives the count from the triple buffer hint.
+    static int              sm_preferredGpuIndex;    // Explicit physical device index; -1 = auto-select by capability score.
+    static bool             sm_depthPrePassEnabled;  // Prepend a depth-only subpass to the main render pass.
+    static ValidationMode   sm_validationMode;
 
     // Static initialization and shutdown for internal shared state.
     // Call at the beginning/end of main().
@@ -73,6 +87,12 @@ public:
 
     // Device (AKA GPU) info queries:
     VkDevice deviceHandle() const;
+
+    // True when the device was created with VK_EXT_descriptor_indexing -
+    // required by the bindless texture array path (BindlessTextures.hpp).
+    // Always false if the SDK headers predate the extension.
+    bool isDescriptorIndexingSupported() const;
+
     const VkPhysicalDeviceFeatures & deviceFeatures() const;
     const VkPhysicalDeviceProperties & deviceProperties() const;
     const VkPhysicalDeviceMemoryProperties & deviceMemoryProperties() const;
@@ -94,6 +114,141 @@ public:
     const CommandPool & mainTextureStagingCmdBufferPool() const;
     const CommandBuffer & mainTextureStagingCmdBuffer() const;
 
+    // Device-wide pipeline cache, preloaded from disk at startup and serialized
+    // back at shutdown so pipeline creation is cheap on subsequent runs.
+    VkPipelineCache pipelineCacheHandle() const;
+
+    // Shared immutable sampler cache, keyed on a hash of the create parameters.
+    // Virtually every texture samples with the same filtering/wrap state, so
+    // sharing collapses what would be one VkSampler per texture into a handful
+    // of unique objects. Returned handles are owned by the context and stay
+    // valid until it is destroyed - never pass one to vkDestroySampler().
+    VkSampler sharedSampler(const VkSamplerCreateInfo & samplerDesc) const;
+
+    // Cache entry for the common Sampler::defaults() state, created upfront.
+    VkSampler defaultSampler() const;
+
+    // Texture staging buffer for the calling thread. The main thread gets the main
+    // staging buffer; other threads lazily get their own pool/buffer pair, created
+    // already in the recording state. Used by the parallel resource load path.
+    const CommandBuffer & textureStagingCmdBufferForThisThread() const;
+
+    // Ends recording on the main staging buffer and on every per-thread staging
+    // buffer, submits them all in a single batch and blocks until the GPU is done.
+    // The main buffer is reset, the per-thread ones are discarded and the staging
+    // ring space consumed by the batch is reclaimed.
+    void submitAllTextureStagingCmdBuffers() const;
+
+    // Persistent host-visible ring that texture uploads sub-allocate their
+    // staging space from, instead of creating one staging buffer per texture.
+    StagingRingBuffer & textureStagingRingBuffer() const;
+
+    //
+    // Submission batcher:
+    //
+    // vkQueueSubmit is one of the most expensive calls in the API, so upload
+    // command buffers are not submitted individually. Instead they enqueue
+    // into a pending list and get flushed as a single vkQueueSubmit carrying
+    // one VkSubmitInfo batch each, guarded by one fence. The load phase calls
+    // flushPendingSubmits() at its explicit sync points (e.g. right before
+    // releasing staging memory); anything still pending when endFrame() runs
+    // is folded into the frame submission instead. Main thread only.
+    //
+
+    // Add a recorded command buffer to the pending submission list for the
+    // graphics queue. The buffer must stay alive and untouched until the
+    // next flush (or endFrame), which is when it actually reaches the GPU.
+    void enqueueSubmit(const CommandBuffer & cmdBuff) const;
+
+    // Submit everything enqueued so far in one vkQueueSubmit and block until
+    // the GPU has finished with it. No-op if the pending list is empty.
+    void flushPendingSubmits() const;
+
+    bool hasPendingSubmits() const;
+
+    //
+    // Asynchronous uploads (dedicated transfer queue):
+    //
+
+    // True when the device exposes a transfer-only queue family, separate
+    // from the graphics queue. Required by the async upload path below.
+    bool hasDedicatedTransferQueue() const;
+
+    // Begin recording copy commands for the dedicated transfer queue.
+    // Only valid when hasDedicatedTransferQueue().
+    const CommandBuffer & beginAsyncTransfer() const;
+
+    // Record a buffer copy on the transfer queue, plus the transfer->graphics
+    // queue ownership release for the destination. The matching acquire goes
+    // into a graphics command buffer via recordPendingTransferAcquires().
+    void asyncTransferCopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize sizeToCopy) const;
+
+    // Submit the recorded transfer batch. This never blocks the CPU - the next
+    // endFrame() submission waits on the transfer-complete semaphore instead,
+    // so the graphics queue can't consume half-uploaded data.
+    void endAsyncTransfer() const;
+
+    // Record the graphics-side queue ownership acquires matching the releases
+    // of the last transfer batch. Call at the top of the first graphics command
+    // buffer that reads the uploaded buffers.
+    void recordPendingTransferAcquires(const CommandBuffer & cmdBuff) const;
+
+    //
+    // Asynchronous compute (dedicated compute queue):
+    //
+
+    // True when the device exposes a compute-capable queue family separate
+    // from the graphics one. Required by the async compute path below, which
+    // lets GPU compute work (e.g. feedback-buffer processing) overlap
+    // rasterization instead of serializing behind it on the graphics queue.
+    bool hasDedicatedComputeQueue() const;
+
+    // Begin recording dispatches for the dedicated compute queue.
+    // Only valid when hasDedicatedComputeQueue().
+    const CommandBuffer & beginAsyncCompute() const;
+
+    // Compute flavors of the graphics bind helpers - usable on any command
+    // buffer, not just the async compute one.
+    void bindComputePipelineState(const CommandBuffer & cmdBuff, VkPipeline pipeline) const;
+    void bindComputeDescriptorSets(const CommandBuffer & cmdBuff, VkPipelineLayout layout,
+                                   array_view<const VkDescriptorSet> descriptorSets) const;
+
+    void dispatchCompute(const CommandBuffer & cmdBuff,
+                         std::uint32_t groupCountX, std::uint32_t groupCountY, std::uint32_t groupCountZ) const;
+
+    // Record the compute->graphics queue ownership release for a buffer the
+    // batch wrote. The matching graphics-side acquire goes into a graphics
+    // command buffer via recordPendingComputeAcquires().
+    void asyncComputeReleaseBuffer(VkBuffer buffer) const;
+
+    // Submit the recorded compute batch. Never blocks the CPU - the next
+    // endFrame() submission waits on the compute-finished semaphore, so the
+    // graphics queue can't consume results the batch hasn't produced yet.
+    void endAsyncCompute() const;
+
+    // Record the graphics-side queue ownership acquires matching the releases
+    // of the last compute batch. Call at the top of the first graphics command
+    // buffer that reads the compute results.
+    void recordPendingComputeAcquires(const CommandBuffer & cmdBuff) const;
+
+    //
+    // Timeline semaphores (VK_KHR_timeline_semaphore):
+    //
+
+    // True when the optional extension was found at device creation, in which
+    // case submission tracking runs in timeline mode: one monotonically
+    // increasing counter per queue, every tracked submission tagged with the
+    // next value, CPU-side waits done with vkWaitSemaphores on a value and
+    // the deferred-destruction queue keyed off counter values. This replaces
+    // the fence-per-submission pattern - fewer driver objects, cheaper waits
+    // and no binary-semaphore juggling between the transfer/compute queues
+    // and endFrame(). FenceCache/AutoFence remain as the fallback for
+    // drivers (and SDK headers) without the extension.
+    bool hasTimelineSemaphores() const;
+
+    // GPU timestamp profiler for this device (see GpuProfiler.hpp).
+    GpuProfiler & gpuProfiler() const;
+
     //
     // Frame rendering / draw calls:
     //
@@ -101,13 +256,39 @@ public:
     void beginFrame();
     void endFrame(array_view<const VkCommandBuffer> submitBuffers, VkFence fence = VK_NULL_HANDLE);
 
-    void beginRenderPass(const CommandBuffer & cmdBuff) const;
+    void beginRenderPass(const CommandBuffer & cmdBuff, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE) const;
     void endRenderPass(const CommandBuffer & cmdBuff) const;
 
+    // Inheritance info for secondary buffers recorded inside the main render pass
+    // (targets the current swap-chain framebuffer - only valid between begin/endFrame).
+    // The parameterless overload assumes the color shading subpass.
+    VkCommandBufferInheritanceInfo mainRenderPassInheritanceInfo() const;
+    VkCommandBufferInheritanceInfo mainRenderPassInheritanceInfo(std::uint32_t subpass) const;
+
+    // Depth pre-pass subpass layout. When enabled (sm_depthPrePassEnabled at
+    // construction time) the main render pass opens with a depth-only subpass,
+    // so fill-bound scenes can lay down depth with a null fragment stage and
+    // then shade with depth-equal testing, paying fragment work only for the
+    // visible surfaces. An opted-in renderer records the pre-pass draws, calls
+    // nextSubpass() and proceeds with the shading subpass as usual; pipelines
+    // target their subpass via depthPrePassSubpassIndex()/colorSubpassIndex().
+    bool isDepthPrePassEnabled() const;
+    std::uint32_t depthPrePassSubpassIndex() const; // Only meaningful when the pre-pass is enabled.
+    std::uint32_t colorSubpassIndex() const;
+    void nextSubpass(const CommandBuffer & cmdBuff, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE) const;
+
+    // Stitch a set of recorded secondary buffers into the primary buffer.
+    void executeCommands(const CommandBuffer & primaryCmdBuff, array_view<const VkCommandBuffer> secondaryCmdBuffs) const;
+
     void bindGraphicsPipelineState(const CommandBuffer & cmdBuff, VkPipeline pipeline) const;
     void bindGraphicsDescriptorSets(const CommandBuffer & cmdBuff, VkPipelineLayout layout,
                                     array_view<const VkDescriptorSet> descriptorSets) const;
 
+    // Overload for sets with VK_DESCRIPTOR_TYPE_*_DYNAMIC descriptors (e.g. a UniformRingBuffer).
+    void bindGraphicsDescriptorSets(const CommandBuffer & cmdBuff, VkPipelineLayout layout,
+                                    array_view<const VkDescriptorSet> descriptorSets,
+                                    array_view<const std::uint32_t> dynamicOffsets) const;
+
     void bindVertexBuffer(const CommandBuffer & cmdBuff, VkBuffer vb, std::uint32_t offsetInBytes = 0) const;
     void bindIndexBuffer(const CommandBuffer & cmdBuff, VkBuffer ib, VkIndexType type, std::uint32_t offsetInBytes = 0) const;
 
@@ -123,6 +304,13 @@ public:
     // Blocks until all pending GPU work is completed.
     void waitGpuIdle() const;
 
+    // Re-create the swap-chain and the framebuffers/depth-buffer that depend on
+    // it for a new window size. The old swap-chain is handed to the driver via
+    // VkSwapchainCreateInfoKHR::oldSwapchain, so its images get recycled instead
+    // of forcing a full destroy/create round-trip on every resize. Only call
+    // between frames (i.e. outside a beginFrame/endFrame pair).
+    void recreateSwapChain(Size2D newFramebufferSize);
+
     // Default screen framebuffer clear-color and depth/stencil values.
     void setDefaultClearColor(const Vector4 & color);
     const Vector4 & defaultClearColor() const;
@@ -145,6 +333,8 @@ public:
 
     const GpuQueue & presentQueue() const;
     const GpuQueue & graphisQueue() const;
+    const GpuQueue & transferQueue() const;
+    const GpuQueue & computeQueue() const;
 
     //
     // Miscellaneous helpers:
@@ -171,6 +361,48 @@ public:
                       VkBuffer * outBuffer, VkDeviceMemory * outBufferMemory,
                       VkMemoryRequirements * outOptMemReqs = nullptr) const;
 
+    // Destroy a buffer/image created by createBuffer/createImage and release its
+    // memory back to the device memory allocator. These must be used instead of
+    // direct vkFreeMemory since the memory handle may point into a shared slab.
+    void destroyBuffer(VkBuffer buffer, VkDeviceMemory bufferMemory) const;
+    void destroyImage(VkImage image, VkDeviceMemory imageMemory) const;
+
+    //
+    // Deferred destruction:
+    //
+
+    // Number of frames a handle sits in the deferred-destruction queue before
+    // it is actually destroyed - enough for every in-flight frame that might
+    // still reference it to retire first.
+    static constexpr std::uint32_t FramesBeforeDestruction = 4; // > max swap-chain images.
+
+    // Queue any non-dispatchable handle for destruction N frames from now,
+    // e.g.: destroyDeferred(viewHandle, &vkDestroyImageView). This is what
+    // makes hot-reloads stall-free - no waitGpuIdle() before swapping a
+    // resource that live frames still reference. Safe from any thread.
+    template<typename T>
+    void destroyDeferred(T handle, void (VKAPI_CALL * destroyFn)(VkDevice, T, const VkAllocationCallbacks *)) const;
+
+    // Deferred versions of destroyBuffer/destroyImage above.
+    void destroyBufferDeferred(VkBuffer buffer, VkDeviceMemory bufferMemory) const;
+    void destroyImageDeferred(VkImage image, VkDeviceMemory imageMemory) const;
+
+    // Slab occupancy and fragmentation stats for the GPU memory sub-allocator.
+    DeviceMemoryAllocator & deviceMemoryAllocator() const;
+
+    // Per-heap memory budget/usage straight from the driver, polled on demand.
+    // 'supported' stays false when VK_EXT_memory_budget wasn't found at device
+    // creation, in which case only heapCount and heapFlags are filled in.
+    struct MemoryBudget
+    {
+        bool              supported = false;
+        std::uint32_t     heapCount = 0;
+        VkMemoryHeapFlags heapFlags[VK_MAX_MEMORY_HEAPS]   = {};
+        VkDeviceSize      budgetBytes[VK_MAX_MEMORY_HEAPS] = {};
+        VkDeviceSize      usageBytes[VK_MAX_MEMORY_HEAPS]  = {};
+    };
+    MemoryBudget queryMemoryBudget() const;
+
 private:
 
     struct LayerProperties
@@ -181,9 +413,10 @@ private:
 
     struct DepthBuffer
     {
-        VkImage        image  = VK_NULL_HANDLE;
-        VkImageView    view   = VK_NULL_HANDLE;
-        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkImage        image      = VK_NULL_HANDLE;
+        VkImageView    view       = VK_NULL_HANDLE;
+        VkDeviceMemory memory     = VK_NULL_HANDLE;
+        VkDeviceSize   memorySize = 0; // For the usage accounting on destruction.
     };
 
     struct SwapChainBuffer
@@ -218,7 +451,7 @@ private:
     void initDevice();
     void initEnumerateGpus();
     void initSwapChainExtensions();
-    void initSwapChain();
+    void initSwapChain(VkSwapchainKHR oldSwapChain = VK_NULL_HANDLE);
 
     // Framebuffer/depth-buffer/misc initialization/shutdown:
     void initDepthBuffer();
@@ -228,6 +461,8 @@ private:
     void initRenderPass();
     void initCommandPoolAndBuffers();
     void initSemaphores();
+    void initPipelineCache();
+    void savePipelineCacheToDisk() const;
 
 private:
 
@@ -269,10 +504,106 @@ private:
     std::uint32_t m_stencilClearValue = 0;
     std::unique_ptr<FenceCache> m_mainFenceCache;
 
+    // Pipeline cache shared by every pipeline created against this device,
+    // preloaded from/saved to VKTB_PIPELINE_CACHE_FILE.
+    VkPipelineCache m_pipelineCacheHandle = VK_NULL_HANDLE;
+
+    // Shared sampler cache (see sharedSampler()). Only ever holds a handful of
+    // entries, so a flat list search beats any hash table here. Guarded by a
+    // mutex - textures load (and request samplers) from the worker threads.
+    struct CachedSampler
+    {
+        std::uint64_t paramsHash;
+        VkSampler     handle;
+    };
+    mutable std::vector<CachedSampler> m_sharedSamplers;
+    mutable std::mutex m_sharedSamplersMutex;
+    VkSampler m_defaultSampler = VK_NULL_HANDLE;
+
     // Command buffers used exclusively for texture uploads (staging resources).
     CommandPool m_mainTextureStagingCmdBufferPool;
     CommandBuffer m_mainTextureStagingCmdBuffer;
 
+    // Shared staging memory for texture uploads (see textureStagingRingBuffer()).
+    // Mutable because the parallel loaders allocate from it via the const context.
+    mutable std::unique_ptr<StagingRingBuffer> m_textureStagingRing;
+
+    // Timestamp profiler for GPU work submitted through this context.
+    mutable std::unique_ptr<GpuProfiler> m_gpuProfiler;
+
+    // Extra staging command buffers for worker threads doing parallel texture
+    // uploads, created on demand and thrown away once the batch is submitted.
+    // Guarded by m_threadStagingCmdBuffersMutex.
+    struct ThreadStagingCmdBuffer
+    {
+        std::thread::id                owningThread;
+        std::unique_ptr<CommandPool>   pool;
+        std::unique_ptr<CommandBuffer> cmdBuffer;
+    };
+    mutable std::vector<ThreadStagingCmdBuffer> m_threadStagingCmdBuffers;
+    mutable std::mutex m_threadStagingCmdBuffersMutex;
+    std::thread::id m_mainThreadId;
+
+    // Command buffers waiting for the next flushPendingSubmits()/endFrame(),
+    // so several upload batches share a single vkQueueSubmit and fence.
+    mutable std::vector<VkCommandBuffer> m_pendingSubmits;
+
+    // Dedicated transfer queue machinery for the asynchronous upload path.
+    // Only created when the GPU has a transfer-only queue family. Mutable
+    // because uploads are allowed from const contexts, like texture staging.
+    mutable std::unique_ptr<CommandPool>   m_transferCmdBufferPool;
+    mutable std::unique_ptr<CommandBuffer> m_transferCmdBuffer;
+    mutable std::vector<VkBuffer> m_pendingTransferAcquires;
+    mutable VkFence m_transferCompleteFence = VK_NULL_HANDLE;
+    mutable bool m_asyncTransferSubmitted   = false;
+    VkSemaphore m_transferFinishedSemaphore = VK_NULL_HANDLE;
+
+    // Same machinery for the dedicated compute queue - GPU compute batches
+    // that run alongside rasterization and get waited on by endFrame().
+    mutable std::unique_ptr<CommandPool>   m_computeCmdBufferPool;
+    mutable std::unique_ptr<CommandBuffer> m_computeCmdBuffer;
+    mutable std::vector<VkBuffer> m_pendingComputeAcquires;
+    mutable VkFence m_computeCompleteFence = VK_NULL_HANDLE;
+    mutable bool m_asyncComputeSubmitted   = false;
+    VkSemaphore m_computeFinishedSemaphore = VK_NULL_HANDLE;
+
+    // Slab sub-allocator servicing createBuffer/createImage, plus the bookkeeping
+    // needed to map a resource handle back to its sub-allocation on destruction.
+    // Mutable because buffer/image creation is allowed from const contexts.
+    struct ResourceMemoryBinding
+    {
+        std::uint64_t resourceHandle;
+        DeviceMemoryAllocator::Allocation allocation;
+        MemoryTracker::Category category; // For the usage accounting on destruction.
+    };
+    mutable std::unique_ptr<DeviceMemoryAllocator> m_deviceMemAllocator;
+    mutable std::vector<ResourceMemoryBinding> m_deviceMemBindings;
+    mutable std::mutex m_deviceMemBindingsMutex; // Resources may be created/destroyed from the load threads.
+
+    void registerMemoryBinding(std::uint64_t resourceHandle, const DeviceMemoryAllocator::Allocation & alloc,
+                               MemoryTracker::Category category) const;
+    ResourceMemoryBinding unregisterMemoryBinding(std::uint64_t resourceHandle) const;
+
+    // Deferred-destruction queue. Entries are retired by beginFrame() once
+    // FramesBeforeDestruction frames have gone by - or, in timeline mode,
+    // once the graphics timeline counter passes the value stamped on the
+    // entry by endFrame(). Guarded by its own mutex - resources may be
+    // destroyed from the loader threads.
+    struct DeferredDestroyEntry
+    {
+        std::uint32_t frameNumber;   // Frame the entry was enqueued on.
+        std::uint64_t timelineValue; // Timeline mode: graphics counter value that must complete first (0 = not stamped yet).
+        std::uint64_t handle;
+        std::uint64_t memHandle;     // Optional paired VkDeviceMemory (buffers/images).
+        void *        vkDestroyFn;   // Typed vkDestroy* function, cast back by invoke.
+        void        (*invoke)(const VulkanContext &, const DeferredDestroyEntry &);
+    };
+    mutable std::vector<DeferredDestroyEntry> m_deferredDestroyQueue;
+    mutable std::mutex m_deferredDestroyMutex;
+
+    void enqueueDeferredDestroy(const DeferredDestroyEntry & entry) const;
+    void executeDeferredDestructions(bool flushAll) const;
+
     // Handle to the "Physical Device", AKA the GPU. This handle is owned by the VK instance.
     // Vulkan allows explicitly selecting the device you want to use, on systems with more than one
     // GPU (e.g. SLI, Crossfire, etc). We will be sticking to a single GPU for now.
@@ -285,11 +616,50 @@ private:
     // Queue index/handle helpers:
     GpuQueue m_gpuPresentQueue;
     GpuQueue m_gpuGraphicsQueue;
+    GpuQueue m_gpuTransferQueue; // Transfer-only family; familyIndex stays -1 when the GPU has none.
+    GpuQueue m_gpuComputeQueue;  // Compute-capable family without graphics; familyIndex -1 when absent.
 
     // Information bits about the graphics hardware physical limitations.
     // We only care about the first GPU for now.
     GpuInfo m_gpuInfo;
 
+    // Set if the optional VK_EXT_descriptor_indexing device extension was
+    // found and enabled at device creation (see BindlessTextures.hpp).
+    bool m_descriptorIndexingSupported = false;
+
+    // Set if the optional VK_EXT_memory_budget device extension was found
+    // and enabled at device creation (see queryMemoryBudget()).
+    bool m_memoryBudgetSupported = false;
+
+    // Set if VK_KHR_timeline_semaphore was found and enabled at device
+    // creation (see hasTimelineSemaphores()). Always false when compiling
+    // against SDK headers that predate the extension.
+    bool m_timelineSemaphoresSupported = false;
+
+    #if defined(VK_KHR_timeline_semaphore)
+    // One timeline per queue; m_*TimelineValue is the value the last tracked
+    // submission on that queue signals. Mutable for the same reason as the
+    // fences they replace - uploads happen through the const context.
+    VkSemaphore m_graphicsTimeline = VK_NULL_HANDLE;
+    VkSemaphore m_transferTimeline = VK_NULL_HANDLE;
+    VkSemaphore m_computeTimeline  = VK_NULL_HANDLE;
+    mutable std::uint64_t m_graphicsTimelineValue = 0;
+    mutable std::uint64_t m_transferTimelineValue = 0;
+    mutable std::uint64_t m_computeTimelineValue  = 0;
+
+    // Extension entry points, resolved at device creation.
+    PFN_vkWaitSemaphoresKHR           m_pfnWaitSemaphores           = nullptr;
+    PFN_vkGetSemaphoreCounterValueKHR m_pfnGetSemaphoreCounterValue = nullptr;
+
+    void initTimelineSemaphores();
+    void waitTimelineValue(VkSemaphore timeline, std::uint64_t value) const;
+    std::uint64_t queryTimelineValue(VkSemaphore timeline) const;
+    #endif // VK_KHR_timeline_semaphore
+
+    // sm_depthPrePassEnabled frozen at construction time, so the subpass
+    // layout can't change under pipelines created against the render pass.
+    bool m_depthPrePassEnabled = false;
+
     // Layers and extensions available for the VK Instance.
     std::vector<LayerProperties> m_instanceLayerProperties;
 };
@@ -392,6 +762,79 @@ private:
     VkFence      m_fenceHandle;
 };
 
+// ========================================================
+// class StagingRingBuffer:
+// ========================================================
+
+// Persistent host-visible ring buffer shared by every texture upload.
+// Loads carve transient staging space out of the ring instead of creating
+// one dedicated staging buffer each, so a whole level's worth of textures
+// goes through a single buffer with zero per-texture allocations. The
+// space consumed by a staging batch is reclaimed in bulk once the batch
+// submission fence has been waited on. Allocation is thread-safe, for
+// the parallel texture loaders.
+class StagingRingBuffer final
+{
+public:
+
+    // Enough for a 4096x4096 RGBA8 texture with a full mipmap
+    // chain, with plenty of room left for the smaller ones.
+    static constexpr VkDeviceSize DefaultSizeBytes = 96 * 1024 * 1024;
+
+    // Sub-allocations are aligned to this, which satisfies the
+    // vkCmdCopyBufferToImage offset rules for every format we load.
+    static constexpr VkDeviceSize AllocationAlignment = 16;
+
+    struct Allocation
+    {
+        VkDeviceSize offsetInBuffer = 0;
+        void * mappedPtr = nullptr; // Write the pixel data here - the ring is persistently mapped.
+
+        bool isValid() const { return (mappedPtr != nullptr); }
+    };
+
+    explicit StagingRingBuffer(const VulkanContext & vkContext)
+        : m_vkContext{ &vkContext }
+    { }
+
+    ~StagingRingBuffer();
+
+    // Not copyable.
+    StagingRingBuffer(const StagingRingBuffer &) = delete;
+    StagingRingBuffer & operator = (const StagingRingBuffer &) = delete;
+
+    void initialize(VkDeviceSize ringSizeBytes);
+    void shutdown();
+    bool isInitialized() const { return (m_bufferHandle != VK_NULL_HANDLE); }
+
+    // Carve sizeBytes out of the ring (lock-free, any thread). Returns an invalid
+    // Allocation when the request doesn't fit, in which case the caller must fall
+    // back to a dedicated staging buffer.
+    Allocation allocate(VkDeviceSize sizeBytes);
+
+    // Reclaim every allocation handed out so far. Only call after the staging
+    // submission fence has been waited on - the GPU is done with the data.
+    void retireCompletedAllocations();
+
+    VkBuffer bufferHandle() const { return m_bufferHandle; }
+    VkDeviceSize sizeBytes() const { return m_ringSizeBytes; }
+
+private:
+
+    const VulkanContext * m_vkContext;
+
+    VkBuffer       m_bufferHandle    = VK_NULL_HANDLE;
+    VkDeviceMemory m_bufferMemHandle = VK_NULL_HANDLE;
+    void *         m_mappedBaseAddr  = nullptr;
+    VkDeviceSize   m_ringSizeBytes   = 0;
+
+    // Monotonically increasing byte cursors - modulo the ring size gives the
+    // buffer offset. The head is bumped by the loader threads as they allocate,
+    // the tail only catches up on retireCompletedAllocations().
+    std::atomic<std::uint64_t> m_ringHead{ 0 };
+    std::atomic<std::uint64_t> m_ringTail{ 0 };
+};
+
 // ========================================================
 // class Fence:
 // ========================================================
@@ -533,7 +976,8 @@ private:
     {
         if (m_handle != VK_NULL_HANDLE)
         {
-            m_deleter(m_vkContex->deviceHandle(), m_handle, m_vkContex->allocationCallbacks());
+            // Deferred so the handle can be replaced while in-flight frames still use it.
+            m_vkContex->destroyDeferred(m_handle, m_deleter);
             m_handle = VK_NULL_HANDLE;
         }
     }
@@ -558,6 +1002,11 @@ inline VkDevice VulkanContext::deviceHandle() const
     return m_device;
 }
 
+inline bool VulkanContext::isDescriptorIndexingSupported() const
+{
+    return m_descriptorIndexingSupported;
+}
+
 inline const VkPhysicalDeviceMemoryProperties & VulkanContext::deviceMemoryProperties() const
 {
     return m_gpuInfo.memoryProperties;
@@ -633,6 +1082,32 @@ inline const CommandBuffer & VulkanContext::mainTextureStagingCmdBuffer() const
     return m_mainTextureStagingCmdBuffer;
 }
 
+inline StagingRingBuffer & VulkanContext::textureStagingRingBuffer() const
+{
+    return *m_textureStagingRing;
+}
+
+inline GpuProfiler & VulkanContext::gpuProfiler() const
+{
+    return *m_gpuProfiler;
+}
+
+inline VkPipelineCache VulkanContext::pipelineCacheHandle() const
+{
+    return m_pipelineCacheHandle;
+}
+
+inline VkSampler VulkanContext::defaultSampler() const
+{
+    assert(m_defaultSampler != VK_NULL_HANDLE);
+    return m_defaultSampler;
+}
+
+inline DeviceMemoryAllocator & VulkanContext::deviceMemoryAllocator() const
+{
+    return *m_deviceMemAllocator;
+}
+
 inline const VulkanContext::GpuQueue & VulkanContext::presentQueue() const
 {
     return m_gpuPresentQueue;
@@ -643,6 +1118,36 @@ inline const VulkanContext::GpuQueue & VulkanContext::graphisQueue() const
     return m_gpuGraphicsQueue;
 }
 
+inline const VulkanContext::GpuQueue & VulkanContext::transferQueue() const
+{
+    return m_gpuTransferQueue;
+}
+
+inline const VulkanContext::GpuQueue & VulkanContext::computeQueue() const
+{
+    return m_gpuComputeQueue;
+}
+
+inline bool VulkanContext::hasDedicatedTransferQueue() const
+{
+    return (m_gpuTransferQueue.familyIndex != -1);
+}
+
+inline bool VulkanContext::hasDedicatedComputeQueue() const
+{
+    return (m_gpuComputeQueue.familyIndex != -1);
+}
+
+inline bool VulkanContext::hasTimelineSemaphores() const
+{
+    return m_timelineSemaphoresSupported;
+}
+
+inline bool VulkanContext::hasPendingSubmits() const
+{
+    return !m_pendingSubmits.empty();
+}
+
 inline void VulkanContext::setDefaultClearColor(const Vector4 & color)
 {
     m_colorClearValue = color;
@@ -673,7 +1178,7 @@ inline std::uint32_t VulkanContext::defaultClearStencil() const
     return m_stencilClearValue;
 }
 
-inline void VulkanContext::beginRenderPass(const CommandBuffer & cmdBuff) const
+inline void VulkanContext::beginRenderPass(const CommandBuffer & cmdBuff, const VkSubpassContents contents) const
 {
     assert(cmdBuff.isInRecordingState());
 
@@ -697,7 +1202,7 @@ inline void VulkanContext::beginRenderPass(const CommandBuffer & cmdBuff) const
     renderPassInfo.clearValueCount          = 2; // Number of attachments in the pass
     renderPassInfo.pClearValues             = clearValues;
 
-    vkCmdBeginRenderPass(cmdBuff.commandBufferHandle(), &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(cmdBuff.commandBufferHandle(), &renderPassInfo, contents);
 }
 
 inline void VulkanContext::endRenderPass(const CommandBuffer & cmdBuff) const
@@ -706,6 +1211,58 @@ inline void VulkanContext::endRenderPass(const CommandBuffer & cmdBuff) const
     vkCmdEndRenderPass(cmdBuff.commandBufferHandle());
 }
 
+inline VkCommandBufferInheritanceInfo VulkanContext::mainRenderPassInheritanceInfo() const
+{
+    return mainRenderPassInheritanceInfo(colorSubpassIndex());
+}
+
+inline VkCommandBufferInheritanceInfo VulkanContext::mainRenderPassInheritanceInfo(const std::uint32_t subpass) const
+{
+    VkCommandBufferInheritanceInfo inheritanceInfo;
+    inheritanceInfo.sType                = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.pNext                = nullptr;
+    inheritanceInfo.renderPass           = mainRenderPass();
+    inheritanceInfo.subpass              = subpass;
+    inheritanceInfo.framebuffer          = framebufferHandle(swapChainBufferIndex());
+    inheritanceInfo.occlusionQueryEnable = VK_FALSE;
+    inheritanceInfo.queryFlags           = 0;
+    inheritanceInfo.pipelineStatistics   = 0;
+    return inheritanceInfo;
+}
+
+inline bool VulkanContext::isDepthPrePassEnabled() const
+{
+    return m_depthPrePassEnabled;
+}
+
+inline std::uint32_t VulkanContext::depthPrePassSubpassIndex() const
+{
+    assert(m_depthPrePassEnabled);
+    return 0;
+}
+
+inline std::uint32_t VulkanContext::colorSubpassIndex() const
+{
+    return (m_depthPrePassEnabled ? 1 : 0);
+}
+
+inline void VulkanContext::nextSubpass(const CommandBuffer & cmdBuff, const VkSubpassContents contents) const
+{
+    assert(cmdBuff.isInRecordingState());
+    vkCmdNextSubpass(cmdBuff.commandBufferHandle(), contents);
+}
+
+inline void VulkanContext::executeCommands(const CommandBuffer & primaryCmdBuff,
+                                           array_view<const VkCommandBuffer> secondaryCmdBuffs) const
+{
+    assert(primaryCmdBuff.isInRecordingState());
+    assert(!secondaryCmdBuffs.empty());
+
+    vkCmdExecuteCommands(primaryCmdBuff.commandBufferHandle(),
+                         static_cast<std::uint32_t>(secondaryCmdBuffs.size()),
+                         secondaryCmdBuffs.data());
+}
+
 inline void VulkanContext::bindGraphicsPipelineState(const CommandBuffer & cmdBuff, VkPipeline pipeline) const
 {
     assert(pipeline != VK_NULL_HANDLE);
@@ -722,6 +1279,40 @@ inline void VulkanContext::bindGraphicsDescriptorSets(const CommandBuffer & cmdB
                             static_cast<std::uint32_t>(descriptorSets.size()), descriptorSets.data(), 0, nullptr);
 }
 
+inline void VulkanContext::bindGraphicsDescriptorSets(const CommandBuffer & cmdBuff, VkPipelineLayout layout,
+                                                      array_view<const VkDescriptorSet> descriptorSets,
+                                                      array_view<const std::uint32_t> dynamicOffsets) const
+{
+    assert(layout != VK_NULL_HANDLE);
+    assert(cmdBuff.isInRecordingState());
+    vkCmdBindDescriptorSets(cmdBuff.commandBufferHandle(), VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0,
+                            static_cast<std::uint32_t>(descriptorSets.size()), descriptorSets.data(),
+                            static_cast<std::uint32_t>(dynamicOffsets.size()), dynamicOffsets.data());
+}
+
+inline void VulkanContext::bindComputePipelineState(const CommandBuffer & cmdBuff, VkPipeline pipeline) const
+{
+    assert(pipeline != VK_NULL_HANDLE);
+    assert(cmdBuff.isInRecordingState());
+    vkCmdBindPipeline(cmdBuff.commandBufferHandle(), VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+}
+
+inline void VulkanContext::bindComputeDescriptorSets(const CommandBuffer & cmdBuff, VkPipelineLayout layout,
+                                                     array_view<const VkDescriptorSet> descriptorSets) const
+{
+    assert(layout != VK_NULL_HANDLE);
+    assert(cmdBuff.isInRecordingState());
+    vkCmdBindDescriptorSets(cmdBuff.commandBufferHandle(), VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0,
+                            static_cast<std::uint32_t>(descriptorSets.size()), descriptorSets.data(), 0, nullptr);
+}
+
+inline void VulkanContext::dispatchCompute(const CommandBuffer & cmdBuff, const std::uint32_t groupCountX,
+                                           const std::uint32_t groupCountY, const std::uint32_t groupCountZ) const
+{
+    assert(cmdBuff.isInRecordingState());
+    vkCmdDispatch(cmdBuff.commandBufferHandle(), groupCountX, groupCountY, groupCountZ);
+}
+
 inline void VulkanContext::bindVertexBuffer(const CommandBuffer & cmdBuff, VkBuffer vb, const std::uint32_t offsetInBytes) const
 {
     assert(vb != VK_NULL_HANDLE);
@@ -762,6 +1353,31 @@ inline void VulkanContext::waitGpuIdle() const
     vkDeviceWaitIdle(m_device);
 }
 
+template<typename T>
+inline void VulkanContext::destroyDeferred(T handle, void (VKAPI_CALL * destroyFn)(VkDevice, T, const VkAllocationCallbacks *)) const
+{
+    if (handle == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    // C-style casts on purpose - non-dispatchable handles are pointers on
+    // 64bits builds but plain integers on 32bits ones.
+    DeferredDestroyEntry entry;
+    entry.frameNumber   = m_frameNumber;
+    entry.timelineValue = 0; // Stamped by the next endFrame() in timeline mode.
+    entry.handle        = (std::uint64_t)handle;
+    entry.memHandle     = 0;
+    entry.vkDestroyFn   = reinterpret_cast<void *>(destroyFn);
+    entry.invoke      = [](const VulkanContext & ctx, const DeferredDestroyEntry & e)
+    {
+        const auto fn = reinterpret_cast<void (VKAPI_CALL *)(VkDevice, T, const VkAllocationCallbacks *)>(e.vkDestroyFn);
+        fn(ctx.deviceHandle(), (T)e.handle, ctx.allocationCallbacks());
+    };
+
+    enqueueDeferredDestroy(entry);
+}
+
 // ========================================================
 // AutoFence inline methods:
 // ========================================================